@@ -60,6 +60,10 @@ public:
     return Info->get(Inst.getOpcode()).isTerminator();
   }
 
+  /// Returns true if Inst is a prefix that extends the instruction that
+  /// follows it, so that the two issue as one.
+  virtual bool isPrefix(const MCInst &Inst) const { return false; }
+
   /// Given a branch instruction try to get the address the branch
   /// targets. Return true on success, and the address in Target.
   virtual bool
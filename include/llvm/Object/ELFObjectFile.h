@@ -1011,6 +1011,8 @@ StringRef ELFObjectFile<ELFT>::getFileFormatName() const {
       return (IsLittleEndian ? "ELF32-arm-little" : "ELF32-arm-big");
     case ELF::EM_AVR:
       return "ELF32-avr";
+    case ELF::EM_CEESPU:
+      return "ELF32-ceespu";
     case ELF::EM_HEXAGON:
       return "ELF32-hexagon";
     case ELF::EM_LANAI:
@@ -1091,6 +1093,8 @@ template <class ELFT> Triple::ArchType ELFObjectFile<ELFT>::getArch() const {
     default:
       report_fatal_error("Invalid ELFCLASS!");
     }
+  case ELF::EM_CEESPU:
+    return IsLittleEndian ? Triple::ceespu : Triple::ceespueb;
   case ELF::EM_PPC:
     return Triple::ppc;
   case ELF::EM_PPC64:
@@ -110,6 +110,9 @@ private:
       return visitSparc32(Rel, R, Value);
     case Triple::hexagon:
       return visitHexagon(Rel, R, Value);
+    case Triple::ceespu:
+    case Triple::ceespueb:
+      return visitCeespu(Rel, R, Value);
     default:
       HasError = true;
       return 0;
@@ -288,6 +291,13 @@ private:
     return 0;
   }
 
+  uint64_t visitCeespu(uint32_t Rel, RelocationRef R, uint64_t Value) {
+    if (Rel == ELF::R_CEESPU_32)
+      return (Value + getELFAddend(R)) & 0xFFFFFFFF;
+    HasError = true;
+    return 0;
+  }
+
   uint64_t visitCOFF(uint32_t Rel, RelocationRef R, uint64_t Value) {
     switch (ObjToVisit.getArch()) {
     case Triple::x86:
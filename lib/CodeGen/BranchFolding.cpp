@@ -220,10 +220,11 @@ bool BranchFolder::OptimizeFunction(MachineFunction &MF,
   if (!JTI)
     return MadeChange;
 
-  // Walk the function to find jump tables that are live.
+  // Walk the function to find jump tables that are live. Look inside bundles
+  // too, as a bundle header only carries the register operands.
   BitVector JTIsLive(JTI->getJumpTables().size());
   for (const MachineBasicBlock &BB : MF) {
-    for (const MachineInstr &I : BB)
+    for (const MachineInstr &I : BB.instrs())
       for (const MachineOperand &Op : I.operands()) {
         if (!Op.isJTI()) continue;
 
@@ -1155,13 +1155,16 @@ MachineOutliner::createOutlinedFunction(Module &M, const OutlinedFunction &OF,
   // Copy over the instructions for the function using the integer mappings in
   // its sequence.
   for (unsigned Str : OF.Sequence) {
-    MachineInstr *NewMI =
-        MF.CloneMachineInstr(Mapper.IntegerInstructionMap.find(Str)->second);
-    NewMI->dropMemRefs();
-
-    // Don't keep debug information for outlined instructions.
-    NewMI->setDebugLoc(DebugLoc());
-    MBB.insert(MBB.end(), NewMI);
+    // Bundles are mapped as a single instruction, so clone the instructions
+    // inside them as well.
+    MachineInstr &NewMI = MF.CloneMachineInstrBundle(
+        MBB, MBB.end(), *Mapper.IntegerInstructionMap.find(Str)->second);
+    for (MachineInstr &MI : make_range(NewMI.getIterator(), MBB.instr_end())) {
+      MI.dropMemRefs();
+
+      // Don't keep debug information for outlined instructions.
+      MI.setDebugLoc(DebugLoc());
+    }
   }
 
   TII.insertOutlinerEpilogue(MBB, MF, OF.TCI);
@@ -101,6 +101,7 @@
 #include "llvm/MC/MCInstrDesc.h"
 #include "llvm/MC/MCInstrItineraries.h"
 #include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSchedule.h"
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Compiler.h"
@@ -570,6 +571,34 @@ public:
 #endif
 };
 
+/// This class tracks the resources used by the instructions issued in one
+/// cycle. Targets that provide a DFA packetizer are modelled with it. Other
+/// targets are modelled with the processor resources and the issue width of
+/// their scheduling model.
+class ResourceManager {
+private:
+  const MCSubtargetInfo &STI;
+  const MCSchedModel &SM;
+  std::unique_ptr<DFAPacketizer> DFAResources;
+
+  /// The number of units of each processor resource that are in use.
+  SmallVector<unsigned, 8> ProcResourceCount;
+
+  /// The number of instructions issued in the cycle.
+  unsigned NumIssued = 0;
+
+public:
+  ResourceManager(const TargetSubtargetInfo &ST)
+      : STI(ST), SM(ST.getSchedModel()),
+        DFAResources(ST.getInstrInfo()->CreateTargetScheduleState(ST)),
+        ProcResourceCount(SM.getNumProcResourceKinds(), 0) {}
+
+  bool usesDFA() const { return DFAResources != nullptr; }
+  bool canReserveResources(MachineInstr &MI) const;
+  void reserveResources(MachineInstr &MI);
+  void clearResources();
+};
+
 /// This class repesents the scheduled code.  The main data structure is a
 /// map from scheduled cycle to instructions.  During scheduling, the
 /// data structure explicitly represents all stages/iterations.   When
@@ -608,12 +637,12 @@ private:
   /// Virtual register information.
   MachineRegisterInfo &MRI;
 
-  std::unique_ptr<DFAPacketizer> Resources;
+  std::unique_ptr<ResourceManager> Resources;
 
 public:
   SMSchedule(MachineFunction *mf)
       : ST(mf->getSubtarget()), MRI(mf->getRegInfo()),
-        Resources(ST.getInstrInfo()->CreateTargetScheduleState(ST)) {}
+        Resources(llvm::make_unique<ResourceManager>(ST)) {}
 
   void reset() {
     ScheduledInstrs.clear();
@@ -881,6 +910,17 @@ bool MachinePipeliner::swingModuloScheduler(MachineLoop &L) {
 void SwingSchedulerDAG::schedule() {
   AliasAnalysis *AA = &Pass.getAnalysis<AAResultsWrapperPass>().getAAResults();
   buildSchedGraph(AA);
+  // Targets with a DFA packetizer pipeline hardware loops, see below. Their
+  // graph is left as it is.
+  bool UsesDFA = ResourceManager(MF.getSubtarget()).usesDFA();
+  // The loop branch is not scheduled, it is recreated for each block of the
+  // pipelined loop. Drop the edges from the values it reads to ExitSU, so
+  // that only nodes of the loop are left in the graph.
+  if (!UsesDFA) {
+    SmallVector<SDep, 4> ExitPreds(ExitSU.Preds.begin(), ExitSU.Preds.end());
+    for (const SDep &Pred : ExitPreds)
+      ExitSU.removePred(Pred);
+  }
   addLoopCarriedDependences(AA);
   updatePhiDependences();
   Topo.InitDAGTopologicalSorting();
@@ -965,6 +1005,16 @@ void SwingSchedulerDAG::schedule() {
   if (SwpMaxStages > -1 && (int)numStages > SwpMaxStages)
     return;
 
+  // A loop that is not a hardware loop is controlled by the branch that
+  // tests its induction variable. The kernel and each prolog block test the
+  // value of the newest iteration, so it has to be computed in the first
+  // stage.
+  MachineInstr *IndVar = Pass.LI.LoopInductionVar;
+  if (!UsesDFA && IndVar && Schedule.stageScheduled(getSUnit(IndVar)) != 0) {
+    LLVM_DEBUG(dbgs() << "Induction variable is not updated in stage 0\n");
+    return;
+  }
+
   generatePipelinedLoop(Schedule);
   ++NumPipelined;
 }
@@ -1312,16 +1362,52 @@ namespace {
 // the number of functional unit choices.
 struct FuncUnitSorter {
   const InstrItineraryData *InstrItins;
+  const MCSubtargetInfo *STI;
   DenseMap<unsigned, unsigned> Resources;
 
-  FuncUnitSorter(const InstrItineraryData *IID) : InstrItins(IID) {}
+  FuncUnitSorter(const TargetSubtargetInfo &ST)
+      : InstrItins(ST.getInstrItineraryData()), STI(&ST) {}
+
+  bool hasItineraries() const {
+    return InstrItins && !InstrItins->isEmpty();
+  }
+
+  // Return the processor resources written by the instruction, or an empty
+  // range if the scheduling model does not describe it.
+  iterator_range<const MCWriteProcResEntry *>
+  writeProcResources(const MachineInstr &MI) const {
+    const MCSchedModel &SM = STI->getSchedModel();
+    if (!SM.hasInstrSchedModel())
+      return make_range<const MCWriteProcResEntry *>(nullptr, nullptr);
+    const MCSchedClassDesc *SCDesc =
+        SM.getSchedClassDesc(MI.getDesc().getSchedClass());
+    if (!SCDesc->isValid())
+      return make_range<const MCWriteProcResEntry *>(nullptr, nullptr);
+    return make_range(STI->getWriteProcResBegin(SCDesc),
+                      STI->getWriteProcResEnd(SCDesc));
+  }
 
   // Compute the number of functional unit alternatives needed
   // at each stage, and take the minimum value. We prioritize the
-  // instructions by the least number of choices first.
+  // instructions by the least number of choices first. Without
+  // itineraries, the processor resources of the scheduling model are
+  // the functional units.
   unsigned minFuncUnits(const MachineInstr *Inst, unsigned &F) const {
     unsigned schedClass = Inst->getDesc().getSchedClass();
     unsigned min = UINT_MAX;
+    if (!hasItineraries()) {
+      for (const MCWriteProcResEntry &PRE : writeProcResources(*Inst)) {
+        if (!PRE.Cycles)
+          continue;
+        unsigned NumUnits =
+            STI->getSchedModel().getProcResource(PRE.ProcResourceIdx)->NumUnits;
+        if (NumUnits < min) {
+          min = NumUnits;
+          F = PRE.ProcResourceIdx;
+        }
+      }
+      return min;
+    }
     for (const InstrStage *IS = InstrItins->beginStage(schedClass),
                           *IE = InstrItins->endStage(schedClass);
          IS != IE; ++IS) {
@@ -1342,6 +1428,14 @@ struct FuncUnitSorter {
   // the same, highly used, functional unit have high priority.
   void calcCriticalResources(MachineInstr &MI) {
     unsigned SchedClass = MI.getDesc().getSchedClass();
+    if (!hasItineraries()) {
+      for (const MCWriteProcResEntry &PRE : writeProcResources(MI))
+        if (PRE.Cycles && STI->getSchedModel()
+                                  .getProcResource(PRE.ProcResourceIdx)
+                                  ->NumUnits == 1)
+          Resources[PRE.ProcResourceIdx]++;
+      return;
+    }
     for (const InstrStage *IS = InstrItins->beginStage(SchedClass),
                           *IE = InstrItins->endStage(SchedClass);
          IS != IE; ++IS) {
@@ -1365,20 +1459,20 @@ struct FuncUnitSorter {
 } // end anonymous namespace
 
 /// Calculate the resource constrained minimum initiation interval for the
-/// specified loop. We use the DFA to model the resources needed for
-/// each instruction, and we ignore dependences. A different DFA is created
-/// for each cycle that is required. When adding a new instruction, we attempt
-/// to add it to each existing DFA, until a legal space is found. If the
-/// instruction cannot be reserved in an existing DFA, we create a new one.
+/// specified loop. We use the DFA, or the scheduling model, to model the
+/// resources needed for each instruction, and we ignore dependences. A
+/// different resource manager is created for each cycle that is required.
+/// When adding a new instruction, we attempt to add it to each existing
+/// manager, until a legal space is found. If the instruction cannot be
+/// reserved in an existing manager, we create a new one.
 unsigned SwingSchedulerDAG::calculateResMII() {
-  SmallVector<DFAPacketizer *, 8> Resources;
+  SmallVector<ResourceManager *, 8> Resources;
   MachineBasicBlock *MBB = Loop.getHeader();
-  Resources.push_back(TII->CreateTargetScheduleState(MF.getSubtarget()));
+  Resources.push_back(new ResourceManager(MF.getSubtarget()));
 
   // Sort the instructions by the number of available choices for scheduling,
   // least to most. Use the number of critical resources as the tie breaker.
-  FuncUnitSorter FUS =
-      FuncUnitSorter(MF.getSubtarget().getInstrItineraryData());
+  FuncUnitSorter FUS = FuncUnitSorter(MF.getSubtarget());
   for (MachineBasicBlock::iterator I = MBB->getFirstNonPHI(),
                                    E = MBB->getFirstTerminator();
        I != E; ++I)
@@ -1397,11 +1491,13 @@ unsigned SwingSchedulerDAG::calculateResMII() {
     if (TII->isZeroCost(MI->getOpcode()))
       continue;
     // Attempt to reserve the instruction in an existing DFA. At least one
-    // DFA is needed for each cycle.
-    unsigned NumCycles = getSUnit(MI)->Latency;
+    // DFA is needed for each cycle. Without a DFA, an instruction holds its
+    // resources for the cycle it issues in, as SMSchedule::insert assumes.
+    unsigned NumCycles =
+        Resources.front()->usesDFA() ? getSUnit(MI)->Latency : 1;
     unsigned ReservedCycles = 0;
-    SmallVectorImpl<DFAPacketizer *>::iterator RI = Resources.begin();
-    SmallVectorImpl<DFAPacketizer *>::iterator RE = Resources.end();
+    SmallVectorImpl<ResourceManager *>::iterator RI = Resources.begin();
+    SmallVectorImpl<ResourceManager *>::iterator RE = Resources.end();
     for (unsigned C = 0; C < NumCycles; ++C)
       while (RI != RE) {
         if ((*RI++)->canReserveResources(*MI)) {
@@ -1416,8 +1512,7 @@ unsigned SwingSchedulerDAG::calculateResMII() {
     }
     // Add new DFAs, if needed, to reserve resources.
     for (unsigned C = ReservedCycles; C < NumCycles; ++C) {
-      DFAPacketizer *NewResource =
-          TII->CreateTargetScheduleState(MF.getSubtarget());
+      ResourceManager *NewResource = new ResourceManager(MF.getSubtarget());
       assert(NewResource->canReserveResources(*MI) && "Reserve error.");
       NewResource->reserveResources(*MI);
       Resources.push_back(NewResource);
@@ -1425,8 +1520,8 @@ unsigned SwingSchedulerDAG::calculateResMII() {
   }
   int Resmii = Resources.size();
   // Delete the memory for each of the DFAs that were created earlier.
-  for (DFAPacketizer *RI : Resources) {
-    DFAPacketizer *D = RI;
+  for (ResourceManager *RI : Resources) {
+    ResourceManager *D = RI;
     delete D;
   }
   Resources.clear();
@@ -3593,6 +3688,59 @@ void SwingSchedulerDAG::postprocessDAG() {
     M->apply(this);
 }
 
+bool ResourceManager::canReserveResources(MachineInstr &MI) const {
+  if (DFAResources)
+    return DFAResources->canReserveResources(MI);
+
+  if (SM.IssueWidth && NumIssued >= SM.IssueWidth)
+    return false;
+  if (!SM.hasInstrSchedModel())
+    return true;
+  const MCSchedClassDesc *SCDesc =
+      SM.getSchedClassDesc(MI.getDesc().getSchedClass());
+  if (!SCDesc->isValid())
+    return true;
+  for (const MCWriteProcResEntry &PRE :
+       make_range(STI.getWriteProcResBegin(SCDesc),
+                  STI.getWriteProcResEnd(SCDesc))) {
+    if (!PRE.Cycles)
+      continue;
+    if (ProcResourceCount[PRE.ProcResourceIdx] >=
+        SM.getProcResource(PRE.ProcResourceIdx)->NumUnits)
+      return false;
+  }
+  return true;
+}
+
+void ResourceManager::reserveResources(MachineInstr &MI) {
+  if (DFAResources) {
+    DFAResources->reserveResources(MI);
+    return;
+  }
+
+  ++NumIssued;
+  if (!SM.hasInstrSchedModel())
+    return;
+  const MCSchedClassDesc *SCDesc =
+      SM.getSchedClassDesc(MI.getDesc().getSchedClass());
+  if (!SCDesc->isValid())
+    return;
+  for (const MCWriteProcResEntry &PRE :
+       make_range(STI.getWriteProcResBegin(SCDesc),
+                  STI.getWriteProcResEnd(SCDesc)))
+    if (PRE.Cycles)
+      ++ProcResourceCount[PRE.ProcResourceIdx];
+}
+
+void ResourceManager::clearResources() {
+  if (DFAResources) {
+    DFAResources->clearResources();
+    return;
+  }
+  NumIssued = 0;
+  std::fill(ProcResourceCount.begin(), ProcResourceCount.end(), 0);
+}
+
 /// Try to schedule the node at the specified StartCycle and continue
 /// until the node is schedule or the EndCycle is reached.  This function
 /// returns true if the node is scheduled.  This routine may search either
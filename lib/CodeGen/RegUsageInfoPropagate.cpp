@@ -133,7 +133,12 @@ bool RegUsageInfoPropagationPass::runOnMachineFunction(MachineFunction &MF) {
       };
 
       if (const Function *F = findCalledFunction(*M, MI)) {
-        UpdateRegMask(F);
+        // The linker may replace a definition that is not exact, like a
+        // weak or linkonce_odr one, with one that clobbers more registers.
+        if (F->isDefinitionExact())
+          UpdateRegMask(F);
+        else
+          LLVM_DEBUG(dbgs() << "Function definition is not exact\n");
       } else {
         LLVM_DEBUG(dbgs() << "Failed to find call target function\n");
       }
@@ -1085,14 +1085,16 @@ void ScheduleDAGInstrs::fixupKills(MachineBasicBlock &MBB) {
       // Some targets make the (questionable) assumtion that the instructions
       // inside the bundle are ordered and consequently only the last use of
       // a register inside the bundle can kill it.
-      MachineBasicBlock::instr_iterator I = std::next(First);
+      MachineBasicBlock::instr_iterator I = First;
       while (I->isBundledWithSucc())
         ++I;
-      do {
+      while (true) {
         if (!I->isDebugInstr())
           toggleKills(MRI, LiveRegs, *I, true);
+        if (I == First)
+          break;
         --I;
-      } while(I != First);
+      }
     }
   }
 }
@@ -111,8 +111,8 @@ static cl::opt<bool> VerifyMachineCode("verify-machineinstrs", cl::Hidden,
     cl::desc("Verify generated machine code"),
     cl::init(false),
     cl::ZeroOrMore);
-static cl::opt<bool> EnableMachineOutliner("enable-machine-outliner",
-    cl::Hidden,
+static cl::opt<cl::boolOrDefault> EnableMachineOutliner(
+    "enable-machine-outliner", cl::Hidden,
     cl::desc("Enable machine outliner"));
 // Enable or disable FastISel. Both options are needed, because
 // FastISel is enabled by default with -fast, and we wish to be
@@ -906,7 +906,11 @@ void TargetPassConfig::addMachinePasses() {
   addPass(&XRayInstrumentationID, false);
   addPass(&PatchableFunctionID, false);
 
-  if (EnableMachineOutliner)
+  // Targets that enable the outliner by default only get it when optimizing.
+  if (EnableMachineOutliner == cl::BOU_TRUE ||
+      (EnableMachineOutliner == cl::BOU_UNSET &&
+       TM->Options.EnableMachineOutliner &&
+       getOptLevel() != CodeGenOpt::None))
     addPass(createMachineOutlinerPass());
 
   // Add passes that directly emit MI after all other MI passes.
@@ -102,6 +102,13 @@ StringRef llvm::object::getELFRelocationTypeName(uint32_t Machine,
       break;
     }
     break;
+  case ELF::EM_CEESPU:
+    switch (Type) {
+#include "llvm/BinaryFormat/ELFRelocs/Ceespu.def"
+    default:
+      break;
+    }
+    break;
   case ELF::EM_RISCV:
     switch (Type) {
 #include "llvm/BinaryFormat/ELFRelocs/RISCV.def"
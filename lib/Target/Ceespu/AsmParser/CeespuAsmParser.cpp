@@ -0,0 +1,693 @@
+//===-- CeespuAsmParser.cpp - Parse Ceespu assembly to MCInst instructions ===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "InstPrinter/CeespuInstPrinter.h"
+#include "MCTargetDesc/CeespuBaseInfo.h"
+#include "MCTargetDesc/CeespuMCExpr.h"
+#include "MCTargetDesc/CeespuMCTargetDesc.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCExpr.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstBuilder.h"
+#include "llvm/MC/MCParser/MCAsmLexer.h"
+#include "llvm/MC/MCParser/MCParsedAsmOperand.h"
+#include "llvm/MC/MCParser/MCTargetAsmParser.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCStreamer.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/TargetRegistry.h"
+
+#include <limits>
+
+using namespace llvm;
+
+namespace {
+struct CeespuOperand;
+
+class CeespuAsmParser : public MCTargetAsmParser {
+  SMLoc getLoc() const { return getParser().getTok().getLoc(); }
+
+  bool generateImmOutOfRangeError(OperandVector &Operands, uint64_t ErrorInfo,
+                                  int64_t Lower, int64_t Upper, Twine Msg);
+
+  bool MatchAndEmitInstruction(SMLoc IDLoc, unsigned &Opcode,
+                               OperandVector &Operands, MCStreamer &Out,
+                               uint64_t &ErrorInfo,
+                               bool MatchingInlineAsm) override;
+
+  bool ParseRegister(unsigned &RegNo, SMLoc &StartLoc, SMLoc &EndLoc) override;
+
+  bool ParseInstruction(ParseInstructionInfo &Info, StringRef Name,
+                        SMLoc NameLoc, OperandVector &Operands) override;
+
+  bool ParseDirective(AsmToken DirectiveID) override;
+
+  /// Helper for processing MC instructions that have been successfully matched
+  /// by MatchAndEmitInstruction. Immediates that do not fit the instruction
+  /// are split into a SETI prefix and the low 16 bits here.
+  bool processInstruction(MCInst &Inst, SMLoc IDLoc, MCStreamer &Out);
+
+// Auto-generated instruction matching functions
+#define GET_ASSEMBLER_HEADER
+#include "CeespuGenAsmMatcher.inc"
+
+  OperandMatchResultTy parseImmediate(OperandVector &Operands);
+  OperandMatchResultTy parseRegister(OperandVector &Operands);
+  OperandMatchResultTy parseMemOpBaseReg(OperandVector &Operands);
+  OperandMatchResultTy parseOperandWithModifier(OperandVector &Operands);
+
+  bool parseOperand(OperandVector &Operands);
+
+public:
+  enum CeespuMatchResultTy {
+    Match_Dummy = FIRST_TARGET_MATCH_RESULT_TY,
+#define GET_OPERAND_DIAGNOSTIC_TYPES
+#include "CeespuGenAsmMatcher.inc"
+#undef GET_OPERAND_DIAGNOSTIC_TYPES
+  };
+
+  static bool classifySymbolRef(const MCExpr *Expr,
+                                CeespuMCExpr::VariantKind &Kind,
+                                int64_t &Addend);
+
+  CeespuAsmParser(const MCSubtargetInfo &STI, MCAsmParser &Parser,
+                  const MCInstrInfo &MII, const MCTargetOptions &Options)
+      : MCTargetAsmParser(Options, STI, MII) {
+    Parser.addAliasForDirective(".half", ".2byte");
+    Parser.addAliasForDirective(".hword", ".2byte");
+    Parser.addAliasForDirective(".word", ".4byte");
+    setAvailableFeatures(ComputeAvailableFeatures(STI.getFeatureBits()));
+  }
+};
+
+/// CeespuOperand - Instances of this class represent a parsed machine
+/// instruction
+struct CeespuOperand : public MCParsedAsmOperand {
+
+  enum KindTy {
+    Token,
+    Register,
+    Immediate,
+    Memory,
+  } Kind;
+
+  struct RegOp {
+    unsigned RegNum;
+  };
+
+  struct ImmOp {
+    const MCExpr *Val;
+  };
+
+  struct MemOp {
+    unsigned BaseReg;
+    const MCExpr *Offset;
+  };
+
+  SMLoc StartLoc, EndLoc;
+  union {
+    StringRef Tok;
+    RegOp Reg;
+    ImmOp Imm;
+    MemOp Mem;
+  };
+
+  CeespuOperand(KindTy K) : MCParsedAsmOperand(), Kind(K) {}
+
+public:
+  CeespuOperand(const CeespuOperand &o) : MCParsedAsmOperand() {
+    Kind = o.Kind;
+    StartLoc = o.StartLoc;
+    EndLoc = o.EndLoc;
+    switch (Kind) {
+    case Register:
+      Reg = o.Reg;
+      break;
+    case Immediate:
+      Imm = o.Imm;
+      break;
+    case Memory:
+      Mem = o.Mem;
+      break;
+    case Token:
+      Tok = o.Tok;
+      break;
+    }
+  }
+
+  bool isToken() const override { return Kind == Token; }
+  bool isReg() const override { return Kind == Register; }
+  bool isImm() const override { return Kind == Immediate; }
+  bool isMem() const override { return Kind == Memory; }
+
+  static bool evaluateConstantImm(const MCExpr *Val, int64_t &Imm,
+                                  CeespuMCExpr::VariantKind &VK) {
+    bool Ret = false;
+    if (auto *CE = dyn_cast<CeespuMCExpr>(Val)) {
+      Ret = CE->evaluateAsConstant(Imm);
+      VK = CE->getKind();
+    } else if (auto CE = dyn_cast<MCConstantExpr>(Val)) {
+      Ret = true;
+      VK = CeespuMCExpr::VK_Ceespu_None;
+      Imm = CE->getValue();
+    }
+    return Ret;
+  }
+
+  // True if Val is a constant that satisfies IsValidConstant, or a symbol
+  // reference whose modifier is one of the allowed ones.
+  template <typename Pred>
+  static bool isImmOrSymbol(const MCExpr *Val, Pred IsValidConstant,
+                            bool AllowLo, bool AllowHi, bool AllowAbs = false) {
+    int64_t Imm;
+    CeespuMCExpr::VariantKind VK = CeespuMCExpr::VK_Ceespu_None;
+    bool IsValid;
+    if (evaluateConstantImm(Val, Imm, VK))
+      IsValid = VK != CeespuMCExpr::VK_Ceespu_None || IsValidConstant(Imm);
+    else
+      IsValid = CeespuAsmParser::classifySymbolRef(Val, VK, Imm);
+    return IsValid && (VK == CeespuMCExpr::VK_Ceespu_None ||
+                       (AllowLo && VK == CeespuMCExpr::VK_Ceespu_LO) ||
+                       (AllowAbs && VK == CeespuMCExpr::VK_Ceespu_ABS) ||
+                       (AllowHi && VK == CeespuMCExpr::VK_Ceespu_HI));
+  }
+
+  static bool isImm32(int64_t Imm) { return isInt<32>(Imm) || isUInt<32>(Imm); }
+
+  // Predicate methods for AsmOperands defined in CeespuInstrInfo.td
+
+  bool isALUImm() const {
+    return isImm() && isImmOrSymbol(getImm(), isImm32, true, true, true);
+  }
+
+  bool isUImm16() const {
+    return isImm() && isImmOrSymbol(getImm(),
+                                    [](int64_t Imm) {
+                                      return isInt<16>(Imm) || isUInt<16>(Imm);
+                                    },
+                                    false, true);
+  }
+
+  bool isUImm5() const {
+    int64_t Imm;
+    CeespuMCExpr::VariantKind VK;
+    if (!isImm())
+      return false;
+    bool IsConstantImm = evaluateConstantImm(getImm(), Imm, VK);
+    return IsConstantImm && isUInt<5>(Imm) &&
+           VK == CeespuMCExpr::VK_Ceespu_None;
+  }
+
+  bool isBranchTarget() const {
+    return isImm() && isImmOrSymbol(getImm(),
+                                    [](int64_t Imm) {
+                                      return isShiftedInt<14, 2>(Imm);
+                                    },
+                                    false, false);
+  }
+
+  bool isJumpTarget() const {
+    return isImm() && isImmOrSymbol(getImm(),
+                                    [](int64_t Imm) {
+                                      return isImm32(Imm) && (Imm & 3) == 0;
+                                    },
+                                    true, false);
+  }
+
+  bool isMemRegImm() const {
+    return isMem() && isImmOrSymbol(Mem.Offset, isImm32, true, false, true);
+  }
+
+  /// getStartLoc - Gets location of the first token of this operand
+  SMLoc getStartLoc() const override { return StartLoc; }
+  /// getEndLoc - Gets location of the last token of this operand
+  SMLoc getEndLoc() const override { return EndLoc; }
+
+  unsigned getReg() const override {
+    assert(Kind == Register && "Invalid type access!");
+    return Reg.RegNum;
+  }
+
+  const MCExpr *getImm() const {
+    assert(Kind == Immediate && "Invalid type access!");
+    return Imm.Val;
+  }
+
+  StringRef getToken() const {
+    assert(Kind == Token && "Invalid type access!");
+    return Tok;
+  }
+
+  void print(raw_ostream &OS) const override {
+    switch (Kind) {
+    case Immediate:
+      OS << *getImm();
+      break;
+    case Register:
+      OS << "<register " << CeespuInstPrinter::getRegisterName(getReg())
+         << ">";
+      break;
+    case Memory:
+      OS << "<memory " << CeespuInstPrinter::getRegisterName(Mem.BaseReg)
+         << " + " << *Mem.Offset << ">";
+      break;
+    case Token:
+      OS << "'" << getToken() << "'";
+      break;
+    }
+  }
+
+  static std::unique_ptr<CeespuOperand> createToken(StringRef Str, SMLoc S) {
+    auto Op = make_unique<CeespuOperand>(Token);
+    Op->Tok = Str;
+    Op->StartLoc = S;
+    Op->EndLoc = S;
+    return Op;
+  }
+
+  static std::unique_ptr<CeespuOperand> createReg(unsigned RegNo, SMLoc S,
+                                                  SMLoc E) {
+    auto Op = make_unique<CeespuOperand>(Register);
+    Op->Reg.RegNum = RegNo;
+    Op->StartLoc = S;
+    Op->EndLoc = E;
+    return Op;
+  }
+
+  static std::unique_ptr<CeespuOperand> createImm(const MCExpr *Val, SMLoc S,
+                                                  SMLoc E) {
+    auto Op = make_unique<CeespuOperand>(Immediate);
+    Op->Imm.Val = Val;
+    Op->StartLoc = S;
+    Op->EndLoc = E;
+    return Op;
+  }
+
+  static std::unique_ptr<CeespuOperand>
+  createMem(unsigned BaseReg, const MCExpr *Offset, SMLoc S, SMLoc E) {
+    auto Op = make_unique<CeespuOperand>(Memory);
+    Op->Mem.BaseReg = BaseReg;
+    Op->Mem.Offset = Offset;
+    Op->StartLoc = S;
+    Op->EndLoc = E;
+    return Op;
+  }
+
+  void addExpr(MCInst &Inst, const MCExpr *Expr) const {
+    assert(Expr && "Expr shouldn't be null!");
+    int64_t Imm = 0;
+    CeespuMCExpr::VariantKind VK;
+    if (evaluateConstantImm(Expr, Imm, VK))
+      Inst.addOperand(MCOperand::createImm(Imm));
+    else
+      Inst.addOperand(MCOperand::createExpr(Expr));
+  }
+
+  // Used by the TableGen Code
+  void addRegOperands(MCInst &Inst, unsigned N) const {
+    assert(N == 1 && "Invalid number of operands!");
+    Inst.addOperand(MCOperand::createReg(getReg()));
+  }
+
+  void addImmOperands(MCInst &Inst, unsigned N) const {
+    assert(N == 1 && "Invalid number of operands!");
+    addExpr(Inst, getImm());
+  }
+
+  void addMemOperands(MCInst &Inst, unsigned N) const {
+    assert(N == 2 && "Invalid number of operands!");
+    Inst.addOperand(MCOperand::createReg(Mem.BaseReg));
+    addExpr(Inst, Mem.Offset);
+  }
+};
+} // end anonymous namespace.
+
+#define GET_REGISTER_MATCHER
+#define GET_MATCHER_IMPLEMENTATION
+#include "CeespuGenAsmMatcher.inc"
+
+bool CeespuAsmParser::generateImmOutOfRangeError(
+    OperandVector &Operands, uint64_t ErrorInfo, int64_t Lower, int64_t Upper,
+    Twine Msg = "immediate must be an integer in the range") {
+  SMLoc ErrorLoc = ((CeespuOperand &)*Operands[ErrorInfo]).getStartLoc();
+  return Error(ErrorLoc, Msg + " [" + Twine(Lower) + ", " + Twine(Upper) + "]");
+}
+
+bool CeespuAsmParser::MatchAndEmitInstruction(SMLoc IDLoc, unsigned &Opcode,
+                                              OperandVector &Operands,
+                                              MCStreamer &Out,
+                                              uint64_t &ErrorInfo,
+                                              bool MatchingInlineAsm) {
+  MCInst Inst;
+
+  switch (MatchInstructionImpl(Operands, Inst, ErrorInfo, MatchingInlineAsm)) {
+  default:
+    break;
+  case Match_Success:
+    return processInstruction(Inst, IDLoc, Out);
+  case Match_MissingFeature:
+    return Error(IDLoc, "instruction use requires an option to be enabled");
+  case Match_MnemonicFail:
+    return Error(IDLoc, "unrecognized instruction mnemonic");
+  case Match_InvalidOperand: {
+    SMLoc ErrorLoc = IDLoc;
+    if (ErrorInfo != ~0U) {
+      if (ErrorInfo >= Operands.size())
+        return Error(ErrorLoc, "too few operands for instruction");
+
+      ErrorLoc = ((CeespuOperand &)*Operands[ErrorInfo]).getStartLoc();
+      if (ErrorLoc == SMLoc())
+        ErrorLoc = IDLoc;
+    }
+    return Error(ErrorLoc, "invalid operand for instruction");
+  }
+  case Match_InvalidALUImm:
+    return generateImmOutOfRangeError(Operands, ErrorInfo,
+                                      std::numeric_limits<int32_t>::min(),
+                                      std::numeric_limits<uint32_t>::max());
+  case Match_InvalidUImm16:
+    return generateImmOutOfRangeError(Operands, ErrorInfo, -(1 << 15),
+                                      (1 << 16) - 1);
+  case Match_InvalidUImm5:
+    return generateImmOutOfRangeError(Operands, ErrorInfo, 0, (1 << 5) - 1);
+  case Match_InvalidBranchTarget:
+    return generateImmOutOfRangeError(
+        Operands, ErrorInfo, -(1 << 15), (1 << 15) - 4,
+        "branch target must be a symbol or a multiple of 4 bytes in the range");
+  case Match_InvalidJumpTarget: {
+    SMLoc ErrorLoc = ((CeespuOperand &)*Operands[ErrorInfo]).getStartLoc();
+    return Error(ErrorLoc,
+                 "jump target must be a symbol or a word aligned address");
+  }
+  case Match_InvalidMemRegImm: {
+    SMLoc ErrorLoc = ((CeespuOperand &)*Operands[ErrorInfo]).getStartLoc();
+    return Error(ErrorLoc, "operand must be a memory operand 'offset(reg)'");
+  }
+  }
+
+  llvm_unreachable("Unknown match type detected!");
+}
+
+bool CeespuAsmParser::ParseRegister(unsigned &RegNo, SMLoc &StartLoc,
+                                    SMLoc &EndLoc) {
+  const AsmToken &Tok = getParser().getTok();
+  StartLoc = Tok.getLoc();
+  EndLoc = Tok.getEndLoc();
+  RegNo = 0;
+  if (Tok.is(AsmToken::Identifier))
+    RegNo = MatchRegisterName(Tok.getIdentifier());
+  if (RegNo == 0)
+    return Error(Tok.getLoc(), "invalid register name");
+
+  getParser().Lex(); // Eat identifier token.
+  return false;
+}
+
+OperandMatchResultTy CeespuAsmParser::parseRegister(OperandVector &Operands) {
+  if (getLexer().getKind() != AsmToken::Identifier)
+    return MatchOperand_NoMatch;
+
+  StringRef Name = getLexer().getTok().getIdentifier();
+  unsigned RegNo = MatchRegisterName(Name);
+  if (RegNo == 0)
+    return MatchOperand_NoMatch;
+
+  SMLoc S = getLoc();
+  SMLoc E = SMLoc::getFromPointer(S.getPointer() + Name.size());
+  getLexer().Lex();
+  Operands.push_back(CeespuOperand::createReg(RegNo, S, E));
+  return MatchOperand_Success;
+}
+
+OperandMatchResultTy CeespuAsmParser::parseImmediate(OperandVector &Operands) {
+  SMLoc S = getLoc();
+  SMLoc E = SMLoc::getFromPointer(S.getPointer() - 1);
+  const MCExpr *Res;
+
+  switch (getLexer().getKind()) {
+  default:
+    return MatchOperand_NoMatch;
+  case AsmToken::LParen:
+  case AsmToken::Minus:
+  case AsmToken::Plus:
+  case AsmToken::Tilde:
+  case AsmToken::Integer:
+  case AsmToken::String:
+  case AsmToken::Identifier:
+  case AsmToken::Dot:
+    if (getParser().parseExpression(Res))
+      return MatchOperand_ParseFail;
+    break;
+  case AsmToken::Percent:
+    return parseOperandWithModifier(Operands);
+  }
+
+  Operands.push_back(CeespuOperand::createImm(Res, S, E));
+  return MatchOperand_Success;
+}
+
+OperandMatchResultTy
+CeespuAsmParser::parseOperandWithModifier(OperandVector &Operands) {
+  SMLoc S = getLoc();
+  SMLoc E = SMLoc::getFromPointer(S.getPointer() - 1);
+
+  if (getLexer().getKind() != AsmToken::Percent) {
+    Error(getLoc(), "expected '%' for operand modifier");
+    return MatchOperand_ParseFail;
+  }
+
+  getParser().Lex(); // Eat '%'
+
+  if (getLexer().getKind() != AsmToken::Identifier) {
+    Error(getLoc(), "expected valid identifier for operand modifier");
+    return MatchOperand_ParseFail;
+  }
+  StringRef Identifier = getParser().getTok().getIdentifier();
+  CeespuMCExpr::VariantKind VK = CeespuMCExpr::getVariantKindForName(Identifier);
+  if (VK != CeespuMCExpr::VK_Ceespu_LO && VK != CeespuMCExpr::VK_Ceespu_HI &&
+      VK != CeespuMCExpr::VK_Ceespu_ABS) {
+    Error(getLoc(), "unrecognized operand modifier");
+    return MatchOperand_ParseFail;
+  }
+
+  getParser().Lex(); // Eat the identifier
+  if (getLexer().getKind() != AsmToken::LParen) {
+    Error(getLoc(), "expected '('");
+    return MatchOperand_ParseFail;
+  }
+  getParser().Lex(); // Eat '('
+
+  const MCExpr *SubExpr;
+  if (getParser().parseParenExpression(SubExpr, E)) {
+    return MatchOperand_ParseFail;
+  }
+
+  const MCExpr *ModExpr = CeespuMCExpr::create(SubExpr, VK, getContext());
+  Operands.push_back(CeespuOperand::createImm(ModExpr, S, E));
+  return MatchOperand_Success;
+}
+
+// Parses the "(reg)" following the offset of a memory operand and folds the
+// offset operand that was just parsed into a single memory operand.
+OperandMatchResultTy
+CeespuAsmParser::parseMemOpBaseReg(OperandVector &Operands) {
+  if (getLexer().isNot(AsmToken::LParen)) {
+    Error(getLoc(), "expected '('");
+    return MatchOperand_ParseFail;
+  }
+
+  getParser().Lex(); // Eat '('
+
+  if (parseRegister(Operands) != MatchOperand_Success) {
+    Error(getLoc(), "expected register");
+    return MatchOperand_ParseFail;
+  }
+
+  if (getLexer().isNot(AsmToken::RParen)) {
+    Error(getLoc(), "expected ')'");
+    return MatchOperand_ParseFail;
+  }
+
+  SMLoc E = getLoc();
+  getParser().Lex(); // Eat ')'
+
+  auto Base = std::move(Operands.back());
+  Operands.pop_back();
+  auto Offset = std::move(Operands.back());
+  Operands.pop_back();
+  const CeespuOperand &BaseOp = static_cast<const CeespuOperand &>(*Base);
+  const CeespuOperand &OffsetOp = static_cast<const CeespuOperand &>(*Offset);
+  Operands.push_back(CeespuOperand::createMem(
+      BaseOp.getReg(), OffsetOp.getImm(), OffsetOp.getStartLoc(), E));
+  return MatchOperand_Success;
+}
+
+/// Looks at a token type and creates the relevant operand from this
+/// information, adding to Operands. If operand was parsed, returns false, else
+/// true.
+bool CeespuAsmParser::parseOperand(OperandVector &Operands) {
+  // A memory operand without an offset, "(reg)".
+  if (getLexer().is(AsmToken::LParen)) {
+    AsmToken Buf[2];
+    if (getLexer().peekTokens(Buf) == 2 &&
+        Buf[0].is(AsmToken::Identifier) && Buf[1].is(AsmToken::RParen) &&
+        MatchRegisterName(Buf[0].getIdentifier())) {
+      SMLoc S = getLoc();
+      Operands.push_back(CeespuOperand::createImm(
+          MCConstantExpr::create(0, getContext()), S, S));
+      return parseMemOpBaseReg(Operands) != MatchOperand_Success;
+    }
+  }
+
+  // Attempt to parse token as register
+  if (parseRegister(Operands) == MatchOperand_Success)
+    return false;
+
+  // Attempt to parse token as an immediate
+  if (parseImmediate(Operands) == MatchOperand_Success) {
+    // Parse memory base register if present
+    if (getLexer().is(AsmToken::LParen))
+      return parseMemOpBaseReg(Operands) != MatchOperand_Success;
+    return false;
+  }
+
+  // Finally we have exhausted all options and must declare defeat.
+  Error(getLoc(), "unknown operand");
+  return true;
+}
+
+bool CeespuAsmParser::ParseInstruction(ParseInstructionInfo &Info,
+                                       StringRef Name, SMLoc NameLoc,
+                                       OperandVector &Operands) {
+  // First operand is token for instruction
+  Operands.push_back(CeespuOperand::createToken(Name, NameLoc));
+
+  // If there are no more operands, then finish
+  if (getLexer().is(AsmToken::EndOfStatement))
+    return false;
+
+  // Parse first operand
+  if (parseOperand(Operands))
+    return true;
+
+  // Parse until end of statement, consuming commas between operands
+  while (getLexer().is(AsmToken::Comma)) {
+    // Consume comma token
+    getLexer().Lex();
+
+    // Parse next operand
+    if (parseOperand(Operands))
+      return true;
+  }
+
+  if (getLexer().isNot(AsmToken::EndOfStatement)) {
+    SMLoc Loc = getLexer().getLoc();
+    getParser().eatToEndOfStatement();
+    return Error(Loc, "unexpected token");
+  }
+
+  getParser().Lex(); // Consume the EndOfStatement.
+  return false;
+}
+
+bool CeespuAsmParser::classifySymbolRef(const MCExpr *Expr,
+                                        CeespuMCExpr::VariantKind &Kind,
+                                        int64_t &Addend) {
+  Kind = CeespuMCExpr::VK_Ceespu_None;
+  Addend = 0;
+
+  if (const CeespuMCExpr *RE = dyn_cast<CeespuMCExpr>(Expr)) {
+    Kind = RE->getKind();
+    Expr = RE->getSubExpr();
+  }
+
+  // It's a simple symbol reference or constant with no addend.
+  if (isa<MCConstantExpr>(Expr) || isa<MCSymbolRefExpr>(Expr))
+    return true;
+
+  const MCBinaryExpr *BE = dyn_cast<MCBinaryExpr>(Expr);
+  if (!BE)
+    return false;
+
+  if (!isa<MCSymbolRefExpr>(BE->getLHS()))
+    return false;
+
+  if (BE->getOpcode() != MCBinaryExpr::Add &&
+      BE->getOpcode() != MCBinaryExpr::Sub)
+    return false;
+
+  // We are able to support the subtraction of two symbol references
+  if (BE->getOpcode() == MCBinaryExpr::Sub &&
+      isa<MCSymbolRefExpr>(BE->getRHS()))
+    return true;
+
+  // See if the addend is a constant, otherwise there's more going
+  // on here than we can deal with.
+  auto AddendExpr = dyn_cast<MCConstantExpr>(BE->getRHS());
+  if (!AddendExpr)
+    return false;
+
+  Addend = AddendExpr->getValue();
+  if (BE->getOpcode() == MCBinaryExpr::Sub)
+    Addend = -Addend;
+
+  // It's some symbol reference + a constant addend
+  return Kind != CeespuMCExpr::VK_Ceespu_Invalid;
+}
+
+bool CeespuAsmParser::ParseDirective(AsmToken DirectiveID) { return true; }
+
+bool CeespuAsmParser::processInstruction(MCInst &Inst, SMLoc IDLoc,
+                                         MCStreamer &Out) {
+  Inst.setLoc(IDLoc);
+
+  int OpIdx = CeespuII::getSETIExtendedOperand(Inst.getOpcode());
+  if (OpIdx < 0) {
+    Out.EmitInstruction(Inst, getSTI());
+    return false;
+  }
+
+  // A bare symbol in an ALU immediate or a memory offset is a full 32-bit
+  // address. It is emitted as a single instruction that the assembler
+  // relaxes to the SETI prefixed form unless layout shows that the value
+  // fits. Branches and calls to a bare symbol stay a single instruction,
+  // like the ones emitted by the code generator.
+  MCOperand &MO = Inst.getOperand(OpIdx);
+  if (MO.isExpr()) {
+    Out.EmitInstruction(Inst, getSTI());
+    return false;
+  }
+
+  // Jump targets are unsigned and keep the jump kind in their low two bits,
+  // the other immediates are sign extended from 16 bits.
+  bool IsJump = OpIdx == 0;
+  int64_t Imm = MO.getImm();
+  if (IsJump ? isUInt<16>(Imm) : isInt<16>(Imm)) {
+    Out.EmitInstruction(Inst, getSTI());
+    return false;
+  }
+  MCOperand Hi = MCOperand::createImm((Imm >> 16) & 0xffff);
+  MCOperand Lo =
+      MCOperand::createImm(IsJump ? Imm & 0xffff : SignExtend64<16>(Imm));
+
+  MCInst Prefix = MCInstBuilder(Ceespu::SETHI).addOperand(Hi);
+  Prefix.setLoc(IDLoc);
+  Out.EmitInstruction(Prefix, getSTI());
+  MO = Lo;
+  Out.EmitInstruction(Inst, getSTI());
+  return false;
+}
+
+extern "C" void LLVMInitializeCeespuAsmParser() {
+  RegisterMCAsmParser<CeespuAsmParser> X(getTheCeespuTarget());
+  RegisterMCAsmParser<CeespuAsmParser> Y(getTheCeespuebTarget());
+}
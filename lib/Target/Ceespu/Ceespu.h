@@ -19,8 +19,11 @@
 
 namespace llvm {
 class CeespuTargetMachine;
+class CeespuRegisterBankInfo;
+class CeespuSubtarget;
 class AsmPrinter;
 class FunctionPass;
+class InstructionSelector;
 class MCInst;
 class MCOperand;
 class MachineInstr;
@@ -32,6 +35,13 @@ bool LowerCeespuMachineOperandToMCOperand(const MachineOperand &MO,
                                          MCOperand &MCOp, const AsmPrinter &AP);
 
 FunctionPass *createCeespuISelDag(CeespuTargetMachine &TM);
+FunctionPass *createCeespuConstantHoistingPass();
+FunctionPass *createCeespuAlignBranchTargetsPass();
+
+InstructionSelector *
+createCeespuInstructionSelector(const CeespuTargetMachine &TM,
+                                CeespuSubtarget &Subtarget,
+                                CeespuRegisterBankInfo &RBI);
 }
 
 #endif
@@ -0,0 +1,90 @@
+//===-- CeespuAlignBranchTargets.cpp - Align the targets of branches ------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Cores that fetch instructions in aligned blocks lose the part of a block in
+// front of a branch target when the branch is taken. Loop headers are aligned
+// by block placement, this pass optionally aligns every other block that is
+// entered by a branch to the same fetch block size. The padding in front of a
+// block that is also fallen into is executed, so it trades code size and a
+// few nops for fetch bandwidth, and is off by default.
+//
+// It runs before branch relaxation, which takes the padding into account.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Ceespu.h"
+#include "CeespuSubtarget.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/Support/CommandLine.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "ceespu-align-branch-targets"
+
+STATISTIC(NumAligned, "Number of branch targets aligned");
+
+static cl::opt<bool>
+    AlignBranchTargets("ceespu-align-branch-targets", cl::Hidden,
+                       cl::init(false),
+                       cl::desc("Align every branch target to the loop "
+                                "alignment, for cores that fetch in blocks"));
+
+namespace {
+class CeespuAlignBranchTargets : public MachineFunctionPass {
+public:
+  static char ID;
+
+  CeespuAlignBranchTargets() : MachineFunctionPass(ID) {}
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+  StringRef getPassName() const override {
+    return "Ceespu Align Branch Targets";
+  }
+};
+
+char CeespuAlignBranchTargets::ID = 0;
+} // end anonymous namespace
+
+// Returns true if MBB can be entered other than by falling into it.
+static bool isBranchTarget(MachineBasicBlock &MBB) {
+  if (MBB.hasAddressTaken())
+    return true;
+  MachineBasicBlock *LayoutPred = &*std::prev(MBB.getIterator());
+  for (MachineBasicBlock *Pred : MBB.predecessors())
+    if (Pred != LayoutPred || !Pred->canFallThrough())
+      return true;
+  return false;
+}
+
+bool CeespuAlignBranchTargets::runOnMachineFunction(MachineFunction &MF) {
+  if (!AlignBranchTargets || skipFunction(MF.getFunction()) ||
+      MF.getFunction().optForSize())
+    return false;
+
+  const TargetLowering *TLI = MF.getSubtarget().getTargetLowering();
+  unsigned Align = TLI->getPrefLoopAlignment();
+  if (!Align)
+    return false;
+
+  bool Changed = false;
+  for (MachineBasicBlock &MBB : make_range(std::next(MF.begin()), MF.end())) {
+    if (MBB.getAlignment() >= Align || !isBranchTarget(MBB))
+      continue;
+    MBB.setAlignment(Align);
+    ++NumAligned;
+    Changed = true;
+  }
+  return Changed;
+}
+
+FunctionPass *llvm::createCeespuAlignBranchTargetsPass() {
+  return new CeespuAlignBranchTargets();
+}
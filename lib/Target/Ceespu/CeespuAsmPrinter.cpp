@@ -14,20 +14,30 @@
 //===----------------------------------------------------------------------===//
 
 #include "Ceespu.h"
+#include "CeespuFrameLowering.h"
+#include "CeespuMachineFunctionInfo.h"
 #include "CeespuTargetMachine.h"
 #include "InstPrinter/CeespuInstPrinter.h"
+#include "MCTargetDesc/CeespuBaseInfo.h"
 #include "MCTargetDesc/CeespuMCExpr.h"
+#include "llvm/BinaryFormat/ELF.h"
 #include "llvm/CodeGen/AsmPrinter.h"
 #include "llvm/CodeGen/MachineConstantPool.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineInstr.h"
+#include "llvm/CodeGen/MachineJumpTableInfo.h"
 #include "llvm/CodeGen/MachineModuleInfo.h"
 #include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCContext.h"
 #include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCInstBuilder.h"
+#include "llvm/MC/MCSectionELF.h"
 #include "llvm/MC/MCStreamer.h"
 #include "llvm/MC/MCSymbol.h"
+#include "llvm/Target/TargetLoweringObjectFile.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/raw_ostream.h"
+#include <set>
 using namespace llvm;
 
 #define DEBUG_TYPE "asm-printer"
@@ -41,7 +51,10 @@ class CeespuAsmPrinter : public AsmPrinter {
 
   StringRef getPassName() const override { return "Ceespu Assembly Printer"; }
 
+  bool runOnMachineFunction(MachineFunction &MF) override;
   void EmitInstruction(const MachineInstr *MI) override;
+  void EmitJumpTableInfo() override;
+  void EmitEndOfAsmFile(Module &M) override;
 
   bool PrintAsmOperand(const MachineInstr *MI, unsigned OpNo,
                        unsigned AsmVariant, const char *ExtraCode,
@@ -57,6 +70,18 @@ class CeespuAsmPrinter : public AsmPrinter {
   bool lowerOperand(const MachineOperand &MO, MCOperand &MCOp) const {
     return LowerCeespuMachineOperandToMCOperand(MO, MCOp, *this);
   }
+
+ private:
+  void emitLoadJumpTableEntry(const MachineInstr *MI);
+  void recordSaveRestoreCall(const MachineInstr *MI);
+  void emitSaveRestoreRoutine(unsigned NumRegs, bool IsRestore);
+
+  // The number of registers of each save and restore routine that the
+  // functions of the module call.
+  std::set<unsigned> SaveRoutines, RestoreRoutines;
+
+  // The compact jump tables of the current function have 16-bit entries.
+  bool HalfwordJumpTableEntries = false;
 };
 }  // namespace
 
@@ -64,15 +89,235 @@ class CeespuAsmPrinter : public AsmPrinter {
 // instructions) auto-generated.
 #include "CeespuGenMCPseudoLowering.inc"
 
+// Returns how much MI grows if the assembler relaxes it to its long form.
+// Only operands without a modifier are relaxed, see
+// CeespuAsmBackend::mayNeedRelaxation.
+static unsigned getRelaxationGrowth(const TargetInstrInfo &TII,
+                                    const MachineInstr &MI) {
+  unsigned Opc = MI.getOpcode();
+  unsigned RelaxedOpc = CeespuII::getLongBranchOpcode(Opc);
+  int OpIdx = MI.getNumExplicitOperands() - 1;
+  if (!RelaxedOpc) {
+    RelaxedOpc = CeespuII::getSETIPrefixedOpcode(Opc);
+    OpIdx = CeespuII::getSETIExtendedOperand(Opc);
+  }
+  if (!RelaxedOpc)
+    return 0;
+
+  const MachineOperand &MO = MI.getOperand(OpIdx);
+  if (MO.isReg() || MO.isImm() || MO.getTargetFlags() != CeespuII::MO_None)
+    return 0;
+  return TII.get(RelaxedOpc).getSize() - TII.getInstSizeInBytes(MI);
+}
+
+// Returns an upper bound on the size of MF once it is laid out, including
+// the padding before aligned blocks and instructions that the assembler may
+// still relax.
+static uint64_t getFunctionSize(const MachineFunction &MF) {
+  const TargetInstrInfo *TII = MF.getSubtarget().getInstrInfo();
+  uint64_t Size = 0;
+  for (const MachineBasicBlock &MBB : MF) {
+    Size = alignTo(Size, UINT64_C(1) << MBB.getAlignment());
+    for (const MachineInstr &MI : MBB.instrs())
+      if (!MI.isBundle())
+        Size += TII->getInstSizeInBytes(MI) + getRelaxationGrowth(*TII, MI);
+  }
+  return Size;
+}
+
+// The entries of compact jump tables are 16 bits wide if every block is
+// within reach of such an offset from the start of the function. The
+// estimate the lowering uses to pick compact tables cannot tell for certain.
+bool CeespuAsmPrinter::runOnMachineFunction(MachineFunction &MF) {
+  HalfwordJumpTableEntries =
+      MF.getInfo<CeespuMachineFunctionInfo>()->hasCompactJumpTables() &&
+      isUInt<16>(getFunctionSize(MF));
+  return AsmPrinter::runOnMachineFunction(MF);
+}
+
+void CeespuAsmPrinter::emitLoadJumpTableEntry(const MachineInstr *MI) {
+  unsigned Rd = MI->getOperand(0).getReg();
+  unsigned Table = MI->getOperand(1).getReg();
+  unsigned Index = MI->getOperand(2).getReg();
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(Ceespu::SHLI)
+                     .addReg(Rd)
+                     .addReg(Index)
+                     .addImm(HalfwordJumpTableEntries ? 1 : 2));
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(Ceespu::ADD).addReg(Rd).addReg(Table).addReg(Rd));
+  EmitToStreamer(*OutStreamer,
+                 MCInstBuilder(HalfwordJumpTableEntries ? Ceespu::LHU
+                                                        : Ceespu::LW)
+                     .addReg(Rd)
+                     .addReg(Rd)
+                     .addImm(0));
+}
+
 void CeespuAsmPrinter::EmitInstruction(const MachineInstr *MI) {
+  // SETI prefixes are bundled with the instruction they extend.
+  if (MI->isBundle()) {
+    const MachineBasicBlock *MBB = MI->getParent();
+    MachineBasicBlock::const_instr_iterator I = ++MI->getIterator();
+    while (I != MBB->instr_end() && I->isInsideBundle()) {
+      EmitInstruction(&*I);
+      ++I;
+    }
+    return;
+  }
+
+  if (MI->isCall())
+    recordSaveRestoreCall(MI);
+
   // Do any auto-generated pseudo lowerings.
   if (emitPseudoExpansionLowering(*OutStreamer, MI)) return;
 
+  if (MI->getOpcode() == Ceespu::PseudoLJT)
+    return emitLoadJumpTableEntry(MI);
+
+  // Jumps out of range of the 16-bit target get a SETI prefix.
+  if (MI->getOpcode() == Ceespu::PseudoBRLONG) {
+    const MCExpr *Dest =
+        MCSymbolRefExpr::create(MI->getOperand(0).getMBB()->getSymbol(),
+                                OutContext);
+    EmitToStreamer(*OutStreamer,
+                   MCInstBuilder(Ceespu::SETHI)
+                       .addExpr(CeespuMCExpr::create(
+                           Dest, CeespuMCExpr::VK_Ceespu_HI, OutContext)));
+    EmitToStreamer(*OutStreamer,
+                   MCInstBuilder(Ceespu::JMP)
+                       .addExpr(CeespuMCExpr::create(
+                           Dest, CeespuMCExpr::VK_Ceespu_LO, OutContext)));
+    return;
+  }
+
   MCInst TmpInst;
   LowerCeespuMachineInstrToMCInst(MI, TmpInst, *this);
   EmitToStreamer(*OutStreamer, TmpInst);
 }
 
+// The calls may have been moved into outlined functions, so the routines are
+// found by name rather than from the frame of the function.
+void CeespuAsmPrinter::recordSaveRestoreCall(const MachineInstr *MI) {
+  if (!MI->getOperand(0).isSymbol())
+    return;
+  StringRef Name = MI->getOperand(0).getSymbolName();
+  std::set<unsigned> *Routines = nullptr;
+  if (Name.consume_front("__ceespu_save_"))
+    Routines = &SaveRoutines;
+  else if (Name.consume_front("__ceespu_restore_"))
+    Routines = &RestoreRoutines;
+  unsigned NumRegs;
+  if (Routines && !Name.getAsInteger(10, NumRegs))
+    Routines->insert(NumRegs);
+}
+
+// Each routine goes in a COMDAT group of its own, so that the linker keeps
+// one copy of it per program.
+void CeespuAsmPrinter::emitSaveRestoreRoutine(unsigned NumRegs,
+                                              bool IsRestore) {
+  const char *Name =
+      IsRestore ? CeespuFrameLowering::getRestoreRoutineName(NumRegs)
+                : CeespuFrameLowering::getSaveRoutineName(NumRegs);
+  OutStreamer->SwitchSection(OutContext.getELFSection(
+      Twine(".text.") + Name, ELF::SHT_PROGBITS,
+      ELF::SHF_ALLOC | ELF::SHF_EXECINSTR | ELF::SHF_GROUP, 0, Name));
+  EmitAlignment(2);
+  MCSymbol *Sym = OutContext.getOrCreateSymbol(Name);
+  OutStreamer->EmitSymbolAttribute(Sym, MCSA_Global);
+  OutStreamer->EmitSymbolAttribute(Sym, MCSA_Hidden);
+  OutStreamer->EmitSymbolAttribute(Sym, MCSA_ELF_TypeFunction);
+  OutStreamer->EmitLabel(Sym);
+
+  const MCSubtargetInfo &STI = *TM.getMCSubtargetInfo();
+  ArrayRef<MCPhysReg> Regs =
+      CeespuFrameLowering::getSaveRestoreOrder().take_front(NumRegs);
+  int64_t Size = CeespuFrameLowering::getSaveRestoreSize(NumRegs);
+  // clr goes at the top of the area and the registers below it, where the
+  // frame lowering expects them.
+  if (IsRestore) {
+    OutStreamer->EmitInstruction(MCInstBuilder(Ceespu::LW)
+                                     .addReg(Ceespu::LR)
+                                     .addReg(Ceespu::SP)
+                                     .addImm(Size - 4),
+                                 STI);
+    for (unsigned I = 0; I != NumRegs; ++I)
+      OutStreamer->EmitInstruction(MCInstBuilder(Ceespu::LW)
+                                       .addReg(Regs[I])
+                                       .addReg(Ceespu::SP)
+                                       .addImm(Size - 4 * (I + 2)),
+                                   STI);
+    OutStreamer->EmitInstruction(MCInstBuilder(Ceespu::ADDI)
+                                     .addReg(Ceespu::SP)
+                                     .addReg(Ceespu::SP)
+                                     .addImm(Size),
+                                 STI);
+  } else {
+    OutStreamer->EmitInstruction(MCInstBuilder(Ceespu::ADDI)
+                                     .addReg(Ceespu::SP)
+                                     .addReg(Ceespu::SP)
+                                     .addImm(-Size),
+                                 STI);
+    OutStreamer->EmitInstruction(
+        MCInstBuilder(Ceespu::SW)
+            .addReg(CeespuFrameLowering::getSaveRoutineLinkReg())
+            .addReg(Ceespu::SP)
+            .addImm(Size - 4),
+        STI);
+    for (unsigned I = 0; I != NumRegs; ++I)
+      OutStreamer->EmitInstruction(MCInstBuilder(Ceespu::SW)
+                                       .addReg(Regs[I])
+                                       .addReg(Ceespu::SP)
+                                       .addImm(Size - 4 * (I + 2)),
+                                   STI);
+  }
+  OutStreamer->EmitInstruction(MCInstBuilder(Ceespu::RET), STI);
+
+  MCSymbol *End = OutContext.createTempSymbol();
+  OutStreamer->EmitLabel(End);
+  OutStreamer->emitELFSize(
+      Sym, MCBinaryExpr::createSub(MCSymbolRefExpr::create(End, OutContext),
+                                   MCSymbolRefExpr::create(Sym, OutContext),
+                                   OutContext));
+}
+
+void CeespuAsmPrinter::EmitEndOfAsmFile(Module &M) {
+  for (unsigned NumRegs : SaveRoutines)
+    emitSaveRestoreRoutine(NumRegs, /*IsRestore=*/false);
+  for (unsigned NumRegs : RestoreRoutines)
+    emitSaveRestoreRoutine(NumRegs, /*IsRestore=*/true);
+}
+
+// Compact jump tables hold the offset of each destination from the start of
+// the function, which the assembler resolves because both labels are in the
+// function's section.
+void CeespuAsmPrinter::EmitJumpTableInfo() {
+  const MachineJumpTableInfo *MJTI = MF->getJumpTableInfo();
+  if (!MJTI || MJTI->getJumpTables().empty()) return;
+  if (!MF->getInfo<CeespuMachineFunctionInfo>()->hasCompactJumpTables())
+    return AsmPrinter::EmitJumpTableInfo();
+
+  unsigned EntrySize = HalfwordJumpTableEntries ? 2 : 4;
+  OutStreamer->SwitchSection(
+      getObjFileLowering().getSectionForJumpTable(MF->getFunction(), TM));
+  EmitAlignment(Log2_32(EntrySize));
+
+  const MCExpr *Base = MCSymbolRefExpr::create(CurrentFnSym, OutContext);
+  const std::vector<MachineJumpTableEntry> &JT = MJTI->getJumpTables();
+  for (unsigned JTI = 0, E = JT.size(); JTI != E; ++JTI) {
+    const std::vector<MachineBasicBlock *> &JTBBs = JT[JTI].MBBs;
+    // If this jump table was deleted, ignore it.
+    if (JTBBs.empty()) continue;
+
+    OutStreamer->EmitLabel(GetJTISymbol(JTI));
+    for (const MachineBasicBlock *MBB : JTBBs) {
+      const MCExpr *Dest = MCSymbolRefExpr::create(MBB->getSymbol(), OutContext);
+      OutStreamer->EmitValue(MCBinaryExpr::createSub(Dest, Base, OutContext),
+                             EntrySize);
+    }
+  }
+}
+
 bool CeespuAsmPrinter::PrintAsmOperand(const MachineInstr *MI, unsigned OpNo,
                                        unsigned AsmVariant,
                                        const char *ExtraCode, raw_ostream &OS) {
@@ -0,0 +1,369 @@
+//===- CeespuCallLowering.cpp - Call lowering for GlobalISel ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+/// \file
+/// This file implements the lowering of LLVM calls to machine code calls for
+/// GlobalISel. Only the C and fast calling conventions with arguments and
+/// return values of at most 32 bits are handled, everything else falls back to
+/// SelectionDAG.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CeespuCallLowering.h"
+#include "CeespuISelLowering.h"
+#include "CeespuSubtarget.h"
+#include "llvm/CodeGen/Analysis.h"
+#include "llvm/CodeGen/CallingConvLower.h"
+#include "llvm/CodeGen/GlobalISel/MachineIRBuilder.h"
+#include "llvm/CodeGen/GlobalISel/Utils.h"
+#include "llvm/CodeGen/MachineFrameInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+
+using namespace llvm;
+
+#include "CeespuGenCallingConv.inc"
+
+CeespuCallLowering::CeespuCallLowering(const CeespuTargetLowering &TLI)
+    : CallLowering(&TLI) {}
+
+// Integers and pointers of up to 32 bits are passed in a single register or
+// stack slot.
+static bool isSupportedType(const DataLayout &DL, Type *T) {
+  if (T->isPointerTy())
+    return DL.getPointerSizeInBits() == 32;
+  if (!T->isIntegerTy())
+    return false;
+  unsigned Size = T->getIntegerBitWidth();
+  return Size == 1 || Size == 8 || Size == 16 || Size == 32;
+}
+
+// The calling convention only describes integer types, so present pointers to
+// it as i32. The virtual register keeps its pointer type.
+static CallLowering::ArgInfo getArgInfoForCC(const DataLayout &DL,
+                                             const CallLowering::ArgInfo &Arg) {
+  Type *Ty = Arg.Ty->isPointerTy() ? DL.getIntPtrType(Arg.Ty) : Arg.Ty;
+  return CallLowering::ArgInfo(Arg.Reg, Ty, Arg.Flags, Arg.IsFixed);
+}
+
+// The handlers analyze values with the convention of the function being
+// lowered, and CC_Ceespu only follows the fast rules inside fastcc functions.
+// Name the rules of the convention CC instead.
+static CCAssignFn *getAssignFn(CallingConv::ID CC, bool IsRet) {
+  if (CC == CallingConv::Fast)
+    return IsRet ? RetCC_Ceespu_Fast : CC_Ceespu_Fast;
+  return IsRet ? RetCC_Ceespu : CC_Ceespu;
+}
+
+namespace {
+
+/// Helper class for values going out through an ABI boundary (used for handling
+/// function return values and call parameters).
+struct OutgoingValueHandler : public CallLowering::ValueHandler {
+  OutgoingValueHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                       MachineInstrBuilder &MIB, CCAssignFn *AssignFn)
+      : ValueHandler(MIRBuilder, MRI, AssignFn), MIB(MIB) {}
+
+  unsigned getStackAddress(uint64_t Size, int64_t Offset,
+                           MachinePointerInfo &MPO) override {
+    LLT p0 = LLT::pointer(0, 32);
+    LLT s32 = LLT::scalar(32);
+    unsigned SPReg = MRI.createGenericVirtualRegister(p0);
+    MIRBuilder.buildCopy(SPReg, Ceespu::SP);
+
+    unsigned OffsetReg = MRI.createGenericVirtualRegister(s32);
+    MIRBuilder.buildConstant(OffsetReg, Offset);
+
+    unsigned AddrReg = MRI.createGenericVirtualRegister(p0);
+    MIRBuilder.buildGEP(AddrReg, SPReg, OffsetReg);
+
+    MPO = MachinePointerInfo::getStack(MIRBuilder.getMF(), Offset);
+    return AddrReg;
+  }
+
+  void assignValueToReg(unsigned ValVReg, unsigned PhysReg,
+                        CCValAssign &VA) override {
+    unsigned ExtReg = extendRegister(ValVReg, VA);
+    MIRBuilder.buildCopy(PhysReg, ExtReg);
+    MIB.addUse(PhysReg, RegState::Implicit);
+  }
+
+  void assignValueToAddress(unsigned ValVReg, unsigned Addr, uint64_t Size,
+                            MachinePointerInfo &MPO, CCValAssign &VA) override {
+    unsigned ExtReg = extendRegister(ValVReg, VA);
+    auto MMO = MIRBuilder.getMF().getMachineMemOperand(
+        MPO, MachineMemOperand::MOStore, VA.getLocVT().getStoreSize(),
+        /* Alignment */ 0);
+    MIRBuilder.buildStore(ExtReg, Addr, *MMO);
+  }
+
+  bool assignArg(unsigned ValNo, MVT ValVT, MVT LocVT,
+                 CCValAssign::LocInfo LocInfo,
+                 const CallLowering::ArgInfo &Info, CCState &State) override {
+    bool Res = AssignFn(ValNo, ValVT, LocVT, LocInfo, Info.Flags, State);
+    StackSize = State.getNextStackOffset();
+    return Res;
+  }
+
+  MachineInstrBuilder &MIB;
+  uint64_t StackSize = 0;
+};
+
+/// Helper class for values coming in through an ABI boundary (used for handling
+/// formal arguments and call return values).
+struct IncomingValueHandler : public CallLowering::ValueHandler {
+  IncomingValueHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                       CCAssignFn *AssignFn)
+      : ValueHandler(MIRBuilder, MRI, AssignFn) {}
+
+  unsigned getStackAddress(uint64_t Size, int64_t Offset,
+                           MachinePointerInfo &MPO) override {
+    auto &MFI = MIRBuilder.getMF().getFrameInfo();
+
+    int FI = MFI.CreateFixedObject(Size, Offset, true);
+    MPO = MachinePointerInfo::getFixedStack(MIRBuilder.getMF(), FI);
+
+    unsigned AddrReg = MRI.createGenericVirtualRegister(LLT::pointer(0, 32));
+    MIRBuilder.buildFrameIndex(AddrReg, FI);
+    return AddrReg;
+  }
+
+  void assignValueToAddress(unsigned ValVReg, unsigned Addr, uint64_t Size,
+                            MachinePointerInfo &MPO, CCValAssign &VA) override {
+    // A promoted value occupies the whole slot, load it all.
+    if (VA.getLocInfo() != CCValAssign::Full) {
+      unsigned LoadVReg = MRI.createGenericVirtualRegister(LLT::scalar(32));
+      buildLoad(LoadVReg, Addr, 4, MPO);
+      MIRBuilder.buildTrunc(ValVReg, LoadVReg);
+      return;
+    }
+    buildLoad(ValVReg, Addr, Size, MPO);
+  }
+
+  void assignValueToReg(unsigned ValVReg, unsigned PhysReg,
+                        CCValAssign &VA) override {
+    markPhysRegUsed(PhysReg);
+    if (VA.getLocInfo() == CCValAssign::Full) {
+      MIRBuilder.buildCopy(ValVReg, PhysReg);
+      return;
+    }
+
+    // A physical register can not be truncated directly, copy it to a
+    // virtual register first.
+    unsigned PhysRegToVReg = MRI.createGenericVirtualRegister(
+        LLT::scalar(VA.getLocVT().getSizeInBits()));
+    MIRBuilder.buildCopy(PhysRegToVReg, PhysReg);
+    MIRBuilder.buildTrunc(ValVReg, PhysRegToVReg);
+  }
+
+  /// Marks the physical register as used by the incoming value, as a live-in
+  /// for formal arguments or an implicit def of the call for call results.
+  virtual void markPhysRegUsed(unsigned PhysReg) = 0;
+
+private:
+  void buildLoad(unsigned Val, unsigned Addr, uint64_t Size,
+                 MachinePointerInfo &MPO) {
+    auto MMO = MIRBuilder.getMF().getMachineMemOperand(
+        MPO, MachineMemOperand::MOLoad, Size, /* Alignment */ 0);
+    MIRBuilder.buildLoad(Val, Addr, *MMO);
+  }
+};
+
+struct FormalArgHandler : public IncomingValueHandler {
+  FormalArgHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                   CCAssignFn *AssignFn)
+      : IncomingValueHandler(MIRBuilder, MRI, AssignFn) {}
+
+  void markPhysRegUsed(unsigned PhysReg) override {
+    MIRBuilder.getMBB().addLiveIn(PhysReg);
+  }
+};
+
+struct CallReturnHandler : public IncomingValueHandler {
+  CallReturnHandler(MachineIRBuilder &MIRBuilder, MachineRegisterInfo &MRI,
+                    MachineInstrBuilder &MIB, CCAssignFn *AssignFn)
+      : IncomingValueHandler(MIRBuilder, MRI, AssignFn), MIB(MIB) {}
+
+  void markPhysRegUsed(unsigned PhysReg) override {
+    MIB.addDef(PhysReg, RegState::Implicit);
+  }
+
+  MachineInstrBuilder &MIB;
+};
+
+} // end anonymous namespace
+
+bool CeespuCallLowering::lowerReturn(MachineIRBuilder &MIRBuilder,
+                                     const Value *Val, unsigned VReg) const {
+  MachineFunction &MF = MIRBuilder.getMF();
+  const Function &F = MF.getFunction();
+  const DataLayout &DL = MF.getDataLayout();
+
+  CallingConv::ID CC =
+      CeespuTargetLowering::getCallingConvFor(F.getCallingConv(), &F);
+  if (CC != CallingConv::C && CC != CallingConv::Fast)
+    return false;
+
+  auto Ret = MIRBuilder.buildInstrNoInsert(Ceespu::RET);
+
+  if (Val) {
+    if (!isSupportedType(DL, Val->getType()))
+      return false;
+
+    // Return values are always returned in a whole register, extend narrower
+    // ones the way the return attributes ask for.
+    ArgInfo RetInfo(VReg, Val->getType());
+    setArgFlags(RetInfo, AttributeList::ReturnIndex, DL, F);
+    if (Val->getType()->isIntegerTy() &&
+        Val->getType()->getIntegerBitWidth() < 32) {
+      unsigned ExtReg =
+          MF.getRegInfo().createGenericVirtualRegister(LLT::scalar(32));
+      unsigned ExtOpc = TargetOpcode::G_ANYEXT;
+      if (RetInfo.Flags.isSExt())
+        ExtOpc = TargetOpcode::G_SEXT;
+      else if (RetInfo.Flags.isZExt())
+        ExtOpc = TargetOpcode::G_ZEXT;
+      MIRBuilder.buildInstr(ExtOpc).addDef(ExtReg).addUse(VReg);
+      RetInfo = ArgInfo(ExtReg, Type::getInt32Ty(F.getContext()),
+                        RetInfo.Flags);
+    }
+
+    OutgoingValueHandler RetHandler(MIRBuilder, MF.getRegInfo(), Ret,
+                                    getAssignFn(CC, /*IsRet=*/true));
+    if (!handleAssignments(MIRBuilder, getArgInfoForCC(DL, RetInfo),
+                           RetHandler))
+      return false;
+  }
+
+  MIRBuilder.insertInstr(Ret);
+  return true;
+}
+
+bool CeespuCallLowering::lowerFormalArguments(MachineIRBuilder &MIRBuilder,
+                                              const Function &F,
+                                              ArrayRef<unsigned> VRegs) const {
+  // Quick exit if there aren't any args.
+  if (F.arg_empty())
+    return true;
+
+  // Variadic functions spill their register arguments for va_start, and sret
+  // functions remember the returned pointer; both are left to SelectionDAG.
+  CallingConv::ID CC =
+      CeespuTargetLowering::getCallingConvFor(F.getCallingConv(), &F);
+  if (F.isVarArg() || (CC != CallingConv::C && CC != CallingConv::Fast) ||
+      F.hasStructRetAttr())
+    return false;
+
+  MachineFunction &MF = MIRBuilder.getMF();
+  const DataLayout &DL = MF.getDataLayout();
+
+  SmallVector<ArgInfo, 8> ArgInfos;
+  unsigned Idx = 0;
+  for (auto &Arg : F.args()) {
+    if (!isSupportedType(DL, Arg.getType()))
+      return false;
+
+    ArgInfo AInfo(VRegs[Idx], Arg.getType());
+    setArgFlags(AInfo, Idx + AttributeList::FirstArgIndex, DL, F);
+    if (AInfo.Flags.isByVal())
+      return false;
+    ArgInfos.push_back(getArgInfoForCC(DL, AInfo));
+    ++Idx;
+  }
+
+  FormalArgHandler ArgHandler(MIRBuilder, MF.getRegInfo(),
+                              getAssignFn(CC, /*IsRet=*/false));
+  return handleAssignments(MIRBuilder, ArgInfos, ArgHandler);
+}
+
+bool CeespuCallLowering::lowerCall(MachineIRBuilder &MIRBuilder,
+                                   CallingConv::ID CallConv,
+                                   const MachineOperand &Callee,
+                                   const ArgInfo &OrigRet,
+                                   ArrayRef<ArgInfo> OrigArgs) const {
+  MachineFunction &MF = MIRBuilder.getMF();
+  const DataLayout &DL = MF.getDataLayout();
+  const auto &STI = MF.getSubtarget<CeespuSubtarget>();
+  const TargetRegisterInfo *TRI = STI.getRegisterInfo();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+
+  const Function *CalleeFn = nullptr;
+  if (Callee.isGlobal())
+    CalleeFn = dyn_cast<Function>(Callee.getGlobal());
+  CallConv = CeespuTargetLowering::getCallingConvFor(CallConv, CalleeFn);
+  if (CallConv != CallingConv::C && CallConv != CallingConv::Fast)
+    return false;
+  // Inside a fastcc function the C rules can not be named, see getAssignFn.
+  if (CallConv == CallingConv::C &&
+      MF.getFunction().getCallingConv() != CallingConv::C)
+    return false;
+
+  SmallVector<ArgInfo, 8> ArgInfos;
+  for (auto &Arg : OrigArgs) {
+    if (!isSupportedType(DL, Arg.Ty))
+      return false;
+    // Variadic arguments always go on the stack, see CC_Ceespu_VarArg.
+    if (!Arg.IsFixed || Arg.Flags.isByVal() || Arg.Flags.isSRet())
+      return false;
+    ArgInfos.push_back(getArgInfoForCC(DL, Arg));
+  }
+
+  if (OrigRet.Reg && !isSupportedType(DL, OrigRet.Ty))
+    return false;
+
+  auto CallSeqStart = MIRBuilder.buildInstr(Ceespu::ADJCALLSTACKDOWN);
+
+  // Create the call instruction so we can add the implicit uses of arg
+  // registers, but don't insert it yet.
+  bool IsDirect = !Callee.isReg();
+  auto MIB =
+      MIRBuilder.buildInstrNoInsert(IsDirect ? Ceespu::JAL : Ceespu::JALR)
+          .add(Callee)
+          .addRegMask(TRI->getCallPreservedMask(MF, CallConv));
+
+  OutgoingValueHandler ArgHandler(MIRBuilder, MRI, MIB,
+                                  getAssignFn(CallConv, /*IsRet=*/false));
+  if (!handleAssignments(MIRBuilder, ArgInfos, ArgHandler))
+    return false;
+
+  // Now we can add the actual call instruction to the correct basic block.
+  MIRBuilder.insertInstr(MIB);
+
+  if (!IsDirect) {
+    unsigned CalleeReg = Callee.getReg();
+    if (CalleeReg && !TRI->isPhysicalRegister(CalleeReg))
+      MIB->getOperand(0).setReg(constrainOperandRegClass(
+          MF, *TRI, MRI, *STI.getInstrInfo(), *STI.getRegBankInfo(),
+          *MIB.getInstr(), MIB->getDesc(), MIB->getOperand(0), 0));
+  }
+
+  if (OrigRet.Reg) {
+    // Narrow results come back in a whole register.
+    ArgInfo RetInfo = getArgInfoForCC(DL, OrigRet);
+    unsigned RetSize = DL.getTypeSizeInBits(OrigRet.Ty);
+    if (RetSize < 32) {
+      RetInfo.Reg = MRI.createGenericVirtualRegister(LLT::scalar(32));
+      RetInfo.Ty = Type::getInt32Ty(MF.getFunction().getContext());
+    }
+
+    CallReturnHandler RetHandler(MIRBuilder, MRI, MIB,
+                                 getAssignFn(CallConv, /*IsRet=*/true));
+    if (!handleAssignments(MIRBuilder, RetInfo, RetHandler))
+      return false;
+
+    if (RetSize < 32)
+      MIRBuilder.buildTrunc(OrigRet.Reg, RetInfo.Reg);
+  }
+
+  CallSeqStart.addImm(ArgHandler.StackSize).addImm(0);
+  MIRBuilder.buildInstr(Ceespu::ADJCALLSTACKUP)
+      .addImm(ArgHandler.StackSize)
+      .addImm(0);
+
+  return true;
+}
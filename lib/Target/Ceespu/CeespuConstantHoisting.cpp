@@ -0,0 +1,241 @@
+//===-- CeespuConstantHoisting.cpp - Hoist large constants out of loops ---===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// Instructions with an immediate that does not fit in 16 bits are selected as
+// *X pseudos, which are expanded to a SETI prefix and the instruction after
+// register allocation. Inside a loop that costs an extra instruction every
+// iteration. This pass materializes such constants once in the loop preheader
+// and rewrites the users into their register-register form, as long as the
+// loop has registers to spare for them.
+//
+// Loads and stores of globals that are not small data fold the address into
+// a SETI prefixed access. Inside a loop they are split back into an LIX of the
+// address and a plain access, so that MachineLICM can hoist the address.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Ceespu.h"
+#include "CeespuInstrInfo.h"
+#include "CeespuSubtarget.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/Statistic.h"
+#include "llvm/CodeGen/MachineFunctionPass.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+#include "llvm/CodeGen/RegisterClassInfo.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "ceespu-const-hoist"
+
+STATISTIC(NumHoisted, "Number of constants hoisted out of loops");
+STATISTIC(NumRewritten, "Number of instructions using a hoisted constant");
+STATISTIC(NumUnfolded, "Number of global accesses unfolded inside loops");
+
+static cl::opt<bool>
+    EnableConstantHoisting("ceespu-hoist-constants", cl::Hidden, cl::init(true),
+                           cl::desc("Hoist large loop-invariant constants "
+                                    "into registers"));
+
+// Registers left for values computed inside the loop body.
+static cl::opt<unsigned> LoopRegReserve(
+    "ceespu-hoist-constants-reserve", cl::Hidden, cl::init(8),
+    cl::desc("Number of registers kept free for loop-local values when "
+             "hoisting constants"));
+
+namespace {
+class CeespuConstantHoisting : public MachineFunctionPass {
+public:
+  static char ID;
+
+  CeespuConstantHoisting() : MachineFunctionPass(ID) {}
+
+  bool runOnMachineFunction(MachineFunction &MF) override;
+
+  void getAnalysisUsage(AnalysisUsage &AU) const override {
+    AU.setPreservesCFG();
+    AU.addRequired<MachineLoopInfo>();
+    AU.addPreserved<MachineLoopInfo>();
+    MachineFunctionPass::getAnalysisUsage(AU);
+  }
+
+  StringRef getPassName() const override {
+    return "Ceespu loop constant hoisting";
+  }
+
+private:
+  const CeespuInstrInfo *TII;
+  MachineRegisterInfo *MRI;
+  MachineLoopInfo *MLI;
+  RegisterClassInfo RegClassInfo;
+
+  bool processLoop(MachineLoop *L);
+  bool unfoldGlobalAccesses(MachineLoop *L);
+  unsigned countLiveThroughRegs(MachineLoop *L) const;
+};
+} // end anonymous namespace
+
+char CeespuConstantHoisting::ID = 0;
+
+// Returns the register-register form of a SETI-extended ALU pseudo, or 0 if
+// its immediate should stay where it is. The carry forms are left alone
+// because they must stay next to the instruction producing the carry.
+static unsigned getRegRegOpcode(unsigned Opc) {
+  switch (Opc) {
+  default:
+    return 0;
+  case Ceespu::ADDX:
+    return Ceespu::ADD;
+  case Ceespu::SUBX:
+    return Ceespu::SUB;
+  case Ceespu::ORX:
+    return Ceespu::OR;
+  case Ceespu::ANDX:
+    return Ceespu::AND;
+  case Ceespu::XORX:
+    return Ceespu::XOR;
+  case Ceespu::MULX:
+    return Ceespu::MUL;
+  }
+}
+
+// Counts the virtual registers defined outside L and used inside it. These
+// stay live for the whole loop and compete with the hoisted constants.
+unsigned CeespuConstantHoisting::countLiveThroughRegs(MachineLoop *L) const {
+  SmallSet<unsigned, 16> LiveThrough;
+  for (MachineBasicBlock *MBB : L->blocks())
+    for (MachineInstr &MI : *MBB)
+      for (const MachineOperand &MO : MI.uses()) {
+        if (!MO.isReg() || !TargetRegisterInfo::isVirtualRegister(MO.getReg()))
+          continue;
+        MachineInstr *Def = MRI->getVRegDef(MO.getReg());
+        if (Def && !L->contains(Def->getParent()))
+          LiveThrough.insert(MO.getReg());
+      }
+  return LiveThrough.size();
+}
+
+bool CeespuConstantHoisting::unfoldGlobalAccesses(MachineLoop *L) {
+  bool Changed = false;
+  for (MachineBasicBlock *MBB : L->blocks()) {
+    if (MLI->getLoopFor(MBB) != L)
+      continue;
+    for (auto I = MBB->begin(), E = MBB->end(); I != E;) {
+      MachineInstr &MI = *I++;
+      unsigned Opc = CeespuInstrInfo::getExtendedMemOpBase(MI.getOpcode());
+      if (!Opc)
+        continue;
+      // The address is the offset, the base is c0.
+      unsigned AddrReg = MRI->createVirtualRegister(&Ceespu::GPRRegClass);
+      BuildMI(*MBB, MI, MI.getDebugLoc(), TII->get(Ceespu::LIX), AddrReg)
+          .add(MI.getOperand(2));
+      BuildMI(*MBB, MI, MI.getDebugLoc(), TII->get(Opc))
+          .add(MI.getOperand(0))
+          .addReg(AddrReg)
+          .addImm(0)
+          .setMemRefs(MI.memoperands_begin(), MI.memoperands_end());
+      MI.eraseFromParent();
+      ++NumUnfolded;
+      Changed = true;
+    }
+  }
+  return Changed;
+}
+
+bool CeespuConstantHoisting::processLoop(MachineLoop *L) {
+  bool Changed = false;
+  for (MachineLoop *SubLoop : *L)
+    Changed |= processLoop(SubLoop);
+  Changed |= unfoldGlobalAccesses(L);
+
+  MachineBasicBlock *Preheader = L->getLoopPreheader();
+  if (!Preheader)
+    return Changed;
+
+  // Collect the instructions of this loop, not its subloops, by constant.
+  MapVector<int64_t, SmallVector<MachineInstr *, 4>> Users;
+  for (MachineBasicBlock *MBB : L->blocks()) {
+    if (MLI->getLoopFor(MBB) != L)
+      continue;
+    for (MachineInstr &MI : *MBB) {
+      if (!getRegRegOpcode(MI.getOpcode()) || !MI.getOperand(2).isImm())
+        continue;
+      int64_t Imm = SignExtend64<32>(MI.getOperand(2).getImm());
+      if (TII->getMaterializationCost(Imm) > 1)
+        Users[Imm].push_back(&MI);
+    }
+  }
+  if (Users.empty())
+    return Changed;
+
+  // Each hoisted constant occupies a register for the whole loop. Only hoist
+  // as many as fit next to the values that are already live through it.
+  unsigned NumRegs = RegClassInfo.getNumAllocatableRegs(&Ceespu::GPRRegClass);
+  unsigned Used = countLiveThroughRegs(L) + LoopRegReserve;
+  if (Used >= NumRegs)
+    return Changed;
+  unsigned Budget = NumRegs - Used;
+
+  // Prefer the constants with the most users.
+  typedef std::pair<int64_t, SmallVector<MachineInstr *, 4>> Candidate;
+  SmallVector<Candidate, 8> Candidates(Users.begin(), Users.end());
+  std::stable_sort(Candidates.begin(), Candidates.end(),
+                   [](const Candidate &A, const Candidate &B) {
+                     return A.second.size() > B.second.size();
+                   });
+  if (Candidates.size() > Budget)
+    Candidates.resize(Budget);
+
+  MachineBasicBlock::iterator InsertPt = Preheader->getFirstTerminator();
+  DebugLoc DL = InsertPt != Preheader->end() ? InsertPt->getDebugLoc()
+                                             : DebugLoc();
+  for (const Candidate &C : Candidates) {
+    unsigned ConstReg = MRI->createVirtualRegister(&Ceespu::GPRRegClass);
+    TII->movImm32(*Preheader, InsertPt, DL, ConstReg, C.first);
+    ++NumHoisted;
+
+    for (MachineInstr *MI : C.second) {
+      // The register-register forms take their operands as (rb, ra).
+      BuildMI(*MI->getParent(), MI, MI->getDebugLoc(),
+              TII->get(getRegRegOpcode(MI->getOpcode())),
+              MI->getOperand(0).getReg())
+          .addReg(ConstReg)
+          .add(MI->getOperand(1));
+      MI->eraseFromParent();
+      ++NumRewritten;
+    }
+    LLVM_DEBUG(dbgs() << "Hoisted " << C.first << " into "
+                      << printMBBReference(*Preheader) << " for "
+                      << C.second.size() << " users\n");
+  }
+  return true;
+}
+
+bool CeespuConstantHoisting::runOnMachineFunction(MachineFunction &MF) {
+  if (skipFunction(MF.getFunction()) || !EnableConstantHoisting)
+    return false;
+
+  TII = MF.getSubtarget<CeespuSubtarget>().getInstrInfo();
+  MRI = &MF.getRegInfo();
+  MLI = &getAnalysis<MachineLoopInfo>();
+  RegClassInfo.runOnMachineFunction(MF);
+
+  bool Changed = false;
+  for (MachineLoop *L : *MLI)
+    Changed |= processLoop(L);
+  return Changed;
+}
+
+FunctionPass *llvm::createCeespuConstantHoistingPass() {
+  return new CeespuConstantHoisting();
+}
@@ -20,9 +20,64 @@
 #include "llvm/CodeGen/MachineInstrBuilder.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/RegisterScavenging.h"
+#include "llvm/Support/CommandLine.h"
 
 using namespace llvm;
 
+// Functions built for size save and restore their callee-saved registers
+// through routines shared by the whole program, which replace a store and a
+// load per register with a call and a jump.
+static cl::opt<cl::boolOrDefault> SaveRestore(
+    "ceespu-save-restore", cl::Hidden,
+    cl::desc("Save and restore callee-saved registers through shared "
+             "routines (default: in functions built for size)"));
+
+static bool useSaveRestoreRoutines(const MachineFunction &MF) {
+  if (SaveRestore == cl::BOU_UNSET)
+    return MF.getFunction().optForSize();
+  return SaveRestore == cl::BOU_TRUE;
+}
+
+// The callee-saved registers that the routines save besides clr, in the
+// order the register allocator hands them out, see GPR. The routines for N
+// registers handle the first N.
+static const MCPhysReg SaveRestoreOrder[] = {
+    Ceespu::R12, Ceespu::R1, Ceespu::R2, Ceespu::R3,  Ceespu::R4,
+    Ceespu::R5,  Ceespu::R6, Ceespu::R7, Ceespu::R8,  Ceespu::R9,
+    Ceespu::R10, Ceespu::R11};
+
+static const char *const SaveRoutines[] = {
+    "__ceespu_save_1",  "__ceespu_save_2",  "__ceespu_save_3",
+    "__ceespu_save_4",  "__ceespu_save_5",  "__ceespu_save_6",
+    "__ceespu_save_7",  "__ceespu_save_8",  "__ceespu_save_9",
+    "__ceespu_save_10", "__ceespu_save_11", "__ceespu_save_12"};
+
+static const char *const RestoreRoutines[] = {
+    "__ceespu_restore_1",  "__ceespu_restore_2",  "__ceespu_restore_3",
+    "__ceespu_restore_4",  "__ceespu_restore_5",  "__ceespu_restore_6",
+    "__ceespu_restore_7",  "__ceespu_restore_8",  "__ceespu_restore_9",
+    "__ceespu_restore_10", "__ceespu_restore_11", "__ceespu_restore_12"};
+
+const char *CeespuFrameLowering::getSaveRoutineName(unsigned NumRegs) {
+  assert(NumRegs >= 1 && NumRegs <= array_lengthof(SaveRoutines) &&
+         "No save routine for this number of registers");
+  return SaveRoutines[NumRegs - 1];
+}
+
+const char *CeespuFrameLowering::getRestoreRoutineName(unsigned NumRegs) {
+  assert(NumRegs >= 1 && NumRegs <= array_lengthof(RestoreRoutines) &&
+         "No restore routine for this number of registers");
+  return RestoreRoutines[NumRegs - 1];
+}
+
+ArrayRef<MCPhysReg> CeespuFrameLowering::getSaveRestoreOrder() {
+  return SaveRestoreOrder;
+}
+
+// The call to the save routine overwrites clr, so its value is handed over
+// in a register that holds no argument and is not callee-saved.
+unsigned CeespuFrameLowering::getSaveRoutineLinkReg() { return Ceespu::R13; }
+
 bool CeespuFrameLowering::hasFP(const MachineFunction &MF) const {
   const TargetRegisterInfo *RegInfo = MF.getSubtarget().getRegisterInfo();
 
@@ -91,10 +146,11 @@ static unsigned getFPReg(const CeespuSubtarget &STI) { return Ceespu::FP; }
 // Returns the register used to hold the stack pointer.
 static unsigned getSPReg(const CeespuSubtarget &STI) { return Ceespu::SP; }
 
+// Shrink-wrapping may place the prologue in any block that dominates the
+// uses of the frame. The callee-saved registers are spilled at the start of
+// that block, so the prologue is built around them as in the entry block.
 void CeespuFrameLowering::emitPrologue(MachineFunction &MF,
                                        MachineBasicBlock &MBB) const {
-  assert(&MF.front() == &MBB && "Shrink-wrapping not yet supported");
-
   MachineFrameInfo &MFI = MF.getFrameInfo();
   auto *RVFI = MF.getInfo<CeespuMachineFunctionInfo>();
   MachineBasicBlock::iterator MBBI = MBB.begin();
@@ -116,17 +172,28 @@ void CeespuFrameLowering::emitPrologue(MachineFunction &MF,
   // Early exit if there is no need to allocate on the stack
   if (StackSize == 0 && !MFI.adjustsStack()) return;
 
-  // Allocate space on the stack if necessary.
-  adjustReg(MBB, MBBI, DL, SPReg, SPReg, -StackSize, MachineInstr::FrameSetup);
-
-  // The frame pointer is callee-saved, and code has been generated for us to
-  // save it to the stack. We need to skip over the storing of callee-saved
-  // registers as the frame pointer must be modified after it has been saved
-  // to the stack, not before.
-  // FIXME: assumes exactly one instruction is used to save each callee-saved
-  // register.
-  const std::vector<CalleeSavedInfo> &CSI = MFI.getCalleeSavedInfo();
-  std::advance(MBBI, CSI.size());
+  if (unsigned NumRegs = RVFI->getNumSaveRestoreRegs()) {
+    // The save routine allocates the area it stores the registers in, so
+    // the rest of the frame is allocated after the call to it.
+    while (MBBI != MBB.end() && MBBI->getFlag(MachineInstr::FrameSetup))
+      ++MBBI;
+    adjustReg(MBB, MBBI, DL, SPReg, SPReg,
+              -(StackSize - getSaveRestoreSize(NumRegs)),
+              MachineInstr::FrameSetup);
+  } else {
+    // Allocate space on the stack if necessary.
+    adjustReg(MBB, MBBI, DL, SPReg, SPReg, -StackSize,
+              MachineInstr::FrameSetup);
+
+    // The frame pointer is callee-saved, and code has been generated for us
+    // to save it to the stack. We need to skip over the storing of
+    // callee-saved registers as the frame pointer must be modified after it
+    // has been saved to the stack, not before.
+    // FIXME: assumes exactly one instruction is used to save each
+    // callee-saved register.
+    const std::vector<CalleeSavedInfo> &CSI = MFI.getCalleeSavedInfo();
+    std::advance(MBBI, CSI.size());
+  }
 
   // Generate new FP.
   if (hasFP(MF))
@@ -135,21 +202,36 @@ void CeespuFrameLowering::emitPrologue(MachineFunction &MF,
 
 void CeespuFrameLowering::emitEpilogue(MachineFunction &MF,
                                        MachineBasicBlock &MBB) const {
-  MachineBasicBlock::iterator MBBI = MBB.getLastNonDebugInstr();
+  // The frame is torn down in front of the terminator, which is either the
+  // return or, for a tail call, the jump to the callee. A restore point
+  // chosen by shrink-wrapping need not return, and its terminator may be a
+  // branch to the return block, or it may have none at all.
+  MachineBasicBlock::iterator MBBI = MBB.getFirstTerminator();
+  DebugLoc DL;
+  if (MBBI != MBB.end())
+    DL = MBBI->getDebugLoc();
+  else if (!MBB.empty())
+    DL = MBB.back().getDebugLoc();
   const CeespuRegisterInfo *RI = STI.getRegisterInfo();
   MachineFrameInfo &MFI = MF.getFrameInfo();
   auto *RVFI = MF.getInfo<CeespuMachineFunctionInfo>();
-  DebugLoc DL = MBBI->getDebugLoc();
   unsigned FPReg = getFPReg(STI);
   unsigned SPReg = getSPReg(STI);
 
+  uint64_t StackSize = MFI.getStackSize();
+  uint64_t DeallocSize = StackSize;
+
   // Skip to before the restores of callee-saved registers
   // FIXME: assumes exactly one instruction is used to restore each
   // callee-saved register.
   MachineBasicBlock::iterator LastFrameDestroy = MBBI;
-  std::advance(LastFrameDestroy, -MFI.getCalleeSavedInfo().size());
-
-  uint64_t StackSize = MFI.getStackSize();
+  if (MBBI != MBB.end() && MBBI->getFlag(MachineInstr::FrameDestroy)) {
+    // The block ends in a jump to the restore routine, which releases the
+    // area the registers were saved in.
+    DeallocSize -= getSaveRestoreSize(RVFI->getNumSaveRestoreRegs());
+  } else {
+    std::advance(LastFrameDestroy, -MFI.getCalleeSavedInfo().size());
+  }
 
   // Restore the stack pointer using the value of the frame pointer. Only
   // necessary if the stack pointer was modified, meaning the stack size is
@@ -162,7 +244,8 @@ void CeespuFrameLowering::emitEpilogue(MachineFunction &MF,
   }
 
   // Deallocate stack
-  adjustReg(MBB, MBBI, DL, SPReg, SPReg, StackSize, MachineInstr::FrameDestroy);
+  adjustReg(MBB, MBBI, DL, SPReg, SPReg, DeallocSize,
+            MachineInstr::FrameDestroy);
 }
 
 int CeespuFrameLowering::getFrameIndexReference(const MachineFunction &MF,
@@ -185,6 +268,10 @@ int CeespuFrameLowering::getFrameIndexReference(const MachineFunction &MF,
   if (CSI.size()) {
     MinCSFI = CSI[0].getFrameIdx();
     MaxCSFI = CSI[CSI.size() - 1].getFrameIdx();
+    // The fixed slots used with the save and restore routines are numbered
+    // downwards.
+    if (MinCSFI > MaxCSFI)
+      std::swap(MinCSFI, MaxCSFI);
   }
 
   if (FI >= MinCSFI && FI <= MaxCSFI) {
@@ -209,6 +296,106 @@ void CeespuFrameLowering::determineCalleeSaves(MachineFunction &MF,
   if (hasFP(MF)) {
     SavedRegs.set(Ceespu::FP);
   }
+
+  // The save and restore routines handle clr and the first N registers of
+  // SaveRestoreOrder together, so the registers before the last one used are
+  // saved as well. For a single register in a leaf function, the call and
+  // the jump cost as much as they save.
+  auto *RVFI = MF.getInfo<CeespuMachineFunctionInfo>();
+  RVFI->setNumSaveRestoreRegs(0);
+  if (!useSaveRestoreRoutines(MF))
+    return;
+  unsigned NumRegs = 0, NumUsed = 0;
+  for (unsigned I = 0; I != array_lengthof(SaveRestoreOrder); ++I)
+    if (SavedRegs.test(SaveRestoreOrder[I])) {
+      NumRegs = I + 1;
+      ++NumUsed;
+    }
+  if (NumUsed == 0 || (NumUsed == 1 && !SavedRegs.test(Ceespu::LR)))
+    return;
+  SavedRegs.set(Ceespu::LR);
+  for (unsigned I = 0; I != NumRegs; ++I)
+    SavedRegs.set(SaveRestoreOrder[I]);
+  RVFI->setNumSaveRestoreRegs(NumRegs);
+}
+
+// The routines store clr and then the registers of SaveRestoreOrder at fixed
+// places below the stack pointer of the caller.
+bool CeespuFrameLowering::assignCalleeSavedSpillSlots(
+    MachineFunction &MF, const TargetRegisterInfo *TRI,
+    std::vector<CalleeSavedInfo> &CSI) const {
+  if (!MF.getInfo<CeespuMachineFunctionInfo>()->getNumSaveRestoreRegs())
+    return false;
+
+  MachineFrameInfo &MFI = MF.getFrameInfo();
+  for (CalleeSavedInfo &CS : CSI) {
+    const MCPhysReg *Pos = find(SaveRestoreOrder, CS.getReg());
+    int64_t Offset = CS.getReg() == Ceespu::LR
+                         ? -4
+                         : -4 * (Pos - std::begin(SaveRestoreOrder) + 2);
+    CS.setFrameIdx(MFI.CreateFixedSpillStackObject(4, Offset));
+  }
+  return true;
+}
+
+bool CeespuFrameLowering::spillCalleeSavedRegisters(
+    MachineBasicBlock &MBB, MachineBasicBlock::iterator MI,
+    const std::vector<CalleeSavedInfo> &CSI,
+    const TargetRegisterInfo *TRI) const {
+  MachineFunction &MF = *MBB.getParent();
+  unsigned NumRegs =
+      MF.getInfo<CeespuMachineFunctionInfo>()->getNumSaveRestoreRegs();
+  if (!NumRegs)
+    return false;
+
+  const CeespuInstrInfo *TII = STI.getInstrInfo();
+  unsigned LinkReg = getSaveRoutineLinkReg();
+  DebugLoc DL;
+  BuildMI(MBB, MI, DL, TII->get(Ceespu::ADDI), LinkReg)
+      .addReg(Ceespu::LR)
+      .addImm(0)
+      .setMIFlag(MachineInstr::FrameSetup);
+  MachineInstrBuilder Call =
+      BuildMI(MBB, MI, DL, TII->get(Ceespu::JAL))
+          .addExternalSymbol(getSaveRoutineName(NumRegs))
+          .addReg(LinkReg, RegState::Implicit | RegState::Kill)
+          .addReg(Ceespu::SP, RegState::Implicit)
+          .addReg(Ceespu::SP, RegState::ImplicitDefine)
+          .setMIFlag(MachineInstr::FrameSetup);
+  for (const CalleeSavedInfo &CS : CSI)
+    if (CS.getReg() != Ceespu::LR)
+      Call.addReg(CS.getReg(), RegState::Implicit);
+  return true;
+}
+
+// A block that returns jumps to the restore routine, which returns to the
+// caller in place of the function. Blocks that end in a tail call restore
+// the registers themselves, as the routine can not return to the callee.
+bool CeespuFrameLowering::restoreCalleeSavedRegisters(
+    MachineBasicBlock &MBB, MachineBasicBlock::iterator MI,
+    std::vector<CalleeSavedInfo> &CSI, const TargetRegisterInfo *TRI) const {
+  MachineFunction &MF = *MBB.getParent();
+  unsigned NumRegs =
+      MF.getInfo<CeespuMachineFunctionInfo>()->getNumSaveRestoreRegs();
+  if (!NumRegs || MI == MBB.end() || MI->getOpcode() != Ceespu::RET)
+    return false;
+
+  const CeespuInstrInfo *TII = STI.getInstrInfo();
+  MachineInstrBuilder Jump =
+      BuildMI(MBB, MI, MI->getDebugLoc(), TII->get(Ceespu::PseudoTAIL))
+          .addExternalSymbol(getRestoreRoutineName(NumRegs))
+          .setMIFlag(MachineInstr::FrameDestroy);
+  Jump->copyImplicitOps(MF, *MI);
+  MI->eraseFromParent();
+  return true;
+}
+
+bool CeespuFrameLowering::enableShrinkWrapping(
+    const MachineFunction &MF) const {
+  // The call to the save routine needs a free register to pass clr in, and
+  // the restore routine returns from the function, so both stay in the entry
+  // and return blocks.
+  return !useSaveRestoreRoutines(MF);
 }
 
 void CeespuFrameLowering::processFunctionBeforeFrameFinalized(
@@ -218,10 +405,9 @@ void CeespuFrameLowering::processFunctionBeforeFrameFinalized(
   const TargetRegisterClass *RC = &Ceespu::GPRRegClass;
   // estimateStackSize has been observed to under-estimate the final stack
   // size, so give ourselves wiggle-room by checking for stack size
-  // representable an 11-bit signed field rather than 12-bits.
-  // FIXME: It may be possible to craft a function with a small stack that
-  // still needs an emergency spill slot for branch relaxation. This case
-  // would currently be missed.
+  // representable an 11-bit signed field rather than 12-bits. Branch
+  // relaxation does not need a register, so the emergency spill slot is only
+  // for frame offsets that do not fit in an immediate.
   if (!isInt<14>(MFI.estimateStackSize(MF))) {
     int RegScavFI = MFI.CreateStackObject(
         RegInfo->getSpillSize(*RC), RegInfo->getSpillAlignment(*RC), false);
@@ -229,6 +415,27 @@ void CeespuFrameLowering::processFunctionBeforeFrameFinalized(
   }
 }
 
+// A frame adjustment that does not fit the immediate of an ADDI goes through
+// a scratch register, which the register scavenger may have to spill. That is
+// only known to work at the usual places for the prologue and epilogue, so a
+// large frame keeps shrink-wrapping from moving them. As in
+// processFunctionBeforeFrameFinalized, a narrower field is checked because the
+// estimate may fall short of the final frame size.
+static bool needsScratchRegForFrame(const MachineFunction &MF) {
+  return !isInt<14>(MF.getFrameInfo().estimateStackSize(MF));
+}
+
+bool CeespuFrameLowering::canUseAsPrologue(
+    const MachineBasicBlock &MBB) const {
+  const MachineFunction &MF = *MBB.getParent();
+  return !needsScratchRegForFrame(MF) || &MBB == &MF.front();
+}
+
+bool CeespuFrameLowering::canUseAsEpilogue(
+    const MachineBasicBlock &MBB) const {
+  return !needsScratchRegForFrame(*MBB.getParent()) || MBB.isReturnBlock();
+}
+
 // Not preserve stack space within prologue for outgoing variables when the
 // function contains variable size objects and let eliminateCallFramePseudoInstr
 // preserve stack space for it.
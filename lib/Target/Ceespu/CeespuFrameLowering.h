@@ -37,16 +37,45 @@ class CeespuFrameLowering : public TargetFrameLowering {
   void determineCalleeSaves(MachineFunction &MF, BitVector &SavedRegs,
                             RegScavenger *RS) const override;
 
+  bool assignCalleeSavedSpillSlots(
+      MachineFunction &MF, const TargetRegisterInfo *TRI,
+      std::vector<CalleeSavedInfo> &CSI) const override;
+  bool spillCalleeSavedRegisters(MachineBasicBlock &MBB,
+                                 MachineBasicBlock::iterator MI,
+                                 const std::vector<CalleeSavedInfo> &CSI,
+                                 const TargetRegisterInfo *TRI) const override;
+  bool restoreCalleeSavedRegisters(
+      MachineBasicBlock &MBB, MachineBasicBlock::iterator MI,
+      std::vector<CalleeSavedInfo> &CSI,
+      const TargetRegisterInfo *TRI) const override;
+
   void processFunctionBeforeFrameFinalized(MachineFunction &MF,
                                            RegScavenger *RS) const override;
 
   bool hasFP(const MachineFunction &MF) const override;
 
+  bool enableShrinkWrapping(const MachineFunction &MF) const override;
+  bool canUseAsPrologue(const MachineBasicBlock &MBB) const override;
+  bool canUseAsEpilogue(const MachineBasicBlock &MBB) const override;
+
   bool hasReservedCallFrame(const MachineFunction &MF) const override;
   MachineBasicBlock::iterator eliminateCallFramePseudoInstr(
       MachineFunction &MF, MachineBasicBlock &MBB,
       MachineBasicBlock::iterator MI) const override;
 
+  // The shared routines that save and restore clr and the first NumRegs
+  // registers of getSaveRestoreOrder(). The save routine is called with the
+  // value of clr in getSaveRoutineLinkReg().
+  static const char *getSaveRoutineName(unsigned NumRegs);
+  static const char *getRestoreRoutineName(unsigned NumRegs);
+  static ArrayRef<MCPhysReg> getSaveRestoreOrder();
+  static unsigned getSaveRoutineLinkReg();
+  // Returns the size of the area that the routines for NumRegs registers
+  // save clr and the registers in.
+  static unsigned getSaveRestoreSize(unsigned NumRegs) {
+    return 4 * (NumRegs + 1);
+  }
+
  protected:
   const CeespuSubtarget &STI;
 
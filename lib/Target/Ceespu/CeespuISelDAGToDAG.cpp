@@ -51,6 +51,7 @@ class CeespuDAGToDAGISel final : public SelectionDAGISel {
                                     std::vector<SDValue> &OutOps) override;
 
   bool SelectAddr(SDValue N, SDValue &Base, SDValue &Offset);
+  bool SelectAddrGlobal(SDValue Addr, SDValue &Base, SDValue &Offset);
   bool SelectAddrFI(SDValue Addr, SDValue &Base);
 
 // Include the pieces autogenerated from the target description.
@@ -115,6 +116,27 @@ bool CeespuDAGToDAGISel::SelectInlineAsmMemoryOperand(
   return true;
 }
 
+// Matches a global address wrapped in WrapperOpc, plus an optional constant,
+// and returns it as a single target global address with the constant folded
+// into its offset.
+static bool selectWrappedGlobal(SelectionDAG *CurDAG, SDValue Addr,
+                                unsigned WrapperOpc, SDValue &GA) {
+  int64_t Offset = 0;
+  if (CurDAG->isBaseWithConstantOffset(Addr)) {
+    Offset = cast<ConstantSDNode>(Addr.getOperand(1))->getSExtValue();
+    Addr = Addr.getOperand(0);
+  }
+  if (Addr.getOpcode() != WrapperOpc)
+    return false;
+  auto *G = dyn_cast<GlobalAddressSDNode>(Addr.getOperand(0));
+  if (!G)
+    return false;
+  GA = CurDAG->getTargetGlobalAddress(G->getGlobal(), SDLoc(Addr), MVT::i32,
+                                      G->getOffset() + Offset,
+                                      G->getTargetFlags());
+  return true;
+}
+
 // ComplexPattern used on Ceespu Load/Store instructions
 bool CeespuDAGToDAGISel::SelectAddr(SDValue Addr, SDValue &Base,
                                     SDValue &Offset) {
@@ -126,6 +148,12 @@ bool CeespuDAGToDAGISel::SelectAddr(SDValue Addr, SDValue &Base,
     return true;
   }
 
+  // Small data lives in the first 32 KiB, its address is an offset from c0.
+  if (selectWrappedGlobal(CurDAG, Addr, CeespuISD::SmallWrapper, Offset)) {
+    Base = CurDAG->getRegister(Ceespu::R0, MVT::i32);
+    return true;
+  }
+
   if (Addr.getOpcode() == ISD::TargetExternalSymbol ||
       Addr.getOpcode() == ISD::TargetGlobalAddress)
     return true;
@@ -133,7 +161,9 @@ bool CeespuDAGToDAGISel::SelectAddr(SDValue Addr, SDValue &Base,
   // Addresses of the form Addr+const or Addr|const
   if (CurDAG->isBaseWithConstantOffset(Addr)) {
     ConstantSDNode *CN = dyn_cast<ConstantSDNode>(Addr.getOperand(1));
-    if (isInt<32>(CN->getSExtValue())) {
+    // Larger offsets would need a SETI prefix, leave them to an add that can
+    // be hoisted out of loops.
+    if (isInt<16>(CN->getSExtValue())) {
       // If the first operand is a FI, get the TargetFI Node
       if (FrameIndexSDNode *FIN =
               dyn_cast<FrameIndexSDNode>(Addr.getOperand(0)))
@@ -151,6 +181,23 @@ bool CeespuDAGToDAGISel::SelectAddr(SDValue Addr, SDValue &Base,
   return true;
 }
 
+// ComplexPattern used on the SETI extended loads and stores. Folds the address
+// of a global, plus any constant offset, into the access. A global used more
+// than once is left to a single LIX that the accesses share.
+bool CeespuDAGToDAGISel::SelectAddrGlobal(SDValue Addr, SDValue &Base,
+                                          SDValue &Offset) {
+  if (!Addr.hasOneUse())
+    return false;
+  SDValue Wrapper =
+      CurDAG->isBaseWithConstantOffset(Addr) ? Addr.getOperand(0) : Addr;
+  if (Wrapper != Addr && !Wrapper.hasOneUse())
+    return false;
+  if (!selectWrappedGlobal(CurDAG, Addr, CeespuISD::Wrapper, Offset))
+    return false;
+  Base = CurDAG->getRegister(Ceespu::R0, MVT::i32);
+  return true;
+}
+
 bool CeespuDAGToDAGISel::SelectAddrFI(SDValue Addr, SDValue &Base) {
   if (auto FIN = dyn_cast<FrameIndexSDNode>(Addr)) {
     Base = CurDAG->getTargetFrameIndex(FIN->getIndex(), MVT::i32);
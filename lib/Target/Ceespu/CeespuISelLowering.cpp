@@ -19,19 +19,23 @@
 #include "CeespuRegisterInfo.h"
 #include "CeespuSubtarget.h"
 #include "CeespuTargetMachine.h"
+#include "CeespuTargetObjectFile.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/CodeGen/CallingConvLower.h"
 #include "llvm/CodeGen/MachineFrameInfo.h"
 #include "llvm/CodeGen/MachineFunction.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/SelectionDAGISel.h"
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
 #include "llvm/CodeGen/ValueTypes.h"
 #include "llvm/IR/DiagnosticInfo.h"
 #include "llvm/IR/DiagnosticPrinter.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/KnownBits.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
@@ -39,6 +43,27 @@ using namespace llvm;
 #define DEBUG_TYPE "ceespu-lower"
 
 STATISTIC(NumTailCalls, "Number of tail calls");
+STATISTIC(NumMaskSelects, "Number of selects lowered without a branch");
+
+static cl::opt<int> SelectBranchCost(
+    "ceespu-select-branch-cost", cl::Hidden, cl::init(-1),
+    cl::desc("Number of instructions a select may expand to before it is "
+             "lowered to a branch instead (default: derived from the "
+             "scheduling model)"));
+
+static cl::opt<unsigned> CompactJumpTableLimit(
+    "ceespu-compact-jump-table-limit", cl::Hidden, cl::init(1024),
+    cl::desc("Largest function, in IR instructions, that uses 16-bit jump "
+             "table entries"));
+
+// Log2 of the fetch block size that loop headers are aligned to.
+static cl::opt<unsigned> LoopAlignment(
+    "ceespu-loop-align", cl::Hidden, cl::init(3),
+    cl::desc("Log2 of the alignment of loop headers (0 disables it)"));
+
+static cl::opt<unsigned> LoopAlignMaxSize(
+    "ceespu-loop-align-max-size", cl::Hidden, cl::init(64),
+    cl::desc("Largest loop, in bytes, whose header is aligned"));
 
 CeespuTargetLowering::CeespuTargetLowering(const TargetMachine &TM,
                                            const CeespuSubtarget &STI)
@@ -59,8 +84,7 @@ CeespuTargetLowering::CeespuTargetLowering(const TargetMachine &TM,
   // TODO: add all necessary setOperationAction calls.
   setOperationAction(ISD::DYNAMIC_STACKALLOC, XLenVT, Expand);
 
-  setOperationAction(ISD::BR_JT, MVT::Other, Expand);
-  setOperationAction(ISD::BR_CC, XLenVT, Expand);
+  setOperationAction(ISD::BR_JT, MVT::Other, Custom);
   setOperationAction(ISD::SETCC, XLenVT, Expand);
 
   setOperationAction(ISD::SELECT, XLenVT, Expand);
@@ -74,8 +98,10 @@ CeespuTargetLowering::CeespuTargetLowering(const TargetMachine &TM,
   setOperationAction(ISD::VACOPY, MVT::Other, Expand);
   setOperationAction(ISD::VAEND, MVT::Other, Expand);
 
-  setOperationAction(ISD::MULHS, XLenVT, Expand);
-  setOperationAction(ISD::MULHU, XLenVT, Expand);
+  // There is only a 32-bit multiply. The high half is built from 16x16 partial
+  // products, which lets division by a constant use a reciprocal multiply.
+  setOperationAction(ISD::MULHS, XLenVT, Custom);
+  setOperationAction(ISD::MULHU, XLenVT, Custom);
   setOperationAction(ISD::SDIV, XLenVT, Expand);
   setOperationAction(ISD::UDIV, XLenVT, Expand);
   setOperationAction(ISD::SREM, XLenVT, Expand);
@@ -85,9 +111,17 @@ CeespuTargetLowering::CeespuTargetLowering(const TargetMachine &TM,
   setOperationAction(ISD::SMUL_LOHI, XLenVT, Expand);
   setOperationAction(ISD::UMUL_LOHI, XLenVT, Expand);
 
-  setOperationAction(ISD::SHL_PARTS, XLenVT, Expand);
-  setOperationAction(ISD::SRL_PARTS, XLenVT, Expand);
-  setOperationAction(ISD::SRA_PARTS, XLenVT, Expand);
+  // 64-bit arithmetic uses the carry. Expanded shifts by a constant are
+  // already optimal, the *_PARTS nodes cover variable shift amounts.
+  setOperationAction(ISD::UADDO, XLenVT, Custom);
+  setOperationAction(ISD::USUBO, XLenVT, Custom);
+  setOperationAction(ISD::ADDCARRY, XLenVT, Custom);
+  setOperationAction(ISD::SUBCARRY, XLenVT, Custom);
+  setOperationAction(ISD::SETCCCARRY, XLenVT, Custom);
+
+  setOperationAction(ISD::SHL_PARTS, XLenVT, Custom);
+  setOperationAction(ISD::SRL_PARTS, XLenVT, Custom);
+  setOperationAction(ISD::SRA_PARTS, XLenVT, Custom);
 
   setOperationAction(ISD::ROTL, XLenVT, Expand);
   setOperationAction(ISD::ROTR, XLenVT, Expand);
@@ -109,10 +143,15 @@ CeespuTargetLowering::CeespuTargetLowering(const TargetMachine &TM,
 
   setBooleanContents(ZeroOrOneBooleanContent);
 
+  setTargetDAGCombine(ISD::BR);
+  setTargetDAGCombine(ISD::BRCOND);
+  setTargetDAGCombine(ISD::BR_CC);
+
   // Function alignments (log2).
   unsigned FunctionAlignment = 2;
   setMinFunctionAlignment(FunctionAlignment);
   setPrefFunctionAlignment(FunctionAlignment);
+  setPrefLoopAlignment(LoopAlignment);
 
   MaxStoresPerMemset = 16;  // For @llvm.memset -> sequence of stores
   MaxStoresPerMemsetOptSize = 8;
@@ -121,8 +160,31 @@ CeespuTargetLowering::CeespuTargetLowering(const TargetMachine &TM,
   MaxStoresPerMemmove = 16;  // For @llvm.memmove -> sequence of stores
   MaxStoresPerMemmoveOptSize = 8;
 
-  // Effectively disable jump table generation.
-  setMinimumJumpTableEntries(16);
+  setMinimumJumpTableEntries(STI.getMinimumJumpTableEntries());
+}
+
+// Aligning a loop header costs the padding in front of it, which is executed
+// whenever the loop is entered by falling into it. It saves a fetch on every
+// iteration whose body would otherwise straddle one more fetch block, which
+// only pays off for small loops, where that fetch is a large part of an
+// iteration. Block placement already leaves cold loops and functions that are
+// optimized for size alone.
+unsigned CeespuTargetLowering::getPrefLoopAlignment(MachineLoop *ML) const {
+  unsigned Align = TargetLowering::getPrefLoopAlignment(ML);
+  if (!ML || !Align)
+    return Align;
+
+  const TargetInstrInfo *TII = Subtarget.getInstrInfo();
+  unsigned Size = 0;
+  for (const MachineBasicBlock *MBB : ML->blocks()) {
+    for (const MachineInstr &MI : *MBB) {
+      Size += TII->getInstSizeInBytes(MI);
+      if (Size > LoopAlignMaxSize)
+        return 0;
+    }
+  }
+  // A loop of a single instruction never straddles a fetch block.
+  return Size > 4 ? Align : 0;
 }
 
 EVT CeespuTargetLowering::getSetCCResultType(const DataLayout &DL,
@@ -245,8 +307,27 @@ SDValue CeespuTargetLowering::LowerOperation(SDValue Op,
       return lowerGlobalAddress(Op, DAG);
     case ISD::JumpTable:
       return LowerJumpTable(Op, DAG);
+    case ISD::BR_JT:
+      return lowerBR_JT(Op, DAG);
     case ISD::SELECT_CC:
       return lowerSELECT_CC(Op, DAG);
+    case ISD::MULHS:
+    case ISD::MULHU:
+      return lowerMULH(Op, DAG);
+    case ISD::UADDO:
+    case ISD::USUBO:
+      return lowerUADDSUBO(Op, DAG);
+    case ISD::ADDCARRY:
+    case ISD::SUBCARRY:
+      return lowerADDSUBCARRY(Op, DAG);
+    case ISD::SETCCCARRY:
+      return lowerSETCCCARRY(Op, DAG);
+    case ISD::SHL_PARTS:
+      return lowerShiftLeftParts(Op, DAG);
+    case ISD::SRA_PARTS:
+      return lowerShiftRightParts(Op, DAG, true);
+    case ISD::SRL_PARTS:
+      return lowerShiftRightParts(Op, DAG, false);
     case ISD::VASTART:
       return lowerVASTART(Op, DAG);
     case ISD::FRAMEADDR:
@@ -264,24 +345,18 @@ SDValue CeespuTargetLowering::lowerGlobalAddress(SDValue Op,
   const GlobalValue *GV = N->getGlobal();
   int64_t Offset = N->getOffset();
 
-  // if (isPositionIndependent() || Subtarget.is64Bit())
-  // report_fatal_error("Unable to lowerGlobalAddress");
-  // In order to maximise the opportunity for common subexpression elimination,
-  // emit a separate ADD node for the global address offset instead of folding
-  // it in the global address node. Later peephole optimisations may choose to
-  // fold it back in when profitable.
-  // SDValue GAHi = DAG.getTargetGlobalAddress(GV, DL, Ty, 0, CeespuII::MO_HI);
-  // SDValue GALo = DAG.getTargetGlobalAddress(GV, DL, Ty, 0, CeespuII::MO_LO);
-  // SDValue MNHi = SDValue(DAG.getMachineNode(Ceespu::LUI, DL, Ty, GAHi), 0);
-  // SDValue MNLo =
-  //    SDValue(DAG.getMachineNode(Ceespu::ADDI, DL, Ty, MNHi, GALo), 0);
-  // if (Offset != 0)
-  // return DAG.getNode(ISD::ADD, DL, Ty, MNLo,
-  // DAG.getConstant(Offset, DL, XLenVT));
-  // return MNLo;
-  SDValue GA = DAG.getTargetGlobalAddress(GV, DL, MVT::i32);
-
-  return DAG.getNode(CeespuISD::Wrapper, DL, MVT::i32, GA);
+  // Small data objects have a 16-bit address, which loads and stores use as
+  // their offset from c0.
+  const auto &TLOF = static_cast<const CeespuELFTargetObjectFile &>(
+      *getTargetMachine().getObjFileLowering());
+  if (TLOF.isGlobalInSmallSection(GV->getBaseObject(), getTargetMachine())) {
+    SDValue GA =
+        DAG.getTargetGlobalAddress(GV, DL, Ty, Offset, CeespuII::MO_ABS);
+    return DAG.getNode(CeespuISD::SmallWrapper, DL, Ty, GA);
+  }
+
+  SDValue GA = DAG.getTargetGlobalAddress(GV, DL, Ty, Offset);
+  return DAG.getNode(CeespuISD::Wrapper, DL, Ty, GA);
 }
 
 SDValue CeespuTargetLowering::LowerJumpTable(SDValue Op,
@@ -294,6 +369,259 @@ SDValue CeespuTargetLowering::LowerJumpTable(SDValue Op,
   return DAG.getNode(CeespuISD::Wrapper, DL, MVT::i32, JMPT);
 }
 
+// Division by a constant becomes a multiply by its reciprocal. The high
+// multiply below is four multiplies and about a dozen simple instructions,
+// still much faster than the division libcall but several times its size.
+bool CeespuTargetLowering::isIntDivCheap(EVT VT, AttributeList Attr) const {
+  return Attr.hasAttribute(AttributeList::FunctionIndex, Attribute::MinSize);
+}
+
+// Compute the high 32 bits of a 64-bit product from the products of the 16-bit
+// halves of the operands (Hacker's Delight, 8-2). Each partial sum fits in 32
+// bits. For MULHS the upper halves are signed, so they are extracted and
+// shifted down arithmetically.
+SDValue CeespuTargetLowering::lowerMULH(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  EVT VT = Op.getValueType();
+  bool IsSigned = Op.getOpcode() == ISD::MULHS;
+  unsigned HiShift = IsSigned ? ISD::SRA : ISD::SRL;
+  SDValue Sixteen = DAG.getConstant(16, DL, VT);
+  SDValue LoMask = DAG.getConstant(0xffff, DL, VT);
+
+  SDValue U = Op.getOperand(0);
+  SDValue V = Op.getOperand(1);
+  SDValue U0 = DAG.getNode(ISD::AND, DL, VT, U, LoMask);
+  SDValue U1 = DAG.getNode(HiShift, DL, VT, U, Sixteen);
+  SDValue V0 = DAG.getNode(ISD::AND, DL, VT, V, LoMask);
+  SDValue V1 = DAG.getNode(HiShift, DL, VT, V, Sixteen);
+
+  // t = u1 * v0 + (u0 * v0 >> 16)
+  SDValue W0 = DAG.getNode(ISD::MUL, DL, VT, U0, V0);
+  SDValue T = DAG.getNode(ISD::ADD, DL, VT,
+                          DAG.getNode(ISD::MUL, DL, VT, U1, V0),
+                          DAG.getNode(ISD::SRL, DL, VT, W0, Sixteen));
+  SDValue W1 = DAG.getNode(ISD::AND, DL, VT, T, LoMask);
+  SDValue W2 = DAG.getNode(HiShift, DL, VT, T, Sixteen);
+
+  // w1 = u0 * v1 + (t & 0xffff)
+  W1 = DAG.getNode(ISD::ADD, DL, VT, DAG.getNode(ISD::MUL, DL, VT, U0, V1), W1);
+
+  // hi = u1 * v1 + (t >> 16) + (w1 >> 16)
+  SDValue Hi = DAG.getNode(ISD::MUL, DL, VT, U1, V1);
+  Hi = DAG.getNode(ISD::ADD, DL, VT, Hi, W2);
+  return DAG.getNode(ISD::ADD, DL, VT, Hi,
+                     DAG.getNode(HiShift, DL, VT, W1, Sixteen));
+}
+
+// The carry is passed between nodes as glue, while the generic carry nodes
+// use an i32 that is 0 or 1. Returns the value of the carry in Glue, which is
+// "adc rd, c0, c0".
+static SDValue getCarryValue(SDValue Glue, SelectionDAG &DAG,
+                             const SDLoc &DL) {
+  SDValue Zero = DAG.getConstant(0, DL, MVT::i32);
+  return DAG.getNode(CeespuISD::ADDE, DL, DAG.getVTList(MVT::i32, MVT::Glue),
+                     Zero, Zero, Glue);
+}
+
+static bool isCarryValue(SDValue V) {
+  return V.getOpcode() == CeespuISD::ADDE && V.getResNo() == 0 &&
+         isNullConstant(V.getOperand(0)) && isNullConstant(V.getOperand(1)) &&
+         !V.getNode()->hasAnyUseOfValue(1);
+}
+
+// Returns glue holding Carry in the carry flag. A carry that was just read
+// out of the flag is used directly.
+static SDValue getCarryGlue(SDValue Carry, SelectionDAG &DAG,
+                            const SDLoc &DL) {
+  if (isCarryValue(Carry) && Carry.hasOneUse())
+    return Carry.getOperand(2);
+  // Adding all ones carries out exactly when Carry is 1.
+  return DAG
+      .getNode(CeespuISD::ADDC, DL, DAG.getVTList(MVT::i32, MVT::Glue), Carry,
+               DAG.getConstant(-1, DL, MVT::i32))
+      .getValue(1);
+}
+
+SDValue CeespuTargetLowering::lowerUADDSUBO(SDValue Op,
+                                            SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  unsigned Opc =
+      Op.getOpcode() == ISD::UADDO ? CeespuISD::ADDC : CeespuISD::SUBC;
+  SDValue Value = DAG.getNode(Opc, DL, DAG.getVTList(MVT::i32, MVT::Glue),
+                              Op.getOperand(0), Op.getOperand(1));
+  SDValue Carry = getCarryValue(Value.getValue(1), DAG, DL);
+  return DAG.getMergeValues({Value, Carry}, DL);
+}
+
+SDValue CeespuTargetLowering::lowerADDSUBCARRY(SDValue Op,
+                                               SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  unsigned Opc =
+      Op.getOpcode() == ISD::ADDCARRY ? CeespuISD::ADDE : CeespuISD::SUBE;
+  SDValue Glue = getCarryGlue(Op.getOperand(2), DAG, DL);
+  SDValue Value = DAG.getNode(Opc, DL, DAG.getVTList(MVT::i32, MVT::Glue),
+                              Op.getOperand(0), Op.getOperand(1), Glue);
+  SDValue Carry = getCarryValue(Value.getValue(1), DAG, DL);
+  return DAG.getMergeValues({Value, Carry}, DL);
+}
+
+// SETCCCARRY compares the high halves of a wide comparison, given the borrow
+// of the low halves. The borrow out of the high halves is set exactly when
+// LHS <u RHS. Flipping the sign bits turns a signed comparison into an
+// unsigned one.
+SDValue CeespuTargetLowering::lowerSETCCCARRY(SDValue Op,
+                                              SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  SDValue LHS = Op.getOperand(0);
+  SDValue RHS = Op.getOperand(1);
+  ISD::CondCode CC = cast<CondCodeSDNode>(Op.getOperand(3))->get();
+  EVT VT = Op.getValueType();
+
+  if (CC == ISD::SETLT || CC == ISD::SETGE) {
+    SDValue SignBit = DAG.getConstant(0x80000000, DL, VT);
+    LHS = DAG.getNode(ISD::XOR, DL, VT, LHS, SignBit);
+    RHS = DAG.getNode(ISD::XOR, DL, VT, RHS, SignBit);
+  } else {
+    assert((CC == ISD::SETULT || CC == ISD::SETUGE) &&
+           "Unexpected SETCCCARRY condition");
+  }
+
+  SDValue Glue = getCarryGlue(Op.getOperand(2), DAG, DL);
+  SDValue Sub = DAG.getNode(CeespuISD::SUBE, DL,
+                            DAG.getVTList(MVT::i32, MVT::Glue), LHS, RHS, Glue);
+  SDValue Less = getCarryValue(Sub.getValue(1), DAG, DL);
+  if (CC == ISD::SETULT || CC == ISD::SETLT)
+    return Less;
+  return DAG.getNode(ISD::XOR, DL, VT, Less, DAG.getConstant(1, DL, VT));
+}
+
+// The shifts below only use amounts in [0, 31], whichever half of the
+// select is taken.
+SDValue CeespuTargetLowering::lowerShiftLeftParts(SDValue Op,
+                                                  SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  SDValue Lo = Op.getOperand(0);
+  SDValue Hi = Op.getOperand(1);
+  SDValue Shamt = Op.getOperand(2);
+  EVT VT = Lo.getValueType();
+
+  // if Shamt < 32:
+  //   Lo = Lo << Shamt
+  //   Hi = (Hi << Shamt) | ((Lo >>u 1) >>u (31 - Shamt))
+  // else:
+  //   Lo = 0
+  //   Hi = Lo << (Shamt - 32)
+  SDValue Zero = DAG.getConstant(0, DL, VT);
+  SDValue One = DAG.getConstant(1, DL, VT);
+  SDValue ShamtMinus32 =
+      DAG.getNode(ISD::ADD, DL, VT, Shamt, DAG.getConstant(-32, DL, VT));
+  SDValue ThirtyOneMinusShamt =
+      DAG.getNode(ISD::SUB, DL, VT, DAG.getConstant(31, DL, VT), Shamt);
+
+  SDValue LoTrue = DAG.getNode(ISD::SHL, DL, VT, Lo, Shamt);
+  SDValue Carried = DAG.getNode(ISD::SRL, DL, VT,
+                                DAG.getNode(ISD::SRL, DL, VT, Lo, One),
+                                ThirtyOneMinusShamt);
+  SDValue HiTrue = DAG.getNode(ISD::OR, DL, VT,
+                               DAG.getNode(ISD::SHL, DL, VT, Hi, Shamt),
+                               Carried);
+  SDValue HiFalse = DAG.getNode(ISD::SHL, DL, VT, Lo, ShamtMinus32);
+
+  SDValue CC = DAG.getSetCC(DL, VT, ShamtMinus32, Zero, ISD::SETLT);
+  Lo = DAG.getNode(ISD::SELECT, DL, VT, CC, LoTrue, Zero);
+  Hi = DAG.getNode(ISD::SELECT, DL, VT, CC, HiTrue, HiFalse);
+  return DAG.getMergeValues({Lo, Hi}, DL);
+}
+
+SDValue CeespuTargetLowering::lowerShiftRightParts(SDValue Op,
+                                                   SelectionDAG &DAG,
+                                                   bool IsSRA) const {
+  SDLoc DL(Op);
+  SDValue Lo = Op.getOperand(0);
+  SDValue Hi = Op.getOperand(1);
+  SDValue Shamt = Op.getOperand(2);
+  EVT VT = Lo.getValueType();
+
+  // if Shamt < 32:
+  //   Lo = (Lo >>u Shamt) | ((Hi << 1) << (31 - Shamt))
+  //   Hi = Hi >> Shamt
+  // else:
+  //   Lo = Hi >> (Shamt - 32)
+  //   Hi = SRA ? Hi >>s 31 : 0
+  unsigned ShiftRightOp = IsSRA ? ISD::SRA : ISD::SRL;
+  SDValue Zero = DAG.getConstant(0, DL, VT);
+  SDValue One = DAG.getConstant(1, DL, VT);
+  SDValue ThirtyOne = DAG.getConstant(31, DL, VT);
+  SDValue ShamtMinus32 =
+      DAG.getNode(ISD::ADD, DL, VT, Shamt, DAG.getConstant(-32, DL, VT));
+  SDValue ThirtyOneMinusShamt =
+      DAG.getNode(ISD::SUB, DL, VT, ThirtyOne, Shamt);
+
+  SDValue Carried = DAG.getNode(ISD::SHL, DL, VT,
+                                DAG.getNode(ISD::SHL, DL, VT, Hi, One),
+                                ThirtyOneMinusShamt);
+  SDValue LoTrue = DAG.getNode(ISD::OR, DL, VT,
+                               DAG.getNode(ISD::SRL, DL, VT, Lo, Shamt),
+                               Carried);
+  SDValue HiTrue = DAG.getNode(ShiftRightOp, DL, VT, Hi, Shamt);
+  SDValue LoFalse = DAG.getNode(ShiftRightOp, DL, VT, Hi, ShamtMinus32);
+  SDValue HiFalse =
+      IsSRA ? DAG.getNode(ISD::SRA, DL, VT, Hi, ThirtyOne) : Zero;
+
+  SDValue CC = DAG.getSetCC(DL, VT, ShamtMinus32, Zero, ISD::SETLT);
+  Lo = DAG.getNode(ISD::SELECT, DL, VT, CC, LoTrue, LoFalse);
+  Hi = DAG.getNode(ISD::SELECT, DL, VT, CC, HiTrue, HiFalse);
+  return DAG.getMergeValues({Lo, Hi}, DL);
+}
+
+// Compact jump table entries are offsets from the start of the function.
+// They are used when the function is likely small enough for 16-bit offsets.
+// Whether it is only known once the function is laid out, so the entries may
+// still end up 32 bits wide, see CeespuAsmPrinter::runOnMachineFunction.
+static bool useCompactJumpTables(const Function &F) {
+  unsigned NumInsts = 0;
+  for (const BasicBlock &BB : F)
+    NumInsts += BB.size();
+  return NumInsts <= CompactJumpTableLimit;
+}
+
+// Lower a jump table branch to a load of the table entry and a "bx". Entries
+// are either block addresses or, in small functions, the offset of the block
+// from the start of the function. The latter are loaded by LOAD_JT.
+SDValue CeespuTargetLowering::lowerBR_JT(SDValue Op, SelectionDAG &DAG) const {
+  SDLoc DL(Op);
+  SDValue Chain = Op.getOperand(0);
+  SDValue Table = LowerJumpTable(Op.getOperand(1), DAG);
+  SDValue Index = Op.getOperand(2);
+  MachineFunction &MF = DAG.getMachineFunction();
+  auto *CFI = MF.getInfo<CeespuMachineFunctionInfo>();
+  EVT PtrVT = getPointerTy(DAG.getDataLayout());
+
+  bool Compact = useCompactJumpTables(MF.getFunction());
+  CFI->setCompactJumpTables(Compact);
+
+  SDValue Target;
+  if (Compact) {
+    Target = DAG.getMemIntrinsicNode(
+        CeespuISD::LOAD_JT, DL, DAG.getVTList(PtrVT, MVT::Other),
+        {Chain, Table, Index}, MVT::i32, MachinePointerInfo::getJumpTable(MF),
+        /*Align=*/2, MachineMemOperand::MOLoad);
+    SDValue Fn = DAG.getNode(
+        CeespuISD::Wrapper, DL, PtrVT,
+        DAG.getTargetGlobalAddress(&MF.getFunction(), DL, PtrVT));
+    Chain = Target.getValue(1);
+    Target = DAG.getNode(ISD::ADD, DL, PtrVT, Fn, Target);
+  } else {
+    Index = DAG.getNode(ISD::SHL, DL, PtrVT, Index,
+                        DAG.getConstant(2, DL, PtrVT));
+    SDValue Addr = DAG.getNode(ISD::ADD, DL, PtrVT, Table, Index);
+    Target = DAG.getLoad(PtrVT, DL, Chain, Addr,
+                         MachinePointerInfo::getJumpTable(MF));
+    Chain = Target.getValue(1);
+  }
+  return DAG.getNode(ISD::BRIND, DL, MVT::Other, Chain, Target);
+}
+
 /*SDValue CeespuTargetLowering::lowerBlockAddress(SDValue Op,
                                                 SelectionDAG &DAG) const {
   SDLoc DL(Op);
@@ -356,6 +684,97 @@ SDValue CeespuTargetLowering::lowerExternalSymbol(SDValue Op,
   return MNLo;
 }*/
 
+// Returns a value that is all ones when LHS CC RHS holds and zero otherwise,
+// computed without branching. Conditions that are cheaper to compute negated
+// return the inverted mask and set Inverted. Cost is set to the number of
+// instructions used.
+static SDValue getSetCCMask(SDValue LHS, SDValue RHS, ISD::CondCode CC,
+                            const SDLoc &DL, SelectionDAG &DAG, bool &Inverted,
+                            unsigned &Cost) {
+  EVT VT = LHS.getValueType();
+  Inverted = false;
+  Cost = 0;
+
+  // Reduce everything to !=, unsigned < and signed <.
+  switch (CC) {
+    default:
+      break;
+    case ISD::SETEQ:
+      CC = ISD::SETNE;
+      Inverted = true;
+      break;
+    case ISD::SETUGE:
+    case ISD::SETGE:
+      CC = ISD::getSetCCInverse(CC, /*isInteger=*/true);
+      Inverted = true;
+      break;
+    case ISD::SETUGT:
+    case ISD::SETGT:
+      CC = ISD::getSetCCSwappedOperands(CC);
+      std::swap(LHS, RHS);
+      break;
+    case ISD::SETULE:
+    case ISD::SETLE:
+      CC = ISD::getSetCCSwappedOperands(ISD::getSetCCInverse(CC, true));
+      std::swap(LHS, RHS);
+      Inverted = true;
+      break;
+  }
+
+  // Constant operands still have to be materialized.
+  for (SDValue Op : {LHS, RHS})
+    if (auto *C = dyn_cast<ConstantSDNode>(Op))
+      if (!C->isNullValue())
+        Cost += isInt<16>(C->getSExtValue()) ? 1 : 2;
+
+  switch (CC) {
+    default:
+      return SDValue();
+    case ISD::SETNE: {
+      // x != 0 exactly when 0 - x borrows.
+      SDValue X = LHS;
+      if (isNullConstant(LHS))
+        X = RHS;
+      else if (!isNullConstant(RHS)) {
+        X = DAG.getNode(ISD::XOR, DL, VT, LHS, RHS);
+        Cost += 1;
+      }
+      Cost += 2;
+      return DAG.getNode(CeespuISD::MASK_ULT, DL, VT, DAG.getConstant(0, DL, VT),
+                         X);
+    }
+    case ISD::SETULT:
+      Cost += 2;
+      return DAG.getNode(CeespuISD::MASK_ULT, DL, VT, LHS, RHS);
+    case ISD::SETLT: {
+      // The sign bit of a negative value, spread over the whole register.
+      if (isNullConstant(RHS)) {
+        Cost += 1;
+        return DAG.getNode(ISD::SRA, DL, VT, LHS,
+                           DAG.getConstant(VT.getSizeInBits() - 1, DL, VT));
+      }
+      // Flipping the sign bits turns a signed compare into an unsigned one.
+      SDValue SignBit = DAG.getConstant(
+          APInt::getSignMask(VT.getSizeInBits()), DL, VT);
+      LHS = DAG.getNode(ISD::XOR, DL, VT, LHS, SignBit);
+      RHS = DAG.getNode(ISD::XOR, DL, VT, RHS, SignBit);
+      Cost += 6;
+      return DAG.getNode(CeespuISD::MASK_ULT, DL, VT, LHS, RHS);
+    }
+  }
+}
+
+// Returns the number of instructions a select may expand to before a branch
+// around a copy is cheaper. Besides the branch and the copy, a taken branch
+// refills the pipeline.
+unsigned CeespuTargetLowering::getSelectBranchCost(SelectionDAG &DAG) const {
+  if (SelectBranchCost >= 0)
+    return SelectBranchCost;
+  if (DAG.getMachineFunction().getFunction().optForMinSize())
+    return 2;
+  return 3 + Subtarget.getSchedModel().MispredictPenalty;
+}
+
 SDValue CeespuTargetLowering::lowerSELECT_CC(SDValue Op,
                                              SelectionDAG &DAG) const {
   SDValue LHS = Op.getOperand(0);
@@ -363,16 +782,41 @@ SDValue CeespuTargetLowering::lowerSELECT_CC(SDValue Op,
   SDValue TrueV = Op.getOperand(2);
   SDValue FalseV = Op.getOperand(3);
   ISD::CondCode CC = cast<CondCodeSDNode>(Op.getOperand(4))->get();
+  EVT VT = Op.getValueType();
   SDLoc DL(Op);
 
+  // Try to select with a mask instead of a branch:
+  //   Result = FalseV ^ ((TrueV ^ FalseV) & Mask)
+  bool Inverted;
+  unsigned Cost;
+  SDValue Mask = getSetCCMask(LHS, RHS, CC, DL, DAG, Inverted, Cost);
+  if (Mask) {
+    SDValue T = Inverted ? FalseV : TrueV;
+    SDValue F = Inverted ? TrueV : FalseV;
+    // The mask is the result of a select between -1 and 0 as it is.
+    if (!isNullConstant(F))
+      Cost += 3;
+    else if (!isAllOnesConstant(T))
+      Cost += 1;
+
+    if (Cost <= getSelectBranchCost(DAG)) {
+      ++NumMaskSelects;
+      if (isNullConstant(F) && isAllOnesConstant(T))
+        return Mask;
+      if (isNullConstant(F))
+        return DAG.getNode(ISD::AND, DL, VT, T, Mask);
+      SDValue Diff = DAG.getNode(ISD::XOR, DL, VT, T, F);
+      return DAG.getNode(ISD::XOR, DL, VT, F,
+                         DAG.getNode(ISD::AND, DL, VT, Diff, Mask));
+    }
+  }
+
   normaliseSetCC(LHS, RHS, CC);
 
   SDValue TargetCC = DAG.getConstant(CC, DL, MVT::i32);
-
-  SDVTList VTs = DAG.getVTList(Op.getValueType(), MVT::Glue);
   SDValue Ops[] = {LHS, RHS, TargetCC, TrueV, FalseV};
 
-  return DAG.getNode(CeespuISD::SELECT_CC, DL, VTs, Ops);
+  return DAG.getNode(CeespuISD::SELECT_CC, DL, VT, Ops);
 }
 
 SDValue CeespuTargetLowering::lowerVASTART(SDValue Op,
@@ -443,6 +887,43 @@ SDValue CeespuTargetLowering::LowerRETURNADDR(SDValue Op,
   return DAG.getCopyFromReg(DAG.getEntryNode(), DL, Reg, XLenVT);
 }
 
+// If BB is the tail of a select triangle on the same condition as MI and MI
+// is the first instruction after its PHIs, returns the head of that triangle
+// so MI can add its PHI there instead of building a triangle of its own.
+static MachineBasicBlock *findSelectTriangleToShare(MachineInstr &MI,
+                                                    MachineBasicBlock *BB,
+                                                    unsigned BranchOpc) {
+  if (BB->pred_size() != 2 || MI.getIterator() == BB->begin())
+    return nullptr;
+  for (MachineBasicBlock::iterator I = BB->begin(); I != MI.getIterator(); ++I)
+    if (!I->isPHI())
+      return nullptr;
+
+  // The true and false values have to be available in the head.
+  MachineRegisterInfo &MRI = BB->getParent()->getRegInfo();
+  for (unsigned i = 4; i <= 5; ++i) {
+    MachineInstr *Def = MRI.getVRegDef(MI.getOperand(i).getReg());
+    if (Def && Def->getParent() == BB)
+      return nullptr;
+  }
+
+  for (MachineBasicBlock *Head : BB->predecessors()) {
+    if (Head->succ_size() != 2 || Head->empty())
+      continue;
+    const MachineInstr &Br = Head->back();
+    if (Br.getOpcode() != BranchOpc || Br.getOperand(2).getMBB() != BB ||
+        !Br.getOperand(0).isIdenticalTo(MI.getOperand(1)) ||
+        !Br.getOperand(1).isIdenticalTo(MI.getOperand(2)))
+      continue;
+    MachineBasicBlock *IfFalse = *Head->succ_begin() == BB
+                                     ? *std::next(Head->succ_begin())
+                                     : *Head->succ_begin();
+    if (IfFalse->empty() && IfFalse->isSuccessor(BB))
+      return Head;
+  }
+  return nullptr;
+}
+
 MachineBasicBlock *CeespuTargetLowering::EmitInstrWithCustomInserter(
     MachineInstr &MI, MachineBasicBlock *BB) const {
   const TargetInstrInfo &TII = *BB->getParent()->getSubtarget().getInstrInfo();
@@ -450,6 +931,25 @@ MachineBasicBlock *CeespuTargetLowering::EmitInstrWithCustomInserter(
   // DEBUG(dbgs() << "EmitInstrWithCustomInserter \n");
   assert(MI.getOpcode() == Ceespu::Select && "Unexpected instr type to insert");
 
+  unsigned LHS = MI.getOperand(1).getReg();
+  unsigned RHS = MI.getOperand(2).getReg();
+  auto CC = static_cast<ISD::CondCode>(MI.getOperand(3).getImm());
+  unsigned Opcode = getBranchOpcodeForIntCondCode(CC);
+
+  // Back-to-back selects on the same condition share one triangle.
+  if (MachineBasicBlock *HeadMBB = findSelectTriangleToShare(MI, BB, Opcode)) {
+    MachineBasicBlock *IfFalseMBB = *HeadMBB->succ_begin() == BB
+                                        ? *std::next(HeadMBB->succ_begin())
+                                        : *HeadMBB->succ_begin();
+    BuildMI(*BB, MI, DL, TII.get(Ceespu::PHI), MI.getOperand(0).getReg())
+        .addReg(MI.getOperand(4).getReg())
+        .addMBB(HeadMBB)
+        .addReg(MI.getOperand(5).getReg())
+        .addMBB(IfFalseMBB);
+    MI.eraseFromParent();
+    return BB;
+  }
+
   // To "insert" a SELECT instruction, we actually have to insert the triangle
   // control-flow pattern.  The incoming instruction knows the destination vreg
   // to set, the condition code register to branch on, the true/false values to
@@ -482,11 +982,6 @@ MachineBasicBlock *CeespuTargetLowering::EmitInstrWithCustomInserter(
   HeadMBB->addSuccessor(TailMBB);
 
   // Insert appropriate branch.
-  unsigned LHS = MI.getOperand(1).getReg();
-  unsigned RHS = MI.getOperand(2).getReg();
-  auto CC = static_cast<ISD::CondCode>(MI.getOperand(3).getImm());
-  unsigned Opcode = getBranchOpcodeForIntCondCode(CC);
-
   BuildMI(HeadMBB, DL, TII.get(Opcode)).addReg(LHS).addReg(RHS).addMBB(TailMBB);
 
   // IfFalseMBB just falls through to TailMBB.
@@ -786,10 +1281,22 @@ static bool CC_Ceespu_VarArg(unsigned ValNo, MVT ValVT, MVT LocVT,
   return false;
 }
 
+// Every caller of a local function whose address is not taken is in this
+// module, so it can use the fast convention whatever the IR asks for.
+CallingConv::ID CeespuTargetLowering::getCallingConvFor(CallingConv::ID CC,
+                                                        const Function *F) {
+  if (CC == CallingConv::C && F && F->hasLocalLinkage() &&
+      !F->hasAddressTaken() && !F->isVarArg())
+    return CallingConv::Fast;
+  return CC;
+}
+
 SDValue CeespuTargetLowering::LowerFormalArguments(
     SDValue Chain, CallingConv::ID CallConv, bool IsVarArg,
     const SmallVectorImpl<ISD::InputArg> &Ins, const SDLoc &DL,
     SelectionDAG &DAG, SmallVectorImpl<SDValue> &InVals) const {
+  const Function &F = DAG.getMachineFunction().getFunction();
+  CallConv = getCallingConvFor(CallConv, &F);
   switch (CallConv) {
     case CallingConv::C:
     case CallingConv::Fast:
@@ -802,25 +1309,14 @@ SDValue CeespuTargetLowering::LowerFormalArguments(
 SDValue CeespuTargetLowering::LowerCall(
     TargetLowering::CallLoweringInfo &CLI,
     SmallVectorImpl<SDValue> &InVals) const {
-  SelectionDAG &DAG = CLI.DAG;
-  SDLoc &DL = CLI.DL;
-  SmallVectorImpl<ISD::OutputArg> &Outs = CLI.Outs;
-  SmallVectorImpl<SDValue> &OutVals = CLI.OutVals;
-  SmallVectorImpl<ISD::InputArg> &Ins = CLI.Ins;
-  SDValue Chain = CLI.Chain;
-  SDValue Callee = CLI.Callee;
-  bool &IsTailCall = CLI.IsTailCall;
-  CallingConv::ID CallConv = CLI.CallConv;
-  bool IsVarArg = CLI.IsVarArg;
-
-  // Ceespu target does not yet support tail call optimization.
-  IsTailCall = false;
-
-  switch (CallConv) {
+  const Function *CalleeFn = nullptr;
+  if (GlobalAddressSDNode *G = dyn_cast<GlobalAddressSDNode>(CLI.Callee))
+    CalleeFn = dyn_cast<Function>(G->getGlobal());
+  CLI.CallConv = getCallingConvFor(CLI.CallConv, CalleeFn);
+  switch (CLI.CallConv) {
     case CallingConv::Fast:
     case CallingConv::C:
-      return LowerCCCCallTo(Chain, Callee, CallConv, IsVarArg, IsTailCall, Outs,
-                            OutVals, Ins, DL, DAG, InVals);
+      return LowerCCCCallTo(CLI, InVals);
     default:
       report_fatal_error("Unsupported calling convention");
   }
@@ -922,11 +1418,24 @@ SDValue CeespuTargetLowering::LowerCCCArguments(
   return Chain;
 }
 
+// The generic code asks with the convention of the IR, so internal functions
+// that use the fast convention still return at most four registers unless the
+// IR gives them the fast convention too. Both sides of a call agree either way.
+bool CeespuTargetLowering::CanLowerReturn(
+    CallingConv::ID CallConv, MachineFunction &MF, bool IsVarArg,
+    const SmallVectorImpl<ISD::OutputArg> &Outs, LLVMContext &Context) const {
+  SmallVector<CCValAssign, 16> RVLocs;
+  CCState CCInfo(CallConv, IsVarArg, MF, RVLocs, Context);
+  return CCInfo.CheckReturn(Outs, RetCC_Ceespu);
+}
+
 SDValue CeespuTargetLowering::LowerReturn(
     SDValue Chain, CallingConv::ID CallConv, bool IsVarArg,
     const SmallVectorImpl<ISD::OutputArg> &Outs,
     const SmallVectorImpl<SDValue> &OutVals, const SDLoc &DL,
     SelectionDAG &DAG) const {
+  const Function &F = DAG.getMachineFunction().getFunction();
+  CallConv = getCallingConvFor(CallConv, &F);
   // CCValAssign - represent the assignment of the return value to a location
   SmallVector<CCValAssign, 16> RVLocs;
 
@@ -984,18 +1493,27 @@ SDValue CeespuTargetLowering::LowerReturn(
 
 // LowerCCCCallTo - functions arguments are copied from virtual regs to
 // (physical regs)/(stack frame), CALLSEQ_START and CALLSEQ_END are emitted.
+// Calls in tail position that pass everything in registers become a TAIL
+// node instead.
 SDValue CeespuTargetLowering::LowerCCCCallTo(
-    SDValue Chain, SDValue Callee, CallingConv::ID CallConv, bool IsVarArg,
-    bool /*IsTailCall*/, const SmallVectorImpl<ISD::OutputArg> &Outs,
-    const SmallVectorImpl<SDValue> &OutVals,
-    const SmallVectorImpl<ISD::InputArg> &Ins, const SDLoc &DL,
-    SelectionDAG &DAG, SmallVectorImpl<SDValue> &InVals) const {
+    CallLoweringInfo &CLI, SmallVectorImpl<SDValue> &InVals) const {
+  SelectionDAG &DAG = CLI.DAG;
+  SDLoc &DL = CLI.DL;
+  SmallVectorImpl<ISD::OutputArg> &Outs = CLI.Outs;
+  SmallVectorImpl<SDValue> &OutVals = CLI.OutVals;
+  SmallVectorImpl<ISD::InputArg> &Ins = CLI.Ins;
+  SDValue Chain = CLI.Chain;
+  SDValue Callee = CLI.Callee;
+  bool &IsTailCall = CLI.IsTailCall;
+  CallingConv::ID CallConv = CLI.CallConv;
+  bool IsVarArg = CLI.IsVarArg;
+  MachineFunction &MF = DAG.getMachineFunction();
+
   // Analyze operands of the call, assigning locations to each operand.
   SmallVector<CCValAssign, 16> ArgLocs;
-  CCState CCInfo(CallConv, IsVarArg, DAG.getMachineFunction(), ArgLocs,
-                 *DAG.getContext());
+  CCState CCInfo(CallConv, IsVarArg, MF, ArgLocs, *DAG.getContext());
   GlobalAddressSDNode *G = dyn_cast<GlobalAddressSDNode>(Callee);
-  MachineFrameInfo &MFI = DAG.getMachineFunction().getFrameInfo();
+  MachineFrameInfo &MFI = MF.getFrameInfo();
 
   NumFixedArgs = 0;
   if (IsVarArg && G) {
@@ -1008,6 +1526,16 @@ SDValue CeespuTargetLowering::LowerCCCCallTo(
     CCInfo.AnalyzeCallOperands(Outs, CC_Ceespu);
   }
 
+  // Check if it's really possible to do a tail call.
+  if (IsTailCall)
+    IsTailCall = IsEligibleForTailCallOptimization(CCInfo, CLI, MF, ArgLocs);
+
+  if (IsTailCall)
+    ++NumTailCalls;
+  else if (CLI.CS && CLI.CS.isMustTailCall())
+    report_fatal_error("failed to perform tail call elimination on a call "
+                       "site marked musttail");
+
   // Get a count of how many bytes are to be pushed on the stack.
   unsigned NumBytes = CCInfo.getNextStackOffset();
 
@@ -1033,7 +1561,10 @@ SDValue CeespuTargetLowering::LowerCCCCallTo(
     ByValArgs.push_back(FIPtr);
   }
 
-  Chain = DAG.getCALLSEQ_START(Chain, NumBytes, 0, DL);
+  // A tail call reuses the caller's incoming argument area, which is empty
+  // because only register arguments are eligible.
+  if (!IsTailCall)
+    Chain = DAG.getCALLSEQ_START(Chain, NumBytes, 0, DL);
 
   SmallVector<std::pair<unsigned, SDValue>, 4> RegsToPass;
   SmallVector<SDValue, 12> MemOpChains;
@@ -1119,13 +1650,6 @@ SDValue CeespuTargetLowering::LowerCCCCallTo(
   SmallVector<SDValue, 8> Ops;
   Ops.push_back(Chain);
   Ops.push_back(Callee);
-  const CeespuRegisterInfo *TRI = Subtarget.getRegisterInfo();
-  // Add a register mask operand representing the call-preserved registers.
-  // TODO: Should return-twice functions be handled?
-  const uint32_t *Mask =
-      TRI->getCallPreservedMask(DAG.getMachineFunction(), CallConv);
-  assert(Mask && "Missing call preserved mask for calling convention");
-  Ops.push_back(DAG.getRegisterMask(Mask));
 
   // Add argument registers to the end of the list so that they are
   // known live into the call.
@@ -1133,8 +1657,24 @@ SDValue CeespuTargetLowering::LowerCCCCallTo(
     Ops.push_back(DAG.getRegister(RegsToPass[I].first,
                                   RegsToPass[I].second.getValueType()));
 
+  // Add a register mask operand representing the call-preserved registers.
+  // Tail calls need it too, so that IPRA counts the registers the callee
+  // clobbers against the caller.
+  // TODO: Should return-twice functions be handled?
+  const CeespuRegisterInfo *TRI = Subtarget.getRegisterInfo();
+  const uint32_t *Mask = TRI->getCallPreservedMask(MF, CallConv);
+  assert(Mask && "Missing call preserved mask for calling convention");
+  Ops.push_back(DAG.getRegisterMask(Mask));
+
   if (InFlag.getNode()) Ops.push_back(InFlag);
 
+  // The callee returns straight to our caller, so there are no results to
+  // copy out and no call frame to tear down here.
+  if (IsTailCall) {
+    MF.getFrameInfo().setHasTailCall();
+    return DAG.getNode(CeespuISD::TAIL, DL, NodeTys, Ops);
+  }
+
   Chain = DAG.getNode(CeespuISD::CALL, DL, NodeTys,
                       ArrayRef<SDValue>(&Ops[0], Ops.size()));
   InFlag = Chain.getValue(1);
@@ -1189,7 +1729,7 @@ bool CeespuTargetLowering::IsEligibleForTailCallOptimization(
   auto IsVarArg = CLI.IsVarArg;
   auto &Outs = CLI.Outs;
   auto &Caller = MF.getFunction();
-  auto CallerCC = Caller.getCallingConv();
+  auto CallerCC = getCallingConvFor(Caller.getCallingConv(), &Caller);
 
   // Do not tail call opt functions with "disable-tail-calls" attribute.
   if (Caller.getFnAttribute("disable-tail-calls").getValueAsString() == "true")
@@ -1278,12 +1818,144 @@ const char *CeespuTargetLowering::getTargetNodeName(unsigned Opcode) const {
       return "CeespuISD::CALL";
     case CeespuISD::SELECT_CC:
       return "CeespuISD::SELECT_CC";
+    case CeespuISD::MASK_ULT:
+      return "CeespuISD::MASK_ULT";
+    case CeespuISD::Wrapper:
+      return "CeespuISD::Wrapper";
+    case CeespuISD::SmallWrapper:
+      return "CeespuISD::SmallWrapper";
     case CeespuISD::TAIL:
       return "CeespuISD::TAIL";
+    case CeespuISD::ADDC:
+      return "CeespuISD::ADDC";
+    case CeespuISD::ADDE:
+      return "CeespuISD::ADDE";
+    case CeespuISD::SUBC:
+      return "CeespuISD::SUBC";
+    case CeespuISD::SUBE:
+      return "CeespuISD::SUBE";
+    case CeespuISD::BR_CARRY:
+      return "CeespuISD::BR_CARRY";
+    case CeespuISD::LOAD_JT:
+      return "CeespuISD::LOAD_JT";
   }
   return nullptr;
 }
 
+// A carry that was read out of the flag and put back with "addi -1" is
+// used directly. Users are legalized before their operands, so
+// getCarryGlue cannot see this when ADDCARRY is lowered.
+static SDValue combineCarryGlue(SDNode *N, SelectionDAG &DAG) {
+  SDValue Glue = N->getOperand(2);
+  if (Glue.getOpcode() != CeespuISD::ADDC ||
+      Glue.getNode()->hasAnyUseOfValue(0) ||
+      !isAllOnesConstant(Glue.getOperand(1)))
+    return SDValue();
+  SDValue Carry = Glue.getOperand(0);
+  if (!isCarryValue(Carry) || !Carry.hasOneUse())
+    return SDValue();
+  return DAG.getNode(N->getOpcode(), SDLoc(N), N->getVTList(),
+                     N->getOperand(0), N->getOperand(1), Carry.getOperand(2));
+}
+
+// Returns the carry read out of the flag that the conditional branch N
+// tests, or an empty value. OnSet is set to whether the branch is taken when
+// the carry is set. After legalization the test is a BR_CC against 0 or 1.
+static SDValue getBranchCarry(SDNode *N, bool &OnSet) {
+  if (N->getOpcode() == ISD::BRCOND) {
+    OnSet = true;
+    return isCarryValue(N->getOperand(1)) ? N->getOperand(1) : SDValue();
+  }
+  if (N->getOpcode() != ISD::BR_CC || !isCarryValue(N->getOperand(2)))
+    return SDValue();
+  ISD::CondCode CC = cast<CondCodeSDNode>(N->getOperand(1))->get();
+  if (CC != ISD::SETEQ && CC != ISD::SETNE)
+    return SDValue();
+  if (isNullConstant(N->getOperand(3)))
+    OnSet = CC == ISD::SETNE;
+  else if (isOneConstant(N->getOperand(3)))
+    OnSet = CC == ISD::SETEQ;
+  else
+    return SDValue();
+  return N->getOperand(2);
+}
+
+static SDValue getBranchDest(SDNode *N) {
+  return N->getOperand(N->getOpcode() == ISD::BRCOND ? 2 : 4);
+}
+
+// Returns glue holding Carry in the flag for a branch. The branch is glued
+// to the node that sets the flag, so that node is scheduled right before
+// it. That is only possible when nothing else uses the node, as its other
+// users are ordered before the branch. Otherwise the flag is set again by
+// a copy of the add with its operands swapped, which is not merged with the
+// original, or from the carry that was read out of it.
+static SDValue getBranchCarryGlue(SDValue Carry, SelectionDAG &DAG,
+                                  const SDLoc &DL) {
+  SDValue Glue = Carry.getOperand(2);
+  SDNode *Flag = Glue.getNode();
+  if (Carry.hasOneUse() && !Flag->hasAnyUseOfValue(0))
+    return Glue;
+  SDVTList VTs = DAG.getVTList(MVT::i32, MVT::Glue);
+  if (Flag->getOpcode() == CeespuISD::ADDC &&
+      Flag->getOperand(0) != Flag->getOperand(1) &&
+      !isa<ConstantSDNode>(Flag->getOperand(0)) &&
+      !isa<ConstantSDNode>(Flag->getOperand(1)))
+    return DAG
+        .getNode(CeespuISD::ADDC, DL, VTs, Flag->getOperand(1),
+                 Flag->getOperand(0))
+        .getValue(1);
+  return DAG.getNode(CeespuISD::ADDC, DL, VTs, Carry,
+                     DAG.getConstant(-1, DL, MVT::i32))
+      .getValue(1);
+}
+
+// A branch on a carry that was read out of the flag branches on the flag
+// itself with bc.
+SDValue CeespuTargetLowering::PerformDAGCombine(SDNode *N,
+                                                DAGCombinerInfo &DCI) const {
+  SelectionDAG &DAG = DCI.DAG;
+  SDLoc DL(N);
+  bool OnSet;
+
+  switch (N->getOpcode()) {
+    default:
+      return SDValue();
+    case CeespuISD::ADDE:
+    case CeespuISD::SUBE:
+      return combineCarryGlue(N, DAG);
+    case ISD::BRCOND:
+    case ISD::BR_CC: {
+      SDValue Carry = getBranchCarry(N, OnSet);
+      if (!Carry || !OnSet)
+        return SDValue();
+      return DAG.getNode(CeespuISD::BR_CARRY, DL, MVT::Other,
+                         N->getOperand(0), getBranchDest(N),
+                         getBranchCarryGlue(Carry, DAG, DL));
+    }
+    case ISD::BR: {
+      // bc only branches on a set carry. A branch taken on a clear carry
+      // that is followed by a jump swaps the two destinations.
+      SDNode *Cond = N->getOperand(0).getNode();
+      SDValue Carry = getBranchCarry(Cond, OnSet);
+      if (!Carry || OnSet || !Cond->hasOneUse())
+        return SDValue();
+      SDValue Branch = DAG.getNode(CeespuISD::BR_CARRY, DL, MVT::Other,
+                                   Cond->getOperand(0), N->getOperand(1),
+                                   getBranchCarryGlue(Carry, DAG, DL));
+      return DAG.getNode(ISD::BR, DL, MVT::Other, Branch, getBranchDest(Cond));
+    }
+  }
+}
+
+void CeespuTargetLowering::computeKnownBitsForTargetNode(
+    const SDValue Op, KnownBits &Known, const APInt &DemandedElts,
+    const SelectionDAG &DAG, unsigned Depth) const {
+  Known.resetAll();
+  if (isCarryValue(Op))
+    Known.Zero.setBitsFrom(1);
+}
+
 std::pair<unsigned, const TargetRegisterClass *>
 CeespuTargetLowering::getRegForInlineAsmConstraint(
     const TargetRegisterInfo *TRI, StringRef Constraint, MVT VT) const {
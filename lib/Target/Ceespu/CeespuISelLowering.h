@@ -30,8 +30,23 @@ enum NodeType : unsigned {
   RET_FLAG,
   CALL,
   SELECT_CC,
+  // All ones if operand 0 is unsigned less than operand 1, zero otherwise.
+  MASK_ULT,
   Wrapper,
-  TAIL
+  // Address of a small data object, reached as an offset from c0.
+  SmallWrapper,
+  TAIL,
+  // Add and subtract producing the carry as glue, and the forms that also
+  // consume it.
+  ADDC,
+  ADDE,
+  SUBC,
+  SUBE,
+  // Branch if the glued carry is set.
+  BR_CARRY,
+  // Load entry operand 1 of the jump table at operand 0. The width of the
+  // entries is chosen when the function is emitted.
+  LOAD_JT = ISD::FIRST_TARGET_MEMORY_OPCODE
 };
 }
 
@@ -50,6 +65,7 @@ class CeespuTargetLowering : public TargetLowering {
   bool isTruncateFree(Type *SrcTy, Type *DstTy) const override;
   bool isTruncateFree(EVT SrcVT, EVT DstVT) const override;
   bool isZExtFree(SDValue Val, EVT VT2) const override;
+  bool isIntDivCheap(EVT VT, AttributeList Attr) const override;
 
   // Provide custom lowering hooks for some operations.
   SDValue LowerOperation(SDValue Op, SelectionDAG &DAG) const override;
@@ -57,6 +73,13 @@ class CeespuTargetLowering : public TargetLowering {
   // This method returns the name of a target specific DAG node.
   const char *getTargetNodeName(unsigned Opcode) const override;
 
+  SDValue PerformDAGCombine(SDNode *N, DAGCombinerInfo &DCI) const override;
+
+  void computeKnownBitsForTargetNode(const SDValue Op, KnownBits &Known,
+                                     const APInt &DemandedElts,
+                                     const SelectionDAG &DAG,
+                                     unsigned Depth) const override;
+
   std::pair<unsigned, const TargetRegisterClass *> getRegForInlineAsmConstraint(
       const TargetRegisterInfo *TRI, StringRef Constraint,
       MVT VT) const override;
@@ -67,6 +90,13 @@ class CeespuTargetLowering : public TargetLowering {
   EVT getSetCCResultType(const DataLayout &DL, LLVMContext &Context,
                          EVT VT) const override;
 
+  unsigned getPrefLoopAlignment(MachineLoop *ML) const override;
+
+  // Returns the calling convention that calls to F, made with the convention
+  // CC, follow. F is null for indirect calls.
+  static CallingConv::ID getCallingConvFor(CallingConv::ID CC,
+                                           const Function *F);
+
  private:
   void analyzeInputArgs(MachineFunction &MF, CCState &CCInfo,
                         const SmallVectorImpl<ISD::InputArg> &Ins,
@@ -90,18 +120,12 @@ class CeespuTargetLowering : public TargetLowering {
                           const SmallVectorImpl<ISD::InputArg> &Ins,
                           const SDLoc &DL, SelectionDAG &DAG,
                           SmallVectorImpl<SDValue> &InVals) const;
-  SDValue LowerCCCCallTo(SDValue Chain, SDValue Callee,
-                         CallingConv::ID CallConv, bool IsVarArg,
-                         bool /*IsTailCall*/,
-                         const SmallVectorImpl<ISD::OutputArg> &Outs,
-                         const SmallVectorImpl<SDValue> &OutVals,
-                         const SmallVectorImpl<ISD::InputArg> &Ins,
-                         const SDLoc &DL, SelectionDAG &DAG,
+  SDValue LowerCCCCallTo(CallLoweringInfo &CLI,
                          SmallVectorImpl<SDValue> &InVals) const;
-  /*bool CanLowerReturn(CallingConv::ID CallConv, MachineFunction &MF,
+  bool CanLowerReturn(CallingConv::ID CallConv, MachineFunction &MF,
                       bool IsVarArg,
                       const SmallVectorImpl<ISD::OutputArg> &Outs,
-                      LLVMContext &Context) const override;*/
+                      LLVMContext &Context) const override;
   SDValue LowerReturn(SDValue Chain, CallingConv::ID CallConv, bool IsVarArg,
                       const SmallVectorImpl<ISD::OutputArg> &Outs,
                       const SmallVectorImpl<SDValue> &OutVals, const SDLoc &DL,
@@ -117,7 +141,16 @@ class CeespuTargetLowering : public TargetLowering {
   SDValue lowerConstantPool(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerExternalSymbol(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerJumpTable(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerBR_JT(SDValue Op, SelectionDAG &DAG) const;
   SDValue lowerSELECT_CC(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerMULH(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerUADDSUBO(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerADDSUBCARRY(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerSETCCCARRY(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerShiftLeftParts(SDValue Op, SelectionDAG &DAG) const;
+  SDValue lowerShiftRightParts(SDValue Op, SelectionDAG &DAG,
+                               bool IsSRA) const;
+  unsigned getSelectBranchCost(SelectionDAG &DAG) const;
   SDValue lowerVASTART(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerFRAMEADDR(SDValue Op, SelectionDAG &DAG) const;
   SDValue LowerRETURNADDR(SDValue Op, SelectionDAG &DAG) const;
@@ -18,10 +18,14 @@
 #include "CeespuTargetMachine.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/CodeGen/LiveRegUnits.h"
 #include "llvm/CodeGen/MachineFunctionPass.h"
 #include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/CodeGen/MachineInstrBundle.h"
+#include "llvm/CodeGen/MachineLoopInfo.h"
 #include "llvm/CodeGen/MachineRegisterInfo.h"
 #include "llvm/CodeGen/RegisterScavenging.h"
+#include "llvm/IR/Module.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/TargetRegistry.h"
 
@@ -30,8 +34,9 @@
 
 using namespace llvm;
 
-CeespuInstrInfo::CeespuInstrInfo()
-    : CeespuGenInstrInfo(Ceespu::ADJCALLSTACKDOWN, Ceespu::ADJCALLSTACKUP) {}
+CeespuInstrInfo::CeespuInstrInfo(bool CodeInLow64K)
+    : CeespuGenInstrInfo(Ceespu::ADJCALLSTACKDOWN, Ceespu::ADJCALLSTACKUP),
+      CodeInLow64K(CodeInLow64K) {}
 
 unsigned CeespuInstrInfo::isLoadFromStackSlot(const MachineInstr &MI,
                                               int &FrameIndex) const {
@@ -75,11 +80,28 @@ unsigned CeespuInstrInfo::isStoreToStackSlot(const MachineInstr &MI,
   return 0;
 }
 
+// Returns true unless the carry is known to be dead before I.
+static bool isCarryLive(MachineBasicBlock &MBB,
+                        MachineBasicBlock::iterator I) {
+  const TargetRegisterInfo *TRI =
+      MBB.getParent()->getSubtarget().getRegisterInfo();
+  return MBB.computeRegisterLiveness(TRI, Ceespu::CARRY, I) !=
+         MachineBasicBlock::LQR_Dead;
+}
+
 void CeespuInstrInfo::copyPhysReg(MachineBasicBlock &MBB,
                                   MachineBasicBlock::iterator MBBI,
                                   const DebugLoc &DL, unsigned DstReg,
                                   unsigned SrcReg, bool KillSrc) const {
   if (Ceespu::GPRRegClass.contains(DstReg, SrcReg)) {
+    // mov is an addi, which sets the carry. Use "or rd, ra, c0" while the
+    // carry is live.
+    if (isCarryLive(MBB, MBBI)) {
+      BuildMI(MBB, MBBI, DL, get(Ceespu::OR), DstReg)
+          .addReg(Ceespu::R0)
+          .addReg(SrcReg, getKillRegState(KillSrc));
+      return;
+    }
     BuildMI(MBB, MBBI, DL, get(Ceespu::ADDI), DstReg)
         .addReg(SrcReg, getKillRegState(KillSrc))
         .addImm(0);
@@ -136,49 +158,129 @@ void CeespuInstrInfo::movImm32(MachineBasicBlock &MBB,
                                uint64_t Val, MachineInstr::MIFlag Flag) const {
   assert(isInt<32>(Val) && "Can only materialize 32-bit constants");
 
-  // TODO: If the value can be materialized using only one instruction, only
-  // insert a single instruction.
+  if (isInt<16>(Val)) {
+    BuildMI(MBB, MBBI, DL, get(Ceespu::ADDI), DstReg)
+        .addReg(Ceespu::R0)
+        .addImm(Val)
+        .setMIFlag(Flag);
+    return;
+  }
 
-  uint64_t Hi16 = Val >> 16;
-  uint64_t Lo16 = Val & 0xffff;
-  BuildMI(MBB, MBBI, DL, get(Ceespu::SETHI)).addImm(Hi16);
-  BuildMI(MBB, MBBI, DL, get(Ceespu::ADDI), DstReg)
-      .addReg(Ceespu::R0)
-      .addImm(Lo16)
+  // Larger values are expanded once the frame is final, see expandLIX.
+  BuildMI(MBB, MBBI, DL, get(Ceespu::LIX), DstReg)
+      .addImm(Val)
       .setMIFlag(Flag);
 }
 
+// Returns the amount by which a signed 16-bit immediate has to be shifted left
+// to produce Val, or 0 if there is no such immediate.
+static unsigned getShiftedImm16Amount(int64_t Val) {
+  if (Val == 0)
+    return 0;
+  unsigned Shift = countTrailingZeros(static_cast<uint64_t>(Val));
+  return isInt<16>(Val >> Shift) ? Shift : 0;
+}
+
+unsigned CeespuInstrInfo::getMaterializationCost(int64_t Val) const {
+  return isInt<16>(Val) ? 1 : 2;
+}
+
+// Builds the SETI prefix and the instruction it extends and bundles them, so
+// that later passes keep the pair together.
+MachineInstr *CeespuInstrInfo::buildSETIPair(MachineBasicBlock &MBB,
+                                             MachineBasicBlock::iterator MBBI,
+                                             const DebugLoc &DL,
+                                             const MachineOperand &Hi,
+                                             unsigned Opc, unsigned DstReg,
+                                             unsigned SrcReg,
+                                             const MachineOperand &Lo,
+                                             MachineInstr::MIFlag Flag) const {
+  MachineInstr *SetHi =
+      BuildMI(MBB, MBBI, DL, get(Ceespu::SETHI)).add(Hi).setMIFlag(Flag);
+  MachineInstr *Op = BuildMI(MBB, MBBI, DL, get(Opc), DstReg)
+                         .addReg(SrcReg)
+                         .add(Lo)
+                         .setMIFlag(Flag);
+  finalizeBundle(MBB, SetHi->getIterator(), std::next(Op->getIterator()));
+  return Op;
+}
+
+// Expands a LIX pseudo into the shortest sequence that produces its value:
+// a single addi, a shifted addi, or a SETI prefixed addi. Where the carry is
+// live, the value is built with a SETI prefixed ori, which leaves it alone.
+void CeespuInstrInfo::expandLIX(MachineInstr &MI) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  DebugLoc DL = MI.getDebugLoc();
+  unsigned DstReg = MI.getOperand(0).getReg();
+  const MachineOperand &MO = MI.getOperand(1);
+  MachineInstr::MIFlag Flag =
+      MI.getFlag(MachineInstr::FrameSetup)
+          ? MachineInstr::FrameSetup
+          : MI.getFlag(MachineInstr::FrameDestroy) ? MachineInstr::FrameDestroy
+                                                   : MachineInstr::NoFlags;
+
+  bool CarryLive = isCarryLive(MBB, std::next(MI.getIterator()));
+  if (!MO.isImm()) {
+    MachineOperand Hi = MO, Lo = MO;
+    Hi.setTargetFlags(CeespuII::MO_HI);
+    Lo.setTargetFlags(CeespuII::MO_LO);
+    buildSETIPair(MBB, MI, DL, Hi, CarryLive ? Ceespu::ORI : Ceespu::ADDI,
+                  DstReg, Ceespu::R0, Lo, Flag);
+    MBB.erase(MI);
+    return;
+  }
+
+  int64_t Val = SignExtend64<32>(MO.getImm());
+  if (CarryLive && isInt<16>(Val)) {
+    // ori sign extends its immediate like addi, but leaves the carry alone.
+    BuildMI(MBB, MI, DL, get(Ceespu::ORI), DstReg)
+        .addReg(Ceespu::R0)
+        .addImm(Val)
+        .setMIFlag(Flag);
+  } else if (CarryLive) {
+    buildSETIPair(MBB, MI, DL, MachineOperand::CreateImm((Val >> 16) & 0xffff),
+                  Ceespu::ORI, DstReg, Ceespu::R0,
+                  MachineOperand::CreateImm(SignExtend64<16>(Val)), Flag);
+  } else if (isInt<16>(Val)) {
+    BuildMI(MBB, MI, DL, get(Ceespu::ADDI), DstReg)
+        .addReg(Ceespu::R0)
+        .addImm(Val)
+        .setMIFlag(Flag);
+  } else if (unsigned Shift = getShiftedImm16Amount(Val)) {
+    // This is as long as the SETI form, but the two instructions do not have
+    // to stay together, which leaves the post-RA scheduler more freedom.
+    BuildMI(MBB, MI, DL, get(Ceespu::ADDI), DstReg)
+        .addReg(Ceespu::R0)
+        .addImm(Val >> Shift)
+        .setMIFlag(Flag);
+    BuildMI(MBB, MI, DL, get(Ceespu::SHLI), DstReg)
+        .addReg(DstReg, RegState::Kill)
+        .addImm(Shift)
+        .setMIFlag(Flag);
+  } else {
+    // The low half is printed sign extended so that it reads back as the
+    // same 16 bits.
+    buildSETIPair(MBB, MI, DL, MachineOperand::CreateImm((Val >> 16) & 0xffff),
+                  Ceespu::ADDI, DstReg, Ceespu::R0,
+                  MachineOperand::CreateImm(SignExtend64<16>(Val)), Flag);
+  }
+  MBB.erase(MI);
+}
+
 // The contents of values added to Cond are not examined outside of
 // CeespuInstrInfo, giving us flexibility in what to push to it. For Ceespu, we
-// push BranchOpcode, Reg1, Reg2.
+// push BranchOpcode, Reg1, Reg2, or only BranchOpcode for BC.
 static void parseCondBranch(MachineInstr &LastInst, MachineBasicBlock *&Target,
                             SmallVectorImpl<MachineOperand> &Cond) {
   // Block ends with fall-through condbranch.
   assert(LastInst.getDesc().isConditionalBranch() &&
          "Unknown conditional branch");
-  Target = LastInst.getOperand(2).getMBB();
+  // The branch target is always the last operand.
+  unsigned NumOps = LastInst.getNumExplicitOperands();
+  Target = LastInst.getOperand(NumOps - 1).getMBB();
   Cond.push_back(MachineOperand::CreateImm(LastInst.getOpcode()));
-  Cond.push_back(LastInst.getOperand(0));
-  Cond.push_back(LastInst.getOperand(1));
-}
-
-static unsigned getOppositeBranchOpcode(int Opc) {
-  switch (Opc) {
-    default:
-      llvm_unreachable("Unrecognized conditional branch");
-    case Ceespu::BEQ:
-      return Ceespu::BNE;
-    case Ceespu::BNE:
-      return Ceespu::BEQ;
-    case Ceespu::BGT:
-      return Ceespu::BGT;
-    case Ceespu::BGE:
-      return Ceespu::BGE;
-    case Ceespu::BGEU:
-      return Ceespu::BGEU;
-    case Ceespu::BGU:
-      return Ceespu::BGU;
-  }
+  for (unsigned i = 0; i < NumOps - 1; ++i)
+    Cond.push_back(LastInst.getOperand(i));
 }
 
 bool CeespuInstrInfo::analyzeBranch(MachineBasicBlock &MBB,
@@ -257,8 +359,8 @@ unsigned CeespuInstrInfo::removeBranch(MachineBasicBlock &MBB,
     return 0;
 
   // Remove the branch.
-  I->eraseFromParent();
   if (BytesRemoved) *BytesRemoved += getInstSizeInBytes(*I);
+  I->eraseFromParent();
 
   I = MBB.end();
 
@@ -267,8 +369,8 @@ unsigned CeespuInstrInfo::removeBranch(MachineBasicBlock &MBB,
   if (!I->getDesc().isConditionalBranch()) return 1;
 
   // Remove the branch.
-  I->eraseFromParent();
   if (BytesRemoved) *BytesRemoved += getInstSizeInBytes(*I);
+  I->eraseFromParent();
   return 2;
 }
 
@@ -281,8 +383,8 @@ unsigned CeespuInstrInfo::insertBranch(
 
   // Shouldn't be a fall through.
   assert(TBB && "InsertBranch must not be told to insert a fallthrough");
-  assert((Cond.size() == 3 || Cond.size() == 0) &&
-         "Ceespu branch conditions have two components!");
+  assert(Cond.size() <= 3 &&
+         "Ceespu branch conditions have at most two components!");
 
   // Unconditional branch.
   if (Cond.empty()) {
@@ -293,8 +395,10 @@ unsigned CeespuInstrInfo::insertBranch(
 
   // Either a one or two-way conditional branch.
   unsigned Opc = Cond[0].getImm();
-  MachineInstr &CondMI =
-      *BuildMI(&MBB, DL, get(Opc)).add(Cond[1]).add(Cond[2]).addMBB(TBB);
+  MachineInstrBuilder MIB = BuildMI(&MBB, DL, get(Opc));
+  for (unsigned i = 1; i < Cond.size(); ++i)
+    MIB.add(Cond[i]);
+  MachineInstr &CondMI = *MIB.addMBB(TBB);
   if (BytesAdded) *BytesAdded += getInstSizeInBytes(CondMI);
 
   // One-way conditional branch.
@@ -308,56 +412,37 @@ unsigned CeespuInstrInfo::insertBranch(
   return 2;
 }
 
-/*unsigned CeespuInstrInfo::insertIndirectBranch(MachineBasicBlock &MBB,
+// Jumps out of range of b take a SETI prefix, which extends the target to 32
+// bits. Unlike a jump through a register this needs no scratch register, so
+// nothing has to be scavenged or spilled.
+unsigned CeespuInstrInfo::insertIndirectBranch(MachineBasicBlock &MBB,
                                                MachineBasicBlock &DestBB,
                                                const DebugLoc &DL,
                                                int64_t BrOffset,
                                                RegScavenger *RS) const {
-  assert(RS && "RegScavenger required for long branching");
   assert(MBB.empty() &&
          "new block should be inserted for expanding unconditional branch");
   assert(MBB.pred_size() == 1);
 
-  MachineFunction *MF = MBB.getParent();
-  MachineRegisterInfo &MRI = MF->getRegInfo();
-  const auto &TM = static_cast<const CeespuTargetMachine &>(MF->getTarget());
-  const auto &STI = MF->getSubtarget<CeespuSubtarget>();
-
-  if (TM.isPositionIndependent() || STI.is64Bit())
-    report_fatal_error("Unable to insert indirect branch");
-
-  if (!isInt<32>(BrOffset))
-    report_fatal_error(
-        "Branch offsets outside of the signed 32-bit range not supported");
-
-  // FIXME: A virtual register must be used initially, as the register
-  // scavenger won't work with empty blocks (SIInstrInfo::insertIndirectBranch
-  // uses the same workaround).
-  unsigned ScratchReg = MRI.createVirtualRegister(&Ceespu::GPRRegClass);
-  auto II = MBB.end();
-
-  MachineInstr &LuiMI = *BuildMI(MBB, II, DL, get(Ceespu::LUI), ScratchReg)
-                             .addMBB(&DestBB, CeespuII::MO_HI);
-  BuildMI(MBB, II, DL, get(Ceespu::PseudoBRIND))
-      .addReg(ScratchReg, RegState::Kill)
-      .addMBB(&DestBB, CeespuII::MO_LO);
-
-  RS->enterBasicBlockEnd(MBB);
-  unsigned Scav = RS->scavengeRegisterBackwards(
-      Ceespu::GPRRegClass, MachineBasicBlock::iterator(LuiMI), false, 0);
-  MRI.replaceRegWith(ScratchReg, Scav);
-  MRI.clearVirtRegs();
-  RS->setRegUsed(Scav);
-  return 8;
-}
-*/
-
-// bool CeespuInstrInfo::reverseBranchCondition(
-//    SmallVectorImpl<MachineOperand> &Cond) const {
-//  assert((Cond.size() == 3) && "Invalid branch condition!");
-//  Cond[0].setImm(getOppositeBranchOpcode(Cond[0].getImm()));
-//  return false;
-//}
+  MachineInstr &MI =
+      *BuildMI(&MBB, DL, get(Ceespu::PseudoBRLONG)).addMBB(&DestBB);
+  return getInstSizeInBytes(MI);
+}
+
+bool CeespuInstrInfo::reverseBranchCondition(
+    SmallVectorImpl<MachineOperand> &Cond) const {
+  // There is no branch on carry clear.
+  if (Cond[0].getImm() == Ceespu::BC)
+    return true;
+
+  assert((Cond.size() == 3) && "Invalid branch condition!");
+  bool SwapOperands;
+  Cond[0].setImm(
+      CeespuII::getOppositeBranchOpcode(Cond[0].getImm(), SwapOperands));
+  if (SwapOperands)
+    std::swap(Cond[1], Cond[2]);
+  return false;
+}
 
 MachineBasicBlock *CeespuInstrInfo::getBranchDestBlock(
     const MachineInstr &MI) const {
@@ -369,15 +454,111 @@ MachineBasicBlock *CeespuInstrInfo::getBranchDestBlock(
 
 bool CeespuInstrInfo::isBranchOffsetInRange(unsigned BranchOp,
                                             int64_t BrOffset) const {
-  // Ideally we could determine the supported branch offset from the
-  // CeespuII::FormMask, but this can't be used for Pseudo instructions like
-  // PseudoBR.
-  return BrOffset < 32767 && BrOffset > -32768;
+  switch (BranchOp) {
+    default:
+      llvm_unreachable("Unexpected opcode!");
+    case Ceespu::BEQ:
+    case Ceespu::BNE:
+    case Ceespu::BGT:
+    case Ceespu::BGE:
+    case Ceespu::BGU:
+    case Ceespu::BGEU:
+    case Ceespu::BC:
+      return isInt<16>(BrOffset);
+    case Ceespu::JMP:
+      // The target of b is an absolute 16-bit address, not an offset, so
+      // BrOffset does not tell whether it reaches. The small code model
+      // links all code below 64K, as call relies on too. Otherwise the final
+      // address of the target is unknown and every jump takes a SETI prefix.
+      return CodeInLow64K;
+    case Ceespu::PseudoBRLONG:
+      return true;
+  }
+}
+
+// Expands MASKULT into "sub rd, ra, rb; sbb rd, c0, c0". The subtract
+// borrows exactly when ra <u rb, and the second instruction turns the borrow
+// into 0 or -1.
+void CeespuInstrInfo::expandMASKULT(MachineInstr &MI) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  DebugLoc DL = MI.getDebugLoc();
+  unsigned DstReg = MI.getOperand(0).getReg();
+
+  // The register-register forms take their operands as (rb, ra).
+  MachineInstr *Sub = BuildMI(MBB, MI, DL, get(Ceespu::SBB), DstReg)
+                          .add(MI.getOperand(2))
+                          .add(MI.getOperand(1));
+  MachineInstr *Mask = BuildMI(MBB, MI, DL, get(Ceespu::SBE), DstReg)
+                           .addReg(Ceespu::R0)
+                           .addReg(Ceespu::R0);
+  finalizeBundle(MBB, Sub->getIterator(), std::next(Mask->getIterator()));
+  MBB.erase(MI);
+}
+
+unsigned CeespuInstrInfo::getExtendedMemOpBase(unsigned Opc) {
+  switch (Opc) {
+    default:
+      return 0;
+    case Ceespu::LWX:
+      return Ceespu::LW;
+    case Ceespu::LHX:
+      return Ceespu::LH;
+    case Ceespu::LHUX:
+      return Ceespu::LHU;
+    case Ceespu::LBX:
+      return Ceespu::LB;
+    case Ceespu::LBUX:
+      return Ceespu::LBU;
+    case Ceespu::SWX:
+      return Ceespu::SW;
+    case Ceespu::SHX:
+      return Ceespu::SH;
+    case Ceespu::SBX:
+      return Ceespu::SB;
+  }
+}
+
+// Expands a SETI extended load or store into the access with the low half
+// of its offset, prefixed by the high half.
+void CeespuInstrInfo::expandExtendedMemOp(MachineInstr &MI,
+                                          unsigned Opc) const {
+  MachineBasicBlock &MBB = *MI.getParent();
+  DebugLoc DL = MI.getDebugLoc();
+  const MachineOperand &MO = MI.getOperand(2);
+  MachineOperand Hi = MO, Lo = MO;
+  if (MO.isImm()) {
+    Hi = MachineOperand::CreateImm((MO.getImm() >> 16) & 0xffff);
+    Lo = MachineOperand::CreateImm(SignExtend64<16>(MO.getImm()));
+  } else {
+    Hi.setTargetFlags(CeespuII::MO_HI);
+    Lo.setTargetFlags(CeespuII::MO_LO);
+  }
+
+  MachineInstr *SetHi = BuildMI(MBB, MI, DL, get(Ceespu::SETHI)).add(Hi);
+  MachineInstr *Access = BuildMI(MBB, MI, DL, get(Opc))
+                             .add(MI.getOperand(0))
+                             .add(MI.getOperand(1))
+                             .add(Lo)
+                             .setMemRefs(MI.memoperands_begin(),
+                                         MI.memoperands_end());
+  finalizeBundle(MBB, SetHi->getIterator(), std::next(Access->getIterator()));
+  MBB.erase(MI);
 }
 
 bool CeespuInstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
+  if (unsigned Opc = getExtendedMemOpBase(MI.getOpcode())) {
+    expandExtendedMemOp(MI, Opc);
+    return true;
+  }
+
   unsigned ReplaceOpc;
   switch (MI.getOpcode()) {
+    case Ceespu::LIX:
+      expandLIX(MI);
+      return true;
+    case Ceespu::MASKULT:
+      expandMASKULT(MI);
+      return true;
     case Ceespu::ADDX:
       ReplaceOpc = Ceespu::ADDI;
       break;
@@ -417,21 +598,24 @@ bool CeespuInstrInfo::expandPostRAPseudo(MachineInstr &MI) const {
   const unsigned SrcReg = MI.getOperand(1).getReg();
   const MachineOperand &MO = MI.getOperand(2);
   if (MO.isImm()) {
-    uint64_t imm = MO.getImm();
-    uint16_t lo = imm & 0xffff;
+    int64_t imm = MO.getImm();
+    // The low half is printed sign extended so that it reads back as the
+    // same 16 bits.
+    int64_t lo = SignExtend64<16>(imm);
     uint16_t hi = imm >> 16;
-    if (!isInt<16>(imm)) {
-      BuildMI(MBB, MI, DL, get(Ceespu::SETHI)).addImm(hi);
-    }
-    BuildMI(MBB, MI, DL, get(ReplaceOpc), DstReg).addReg(SrcReg).addImm(lo);
-    MBB.erase(MI);
-    return true;
+    if (isInt<16>(imm))
+      BuildMI(MBB, MI, DL, get(ReplaceOpc), DstReg).addReg(SrcReg).addImm(lo);
+    else
+      buildSETIPair(MBB, MI, DL, MachineOperand::CreateImm(hi), ReplaceOpc,
+                    DstReg, SrcReg, MachineOperand::CreateImm(lo));
   } else {
-    BuildMI(MBB, MI, DL, get(Ceespu::SETHI)).add(MO);
-    BuildMI(MBB, MI, DL, get(ReplaceOpc), DstReg).addReg(SrcReg).add(MO);
-    MBB.erase(MI);
-    return true;
+    MachineOperand Hi = MO, Lo = MO;
+    Hi.setTargetFlags(CeespuII::MO_HI);
+    Lo.setTargetFlags(CeespuII::MO_LO);
+    buildSETIPair(MBB, MI, DL, Hi, ReplaceOpc, DstReg, SrcReg, Lo);
   }
+  MBB.erase(MI);
+  return true;
 }
 
 unsigned CeespuInstrInfo::getInstSizeInBytes(const MachineInstr &MI) const {
@@ -439,6 +623,14 @@ unsigned CeespuInstrInfo::getInstSizeInBytes(const MachineInstr &MI) const {
 
   switch (Opcode) {
     default: { return get(Opcode).getSize(); }
+    case TargetOpcode::BUNDLE: {
+      unsigned Size = 0;
+      MachineBasicBlock::const_instr_iterator I = MI.getIterator();
+      MachineBasicBlock::const_instr_iterator E = MI.getParent()->instr_end();
+      while (++I != E && I->isInsideBundle())
+        Size += getInstSizeInBytes(*I);
+      return Size;
+    }
     case TargetOpcode::EH_LABEL:
     case TargetOpcode::IMPLICIT_DEF:
     case TargetOpcode::KILL:
@@ -452,3 +644,413 @@ unsigned CeespuInstrInfo::getInstSizeInBytes(const MachineInstr &MI) const {
     }
   }
 }
+
+// Returns true for the loads and stores that take a register base and an
+// immediate offset, as operands 1 and 2.
+static bool isRegImmMemOp(const MachineInstr &MI) {
+  switch (MI.getOpcode()) {
+    default:
+      return false;
+    case Ceespu::LW:
+    case Ceespu::LH:
+    case Ceespu::LHU:
+    case Ceespu::LB:
+    case Ceespu::LBU:
+    case Ceespu::SW:
+    case Ceespu::SH:
+    case Ceespu::SB:
+      return MI.getOperand(1).isReg() && MI.getOperand(2).isImm();
+  }
+}
+
+bool CeespuInstrInfo::getMemOpBaseRegImmOfs(
+    MachineInstr &MemOp, unsigned &BaseReg, int64_t &Offset,
+    const TargetRegisterInfo *TRI) const {
+  if (!isRegImmMemOp(MemOp))
+    return false;
+  BaseReg = MemOp.getOperand(1).getReg();
+  Offset = MemOp.getOperand(2).getImm();
+  return true;
+}
+
+// Two accesses off the same base register are disjoint if their offset
+// ranges do not overlap.
+bool CeespuInstrInfo::areMemAccessesTriviallyDisjoint(
+    MachineInstr &MIa, MachineInstr &MIb, AliasAnalysis *AA) const {
+  if (MIa.hasUnmodeledSideEffects() || MIb.hasUnmodeledSideEffects() ||
+      MIa.hasOrderedMemoryRef() || MIb.hasOrderedMemoryRef())
+    return false;
+  if (!MIa.hasOneMemOperand() || !MIb.hasOneMemOperand())
+    return false;
+
+  const TargetRegisterInfo *TRI =
+      MIa.getMF()->getSubtarget().getRegisterInfo();
+  unsigned BaseA, BaseB;
+  int64_t OffsetA, OffsetB;
+  if (!getMemOpBaseRegImmOfs(MIa, BaseA, OffsetA, TRI) ||
+      !getMemOpBaseRegImmOfs(MIb, BaseB, OffsetB, TRI) || BaseA != BaseB)
+    return false;
+
+  uint64_t WidthA = (*MIa.memoperands_begin())->getSize();
+  uint64_t WidthB = (*MIb.memoperands_begin())->getSize();
+  if (OffsetA <= OffsetB)
+    return OffsetA + (int64_t)WidthA <= OffsetB;
+  return OffsetB + (int64_t)WidthB <= OffsetA;
+}
+
+bool CeespuInstrInfo::getBaseAndOffsetPosition(const MachineInstr &MI,
+                                               unsigned &BasePos,
+                                               unsigned &OffsetPos) const {
+  if (!isRegImmMemOp(MI))
+    return false;
+  BasePos = 1;
+  OffsetPos = 2;
+  return true;
+}
+
+bool CeespuInstrInfo::getIncrementValue(const MachineInstr &MI,
+                                        int &Value) const {
+  if (MI.getOpcode() != Ceespu::ADDI || !MI.getOperand(2).isImm())
+    return false;
+  Value = MI.getOperand(2).getImm();
+  return true;
+}
+
+// Returns true if MI adds a constant to a value that a phi in Header carries
+// from the previous iteration, and that phi takes MI as its next value.
+static bool isInductionUpdate(const MachineInstr &MI,
+                              const MachineBasicBlock &Header,
+                              const MachineRegisterInfo &MRI) {
+  if (MI.getOpcode() != Ceespu::ADDI || !MI.getOperand(2).isImm() ||
+      !TargetRegisterInfo::isVirtualRegister(MI.getOperand(1).getReg()))
+    return false;
+  const MachineInstr *Phi = MRI.getVRegDef(MI.getOperand(1).getReg());
+  if (!Phi || !Phi->isPHI() || Phi->getParent() != &Header)
+    return false;
+  for (unsigned i = 1, e = Phi->getNumOperands(); i != e; i += 2)
+    if (Phi->getOperand(i + 1).getMBB() == &Header)
+      return Phi->getOperand(i).getReg() == MI.getOperand(0).getReg();
+  return false;
+}
+
+// Returns true if Reg is a copy of c0.
+static bool isZeroCopy(unsigned Reg, const MachineRegisterInfo &MRI) {
+  const MachineInstr *Def = MRI.getVRegDef(Reg);
+  return Def && Def->isCopy() && Def->getOperand(1).getReg() == Ceespu::R0;
+}
+
+// The software pipeliner handles single block loops that branch back to
+// their header on a compare of the induction variable with a loop invariant
+// bound, such as "addi %iv.next, %iv, 1; bne %iv.next, %n, %loop". A loop
+// that counts down to zero compares with a copy of c0 made in the loop.
+bool CeespuInstrInfo::analyzeLoop(MachineLoop &L, MachineInstr *&IndVarInst,
+                                  MachineInstr *&CmpInst) const {
+  MachineBasicBlock *Header = L.getHeader();
+  MachineBasicBlock::iterator Br = Header->getFirstTerminator();
+  if (Br == Header->end() || !Br->getDesc().isConditionalBranch() ||
+      Br->getOpcode() == Ceespu::BC || Br->getOperand(2).getMBB() != Header)
+    return true;
+
+  const MachineRegisterInfo &MRI = Header->getParent()->getRegInfo();
+  MachineInstr *IndVar = nullptr;
+  for (unsigned OpIdx = 0; OpIdx != 2; ++OpIdx) {
+    unsigned Reg = Br->getOperand(OpIdx).getReg();
+    if (!TargetRegisterInfo::isVirtualRegister(Reg)) {
+      if (Reg != Ceespu::R0)
+        return true;
+      continue;
+    }
+    MachineInstr *Def = MRI.getVRegDef(Reg);
+    if (!Def || !L.contains(Def) || isZeroCopy(Reg, MRI))
+      continue;
+    if (IndVar || !isInductionUpdate(*Def, *Header, MRI))
+      return true;
+    IndVar = Def;
+  }
+  if (!IndVar)
+    return true;
+
+  IndVarInst = IndVar;
+  CmpInst = &*Br;
+  return false;
+}
+
+// Each prolog block of a pipelined loop leaves for its epilog if the
+// iteration it started was the last one. That is the loop branch reversed.
+// The pipeliner renames the registers of the inserted branch to the values
+// of that iteration, so nothing has to be computed here.
+unsigned CeespuInstrInfo::reduceLoopCount(
+    MachineBasicBlock &MBB, MachineInstr *IndVar, MachineInstr &Cmp,
+    SmallVectorImpl<MachineOperand> &Cond,
+    SmallVectorImpl<MachineInstr *> &PrevInsts, unsigned Iter,
+    unsigned MaxIter) const {
+  const MachineRegisterInfo &MRI = MBB.getParent()->getRegInfo();
+  MachineBasicBlock *Target;
+  parseCondBranch(Cmp, Target, Cond);
+  // The operands are copied from Cmp and still point at it, so they are
+  // replaced rather than modified in place. A copy of c0 may not have been
+  // made yet in this block, so c0 is used directly.
+  for (unsigned i = 1; i < Cond.size(); ++i) {
+    unsigned Reg = Cond[i].getReg();
+    if (TargetRegisterInfo::isVirtualRegister(Reg) && isZeroCopy(Reg, MRI))
+      Reg = Ceespu::R0;
+    Cond[i] = MachineOperand::CreateReg(Reg, false);
+  }
+  bool CannotReverse = reverseBranchCondition(Cond);
+  (void)CannotReverse;
+  assert(!CannotReverse && "analyzeLoop accepted an irreversible branch");
+  // The trip count is only known at run time.
+  return IndVar->getOperand(0).getReg();
+}
+
+// Outlined functions are called in one of the ways below. None of them saves
+// clr on the stack, so outlined code sees the same stack as the code it was
+// taken from, and instructions that use csp or cfp can be outlined as they
+// are.
+//
+// MachineOutlinerTailCall: the sequence ends in a return or a tail call. It
+// is replaced by a b to the outlined function, which returns to the caller of
+// the function the sequence came from.
+//
+// MachineOutlinerThunk: the sequence ends in a call. It is replaced by a jal
+// to the outlined function, which tail calls the original callee.
+//
+// MachineOutlinerNoLRSave: clr is dead after the sequence, so it is replaced
+// by a jal to the outlined function, which returns with bx clr.
+//
+// MachineOutlinerRegSave: as MachineOutlinerNoLRSave, but clr is live and is
+// copied to a free caller-saved register around the jal. The register is the
+// same for every occurrence and is passed in CallConstructionID.
+enum MachineOutlinerClass {
+  MachineOutlinerTailCall,
+  MachineOutlinerThunk,
+  MachineOutlinerNoLRSave,
+  MachineOutlinerRegSave
+};
+
+// Returns true if clr is known to be dead after I. clr is reserved, so it is
+// not tracked in block live-ins, and it is only known to be dead where a
+// later call in the same block writes it before it is read.
+static bool isLRDeadAfter(MachineBasicBlock::iterator I,
+                          const TargetRegisterInfo &TRI) {
+  MachineBasicBlock &MBB = *I->getParent();
+  for (++I; I != MBB.end(); ++I) {
+    if (I->readsRegister(Ceespu::LR, &TRI))
+      return false;
+    if (I->definesRegister(Ceespu::LR, &TRI))
+      return true;
+  }
+  return false;
+}
+
+// Collects the registers that are live across the candidate C or used in it.
+// Any other caller-saved register can hold clr while C is outlined.
+static void getRegsUsedAround(outliner::Candidate &C, LiveRegUnits &Regs) {
+  MachineBasicBlock &MBB = *C.getMBB();
+  Regs.addLiveOuts(MBB);
+  for (MachineBasicBlock::iterator I = MBB.end(); I != C.front();)
+    Regs.stepBackward(*--I);
+  for (MachineBasicBlock::iterator I = C.front(), E = std::next(C.back());
+       I != E; ++I)
+    Regs.accumulate(*I);
+}
+
+outliner::TargetCostInfo CeespuInstrInfo::getOutlininingCandidateInfo(
+    std::vector<outliner::Candidate> &RepeatedSequenceLocs) const {
+  outliner::Candidate &First = RepeatedSequenceLocs[0];
+  unsigned SequenceSize = 0;
+  for (MachineBasicBlock::iterator I = First.front(),
+                                   E = std::next(First.back());
+       I != E; ++I)
+    SequenceSize += getInstSizeInBytes(*I);
+
+  MachineInstr &Last = *First.back();
+  if (Last.isTerminator())
+    return outliner::TargetCostInfo(SequenceSize, 4, 0, MachineOutlinerTailCall,
+                                    MachineOutlinerTailCall);
+  if (Last.isCall())
+    return outliner::TargetCostInfo(SequenceSize, 4, 0, MachineOutlinerThunk,
+                                    MachineOutlinerThunk);
+
+  const TargetRegisterInfo &TRI =
+      *First.getMF()->getSubtarget().getRegisterInfo();
+  std::vector<LiveRegUnits> UsedRegs;
+  // With IPRA, callers only expect the registers the function was seen to
+  // modify to be clobbered, so clr can not be kept in any other one.
+  bool IPRA = First.getMF()->getTarget().Options.EnableIPRA;
+  for (outliner::Candidate &C : RepeatedSequenceLocs) {
+    UsedRegs.emplace_back(TRI);
+    if (isLRDeadAfter(C.back(), TRI))
+      continue;
+    getRegsUsedAround(C, UsedRegs.back());
+    if (!IPRA)
+      continue;
+    const MachineRegisterInfo &MRI = C.getMF()->getRegInfo();
+    for (MCPhysReg Reg : Ceespu::GPRTCRegClass)
+      if (!MRI.isPhysRegModified(Reg) && !MRI.getUsedPhysRegsMask().test(Reg))
+        UsedRegs.back().addReg(Reg);
+  }
+  if (std::all_of(UsedRegs.begin(), UsedRegs.end(),
+                  [](const LiveRegUnits &Regs) { return Regs.empty(); }))
+    return outliner::TargetCostInfo(SequenceSize, 4, 4,
+                                    MachineOutlinerNoLRSave,
+                                    MachineOutlinerNoLRSave);
+
+  // Pick the register that is free at the most occurrences. Occurrences where
+  // it is not free are left alone, as long as at least two remain.
+  unsigned SaveReg = 0, MaxFree = 0;
+  for (MCPhysReg Reg : Ceespu::GPRTCRegClass) {
+    unsigned NumFree = count_if(UsedRegs, [Reg](const LiveRegUnits &Regs) {
+      return Regs.available(Reg);
+    });
+    if (NumFree > MaxFree) {
+      SaveReg = Reg;
+      MaxFree = NumFree;
+    }
+  }
+  // Outlining would not pay off if the call costs as much as the sequence.
+  if (MaxFree < 2)
+    return outliner::TargetCostInfo(SequenceSize, SequenceSize, 4,
+                                    MachineOutlinerRegSave,
+                                    MachineOutlinerRegSave);
+
+  std::vector<outliner::Candidate> Kept;
+  for (unsigned I = 0, E = RepeatedSequenceLocs.size(); I != E; ++I)
+    if (UsedRegs[I].available(SaveReg))
+      Kept.push_back(RepeatedSequenceLocs[I]);
+  RepeatedSequenceLocs = std::move(Kept);
+  return outliner::TargetCostInfo(SequenceSize, 12, 4, SaveReg,
+                                  MachineOutlinerRegSave);
+}
+
+bool CeespuInstrInfo::isFunctionSafeToOutlineFrom(
+    MachineFunction &MF, bool OutlineFromLinkOnceODRs) const {
+  const Function &F = MF.getFunction();
+
+  // Outlining trades a call for code size, so only do it at -Oz.
+  if (!F.optForMinSize())
+    return false;
+
+  // Can F be deduplicated by the linker? If it can, don't outline from it.
+  if (!OutlineFromLinkOnceODRs && F.hasLinkOnceODRLinkage())
+    return false;
+
+  // The program could expect all of the code to be in the named section.
+  if (F.hasSection())
+    return false;
+
+  // Choosing how to call an outlined function needs liveness.
+  return MF.getProperties().hasProperty(
+      MachineFunctionProperties::Property::TracksLiveness);
+}
+
+// Returns true if MI can be moved into an outlined function as it is.
+static bool isSafeToOutline(const MachineInstr &MI) {
+  for (const MachineOperand &MO : MI.operands())
+    if (MO.isCPI() || MO.isJTI() || MO.isCFIIndex() || MO.isFI() ||
+        MO.isTargetIndex() || MO.isMBB())
+      return false;
+  return !MI.isPosition() && !MI.isInlineAsm();
+}
+
+outliner::InstrType
+CeespuInstrInfo::getOutliningType(MachineBasicBlock::iterator &MIT,
+                                  unsigned Flags) const {
+  MachineInstr &MI = *MIT;
+  const TargetRegisterInfo &TRI =
+      *MI.getParent()->getParent()->getSubtarget().getRegisterInfo();
+
+  if (MI.isDebugInstr() || MI.isKill())
+    return outliner::InstrType::Invisible;
+
+  // A SETI prefix is only outlined in the bundle with the instruction it
+  // extends.
+  if (MI.getOpcode() == Ceespu::SETHI)
+    return outliner::InstrType::Illegal;
+  // The width of the jump table entries is chosen for the function that
+  // holds the load.
+  if (MI.getOpcode() == Ceespu::PseudoLJT)
+    return outliner::InstrType::Illegal;
+  if (MI.isBundle()) {
+    MachineBasicBlock::const_instr_iterator I = MI.getIterator();
+    MachineBasicBlock::const_instr_iterator E = MI.getParent()->instr_end();
+    while (++I != E && I->isInsideBundle())
+      if (!isSafeToOutline(*I))
+        return outliner::InstrType::Illegal;
+  }
+  if (!isSafeToOutline(MI))
+    return outliner::InstrType::Illegal;
+
+  // Returns and tail calls end the outlined function as well.
+  if (MI.isTerminator())
+    return MI.getParent()->succ_empty() ? outliner::InstrType::Legal
+                                        : outliner::InstrType::Illegal;
+
+  // A direct call can end an outlined function, which then tail calls the
+  // callee. Nothing can follow it, as the outlined function does not save
+  // clr.
+  if (MI.isCall())
+    return MI.getOpcode() == Ceespu::JAL &&
+                   (MI.getOperand(0).isGlobal() || MI.getOperand(0).isSymbol())
+               ? outliner::InstrType::LegalTerminator
+               : outliner::InstrType::Illegal;
+
+  // The call to the outlined function changes clr.
+  if (MI.readsRegister(Ceespu::LR, &TRI) ||
+      MI.modifiesRegister(Ceespu::LR, &TRI))
+    return outliner::InstrType::Illegal;
+
+  return outliner::InstrType::Legal;
+}
+
+void CeespuInstrInfo::insertOutlinerEpilogue(
+    MachineBasicBlock &MBB, MachineFunction &MF,
+    const outliner::TargetCostInfo &TCI) const {
+  if (TCI.FrameConstructionID == MachineOutlinerTailCall)
+    return;
+
+  if (TCI.FrameConstructionID == MachineOutlinerThunk) {
+    MachineInstr &Call = MBB.back();
+    BuildMI(MBB, MBB.end(), DebugLoc(), get(Ceespu::PseudoTAIL))
+        .add(Call.getOperand(0));
+    Call.eraseFromParent();
+    return;
+  }
+
+  BuildMI(MBB, MBB.end(), DebugLoc(), get(Ceespu::RET));
+}
+
+void CeespuInstrInfo::insertOutlinerPrologue(
+    MachineBasicBlock &MBB, MachineFunction &MF,
+    const outliner::TargetCostInfo &TCI) const {}
+
+MachineBasicBlock::iterator CeespuInstrInfo::insertOutlinedCall(
+    Module &M, MachineBasicBlock &MBB, MachineBasicBlock::iterator &It,
+    MachineFunction &MF, const outliner::TargetCostInfo &TCI) const {
+  const GlobalValue *Callee = M.getNamedValue(MF.getName());
+
+  if (TCI.FrameConstructionID == MachineOutlinerTailCall) {
+    It = MBB.insert(It, BuildMI(MF, DebugLoc(), get(Ceespu::PseudoTAIL))
+                            .addGlobalAddress(Callee));
+    return It;
+  }
+
+  if (TCI.FrameConstructionID != MachineOutlinerRegSave) {
+    It = MBB.insert(It, BuildMI(MF, DebugLoc(), get(Ceespu::JAL))
+                            .addGlobalAddress(Callee));
+    return It;
+  }
+
+  // or leaves the carry alone, which the outlined code may use or produce.
+  unsigned SaveReg = TCI.CallConstructionID;
+  BuildMI(MBB, It, DebugLoc(), get(Ceespu::OR), SaveReg)
+      .addReg(Ceespu::R0)
+      .addReg(Ceespu::LR);
+  MachineBasicBlock::iterator CallPt =
+      BuildMI(MBB, It, DebugLoc(), get(Ceespu::JAL)).addGlobalAddress(Callee);
+  // The outliner erases the sequence after It.
+  It = BuildMI(MBB, It, DebugLoc(), get(Ceespu::OR), Ceespu::LR)
+           .addReg(Ceespu::R0)
+           .addReg(SaveReg, RegState::Kill);
+  return CallPt;
+}
@@ -24,8 +24,11 @@
 namespace llvm {
 
 class CeespuInstrInfo : public CeespuGenInstrInfo {
+  // Code is linked below 64K, where the absolute target of b reaches it.
+  bool CodeInLow64K;
+
  public:
-  CeespuInstrInfo();
+  explicit CeespuInstrInfo(bool CodeInLow64K);
 
   unsigned isLoadFromStackSlot(const MachineInstr &MI,
                                int &FrameIndex) const override;
@@ -52,6 +55,23 @@ class CeespuInstrInfo : public CeespuGenInstrInfo {
                 const DebugLoc &DL, unsigned DstReg, uint64_t Val,
                 MachineInstr::MIFlag Flag = MachineInstr::NoFlags) const;
 
+  // Returns the number of instructions needed to materialize the int32 Val.
+  unsigned getMaterializationCost(int64_t Val) const;
+
+  // Builds "seti Hi; Opc DstReg, SrcReg, Lo" as a single bundle and returns
+  // the extended instruction.
+  MachineInstr *buildSETIPair(MachineBasicBlock &MBB,
+                              MachineBasicBlock::iterator MBBI,
+                              const DebugLoc &DL, const MachineOperand &Hi,
+                              unsigned Opc, unsigned DstReg, unsigned SrcReg,
+                              const MachineOperand &Lo,
+                              MachineInstr::MIFlag Flag =
+                                  MachineInstr::NoFlags) const;
+
+  // Returns the load or store that the SETI extended memory pseudo Opc
+  // expands to, or 0 if Opc is not one.
+  static unsigned getExtendedMemOpBase(unsigned Opc);
+
   unsigned getInstSizeInBytes(const MachineInstr &MI) const override;
 
   bool analyzeBranch(MachineBasicBlock &MBB, MachineBasicBlock *&TBB,
@@ -67,19 +87,71 @@ class CeespuInstrInfo : public CeespuGenInstrInfo {
   unsigned insertIndirectBranch(MachineBasicBlock &MBB,
                                 MachineBasicBlock &NewDestBB,
                                 const DebugLoc &DL, int64_t BrOffset,
-                                RegScavenger *RS = nullptr) const override{};
+                                RegScavenger *RS = nullptr) const override;
 
   unsigned removeBranch(MachineBasicBlock &MBB,
                         int *BytesRemoved = nullptr) const override;
 
-  // bool reverseBranchCondition(
-  //    SmallVectorImpl<MachineOperand> &Cond) const override;
+  bool reverseBranchCondition(
+      SmallVectorImpl<MachineOperand> &Cond) const override;
 
   MachineBasicBlock *getBranchDestBlock(const MachineInstr &MI) const override;
 
   bool isBranchOffsetInRange(unsigned BranchOpc,
                              int64_t BrOffset) const override;
   bool expandPostRAPseudo(MachineInstr &MI) const override;
+
+  bool getMemOpBaseRegImmOfs(MachineInstr &MemOp, unsigned &BaseReg,
+                             int64_t &Offset,
+                             const TargetRegisterInfo *TRI) const override;
+
+  bool
+  areMemAccessesTriviallyDisjoint(MachineInstr &MIa, MachineInstr &MIb,
+                                  AliasAnalysis *AA = nullptr) const override;
+
+  // Hooks used by the software pipeliner.
+  bool getBaseAndOffsetPosition(const MachineInstr &MI, unsigned &BasePos,
+                                unsigned &OffsetPos) const override;
+
+  bool getIncrementValue(const MachineInstr &MI, int &Value) const override;
+
+  bool analyzeLoop(MachineLoop &L, MachineInstr *&IndVarInst,
+                   MachineInstr *&CmpInst) const override;
+
+  unsigned reduceLoopCount(MachineBasicBlock &MBB, MachineInstr *IndVar,
+                           MachineInstr &Cmp,
+                           SmallVectorImpl<MachineOperand> &Cond,
+                           SmallVectorImpl<MachineInstr *> &PrevInsts,
+                           unsigned Iter, unsigned MaxIter) const override;
+
+  bool useMachineOutliner() const override { return true; }
+
+  outliner::TargetCostInfo getOutlininingCandidateInfo(
+      std::vector<outliner::Candidate> &RepeatedSequenceLocs) const override;
+
+  bool isFunctionSafeToOutlineFrom(MachineFunction &MF,
+                                   bool OutlineFromLinkOnceODRs) const override;
+
+  outliner::InstrType getOutliningType(MachineBasicBlock::iterator &MIT,
+                                       unsigned Flags) const override;
+
+  void
+  insertOutlinerEpilogue(MachineBasicBlock &MBB, MachineFunction &MF,
+                         const outliner::TargetCostInfo &TCI) const override;
+
+  void
+  insertOutlinerPrologue(MachineBasicBlock &MBB, MachineFunction &MF,
+                         const outliner::TargetCostInfo &TCI) const override;
+
+  MachineBasicBlock::iterator
+  insertOutlinedCall(Module &M, MachineBasicBlock &MBB,
+                     MachineBasicBlock::iterator &It, MachineFunction &MF,
+                     const outliner::TargetCostInfo &TCI) const override;
+
+ private:
+  void expandLIX(MachineInstr &MI) const;
+  void expandMASKULT(MachineInstr &MI) const;
+  void expandExtendedMemOp(MachineInstr &MI, unsigned Opc) const;
 };
 }  // namespace llvm
 #endif
@@ -0,0 +1,337 @@
+//===- CeespuInstructionSelector.cpp - Instruction selection ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the InstructionSelector class for
+/// Ceespu. Most instructions are selected by the patterns imported from
+/// CeespuInstrInfo.td; the rest, whose patterns rely on SelectionDAG specific
+/// nodes or complex patterns, are selected by hand.
+//===----------------------------------------------------------------------===//
+
+#include "CeespuRegisterBankInfo.h"
+#include "CeespuSubtarget.h"
+#include "CeespuTargetMachine.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelector.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelectorImpl.h"
+#include "llvm/CodeGen/GlobalISel/Utils.h"
+#include "llvm/CodeGen/MachineInstrBuilder.h"
+#include "llvm/Support/Debug.h"
+
+#define DEBUG_TYPE "ceespu-isel"
+
+using namespace llvm;
+
+namespace {
+
+#define GET_GLOBALISEL_PREDICATE_BITSET
+#include "CeespuGenGlobalISel.inc"
+#undef GET_GLOBALISEL_PREDICATE_BITSET
+
+class CeespuInstructionSelector : public InstructionSelector {
+public:
+  CeespuInstructionSelector(const CeespuTargetMachine &TM,
+                            const CeespuSubtarget &STI,
+                            const CeespuRegisterBankInfo &RBI);
+
+  bool select(MachineInstr &I, CodeGenCoverage &CoverageInfo) const override;
+  static const char *getName() { return DEBUG_TYPE; }
+
+private:
+  bool selectImpl(MachineInstr &I, CodeGenCoverage &CoverageInfo) const;
+
+  bool selectCopy(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectExt(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectLoadStore(MachineInstr &I, MachineRegisterInfo &MRI) const;
+  bool selectBrCond(MachineInstr &I, MachineRegisterInfo &MRI) const;
+
+  const CeespuTargetMachine &TM;
+  const CeespuSubtarget &STI;
+  const CeespuInstrInfo &TII;
+  const CeespuRegisterInfo &TRI;
+  const CeespuRegisterBankInfo &RBI;
+
+#define GET_GLOBALISEL_PREDICATES_DECL
+#include "CeespuGenGlobalISel.inc"
+#undef GET_GLOBALISEL_PREDICATES_DECL
+
+#define GET_GLOBALISEL_TEMPORARIES_DECL
+#include "CeespuGenGlobalISel.inc"
+#undef GET_GLOBALISEL_TEMPORARIES_DECL
+};
+
+} // end anonymous namespace
+
+#define GET_GLOBALISEL_IMPL
+#include "CeespuGenGlobalISel.inc"
+#undef GET_GLOBALISEL_IMPL
+
+CeespuInstructionSelector::CeespuInstructionSelector(
+    const CeespuTargetMachine &TM, const CeespuSubtarget &STI,
+    const CeespuRegisterBankInfo &RBI)
+    : InstructionSelector(), TM(TM), STI(STI), TII(*STI.getInstrInfo()),
+      TRI(*STI.getRegisterInfo()), RBI(RBI),
+#define GET_GLOBALISEL_PREDICATES_INIT
+#include "CeespuGenGlobalISel.inc"
+#undef GET_GLOBALISEL_PREDICATES_INIT
+#define GET_GLOBALISEL_TEMPORARIES_INIT
+#include "CeespuGenGlobalISel.inc"
+#undef GET_GLOBALISEL_TEMPORARIES_INIT
+{
+}
+
+// Constrains the virtual registers of a copy-like instruction, that is one
+// with a def and a use that both end up in a GPR, and turns it into a COPY.
+bool CeespuInstructionSelector::selectCopy(MachineInstr &I,
+                                           MachineRegisterInfo &MRI) const {
+  I.setDesc(TII.get(TargetOpcode::COPY));
+  for (unsigned Idx : {0, 1}) {
+    unsigned Reg = I.getOperand(Idx).getReg();
+    if (TargetRegisterInfo::isPhysicalRegister(Reg))
+      continue;
+    if (!RBI.constrainGenericRegister(Reg, Ceespu::GPRRegClass, MRI)) {
+      LLVM_DEBUG(dbgs() << "Failed to constrain " << TII.getName(I.getOpcode())
+                        << " operand\n");
+      return false;
+    }
+  }
+  return true;
+}
+
+bool CeespuInstructionSelector::selectExt(MachineInstr &I,
+                                          MachineRegisterInfo &MRI) const {
+  MachineBasicBlock &MBB = *I.getParent();
+  const DebugLoc &DL = I.getDebugLoc();
+  unsigned DstReg = I.getOperand(0).getReg();
+  unsigned SrcReg = I.getOperand(1).getReg();
+  unsigned SrcSize = MRI.getType(SrcReg).getSizeInBits();
+  bool IsSigned = I.getOpcode() == TargetOpcode::G_SEXT;
+
+  MachineInstr *Ext;
+  if (IsSigned && (SrcSize == 8 || SrcSize == 16)) {
+    Ext = BuildMI(MBB, I, DL,
+                  TII.get(SrcSize == 8 ? Ceespu::SEXT8 : Ceespu::SEXT16),
+                  DstReg)
+              .addReg(SrcReg);
+  } else if (!IsSigned && SrcSize != 16) {
+    Ext = BuildMI(MBB, I, DL, TII.get(Ceespu::ANDI), DstReg)
+              .addReg(SrcReg)
+              .addImm(SrcSize == 1 ? 1 : 0xff);
+  } else {
+    // Shift the value to the top of the register and back.
+    unsigned ShiftAmt = 32 - SrcSize;
+    unsigned TmpReg = MRI.createVirtualRegister(&Ceespu::GPRRegClass);
+    MachineInstr *Shl = BuildMI(MBB, I, DL, TII.get(Ceespu::SHLI), TmpReg)
+                            .addReg(SrcReg)
+                            .addImm(ShiftAmt);
+    if (!constrainSelectedInstRegOperands(*Shl, TII, TRI, RBI))
+      return false;
+    Ext = BuildMI(MBB, I, DL, TII.get(IsSigned ? Ceespu::SARI : Ceespu::SHRI),
+                  DstReg)
+              .addReg(TmpReg)
+              .addImm(ShiftAmt);
+  }
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*Ext, TII, TRI, RBI);
+}
+
+bool CeespuInstructionSelector::selectLoadStore(
+    MachineInstr &I, MachineRegisterInfo &MRI) const {
+  bool IsLoad = I.getOpcode() == TargetOpcode::G_LOAD;
+  const MachineMemOperand &MMO = **I.memoperands_begin();
+  if (MMO.getOrdering() != AtomicOrdering::NotAtomic)
+    return false;
+
+  unsigned Opc;
+  switch (MRI.getType(I.getOperand(0).getReg()).getSizeInBits()) {
+  case 8:
+    Opc = IsLoad ? Ceespu::LBU : Ceespu::SB;
+    break;
+  case 16:
+    Opc = IsLoad ? Ceespu::LHU : Ceespu::SH;
+    break;
+  case 32:
+    Opc = IsLoad ? Ceespu::LW : Ceespu::SW;
+    break;
+  default:
+    return false;
+  }
+
+  // Address a stack slot directly, the frame index is replaced by the frame
+  // register and offset during prologue/epilogue insertion.
+  MachineOperand &Ptr = I.getOperand(1);
+  MachineInstr *PtrDef = MRI.getVRegDef(Ptr.getReg());
+  int FI = -1;
+  if (PtrDef && PtrDef->getOpcode() == TargetOpcode::G_FRAME_INDEX)
+    FI = PtrDef->getOperand(1).getIndex();
+
+  MachineInstrBuilder MIB =
+      BuildMI(*I.getParent(), I, I.getDebugLoc(), TII.get(Opc));
+  if (IsLoad)
+    MIB.addDef(I.getOperand(0).getReg());
+  else
+    MIB.addUse(I.getOperand(0).getReg());
+  if (FI >= 0)
+    MIB.addFrameIndex(FI);
+  else
+    MIB.addUse(Ptr.getReg());
+  MIB.addImm(0).setMemRefs(I.memoperands_begin(), I.memoperands_end());
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+}
+
+// Returns the branch that is taken when LHS Pred RHS holds, swapping the
+// operands for the conditions that only exist the other way around.
+static unsigned getBranchOpcode(CmpInst::Predicate Pred, bool &Swap) {
+  Swap = false;
+  switch (Pred) {
+  case CmpInst::ICMP_EQ:
+    return Ceespu::BEQ;
+  case CmpInst::ICMP_NE:
+    return Ceespu::BNE;
+  case CmpInst::ICMP_SLT:
+    Swap = true;
+    LLVM_FALLTHROUGH;
+  case CmpInst::ICMP_SGT:
+    return Ceespu::BGT;
+  case CmpInst::ICMP_SLE:
+    Swap = true;
+    LLVM_FALLTHROUGH;
+  case CmpInst::ICMP_SGE:
+    return Ceespu::BGE;
+  case CmpInst::ICMP_ULT:
+    Swap = true;
+    LLVM_FALLTHROUGH;
+  case CmpInst::ICMP_UGT:
+    return Ceespu::BGU;
+  case CmpInst::ICMP_ULE:
+    Swap = true;
+    LLVM_FALLTHROUGH;
+  case CmpInst::ICMP_UGE:
+    return Ceespu::BGEU;
+  default:
+    llvm_unreachable("Unexpected integer predicate");
+  }
+}
+
+// There are no flags or set-on-condition instructions, so a comparison is
+// folded into the branch that uses it. Instructions are selected bottom-up,
+// which leaves the comparison dead once the branch has been selected.
+bool CeespuInstructionSelector::selectBrCond(MachineInstr &I,
+                                             MachineRegisterInfo &MRI) const {
+  MachineBasicBlock &MBB = *I.getParent();
+  const DebugLoc &DL = I.getDebugLoc();
+  unsigned CondReg = I.getOperand(0).getReg();
+  MachineBasicBlock *Dest = I.getOperand(1).getMBB();
+
+  MachineInstr *CondDef = MRI.getVRegDef(CondReg);
+  MachineInstrBuilder MIB;
+  if (CondDef && CondDef->getOpcode() == TargetOpcode::G_ICMP &&
+      CondDef->getParent() == &MBB && MRI.hasOneUse(CondReg)) {
+    bool Swap;
+    unsigned Opc = getBranchOpcode(
+        (CmpInst::Predicate)CondDef->getOperand(1).getPredicate(), Swap);
+    unsigned LHS = CondDef->getOperand(2).getReg();
+    unsigned RHS = CondDef->getOperand(3).getReg();
+    if (Swap)
+      std::swap(LHS, RHS);
+    MIB = BuildMI(MBB, I, DL, TII.get(Opc)).addUse(LHS).addUse(RHS);
+  } else {
+    // Only the low bit of an s1 is defined.
+    unsigned BitReg = MRI.createVirtualRegister(&Ceespu::GPRRegClass);
+    MachineInstr *And = BuildMI(MBB, I, DL, TII.get(Ceespu::ANDI), BitReg)
+                            .addUse(CondReg)
+                            .addImm(1);
+    if (!constrainSelectedInstRegOperands(*And, TII, TRI, RBI))
+      return false;
+    MIB = BuildMI(MBB, I, DL, TII.get(Ceespu::BNE))
+              .addUse(BitReg)
+              .addUse(Ceespu::R0);
+  }
+  MIB.addMBB(Dest);
+
+  I.eraseFromParent();
+  return constrainSelectedInstRegOperands(*MIB, TII, TRI, RBI);
+}
+
+bool CeespuInstructionSelector::select(MachineInstr &I,
+                                       CodeGenCoverage &CoverageInfo) const {
+  MachineBasicBlock &MBB = *I.getParent();
+  MachineFunction &MF = *MBB.getParent();
+  MachineRegisterInfo &MRI = MF.getRegInfo();
+
+  if (!isPreISelGenericOpcode(I.getOpcode())) {
+    if (I.isCopy())
+      return selectCopy(I, MRI);
+
+    return true;
+  }
+
+  if (selectImpl(I, CoverageInfo))
+    return true;
+
+  using namespace TargetOpcode;
+
+  switch (I.getOpcode()) {
+  case G_TRUNC:
+  case G_ANYEXT:
+  case G_INTTOPTR:
+  case G_PTRTOINT:
+    return selectCopy(I, MRI);
+  case G_SEXT:
+  case G_ZEXT:
+    return selectExt(I, MRI);
+  case G_LOAD:
+  case G_STORE:
+    return selectLoadStore(I, MRI);
+  case G_BRCOND:
+    return selectBrCond(I, MRI);
+  case G_GEP:
+    I.setDesc(TII.get(Ceespu::ADD));
+    break;
+  case G_FRAME_INDEX:
+    I.setDesc(TII.get(Ceespu::ADDI));
+    MachineInstrBuilder(MF, I).addImm(0);
+    break;
+  case G_GLOBAL_VALUE:
+    I.setDesc(TII.get(Ceespu::LIX));
+    break;
+  case G_CONSTANT: {
+    // Null and other constant pointers, integers are handled by the imported
+    // patterns.
+    MachineOperand &Op = I.getOperand(1);
+    int64_t Imm = Op.getCImm()->getSExtValue();
+    Op.ChangeToImmediate(Imm);
+    I.setDesc(TII.get(Ceespu::LIX));
+    break;
+  }
+  case G_IMPLICIT_DEF:
+    I.setDesc(TII.get(TargetOpcode::IMPLICIT_DEF));
+    return RBI.constrainGenericRegister(I.getOperand(0).getReg(),
+                                        Ceespu::GPRRegClass, MRI);
+  case G_PHI:
+    I.setDesc(TII.get(TargetOpcode::PHI));
+    return RBI.constrainGenericRegister(I.getOperand(0).getReg(),
+                                        Ceespu::GPRRegClass, MRI);
+  default:
+    // We didn't select anything.
+    return false;
+  }
+
+  return constrainSelectedInstRegOperands(I, TII, TRI, RBI);
+}
+
+namespace llvm {
+InstructionSelector *
+createCeespuInstructionSelector(const CeespuTargetMachine &TM,
+                                CeespuSubtarget &Subtarget,
+                                CeespuRegisterBankInfo &RBI) {
+  return new CeespuInstructionSelector(TM, Subtarget, RBI);
+}
+} // end namespace llvm
@@ -0,0 +1,70 @@
+//===- CeespuLegalizerInfo.cpp - Legalization rules for Ceespu --*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the Machinelegalizer class for
+/// Ceespu. Operations the instruction selector does not handle are left
+/// unsupported, so that GlobalISel falls back to SelectionDAG for them.
+//===----------------------------------------------------------------------===//
+
+#include "CeespuLegalizerInfo.h"
+#include "CeespuSubtarget.h"
+
+using namespace llvm;
+
+CeespuLegalizerInfo::CeespuLegalizerInfo(const CeespuSubtarget &ST) {
+  using namespace TargetOpcode;
+
+  const LLT p0 = LLT::pointer(0, 32);
+
+  const LLT s1 = LLT::scalar(1);
+  const LLT s8 = LLT::scalar(8);
+  const LLT s16 = LLT::scalar(16);
+  const LLT s32 = LLT::scalar(32);
+
+  getActionDefinitionsBuilder(G_GLOBAL_VALUE).legalFor({p0});
+  getActionDefinitionsBuilder(G_FRAME_INDEX).legalFor({p0});
+
+  getActionDefinitionsBuilder({G_ADD, G_SUB, G_MUL, G_AND, G_OR, G_XOR})
+      .legalFor({s32})
+      .minScalar(0, s32);
+
+  getActionDefinitionsBuilder({G_SHL, G_LSHR, G_ASHR})
+      .legalFor({s32})
+      .clampScalar(0, s32, s32);
+
+  getActionDefinitionsBuilder({G_SEXT, G_ZEXT, G_ANYEXT})
+      .legalForCartesianProduct({s32}, {s1, s8, s16});
+  getActionDefinitionsBuilder(G_TRUNC).legalForCartesianProduct({s1, s8, s16},
+                                                                {s32});
+
+  getActionDefinitionsBuilder(G_INTTOPTR).legalFor({{p0, s32}});
+  getActionDefinitionsBuilder(G_PTRTOINT).legalFor({{s32, p0}});
+
+  getActionDefinitionsBuilder(G_GEP).legalFor({{p0, s32}});
+
+  getActionDefinitionsBuilder(G_CONSTANT)
+      .legalFor({s32, p0})
+      .clampScalar(0, s32, s32);
+
+  // There is no instruction to materialize a comparison, the selector only
+  // handles one that feeds a conditional branch.
+  getActionDefinitionsBuilder(G_ICMP)
+      .legalForCartesianProduct({s1}, {s32, p0})
+      .minScalar(1, s32);
+  getActionDefinitionsBuilder(G_BRCOND).legalFor({s1});
+
+  getActionDefinitionsBuilder({G_LOAD, G_STORE})
+      .legalForCartesianProduct({s8, s16, s32, p0}, {p0});
+
+  getActionDefinitionsBuilder(G_IMPLICIT_DEF).legalFor({s32, p0});
+  getActionDefinitionsBuilder(G_PHI).legalFor({s32, p0}).minScalar(0, s32);
+
+  computeTables();
+  verify(*ST.getInstrInfo());
+}
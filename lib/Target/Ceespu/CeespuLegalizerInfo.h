@@ -0,0 +1,28 @@
+//===- CeespuLegalizerInfo.h - Legalization rules for Ceespu ----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file declares the targeting of the Machinelegalizer class for Ceespu.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_Ceespu_CeespuMACHINELEGALIZER_H
+#define LLVM_LIB_TARGET_Ceespu_CeespuMACHINELEGALIZER_H
+
+#include "llvm/CodeGen/GlobalISel/LegalizerInfo.h"
+
+namespace llvm {
+
+class CeespuSubtarget;
+
+/// This class provides legalization strategies.
+class CeespuLegalizerInfo : public LegalizerInfo {
+public:
+  CeespuLegalizerInfo(const CeespuSubtarget &ST);
+};
+} // end namespace llvm
+#endif
@@ -54,6 +54,9 @@ static MCOperand lowerSymbolOperand(const MachineOperand &MO, MCSymbol *Sym,
     case CeespuII::MO_HI:
       Kind = CeespuMCExpr::VK_Ceespu_HI;
       break;
+    case CeespuII::MO_ABS:
+      Kind = CeespuMCExpr::VK_Ceespu_ABS;
+      break;
   }
 
   const MCExpr *ME =
@@ -41,9 +41,21 @@ class CeespuMachineFunctionInfo : public MachineFunctionInfo {
   // VarArgsFrameIndex - FrameIndex for start of varargs area.
   int VarArgsFrameIndex;
 
+  // CompactJumpTables - The jump tables of this function hold offsets from
+  // the start of the function instead of block addresses. They are 16 bits
+  // wide if the function turns out small enough.
+  bool CompactJumpTables;
+
+  // NumSaveRestoreRegs - The number of registers besides clr that the shared
+  // routines save and restore for this function, see
+  // CeespuFrameLowering::getSaveRestoreOrder. Zero if the function saves its
+  // callee-saved registers itself.
+  unsigned NumSaveRestoreRegs;
+
  public:
   explicit CeespuMachineFunctionInfo(MachineFunction &MF)
-      : MF(MF), SRetReturnReg(0), GlobalBaseReg(0), VarArgsFrameIndex(0) {}
+      : MF(MF), SRetReturnReg(0), GlobalBaseReg(0), VarArgsFrameIndex(0),
+        CompactJumpTables(false), NumSaveRestoreRegs(0) {}
 
   unsigned getSRetReturnReg() const { return SRetReturnReg; }
   void setSRetReturnReg(unsigned Reg) { SRetReturnReg = Reg; }
@@ -52,6 +64,12 @@ class CeespuMachineFunctionInfo : public MachineFunctionInfo {
 
   int getVarArgsFrameIndex() const { return VarArgsFrameIndex; }
   void setVarArgsFrameIndex(int Index) { VarArgsFrameIndex = Index; }
+
+  bool hasCompactJumpTables() const { return CompactJumpTables; }
+  void setCompactJumpTables(bool Compact) { CompactJumpTables = Compact; }
+
+  unsigned getNumSaveRestoreRegs() const { return NumSaveRestoreRegs; }
+  void setNumSaveRestoreRegs(unsigned Num) { NumSaveRestoreRegs = Num; }
 };
 
 }  // namespace llvm
@@ -0,0 +1,73 @@
+//===- CeespuRegisterBankInfo.cpp - Register banks for Ceespu ---*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file implements the targeting of the RegisterBankInfo class for
+/// Ceespu. All values, including pointers and narrow integers, live in the
+/// general purpose registers.
+//===----------------------------------------------------------------------===//
+
+#include "CeespuRegisterBankInfo.h"
+#include "MCTargetDesc/CeespuMCTargetDesc.h"
+#include "llvm/CodeGen/MachineRegisterInfo.h"
+
+#define GET_TARGET_REGBANK_IMPL
+
+#define DEBUG_TYPE "registerbankinfo"
+
+#include "CeespuGenRegisterBank.inc"
+
+namespace llvm {
+namespace Ceespu {
+RegisterBankInfo::PartialMapping PartMappings[]{
+    {0, 32, GPRRegBank}
+};
+
+RegisterBankInfo::ValueMapping GPRValueMapping{&PartMappings[0], 1};
+} // end namespace Ceespu
+} // end namespace llvm
+
+using namespace llvm;
+
+CeespuRegisterBankInfo::CeespuRegisterBankInfo(const TargetRegisterInfo &TRI)
+    : CeespuGenRegisterBankInfo() {}
+
+const RegisterBank &CeespuRegisterBankInfo::getRegBankFromRegClass(
+    const TargetRegisterClass &RC) const {
+  switch (RC.getID()) {
+  case Ceespu::GPRRegClassID:
+  case Ceespu::GPRTCRegClassID:
+    return getRegBank(Ceespu::GPRRegBankID);
+  default:
+    llvm_unreachable("Register class not supported");
+  }
+}
+
+const RegisterBankInfo::InstructionMapping &
+CeespuRegisterBankInfo::getInstrMapping(const MachineInstr &MI) const {
+  unsigned Opc = MI.getOpcode();
+
+  // Try the default logic for non-generic instructions that are either copies
+  // or already have some operands assigned to banks.
+  if (!isPreISelGenericOpcode(Opc) || Opc == TargetOpcode::G_PHI) {
+    const InstructionMapping &Mapping = getInstrMappingImpl(MI);
+    if (Mapping.isValid())
+      return Mapping;
+  }
+
+  // There is a single bank: map every register operand to it, and leave the
+  // others (immediates, blocks, predicates) unmapped.
+  unsigned NumOperands = MI.getNumOperands();
+  SmallVector<const ValueMapping *, 4> OpdsMapping(NumOperands);
+  for (unsigned Idx = 0; Idx < NumOperands; ++Idx)
+    if (MI.getOperand(Idx).isReg())
+      OpdsMapping[Idx] = &Ceespu::GPRValueMapping;
+
+  return getInstructionMapping(DefaultMappingID, /*Cost=*/1,
+                               getOperandsMapping(OpdsMapping), NumOperands);
+}
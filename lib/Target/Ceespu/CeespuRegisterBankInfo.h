@@ -0,0 +1,42 @@
+//===- CeespuRegisterBankInfo.h - Register banks for Ceespu -----*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+/// This file declares the targeting of the RegisterBankInfo class for Ceespu.
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_Ceespu_CeespuREGISTERBANKINFO_H
+#define LLVM_LIB_TARGET_Ceespu_CeespuREGISTERBANKINFO_H
+
+#include "llvm/CodeGen/GlobalISel/RegisterBankInfo.h"
+
+#define GET_REGBANK_DECLARATIONS
+#include "CeespuGenRegisterBank.inc"
+
+namespace llvm {
+
+class TargetRegisterInfo;
+
+class CeespuGenRegisterBankInfo : public RegisterBankInfo {
+#define GET_TARGET_REGBANK_CLASS
+#include "CeespuGenRegisterBank.inc"
+};
+
+/// This class provides the information for the target register banks.
+class CeespuRegisterBankInfo final : public CeespuGenRegisterBankInfo {
+public:
+  CeespuRegisterBankInfo(const TargetRegisterInfo &TRI);
+
+  const RegisterBank &
+  getRegBankFromRegClass(const TargetRegisterClass &RC) const override;
+
+  const InstructionMapping &
+  getInstrMapping(const MachineInstr &MI) const override;
+};
+} // end namespace llvm
+#endif
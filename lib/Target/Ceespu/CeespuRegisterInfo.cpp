@@ -29,7 +29,7 @@
 using namespace llvm;
 
 CeespuRegisterInfo::CeespuRegisterInfo(unsigned HwMode)
-    : CeespuGenRegisterInfo(Ceespu::R1, /*DwarfFlavour*/ 0, /*EHFlavor*/ 0,
+    : CeespuGenRegisterInfo(Ceespu::LR, /*DwarfFlavour*/ 0, /*EHFlavor*/ 0,
                             /*PC*/ 0, HwMode) {}
 
 const MCPhysReg *CeespuRegisterInfo::getCalleeSavedRegs(
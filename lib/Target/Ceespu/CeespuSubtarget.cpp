@@ -14,7 +14,11 @@
 
 #include "CeespuSubtarget.h"
 #include "Ceespu.h"
+#include "CeespuCallLowering.h"
 #include "CeespuFrameLowering.h"
+#include "CeespuLegalizerInfo.h"
+#include "CeespuRegisterBankInfo.h"
+#include "CeespuTargetMachine.h"
 #include "llvm/Support/TargetRegistry.h"
 
 using namespace llvm;
@@ -32,6 +36,9 @@ CeespuSubtarget &CeespuSubtarget::initializeSubtargetDependencies(
   // Determine default and user-specified characteristics
   std::string CPUName = CPU;
   if (CPUName.empty()) CPUName = Is64Bit ? "generic-ceespu" : "generic-ceespu";
+  // Ceespu has no subtarget features, so ParseSubtargetFeatures does not
+  // select the scheduling model of the default CPU.
+  InitMCProcessorInfo(CPUName, FS);
   ParseSubtargetFeatures(CPUName, FS);
   return *this;
 }
@@ -40,6 +47,30 @@ CeespuSubtarget::CeespuSubtarget(const Triple &TT, const std::string &CPU,
                                  const std::string &FS, const TargetMachine &TM)
     : CeespuGenSubtargetInfo(TT, CPU, FS),
       FrameLowering(initializeSubtargetDependencies(CPU, FS, TT.isArch64Bit())),
-      InstrInfo(),
+      InstrInfo(TM.getCodeModel() == CodeModel::Small),
       RegInfo(getHwMode()),
-      TLInfo(TM, *this) {}
+      TLInfo(TM, *this) {
+  CallLoweringInfo.reset(new CeespuCallLowering(*getTargetLowering()));
+  Legalizer.reset(new CeespuLegalizerInfo(*this));
+
+  auto *RBI = new CeespuRegisterBankInfo(*getRegisterInfo());
+  RegBankInfo.reset(RBI);
+  InstSelector.reset(createCeespuInstructionSelector(
+      *static_cast<const CeespuTargetMachine *>(&TM), *this, *RBI));
+}
+
+const CallLowering *CeespuSubtarget::getCallLowering() const {
+  return CallLoweringInfo.get();
+}
+
+const LegalizerInfo *CeespuSubtarget::getLegalizerInfo() const {
+  return Legalizer.get();
+}
+
+const RegisterBankInfo *CeespuSubtarget::getRegBankInfo() const {
+  return RegBankInfo.get();
+}
+
+const InstructionSelector *CeespuSubtarget::getInstructionSelector() const {
+  return InstSelector.get();
+}
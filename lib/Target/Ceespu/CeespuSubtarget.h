@@ -18,6 +18,10 @@
 #include "CeespuFrameLowering.h"
 #include "CeespuISelLowering.h"
 #include "CeespuInstrInfo.h"
+#include "llvm/CodeGen/GlobalISel/CallLowering.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelector.h"
+#include "llvm/CodeGen/GlobalISel/LegalizerInfo.h"
+#include "llvm/CodeGen/GlobalISel/RegisterBankInfo.h"
 #include "llvm/CodeGen/SelectionDAGTargetInfo.h"
 #include "llvm/CodeGen/TargetSubtargetInfo.h"
 #include "llvm/IR/DataLayout.h"
@@ -39,6 +43,10 @@ class CeespuSubtarget : public CeespuGenSubtargetInfo {
   bool HasRV64 = false;
   bool EnableLinkerRelax = false;
   unsigned XLen = 32;
+  // A jump table costs a load, an add and an indirect branch that is
+  // mispredicted whenever the target changes, so it only pays off over a
+  // compare and branch ladder once there are enough cases.
+  unsigned MinimumJumpTableEntries = 6;
   MVT XLenVT = MVT::i32;
   CeespuFrameLowering FrameLowering;
   CeespuInstrInfo InstrInfo;
@@ -46,6 +54,12 @@ class CeespuSubtarget : public CeespuGenSubtargetInfo {
   CeespuTargetLowering TLInfo;
   SelectionDAGTargetInfo TSInfo;
 
+  // GlobalISel related APIs.
+  std::unique_ptr<CallLowering> CallLoweringInfo;
+  std::unique_ptr<LegalizerInfo> Legalizer;
+  std::unique_ptr<RegisterBankInfo> RegBankInfo;
+  std::unique_ptr<InstructionSelector> InstSelector;
+
   /// Initializes using the passed in CPU and feature strings so that we can
   /// use initializer lists for subtarget initialization.
   CeespuSubtarget &initializeSubtargetDependencies(StringRef CPU, StringRef FS,
@@ -73,6 +87,14 @@ class CeespuSubtarget : public CeespuGenSubtargetInfo {
   const SelectionDAGTargetInfo *getSelectionDAGInfo() const override {
     return &TSInfo;
   }
+  const CallLowering *getCallLowering() const override;
+  const LegalizerInfo *getLegalizerInfo() const override;
+  const RegisterBankInfo *getRegBankInfo() const override;
+  const InstructionSelector *getInstructionSelector() const override;
+  // CeespuSchedModel describes load-use and multiply latency, so run both the
+  // pre-RA machine scheduler and the post-RA scheduler.
+  bool enableMachineScheduler() const override { return true; }
+  bool enablePostRAScheduler() const override { return true; }
   bool hasStdExtM() const { return HasStdExtM; }
   bool hasStdExtA() const { return HasStdExtA; }
   bool hasStdExtF() const { return HasStdExtF; }
@@ -82,6 +104,9 @@ class CeespuSubtarget : public CeespuGenSubtargetInfo {
   bool enableLinkerRelax() const { return EnableLinkerRelax; }
   MVT getXLenVT() const { return XLenVT; }
   unsigned getXLen() const { return XLen; }
+  unsigned getMinimumJumpTableEntries() const {
+    return MinimumJumpTableEntries;
+  }
 };
 }  // namespace llvm
 
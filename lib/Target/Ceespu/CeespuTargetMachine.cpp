@@ -15,19 +15,42 @@
 #include "CeespuTargetMachine.h"
 #include "Ceespu.h"
 #include "CeespuTargetObjectFile.h"
+#include "CeespuTargetTransformInfo.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/CodeGen/GlobalISel/IRTranslator.h"
+#include "llvm/CodeGen/GlobalISel/InstructionSelect.h"
+#include "llvm/CodeGen/GlobalISel/Legalizer.h"
+#include "llvm/CodeGen/GlobalISel/RegBankSelect.h"
 #include "llvm/CodeGen/Passes.h"
 #include "llvm/CodeGen/TargetLoweringObjectFileImpl.h"
 #include "llvm/CodeGen/TargetPassConfig.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Support/CommandLine.h"
 #include "llvm/Support/FormattedStream.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Target/TargetOptions.h"
 using namespace llvm;
 
+// GlobalISel selects the instructions of a function in one pass over the
+// machine IR instead of building and legalizing a DAG per block, which makes
+// unoptimized builds faster. Functions it can not handle fall back to
+// SelectionDAG.
+static cl::opt<int> EnableGlobalISelAtO(
+    "ceespu-enable-global-isel-at-O", cl::Hidden,
+    cl::desc("Enable GlobalISel at or below an opt level (-1 to disable)"),
+    cl::init(0));
+
+// Modulo scheduling overlaps the iterations of small loops, which hides the
+// latency of loads and multiplies the core does not.
+static cl::opt<bool> EnablePipeliner(
+    "ceespu-enable-pipeliner", cl::Hidden,
+    cl::desc("Software pipeline single block loops"), cl::init(false));
+
 extern "C" void LLVMInitializeCeespuTarget() {
   RegisterTargetMachine<CeespuTargetMachine> X(getTheCeespuTarget());
   RegisterTargetMachine<CeespuTargetMachine> Y(getTheCeespuebTarget());
+  auto PR = PassRegistry::getPassRegistry();
+  initializeGlobalISel(*PR);
 }
 
 static std::string computeDataLayout(const Triple &TT) {
@@ -60,6 +83,21 @@ CeespuTargetMachine::CeespuTargetMachine(const Target &T, const Triple &TT,
       TLOF(make_unique<CeespuELFTargetObjectFile>()),
       Subtarget(TT, CPU, FS, *this) {
   initAsmInfo();
+
+  // Enable GlobalISel at or below EnableGlobalISelAtO.
+  if (getOptLevel() <= EnableGlobalISelAtO)
+    setGlobalISel(true);
+
+  // Functions built for minimum size have repeated sequences of instructions
+  // moved into shared functions, see CeespuInstrInfo::getOutliningType. The
+  // outliner runs after branch relaxation. Outlining only shrinks functions,
+  // so every branch stays in range.
+  setMachineOutliner(true);
+}
+
+TargetTransformInfo
+CeespuTargetMachine::getTargetTransformInfo(const Function &F) {
+  return TargetTransformInfo(CeespuTTIImpl(this, F));
 }
 
 namespace {
@@ -73,6 +111,12 @@ class CeespuPassConfig : public TargetPassConfig {
   }
 
   bool addInstSelector() override;
+  bool addIRTranslator() override;
+  bool addLegalizeMachineIR() override;
+  bool addRegBankSelect() override;
+  bool addGlobalInstructionSelect() override;
+  bool addILPOpts() override;
+  void addPreRegAlloc() override;
   void addPreEmitPass() override;
 };
 }  // namespace
@@ -87,4 +131,38 @@ bool CeespuPassConfig::addInstSelector() {
   return false;
 }
 
-void CeespuPassConfig::addPreEmitPass() { addPass(&BranchRelaxationPassID); }
+bool CeespuPassConfig::addIRTranslator() {
+  addPass(new IRTranslator());
+  return false;
+}
+
+bool CeespuPassConfig::addLegalizeMachineIR() {
+  addPass(new Legalizer());
+  return false;
+}
+
+bool CeespuPassConfig::addRegBankSelect() {
+  addPass(new RegBankSelect());
+  return false;
+}
+
+bool CeespuPassConfig::addGlobalInstructionSelect() {
+  addPass(new InstructionSelect());
+  return false;
+}
+
+bool CeespuPassConfig::addILPOpts() {
+  addPass(createCeespuConstantHoistingPass());
+
+  return true;
+}
+
+void CeespuPassConfig::addPreRegAlloc() {
+  if (EnablePipeliner && getOptLevel() >= CodeGenOpt::Default)
+    addPass(&MachinePipelinerID);
+}
+
+void CeespuPassConfig::addPreEmitPass() {
+  addPass(createCeespuAlignBranchTargetsPass());
+  addPass(&BranchRelaxationPassID);
+}
@@ -37,9 +37,15 @@ public:
 
   TargetPassConfig *createPassConfig(PassManagerBase &PM) override;
 
+  TargetTransformInfo getTargetTransformInfo(const Function &F) override;
+
   TargetLoweringObjectFile *getObjFileLowering() const override {
     return TLOF.get();
   }
+
+  // Calls carry register masks and JAL only defines clr, so the masks can be
+  // narrowed to what the callee really clobbers.
+  bool useIPRA() const override { return true; }
 };
 }
 
@@ -9,11 +9,79 @@
 
 #include "CeespuTargetObjectFile.h"
 #include "CeespuTargetMachine.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCSectionELF.h"
+#include "llvm/Support/CommandLine.h"
 
 using namespace llvm;
 
+static cl::opt<unsigned> SSThreshold(
+    "ceespu-ssection-threshold", cl::Hidden,
+    cl::desc("Small data and bss section threshold size (default=0). The "
+             "small sections must be linked into the first 32 KiB"),
+    cl::init(0));
+
 void CeespuELFTargetObjectFile::Initialize(MCContext &Ctx,
                                           const TargetMachine &TM) {
   TargetLoweringObjectFileELF::Initialize(Ctx, TM);
   InitializeELF(TM.Options.UseInitArray);
+
+  SmallDataSection = getContext().getELFSection(
+      ".sdata", ELF::SHT_PROGBITS, ELF::SHF_WRITE | ELF::SHF_ALLOC);
+  SmallBSSSection = getContext().getELFSection(".sbss", ELF::SHT_NOBITS,
+                                               ELF::SHF_WRITE | ELF::SHF_ALLOC);
+  SmallReadOnlySection =
+      getContext().getELFSection(".srodata", ELF::SHT_PROGBITS, ELF::SHF_ALLOC);
+}
+
+// Small objects are the ones accessed often enough, relative to their size,
+// that a single instruction access pays for the scarce low memory. Zero-sized
+// objects are never small, as in gcc.
+bool CeespuELFTargetObjectFile::isGlobalInSmallSection(
+    const GlobalObject *GO, const TargetMachine &TM) const {
+  const auto *GVA = dyn_cast_or_null<GlobalVariable>(GO);
+  if (!GVA || GVA->isThreadLocal())
+    return false;
+
+  // An explicit section places the object wherever the user wants it, and a
+  // common symbol is allocated by the linker.
+  if (GVA->hasSection() || GVA->hasCommonLinkage())
+    return false;
+
+  // Objects defined elsewhere are assumed to follow the same threshold, unless
+  // they may be replaced at link time by a definition that does not.
+  if (GVA->isDeclaration() && GVA->hasExternalWeakLinkage())
+    return false;
+
+  Type *Ty = GVA->getValueType();
+  if (!Ty->isSized())
+    return false;
+  uint64_t Size = GVA->getParent()->getDataLayout().getTypeAllocSize(Ty);
+  return Size > 0 && Size <= SSThreshold;
+}
+
+MCSection *CeespuELFTargetObjectFile::SelectSectionForGlobal(
+    const GlobalObject *GO, SectionKind Kind, const TargetMachine &TM) const {
+  if (isGlobalInSmallSection(GO, TM)) {
+    if (Kind.isBSS())
+      return SmallBSSSection;
+    if (Kind.isData())
+      return SmallDataSection;
+    if (Kind.isReadOnly())
+      return SmallReadOnlySection;
+  }
+
+  // Otherwise, we work the same as ELF.
+  return TargetLoweringObjectFileELF::SelectSectionForGlobal(GO, Kind, TM);
+}
+
+// Jump tables are read with ordinary loads, so they belong in .rodata with the
+// other constants. Even the compact entries, which are relative to the
+// function, do not need to share its section.
+bool CeespuELFTargetObjectFile::shouldPutJumpTableInFunctionSection(
+    bool UsesLabelDifference, const Function &F) const {
+  return false;
 }
@@ -17,7 +17,23 @@ class CeespuTargetMachine;
 
 /// This implementation is used for Ceespu ELF targets.
 class CeespuELFTargetObjectFile : public TargetLoweringObjectFileELF {
+  MCSection *SmallDataSection;
+  MCSection *SmallBSSSection;
+  MCSection *SmallReadOnlySection;
+
+public:
   void Initialize(MCContext &Ctx, const TargetMachine &TM) override;
+
+  /// Return true if GO is placed in the small data sections, which are
+  /// linked into the first 32 KiB and addressed as an offset from c0.
+  bool isGlobalInSmallSection(const GlobalObject *GO,
+                              const TargetMachine &TM) const;
+
+  MCSection *SelectSectionForGlobal(const GlobalObject *GO, SectionKind Kind,
+                                    const TargetMachine &TM) const override;
+
+  bool shouldPutJumpTableInFunctionSection(bool UsesLabelDifference,
+                                           const Function &F) const override;
 };
 
 } // end namespace llvm
@@ -0,0 +1,216 @@
+//===-- CeespuTargetTransformInfo.cpp - Ceespu specific TTI ---------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "CeespuTargetTransformInfo.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/MathExtras.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "ceesputti"
+
+// Size in instructions up to which loops are partially or runtime unrolled.
+// Every iteration of a loop pays for a taken branch, which flushes the front
+// of the pipeline, and for the induction variable update.
+static cl::opt<unsigned> UnrollThreshold(
+    "ceespu-unroll-threshold", cl::Hidden, cl::init(48),
+    cl::desc("Loop size up to which partial and runtime unrolling is done"));
+
+// Materializing a constant takes one instruction if it fits in a signed
+// 16-bit immediate and a SETI prefix more otherwise.
+int CeespuTTIImpl::getIntImmCost(const APInt &Imm, Type *Ty) {
+  assert(Ty->isIntegerTy());
+
+  unsigned BitSize = Ty->getPrimitiveSizeInBits();
+  if (BitSize == 0)
+    return ~0U;
+
+  if (Imm == 0)
+    return TTI::TCC_Free;
+
+  // Wide constants are built one 32-bit part at a time.
+  APInt Val = Imm.sextOrTrunc(alignTo(BitSize, 32));
+  int Cost = 0;
+  for (unsigned ShiftVal = 0; ShiftVal < Val.getBitWidth(); ShiftVal += 32) {
+    int64_t Part = Val.ashr(ShiftVal).sextOrTrunc(32).getSExtValue();
+    if (Part == 0)
+      continue;
+    Cost += isInt<16>(Part) ? TTI::TCC_Basic : 2 * TTI::TCC_Basic;
+  }
+  return std::max(1, Cost);
+}
+
+int CeespuTTIImpl::getIntImmCost(unsigned Opcode, unsigned Idx,
+                                 const APInt &Imm, Type *Ty) {
+  assert(Ty->isIntegerTy());
+
+  unsigned BitSize = Ty->getPrimitiveSizeInBits();
+  if (BitSize == 0 || BitSize > 32)
+    return getIntImmCost(Imm, Ty);
+
+  int64_t Val = Imm.getSExtValue();
+  bool TakesImm = false;
+  switch (Opcode) {
+    default:
+      break;
+    case Instruction::GetElementPtr:
+      // Offsets are folded into the addressing mode, or computed with an add.
+      if (Idx == 0)
+        return 2 * TTI::TCC_Basic;
+      return TTI::TCC_Free;
+    case Instruction::Add:
+    case Instruction::Sub:
+    case Instruction::Mul:
+    case Instruction::And:
+    case Instruction::Or:
+    case Instruction::Xor:
+    case Instruction::Shl:
+    case Instruction::LShr:
+    case Instruction::AShr:
+      TakesImm = Idx == 1;
+      break;
+    case Instruction::ICmp:
+      // Branches only compare registers, but zero is c0.
+      if (Val == 0)
+        return TTI::TCC_Free;
+      break;
+    case Instruction::Store:
+      // The value stored needs a register, zero is c0.
+      if (Idx == 0 && Val == 0)
+        return TTI::TCC_Free;
+      break;
+    case Instruction::Trunc:
+    case Instruction::ZExt:
+    case Instruction::SExt:
+    case Instruction::IntToPtr:
+    case Instruction::PtrToInt:
+    case Instruction::BitCast:
+    case Instruction::PHI:
+    case Instruction::Call:
+    case Instruction::Select:
+    case Instruction::Ret:
+    case Instruction::Load:
+      break;
+  }
+
+  if (TakesImm) {
+    // The 16-bit immediate form is free, anything else is the same
+    // instruction with a SETI prefix.
+    if (isInt<16>(Val))
+      return TTI::TCC_Free;
+    return TTI::TCC_Basic;
+  }
+  return getIntImmCost(Imm, Ty);
+}
+
+int CeespuTTIImpl::getIntImmCost(Intrinsic::ID IID, unsigned Idx,
+                                 const APInt &Imm, Type *Ty) {
+  // The overflow intrinsics are an add or subtract followed by a read of the
+  // carry.
+  switch (IID) {
+    default:
+      break;
+    case Intrinsic::uadd_with_overflow:
+    case Intrinsic::usub_with_overflow:
+      if (Idx == 1 && Ty->getPrimitiveSizeInBits() <= 32 &&
+          isInt<16>(Imm.getSExtValue()))
+        return TTI::TCC_Free;
+      break;
+  }
+  return getIntImmCost(Imm, Ty);
+}
+
+// Rank solutions by the number of instructions in the loop first; the core
+// issues one instruction per cycle, so that is what a loop costs. Extra base
+// adds come next, since each one is an instruction LSR did not count.
+bool CeespuTTIImpl::isLSRCostLess(TargetTransformInfo::LSRCost &C1,
+                                  TargetTransformInfo::LSRCost &C2) {
+  return std::tie(C1.Insns, C1.NumBaseAdds, C1.NumRegs, C1.AddRecCost,
+                  C1.NumIVMuls, C1.ScaleCost, C1.ImmCost, C1.SetupCost) <
+         std::tie(C2.Insns, C2.NumBaseAdds, C2.NumRegs, C2.AddRecCost,
+                  C2.NumIVMuls, C2.ScaleCost, C2.ImmCost, C2.SetupCost);
+}
+
+void CeespuTTIImpl::getUnrollingPreferences(Loop *L, ScalarEvolution &SE,
+                                            TTI::UnrollingPreferences &UP) {
+  // Unrolling grows the code, which is not wanted when optimizing for size.
+  const Function *F = L->getHeader()->getParent();
+  if (F->optForSize())
+    return;
+
+  // Only unroll innermost loops without calls. A call clobbers most of the
+  // registers that unrolled iterations would use.
+  if (!L->empty())
+    return;
+  for (BasicBlock *BB : L->blocks()) {
+    for (Instruction &I : *BB) {
+      if (!isa<CallInst>(I) && !isa<InvokeInst>(I))
+        continue;
+      ImmutableCallSite CS(&I);
+      if (const Function *Callee = CS.getCalledFunction())
+        if (!isLoweredToCall(Callee))
+          continue;
+      return;
+    }
+  }
+
+  UP.Partial = UP.Runtime = UP.UpperBound = true;
+  UP.PartialThreshold = UnrollThreshold;
+  // Runtime unrolling needs a remainder loop, keep the unroll factor small
+  // so the remainder stays cheap.
+  UP.DefaultUnrollRuntimeCount = 4;
+  // The compare and branch at the end of each copied iteration disappear.
+  UP.BEInsns = 2;
+  UP.OptSizeThreshold = 0;
+  UP.PartialOptSizeThreshold = 0;
+}
+
+unsigned CeespuTTIImpl::getArithmeticInstrCost(
+    unsigned Opcode, Type *Ty, TTI::OperandValueKind Opd1Info,
+    TTI::OperandValueKind Opd2Info, TTI::OperandValueProperties Opd1PropInfo,
+    TTI::OperandValueProperties Opd2PropInfo, ArrayRef<const Value *> Args) {
+  int ISD = TLI->InstructionOpcodeToISD(Opcode);
+
+  switch (ISD) {
+    default:
+      break;
+    case ISD::SDIV:
+    case ISD::UDIV:
+    case ISD::SREM:
+    case ISD::UREM: {
+      // getOperandInfo only reports constants for vectors, look at the
+      // divisor itself for scalars.
+      if (Args.size() == 2)
+        if (const auto *C = dyn_cast<ConstantInt>(Args[1])) {
+          Opd2Info = TTI::OK_UniformConstantValue;
+          if (C->getValue().isPowerOf2())
+            Opd2PropInfo = TTI::OP_PowerOf2;
+        }
+      // An unsigned division by a power of two is a shift or a mask. Signed
+      // ones round towards zero first, and other constants are a multiply by
+      // the reciprocal, unless optimizing for size keeps the library call.
+      if (Opd2Info == TTI::OK_UniformConstantValue ||
+          Opd2Info == TTI::OK_NonUniformConstantValue) {
+        bool IsSigned = ISD == ISD::SDIV || ISD == ISD::SREM;
+        if (Opd2PropInfo == TTI::OP_PowerOf2 && !IsSigned)
+          return TTI::TCC_Basic;
+        if (!OptForMinSize)
+          return Opd2PropInfo == TTI::OP_PowerOf2 ? 4 * TTI::TCC_Basic
+                                                  : 12 * TTI::TCC_Basic;
+      }
+      // Otherwise there is no divider, this is a call to a shift and
+      // subtract loop in the runtime library.
+      std::pair<int, MVT> LT = TLI->getTypeLegalizationCost(DL, Ty);
+      return LT.first * 64 * TTI::TCC_Basic;
+    }
+  }
+  return BaseT::getArithmeticInstrCost(Opcode, Ty, Opd1Info, Opd2Info,
+                                       Opd1PropInfo, Opd2PropInfo, Args);
+}
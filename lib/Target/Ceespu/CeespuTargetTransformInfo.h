@@ -0,0 +1,70 @@
+//===-- CeespuTargetTransformInfo.h - Ceespu specific TTI -------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a TargetTransformInfo::Concept conforming object specific
+// to the Ceespu target machine. It describes the costs of immediates that
+// need a SETI prefix, of division done in software and of loop shapes on the
+// single-issue pipeline, so that IR passes optimize for the actual core.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_LIB_TARGET_Ceespu_CeespuTARGETTRANSFORMINFO_H
+#define LLVM_LIB_TARGET_Ceespu_CeespuTARGETTRANSFORMINFO_H
+
+#include "CeespuSubtarget.h"
+#include "CeespuTargetMachine.h"
+#include "llvm/Analysis/TargetTransformInfo.h"
+#include "llvm/CodeGen/BasicTTIImpl.h"
+#include "llvm/IR/Function.h"
+
+namespace llvm {
+
+class CeespuTTIImpl : public BasicTTIImplBase<CeespuTTIImpl> {
+  typedef BasicTTIImplBase<CeespuTTIImpl> BaseT;
+  typedef TargetTransformInfo TTI;
+  friend BaseT;
+
+  const CeespuSubtarget *ST;
+  const CeespuTargetLowering *TLI;
+  // Division by a constant stays a library call, see isIntDivCheap.
+  bool OptForMinSize;
+
+  const CeespuSubtarget *getST() const { return ST; }
+  const CeespuTargetLowering *getTLI() const { return TLI; }
+
+public:
+  explicit CeespuTTIImpl(const CeespuTargetMachine *TM, const Function &F)
+      : BaseT(TM, F.getParent()->getDataLayout()), ST(TM->getSubtargetImpl(F)),
+        TLI(ST->getTargetLowering()), OptForMinSize(F.optForMinSize()) {}
+
+  int getIntImmCost(const APInt &Imm, Type *Ty);
+  int getIntImmCost(unsigned Opcode, unsigned Idx, const APInt &Imm, Type *Ty);
+  int getIntImmCost(Intrinsic::ID IID, unsigned Idx, const APInt &Imm,
+                    Type *Ty);
+
+  unsigned getNumberOfRegisters(bool Vector) { return Vector ? 0 : 27; }
+
+  bool isLSRCostLess(TargetTransformInfo::LSRCost &C1,
+                     TargetTransformInfo::LSRCost &C2);
+
+  void getUnrollingPreferences(Loop *L, ScalarEvolution &SE,
+                               TTI::UnrollingPreferences &UP);
+
+  unsigned getArithmeticInstrCost(
+      unsigned Opcode, Type *Ty,
+      TTI::OperandValueKind Opd1Info = TTI::OK_AnyValue,
+      TTI::OperandValueKind Opd2Info = TTI::OK_AnyValue,
+      TTI::OperandValueProperties Opd1PropInfo = TTI::OP_None,
+      TTI::OperandValueProperties Opd2PropInfo = TTI::OP_None,
+      ArrayRef<const Value *> Args = ArrayRef<const Value *>());
+};
+
+} // end namespace llvm
+
+#endif
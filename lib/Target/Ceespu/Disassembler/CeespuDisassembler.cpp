@@ -0,0 +1,163 @@
+//===-- CeespuDisassembler.cpp - Disassembler for Ceespu ------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file implements the CeespuDisassembler class.
+//
+//===----------------------------------------------------------------------===//
+
+#include "MCTargetDesc/CeespuBaseInfo.h"
+#include "MCTargetDesc/CeespuMCTargetDesc.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCDisassembler/MCDisassembler.h"
+#include "llvm/MC/MCFixedLenDisassembler.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/TargetRegistry.h"
+
+using namespace llvm;
+
+#define DEBUG_TYPE "ceespu-disassembler"
+
+typedef MCDisassembler::DecodeStatus DecodeStatus;
+
+namespace {
+class CeespuDisassembler : public MCDisassembler {
+
+public:
+  CeespuDisassembler(const MCSubtargetInfo &STI, MCContext &Ctx)
+      : MCDisassembler(STI, Ctx) {}
+
+  DecodeStatus getInstruction(MCInst &Instr, uint64_t &Size,
+                              ArrayRef<uint8_t> Bytes, uint64_t Address,
+                              raw_ostream &VStream,
+                              raw_ostream &CStream) const override;
+};
+} // end anonymous namespace
+
+static MCDisassembler *createCeespuDisassembler(const Target &T,
+                                                const MCSubtargetInfo &STI,
+                                                MCContext &Ctx) {
+  return new CeespuDisassembler(STI, Ctx);
+}
+
+extern "C" void LLVMInitializeCeespuDisassembler() {
+  // Register the disassembler for each target.
+  TargetRegistry::RegisterMCDisassembler(getTheCeespuTarget(),
+                                         createCeespuDisassembler);
+  TargetRegistry::RegisterMCDisassembler(getTheCeespuebTarget(),
+                                         createCeespuDisassembler);
+}
+
+static const unsigned GPRDecoderTable[] = {
+  Ceespu::R0,  Ceespu::R1,  Ceespu::R2,  Ceespu::R3,
+  Ceespu::R4,  Ceespu::R5,  Ceespu::R6,  Ceespu::R7,
+  Ceespu::R8,  Ceespu::R9,  Ceespu::R10, Ceespu::R11,
+  Ceespu::R12, Ceespu::R13, Ceespu::R14, Ceespu::R15,
+  Ceespu::FP,  Ceespu::R17, Ceespu::SP,  Ceespu::LR,
+  Ceespu::R20, Ceespu::R21, Ceespu::R22, Ceespu::R23,
+  Ceespu::R24, Ceespu::R25, Ceespu::R26, Ceespu::R27,
+  Ceespu::R28, Ceespu::R29, Ceespu::R30, Ceespu::R31
+};
+
+static DecodeStatus DecodeGPRRegisterClass(MCInst &Inst, uint64_t RegNo,
+                                           uint64_t Address,
+                                           const void *Decoder) {
+  if (RegNo >= array_lengthof(GPRDecoderTable))
+    return MCDisassembler::Fail;
+
+  // We must define our own mapping from RegNo to register identifier.
+  // Accessing index RegNo in the register class will work in the case that
+  // registers were added in ascending order, but not in general.
+  unsigned Reg = GPRDecoderTable[RegNo];
+  Inst.addOperand(MCOperand::createReg(Reg));
+  return MCDisassembler::Success;
+}
+
+template <unsigned N>
+static DecodeStatus decodeUImmOperand(MCInst &Inst, uint64_t Imm,
+                                      int64_t Address, const void *Decoder) {
+  assert(isUInt<N>(Imm) && "Invalid immediate");
+  Inst.addOperand(MCOperand::createImm(Imm));
+  return MCDisassembler::Success;
+}
+
+template <unsigned N>
+static DecodeStatus decodeSImmOperand(MCInst &Inst, uint64_t Imm,
+                                      int64_t Address, const void *Decoder) {
+  assert(isUInt<N>(Imm) && "Invalid immediate");
+  // Sign-extend the number in the bottom N bits of Imm
+  Inst.addOperand(MCOperand::createImm(SignExtend64<N>(Imm)));
+  return MCDisassembler::Success;
+}
+
+// A memory operand is the base register in bits 20-16 and a signed 16-bit
+// offset in bits 15-0.
+static DecodeStatus decodeMemoryOperand(MCInst &Inst, uint64_t Imm,
+                                        int64_t Address, const void *Decoder) {
+  unsigned Base = (Imm >> 16) & 0x1f;
+  if (DecodeGPRRegisterClass(Inst, Base, Address, Decoder) ==
+      MCDisassembler::Fail)
+    return MCDisassembler::Fail;
+  Inst.addOperand(MCOperand::createImm(SignExtend64<16>(Imm & 0xffff)));
+  return MCDisassembler::Success;
+}
+
+#include "CeespuGenDisassemblerTables.inc"
+
+// Folds the immediate of a SETI prefix into the instruction that follows it.
+// Returns false if Inst does not take a 32-bit immediate.
+static bool foldSETIPrefix(MCInst &Inst, uint64_t Hi) {
+  int OpIdx = CeespuII::getSETIExtendedOperand(Inst.getOpcode());
+  if (OpIdx < 0)
+    return false;
+
+  MCOperand &MO = Inst.getOperand(OpIdx);
+  uint32_t Lo = MO.getImm() & 0xffff;
+  // The low two bits of a jump target select the kind of jump.
+  if (OpIdx == 0)
+    Lo &= ~3U;
+  MO.setImm(SignExtend64<32>((Hi << 16) | Lo));
+  return true;
+}
+
+DecodeStatus CeespuDisassembler::getInstruction(MCInst &MI, uint64_t &Size,
+                                                ArrayRef<uint8_t> Bytes,
+                                                uint64_t Address,
+                                                raw_ostream &OS,
+                                                raw_ostream &CS) const {
+  // All Ceespu instructions are 32 bits wide.
+  if (Bytes.size() < 4) {
+    Size = 0;
+    return MCDisassembler::Fail;
+  }
+
+  uint32_t Insn = support::endian::read32le(Bytes.data());
+  LLVM_DEBUG(dbgs() << "Trying Ceespu table :\n");
+  DecodeStatus Result =
+      decodeInstruction(DecoderTable32, MI, Insn, Address, this, STI);
+  Size = 4;
+  if (Result == MCDisassembler::Fail || MI.getOpcode() != Ceespu::SETHI ||
+      Bytes.size() < 8)
+    return Result;
+
+  // A SETI prefix and the instruction it extends are shown as a single
+  // instruction with a 32-bit immediate.
+  MCInst Next;
+  uint32_t NextInsn = support::endian::read32le(Bytes.data() + 4);
+  if (decodeInstruction(DecoderTable32, Next, NextInsn, Address + 4, this,
+                        STI) == MCDisassembler::Fail ||
+      !foldSETIPrefix(Next, MI.getOperand(0).getImm() & 0xffff))
+    return Result;
+
+  MI = Next;
+  Size = 8;
+  return Result;
+}
@@ -77,8 +77,10 @@ void CeespuInstPrinter::printMemOperand(const MCInst *MI, int OpNo,
   // offset
   if (OffsetOp.isImm())
     O << formatDec(OffsetOp.getImm());
-  else
-    assert(0 && "Expected an immediate");
+  else {
+    assert(OffsetOp.isExpr() && "Expected an immediate or an expression");
+    OffsetOp.getExpr()->print(O, &MAI);
+  }
 
   // register
   assert(RegOp.isReg() && "Register operand not a register");
@@ -8,7 +8,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "MCTargetDesc/CeespuBaseInfo.h"
 #include "MCTargetDesc/CeespuFixupKinds.h"
+#include "MCTargetDesc/CeespuMCExpr.h"
 #include "MCTargetDesc/CeespuMCTargetDesc.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/MC/MCAsmBackend.h"
@@ -83,7 +85,9 @@ class CeespuAsmBackend : public MCAsmBackend {
         {"fixup_ceespu_lo16", 0, 16, 0},
         {"fixup_ceespu_lo12", 0, 32, 0},
         {"fixup_ceespu_cbranch", 0, 32, MCFixupKindInfo::FKF_IsPCRel},
-        {"fixup_ceespu_lo22", 2, 22, MCFixupKindInfo::FKF_IsPCRel}};
+        {"fixup_ceespu_jmp16", 0, 16, 0},
+        {"fixup_ceespu_abs16", 0, 16, 0},
+        {"fixup_ceespu_abs16_s", 0, 32, 0}};
     static_assert((array_lengthof(Infos)) == Ceespu::NumTargetFixupKinds,
                   "Not all fixup kinds added to Infos array");
 
@@ -105,99 +109,66 @@ class CeespuAsmBackend : public MCAsmBackend {
   bool writeNopData(raw_ostream &OS, uint64_t Count) const override;
 };
 
+// Instructions with an expression operand are emitted in their short form
+// and only grow once layout shows that the value does not fit. Values that
+// are only known at link time always need the long form, except for branch
+// targets, which are left to the linker like calls are.
 bool CeespuAsmBackend::fixupNeedsRelaxationAdvanced(
     const MCFixup &Fixup, bool Resolved, uint64_t Value,
     const MCRelaxableFragment *DF, const MCAsmLayout &Layout,
     const bool WasForced) const {
-  // Return true if the symbol is actually unresolved.
-  // Resolved could be always false when shouldForceRelocation return true.
-  // We use !WasForced to indicate that the symbol is unresolved and not forced
-  // by shouldForceRelocation.
-  if (!Resolved && !WasForced) return true;
-
   int64_t Offset = int64_t(Value);
   switch ((unsigned)Fixup.getKind()) {
     default:
       return false;
+    case Ceespu::fixup_ceespu_lo16:
+    case Ceespu::fixup_ceespu_lo12:
+      return !Resolved || !isInt<16>(Offset);
     case Ceespu::fixup_ceespu_cbranch:
-      // For compressed jump instructions the immediate must be
-      // in the range [-2048, 2046].
-      return Offset > 32767 || Offset < -32768;
+      return Resolved && !isInt<16>(Offset);
   }
 }
 
 void CeespuAsmBackend::relaxInstruction(const MCInst &Inst,
                                         const MCSubtargetInfo &STI,
                                         MCInst &Res) const {
-  /* TODO: replace this with call to auto generated uncompressinstr() function.
-  switch (Inst.getOpcode()) {
-    default:
-      llvm_unreachable("Opcode not expected!");
-    case Ceespu::C_BEQZ:
-      // c.beqz $rs1, $imm -> beq $rs1, X0, $imm.
-      Res.setOpcode(Ceespu::BEQ);
-      Res.addOperand(Inst.getOperand(0));
-      Res.addOperand(MCOperand::createReg(Ceespu::X0));
-      Res.addOperand(Inst.getOperand(1));
-      break;
-    case Ceespu::C_BNEZ:
-      // c.bnez $rs1, $imm -> bne $rs1, X0, $imm.
-      Res.setOpcode(Ceespu::BNE);
-      Res.addOperand(Inst.getOperand(0));
-      Res.addOperand(MCOperand::createReg(Ceespu::X0));
-      Res.addOperand(Inst.getOperand(1));
-      break;
-    case Ceespu::C_J:
-      // c.j $imm -> jal X0, $imm.
-      Res.setOpcode(Ceespu::JAL);
-      Res.addOperand(MCOperand::createReg(Ceespu::X0));
-      Res.addOperand(Inst.getOperand(0));
-      break;
-    case Ceespu::C_JAL:
-      // c.jal $imm -> jal X1, $imm.
-      Res.setOpcode(Ceespu::JAL);
-      Res.addOperand(MCOperand::createReg(Ceespu::X1));
-      Res.addOperand(Inst.getOperand(0));
-      break;
-  } */
+  unsigned Opc = getRelaxedOpcode(Inst.getOpcode());
+  assert(Opc != Inst.getOpcode() && "Opcode not expected!");
+  Res = Inst;
+  Res.setOpcode(Opc);
 }
 
-// Given a compressed control flow instruction this function returns
-// the expanded instruction.
+// Returns the long form of an instruction with a 16-bit immediate or branch
+// offset: the SETI prefixed instruction, or the opposite branch over a jump.
 unsigned CeespuAsmBackend::getRelaxedOpcode(unsigned Op) const {
-  /*  switch (Op) {
-    default:
-      return Op;
-    case Ceespu::C_BEQZ:
-      return Ceespu::BEQ;
-    case Ceespu::C_BNEZ:
-      return Ceespu::BNE;
-    case Ceespu::C_J:
-    case Ceespu::C_JAL: // fall through.
-      return Ceespu::JAL;
-    }*/
+  if (unsigned Opc = CeespuII::getSETIPrefixedOpcode(Op))
+    return Opc;
+  if (unsigned Opc = CeespuII::getLongBranchOpcode(Op))
+    return Opc;
+  return Op;
 }
 
 bool CeespuAsmBackend::mayNeedRelaxation(const MCInst &Inst,
                                          const MCSubtargetInfo &STI) const {
-  return getRelaxedOpcode(Inst.getOpcode()) != Inst.getOpcode();
+  unsigned Opc = Inst.getOpcode();
+  if (getRelaxedOpcode(Opc) == Opc)
+    return false;
+
+  // Only bare expressions are relaxed. An operand with a modifier is half of
+  // an explicit SETI pair, or a small data address, and is always 16 bits.
+  int OpIdx = CeespuII::getLongBranchOpcode(Opc)
+                  ? Inst.getNumOperands() - 1
+                  : CeespuII::getSETIExtendedOperand(Opc);
+  const MCOperand &MO = Inst.getOperand(OpIdx);
+  return MO.isExpr() && !isa<CeespuMCExpr>(MO.getExpr());
 }
 
 bool CeespuAsmBackend::writeNopData(raw_ostream &OS, uint64_t Count) const {
-  bool HasStdExtC = false;  // STI.getFeatureBits()[Ceespu::FeatureStdExtC];
-  unsigned MinNopLen = HasStdExtC ? 2 : 4;
-
-  if ((Count % MinNopLen) != 0) return false;
-
-  // The canonical nop on RISC-V is addi x0, x0, 0.
-  uint64_t Nop32Count = Count / 4;
-  for (uint64_t i = Nop32Count; i != 0; --i) OS.write("\x13\0\0\0", 4);
+  if ((Count % 4) != 0) return false;
 
-  // The canonical nop on RVC is c.nop.
-  if (HasStdExtC) {
-    uint64_t Nop16Count = (Count - Nop32Count * 4) / 2;
-    for (uint64_t i = Nop16Count; i != 0; --i) OS.write("\x01\0", 2);
-  }
+  // The canonical nop is add c1, c1, c0. Padding only goes in front of a
+  // block, and the carry that it clobbers is never live into one.
+  for (uint64_t i = Count / 4; i != 0; --i) OS.write("\0\0\x21\0", 4);
 
   return true;
 }
@@ -209,18 +180,32 @@ static uint64_t adjustFixupValue(const MCFixup &Fixup, uint64_t Value,
     default:
       llvm_unreachable("Unknown fixup kind!");
     case FK_Data_1:
-    case FK_Data_2:
     case FK_Data_4:
     case FK_Data_8:
       return Value;
+    case FK_Data_2:
+      // Compact jump table entries are 16-bit offsets within a function.
+      if (!isUInt<16>(Value) && !isInt<16>(Value))
+        Ctx.reportError(Fixup.getLoc(), "fixup value out of range");
+      return Value;
     case Ceespu::fixup_ceespu_hi16:
       return (Value >> 16) & 0xffff;
     case Ceespu::fixup_ceespu_lo16:
       return Value & 0xffff;
     case Ceespu::fixup_ceespu_lo12:
       return (Value & 0x7ff) | ((Value & 0xF800) << 10);
-    case Ceespu::fixup_ceespu_lo22:
-      return (Value & 0x1fffffc);
+    case Ceespu::fixup_ceespu_abs16:
+    case Ceespu::fixup_ceespu_abs16_s:
+      if (!isInt<16>(Value))
+        Ctx.reportError(Fixup.getLoc(),
+                        "small data address does not fit in 16 bits");
+      if (Kind == Ceespu::fixup_ceespu_abs16)
+        return Value & 0xffff;
+      return (Value & 0x7ff) | ((Value & 0xF800) << 10);
+    case Ceespu::fixup_ceespu_jmp16:
+      if (Value & 0x3)
+        Ctx.reportError(Fixup.getLoc(), "fixup value must be 4-byte aligned");
+      return Value & 0xfffc;
     case Ceespu::fixup_ceespu_cbranch: {
       if (!isInt<16>(Value))
         Ctx.reportError(Fixup.getLoc(), "fixup value out of range");
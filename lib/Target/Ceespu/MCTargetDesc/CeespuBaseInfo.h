@@ -17,6 +17,7 @@
 #include "CeespuMCTargetDesc.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/ErrorHandling.h"
 
 namespace llvm {
 
@@ -50,7 +51,150 @@ enum {
   MO_LO,
   MO_HI,
   MO_PCREL_HI,
+  MO_ABS,
 };
+
+// A SETI prefix supplies the upper 16 bits of the immediate of the
+// instruction that follows it. Returns the index of the operand that is
+// extended for Opcode, or -1 if Opcode cannot follow a SETI prefix.
+inline static int getSETIExtendedOperand(unsigned Opcode) {
+  switch (Opcode) {
+  default:
+    return -1;
+  case Ceespu::JMP:
+  case Ceespu::JAL:
+    return 0;
+  case Ceespu::ADDI:
+  case Ceespu::ADEI:
+  case Ceespu::ADCI:
+  case Ceespu::SUBI:
+  case Ceespu::SBBI:
+  case Ceespu::SBEI:
+  case Ceespu::ORI:
+  case Ceespu::ANDI:
+  case Ceespu::XORI:
+  case Ceespu::MULI:
+  case Ceespu::LW:
+  case Ceespu::LH:
+  case Ceespu::LHU:
+  case Ceespu::LB:
+  case Ceespu::LBU:
+  case Ceespu::SW:
+  case Ceespu::SH:
+  case Ceespu::SB:
+    return 2;
+  }
+}
+
+// Returns the SETI prefixed form that the assembler relaxes Opcode to when
+// its immediate does not fit in 16 bits, or 0 if there is none.
+inline static unsigned getSETIPrefixedOpcode(unsigned Opcode) {
+  switch (Opcode) {
+  default:
+    return 0;
+  case Ceespu::ADDI: return Ceespu::ADDX;
+  case Ceespu::ADEI: return Ceespu::ADEX;
+  case Ceespu::ADCI: return Ceespu::ADCX;
+  case Ceespu::SUBI: return Ceespu::SUBX;
+  case Ceespu::SBBI: return Ceespu::SBBX;
+  case Ceespu::SBEI: return Ceespu::SBEX;
+  case Ceespu::ORI:  return Ceespu::ORX;
+  case Ceespu::ANDI: return Ceespu::ANDX;
+  case Ceespu::XORI: return Ceespu::XORX;
+  case Ceespu::MULI: return Ceespu::MULX;
+  case Ceespu::LW:   return Ceespu::LWX;
+  case Ceespu::LH:   return Ceespu::LHX;
+  case Ceespu::LHU:  return Ceespu::LHUX;
+  case Ceespu::LB:   return Ceespu::LBX;
+  case Ceespu::LBU:  return Ceespu::LBUX;
+  case Ceespu::SW:   return Ceespu::SWX;
+  case Ceespu::SH:   return Ceespu::SHX;
+  case Ceespu::SB:   return Ceespu::SBX;
+  }
+}
+
+// The inverse of getSETIPrefixedOpcode: returns the instruction that follows
+// the SETI prefix in the encoding of Opcode, or 0 if Opcode has no prefix.
+inline static unsigned getUnprefixedOpcode(unsigned Opcode) {
+  switch (Opcode) {
+  default:
+    return 0;
+  case Ceespu::ADDX: return Ceespu::ADDI;
+  case Ceespu::ADEX: return Ceespu::ADEI;
+  case Ceespu::ADCX: return Ceespu::ADCI;
+  case Ceespu::SUBX: return Ceespu::SUBI;
+  case Ceespu::SBBX: return Ceespu::SBBI;
+  case Ceespu::SBEX: return Ceespu::SBEI;
+  case Ceespu::ORX:  return Ceespu::ORI;
+  case Ceespu::ANDX: return Ceespu::ANDI;
+  case Ceespu::XORX: return Ceespu::XORI;
+  case Ceespu::MULX: return Ceespu::MULI;
+  case Ceespu::LWX:  return Ceespu::LW;
+  case Ceespu::LHX:  return Ceespu::LH;
+  case Ceespu::LHUX: return Ceespu::LHU;
+  case Ceespu::LBX:  return Ceespu::LB;
+  case Ceespu::LBUX: return Ceespu::LBU;
+  case Ceespu::SWX:  return Ceespu::SW;
+  case Ceespu::SHX:  return Ceespu::SH;
+  case Ceespu::SBX:  return Ceespu::SB;
+  }
+}
+
+// Returns the branch that is taken exactly when Opcode is not. Only BEQ and
+// BNE are each other's opposite; for the ordered compares a > b is negated
+// as b >= a, so SwapOperands is set and the caller has to exchange the
+// registers.
+inline static unsigned getOppositeBranchOpcode(unsigned Opcode,
+                                               bool &SwapOperands) {
+  SwapOperands = true;
+  switch (Opcode) {
+  default:
+    llvm_unreachable("Unrecognized conditional branch");
+  case Ceespu::BEQ:
+    SwapOperands = false;
+    return Ceespu::BNE;
+  case Ceespu::BNE:
+    SwapOperands = false;
+    return Ceespu::BEQ;
+  case Ceespu::BGT:
+    return Ceespu::BGE;
+  case Ceespu::BGE:
+    return Ceespu::BGT;
+  case Ceespu::BGEU:
+    return Ceespu::BGU;
+  case Ceespu::BGU:
+    return Ceespu::BGEU;
+  }
+}
+
+// Returns the long form that the assembler relaxes the conditional branch
+// Opcode to when its target is out of range, or 0 if there is none.
+inline static unsigned getLongBranchOpcode(unsigned Opcode) {
+  switch (Opcode) {
+  default:
+    return 0;
+  case Ceespu::BEQ:  return Ceespu::PseudoLongBEQ;
+  case Ceespu::BNE:  return Ceespu::PseudoLongBNE;
+  case Ceespu::BGT:  return Ceespu::PseudoLongBGT;
+  case Ceespu::BGE:  return Ceespu::PseudoLongBGE;
+  case Ceespu::BGU:  return Ceespu::PseudoLongBGU;
+  case Ceespu::BGEU: return Ceespu::PseudoLongBGEU;
+  }
+}
+
+// The inverse of getLongBranchOpcode.
+inline static unsigned getShortBranchOpcode(unsigned Opcode) {
+  switch (Opcode) {
+  default:
+    return 0;
+  case Ceespu::PseudoLongBEQ:  return Ceespu::BEQ;
+  case Ceespu::PseudoLongBNE:  return Ceespu::BNE;
+  case Ceespu::PseudoLongBGT:  return Ceespu::BGT;
+  case Ceespu::PseudoLongBGE:  return Ceespu::BGE;
+  case Ceespu::PseudoLongBGU:  return Ceespu::BGU;
+  case Ceespu::PseudoLongBGEU: return Ceespu::BGEU;
+  }
+}
 } // namespace CeespuII
 
 // Describes the predecessor/successor bits used in the FENCE instruction.
@@ -54,7 +54,7 @@ unsigned CeespuELFObjectWriter::getRelocType(MCContext &Ctx,
     default:
       llvm_unreachable("invalid fixup kind!");
     case FK_Data_4:
-      return ELF::R_CEESPU_NONE;
+      return ELF::R_CEESPU_32;
     case FK_Data_8:
       return ELF::R_CEESPU_NONE;
     case FK_Data_Add_1:
@@ -73,8 +73,8 @@ unsigned CeespuELFObjectWriter::getRelocType(MCContext &Ctx,
       return ELF::R_CEESPU_NONE;
     case FK_Data_Sub_8:
       return ELF::R_CEESPU_NONE;
-    case Ceespu::fixup_ceespu_lo22:
-      return ELF::R_CEESPU_LO_22;
+    case Ceespu::fixup_ceespu_jmp16:
+      return ELF::R_CEESPU_JMP_16;
     case Ceespu::fixup_ceespu_lo12:
       return ELF::R_CEESPU_LO_12;
     case Ceespu::fixup_ceespu_lo16:
@@ -83,6 +83,10 @@ unsigned CeespuELFObjectWriter::getRelocType(MCContext &Ctx,
       return ELF::R_CEESPU_HI_16;
     case Ceespu::fixup_ceespu_cbranch:
       return ELF::R_CEESPU_RJMP;
+    case Ceespu::fixup_ceespu_abs16:
+      return ELF::R_CEESPU_ABS_16;
+    case Ceespu::fixup_ceespu_abs16_s:
+      return ELF::R_CEESPU_ABS_16_S;
   }
 }
 
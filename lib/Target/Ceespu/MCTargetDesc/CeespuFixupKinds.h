@@ -29,9 +29,15 @@ enum Fixups {
   fixup_ceespu_lo12,
   // fixup_ceespu_cbranch - 16 bit relative symbol
   fixup_ceespu_cbranch,
-  // fixup_ceespu_lo_22 - 22 bit symbol fixup for unconditianal branches and
-  // calls
-  fixup_ceespu_lo22,
+  // fixup_ceespu_jmp16 - 16-bit absolute target of unconditional branches and
+  // calls, the low two bits select the kind of jump and are preserved
+  fixup_ceespu_jmp16,
+  // fixup_ceespu_abs16 - 16-bit absolute address of a small data object,
+  // which is reached as an offset from c0
+  fixup_ceespu_abs16,
+  // fixup_ceespu_abs16_s - the same, split around the source register of the
+  // store instructions
+  fixup_ceespu_abs16_s,
 
   // fixup_ceespu_invalid - used as a sentinel and a marker, must be last fixup
   fixup_ceespu_invalid,
@@ -19,11 +19,11 @@ using namespace llvm;
 void CeespuMCAsmInfo::anchor() {}
 
 CeespuMCAsmInfo::CeespuMCAsmInfo(const Triple &TT) {
-  IsLittleEndian = false;
+  IsLittleEndian = TT.getArch() == Triple::ceespu;
   CodePointerSize = CalleeSaveStackSlotSize = TT.isArch64Bit() ? 8 : 4;
   CommentString = ";";
   AlignmentIsInBytes = false;
-  SupportsDebugInformation = false;  // true;
+  SupportsDebugInformation = true;
   Data16bitsDirective = "\t.hword\t";
   Data32bitsDirective = "\t.word\t";
   ZeroDirective = "\t.space\t";
@@ -28,6 +28,7 @@
 #include "llvm/MC/MCSymbol.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/EndianStream.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
@@ -60,6 +61,18 @@ class CeespuMCCodeEmitter : public MCCodeEmitter {
                           SmallVectorImpl<MCFixup> &Fixups,
                           const MCSubtargetInfo &STI) const;
 
+  void emitWord(const MCInst &MI, unsigned Offset, raw_ostream &OS,
+                SmallVectorImpl<MCFixup> &Fixups,
+                const MCSubtargetInfo &STI) const;
+
+  void expandSETIPrefixed(const MCInst &MI, unsigned Opc, raw_ostream &OS,
+                          SmallVectorImpl<MCFixup> &Fixups,
+                          const MCSubtargetInfo &STI) const;
+
+  void expandLongBranch(const MCInst &MI, unsigned Opc, raw_ostream &OS,
+                        SmallVectorImpl<MCFixup> &Fixups,
+                        const MCSubtargetInfo &STI) const;
+
   /// TableGen'erated function for getting the binary encoding for an
   /// instruction.
   uint64_t getBinaryCodeForInstr(const MCInst &MI,
@@ -79,6 +92,14 @@ class CeespuMCCodeEmitter : public MCCodeEmitter {
   unsigned getImmOpValue(const MCInst &MI, unsigned OpNo,
                          SmallVectorImpl<MCFixup> &Fixups,
                          const MCSubtargetInfo &STI) const;
+
+  unsigned getBranchTargetOpValue(const MCInst &MI, unsigned OpNo,
+                                  SmallVectorImpl<MCFixup> &Fixups,
+                                  const MCSubtargetInfo &STI) const;
+
+  unsigned getJumpTargetOpValue(const MCInst &MI, unsigned OpNo,
+                                SmallVectorImpl<MCFixup> &Fixups,
+                                const MCSubtargetInfo &STI) const;
   // Encode BPF Memory Operand
   uint64_t getMemoryOpValue(const MCInst &MI, unsigned Op,
                             SmallVectorImpl<MCFixup> &Fixups,
@@ -129,6 +150,73 @@ void CeespuMCCodeEmitter::expandFunctionCall(const MCInst &MI, raw_ostream &OS,
   support::endian::write(OS, Binary, support::little);*/
 }
 
+// Encodes MI as the word at Offset bytes into the instruction being emitted,
+// moving the fixups it creates along with it.
+void CeespuMCCodeEmitter::emitWord(const MCInst &MI, unsigned Offset,
+                                   raw_ostream &OS,
+                                   SmallVectorImpl<MCFixup> &Fixups,
+                                   const MCSubtargetInfo &STI) const {
+  unsigned FirstFixup = Fixups.size();
+  uint32_t Bits = getBinaryCodeForInstr(MI, Fixups, STI);
+  for (unsigned I = FirstFixup, E = Fixups.size(); I != E; ++I)
+    Fixups[I].setOffset(Fixups[I].getOffset() + Offset);
+  support::endian::write(OS, Bits, support::little);
+}
+
+// Emits an instruction that the assembler relaxed to its SETI prefixed form
+// as the prefix with the upper half of the immediate, followed by Opc with
+// the lower half.
+void CeespuMCCodeEmitter::expandSETIPrefixed(const MCInst &MI, unsigned Opc,
+                                             raw_ostream &OS,
+                                             SmallVectorImpl<MCFixup> &Fixups,
+                                             const MCSubtargetInfo &STI) const {
+  int OpIdx = CeespuII::getSETIExtendedOperand(Opc);
+  assert(OpIdx > 0 && "Unexpected SETI prefixed instruction");
+  const MCOperand &MO = MI.getOperand(OpIdx);
+  MCOperand Hi, Lo;
+  if (MO.isImm()) {
+    Hi = MCOperand::createImm((MO.getImm() >> 16) & 0xffff);
+    Lo = MCOperand::createImm(SignExtend64<16>(MO.getImm()));
+  } else {
+    const MCExpr *Expr = MO.getExpr();
+    Hi = MCOperand::createExpr(
+        CeespuMCExpr::create(Expr, CeespuMCExpr::VK_Ceespu_HI, Ctx));
+    Lo = MCOperand::createExpr(
+        CeespuMCExpr::create(Expr, CeespuMCExpr::VK_Ceespu_LO, Ctx));
+  }
+
+  MCInst Prefix = MCInstBuilder(Ceespu::SETHI).addOperand(Hi);
+  Prefix.setLoc(MI.getLoc());
+  emitWord(Prefix, 0, OS, Fixups, STI);
+
+  MCInst Inst = MI;
+  Inst.setOpcode(Opc);
+  Inst.getOperand(OpIdx) = Lo;
+  emitWord(Inst, 4, OS, Fixups, STI);
+}
+
+// Emits a conditional branch that the assembler relaxed because its target
+// is out of range as the opposite branch over an absolute jump.
+void CeespuMCCodeEmitter::expandLongBranch(const MCInst &MI, unsigned Opc,
+                                           raw_ostream &OS,
+                                           SmallVectorImpl<MCFixup> &Fixups,
+                                           const MCSubtargetInfo &STI) const {
+  bool SwapOperands;
+  unsigned InvOpc = CeespuII::getOppositeBranchOpcode(Opc, SwapOperands);
+  MCOperand Ra = MI.getOperand(0), Rb = MI.getOperand(1);
+  if (SwapOperands)
+    std::swap(Ra, Rb);
+
+  MCInst Branch =
+      MCInstBuilder(InvOpc).addOperand(Ra).addOperand(Rb).addImm(8);
+  Branch.setLoc(MI.getLoc());
+  emitWord(Branch, 0, OS, Fixups, STI);
+
+  MCInst Jump = MCInstBuilder(Ceespu::JMP).addOperand(MI.getOperand(2));
+  Jump.setLoc(MI.getLoc());
+  emitWord(Jump, 4, OS, Fixups, STI);
+}
+
 void CeespuMCCodeEmitter::encodeInstruction(const MCInst &MI, raw_ostream &OS,
                                             SmallVectorImpl<MCFixup> &Fixups,
                                             const MCSubtargetInfo &STI) const {
@@ -143,6 +231,18 @@ void CeespuMCCodeEmitter::encodeInstruction(const MCInst &MI, raw_ostream &OS,
     return;
   }*/
 
+  if (unsigned Opc = CeespuII::getUnprefixedOpcode(MI.getOpcode())) {
+    expandSETIPrefixed(MI, Opc, OS, Fixups, STI);
+    MCNumEmitted += 2;
+    return;
+  }
+
+  if (unsigned Opc = CeespuII::getShortBranchOpcode(MI.getOpcode())) {
+    expandLongBranch(MI, Opc, OS, Fixups, STI);
+    MCNumEmitted += 2;
+    return;
+  }
+
   switch (Size) {
     default:
       llvm_unreachable("Unhandled encodeInstruction length!");
@@ -189,83 +289,75 @@ unsigned CeespuMCCodeEmitter::getImmOpValueAsr1(
 unsigned CeespuMCCodeEmitter::getImmOpValue(const MCInst &MI, unsigned OpNo,
                                             SmallVectorImpl<MCFixup> &Fixups,
                                             const MCSubtargetInfo &STI) const {
-  /* TODO ACTUALLY IMPLEMENT THIS  bool EnableRelax =
-  STI.getFeatureBits()[Ceespu::FeatureRelax]; const MCOperand &MO =
-  MI.getOperand(OpNo);
-
-    MCInstrDesc const &Desc = MCII.get(MI.getOpcode());
-    unsigned MIFrm = Desc.TSFlags & CeespuII::InstFormatMask;
-
-    // If the destination is an immediate, there is nothing to do
-    if (MO.isImm()) return MO.getImm();
-
-    assert(MO.isExpr() && "getImmOpValue expects only expressions or
-  immediates"); const MCExpr *Expr = MO.getExpr(); MCExpr::ExprKind Kind =
-  Expr->getKind(); Ceespu::Fixups FixupKind = Ceespu::fixup_ceespu_invalid; if
-  (Kind == MCExpr::Target) { const CeespuMCExpr *RVExpr =
-  cast<CeespuMCExpr>(Expr);
-
-      switch (RVExpr->getKind()) {
-        case CeespuMCExpr::VK_Ceespu_None:
-        case CeespuMCExpr::VK_Ceespu_Invalid:
-          llvm_unreachable("Unhandled fixup kind!");
-        case CeespuMCExpr::VK_Ceespu_LO:
-          if (MIFrm == CeespuII::InstFormatI)
-            FixupKind = Ceespu::fixup_ceespu_lo12_i;
-          else if (MIFrm == CeespuII::InstFormatS)
-            FixupKind = Ceespu::fixup_ceespu_lo12_s;
-          else
-            llvm_unreachable(
-                "VK_Ceespu_LO used with unexpected instruction format");
-          break;
-        case CeespuMCExpr::VK_Ceespu_HI:
-          FixupKind = Ceespu::fixup_ceespu_hi20;
-          break;
-        case CeespuMCExpr::VK_Ceespu_PCREL_LO:
-          if (MIFrm == CeespuII::InstFormatI)
-            FixupKind = Ceespu::fixup_ceespu_pcrel_lo12_i;
-          else if (MIFrm == CeespuII::InstFormatS)
-            FixupKind = Ceespu::fixup_ceespu_pcrel_lo12_s;
-          else
-            llvm_unreachable(
-                "VK_Ceespu_PCREL_LO used with unexpected instruction format");
-          break;
-        case CeespuMCExpr::VK_Ceespu_PCREL_HI:
-          FixupKind = Ceespu::fixup_ceespu_pcrel_hi20;
-          break;
-        case CeespuMCExpr::VK_Ceespu_CALL:
-          FixupKind = Ceespu::fixup_ceespu_call;
-          break;
-      }
-    } else if (Kind == MCExpr::SymbolRef &&
-               cast<MCSymbolRefExpr>(Expr)->getKind() ==
-                   MCSymbolRefExpr::VK_None) {
-      if (Desc.getOpcode() == Ceespu::JAL) {
-        FixupKind = Ceespu::fixup_ceespu_jal;
-      } else if (MIFrm == CeespuII::InstFormatB) {
-        FixupKind = Ceespu::fixup_ceespu_branch;
-      } else if (MIFrm == CeespuII::InstFormatCJ) {
-        FixupKind = Ceespu::fixup_ceespu_rvc_jump;
-      } else if (MIFrm == CeespuII::InstFormatCB) {
-        FixupKind = Ceespu::fixup_ceespu_rvc_branch;
-      }
+  const MCOperand &MO = MI.getOperand(OpNo);
+
+  // If the destination is an immediate, there is nothing to do
+  if (MO.isImm()) return MO.getImm();
+
+  assert(MO.isExpr() && "getImmOpValue expects only expressions or immediates");
+  const MCExpr *Expr = MO.getExpr();
+
+  // A bare symbol in a SETI prefix supplies the upper half of its address,
+  // anywhere else it is the lower half.
+  Ceespu::Fixups FixupKind = MI.getOpcode() == Ceespu::SETHI
+                                 ? Ceespu::fixup_ceespu_hi16
+                                 : Ceespu::fixup_ceespu_lo16;
+  if (const CeespuMCExpr *CExpr = dyn_cast<CeespuMCExpr>(Expr)) {
+    int64_t Res;
+    if (CExpr->evaluateAsConstant(Res)) return Res;
+
+    switch (CExpr->getKind()) {
+      default:
+        llvm_unreachable("Unhandled fixup kind!");
+      case CeespuMCExpr::VK_Ceespu_LO:
+        FixupKind = Ceespu::fixup_ceespu_lo16;
+        break;
+      case CeespuMCExpr::VK_Ceespu_HI:
+        FixupKind = Ceespu::fixup_ceespu_hi16;
+        break;
+      case CeespuMCExpr::VK_Ceespu_ABS:
+        FixupKind = Ceespu::fixup_ceespu_abs16;
+        break;
     }
+  }
 
-    assert(FixupKind != Ceespu::fixup_ceespu_invalid && "Unhandled
-  expression!");
+  Fixups.push_back(
+      MCFixup::create(0, Expr, MCFixupKind(FixupKind), MI.getLoc()));
+  ++MCNumFixups;
+  return 0;
+}
 
-    Fixups.push_back(
-        MCFixup::create(0, Expr, MCFixupKind(FixupKind), MI.getLoc()));
-    ++MCNumFixups;
+unsigned CeespuMCCodeEmitter::getBranchTargetOpValue(
+    const MCInst &MI, unsigned OpNo, SmallVectorImpl<MCFixup> &Fixups,
+    const MCSubtargetInfo &STI) const {
+  const MCOperand &MO = MI.getOperand(OpNo);
+  if (MO.isImm()) return MO.getImm();
 
-    if (EnableRelax) {
-      if (FixupKind == Ceespu::fixup_ceespu_call) {
-        Fixups.push_back(MCFixup::create(
-            0, Expr, MCFixupKind(Ceespu::fixup_ceespu_relax), MI.getLoc()));
-        ++MCNumFixups;
-      }
-    }*/
+  assert(MO.isExpr() && "Expected an expression as branch target");
+  Fixups.push_back(MCFixup::create(
+      0, MO.getExpr(), MCFixupKind(Ceespu::fixup_ceespu_cbranch), MI.getLoc()));
+  ++MCNumFixups;
+  return 0;
+}
 
+unsigned CeespuMCCodeEmitter::getJumpTargetOpValue(
+    const MCInst &MI, unsigned OpNo, SmallVectorImpl<MCFixup> &Fixups,
+    const MCSubtargetInfo &STI) const {
+  const MCOperand &MO = MI.getOperand(OpNo);
+  if (MO.isImm()) return MO.getImm();
+
+  assert(MO.isExpr() && "Expected an expression as jump target");
+  const MCExpr *Expr = MO.getExpr();
+  // The low half of a SETI extended target uses the same fixup.
+  if (const CeespuMCExpr *CExpr = dyn_cast<CeespuMCExpr>(Expr)) {
+    int64_t Res;
+    if (CExpr->evaluateAsConstant(Res)) return Res;
+    assert(CExpr->getKind() == CeespuMCExpr::VK_Ceespu_LO &&
+           "Unexpected modifier on jump target");
+  }
+  Fixups.push_back(MCFixup::create(
+      0, Expr, MCFixupKind(Ceespu::fixup_ceespu_jmp16), MI.getLoc()));
+  ++MCNumFixups;
   return 0;
 }
 
@@ -274,13 +366,32 @@ uint64_t CeespuMCCodeEmitter::getMemoryOpValue(
     const MCInst &MI, unsigned Op, SmallVectorImpl<MCFixup> &Fixups,
     const MCSubtargetInfo &STI) const {
   uint64_t Encoding;
-  const MCOperand Op1 = MI.getOperand(1);
+  const MCOperand Op1 = MI.getOperand(Op);
   assert(Op1.isReg() && "First operand is not register.");
   Encoding = MRI.getEncodingValue(Op1.getReg());
   Encoding <<= 16;
-  MCOperand Op2 = MI.getOperand(2);
-  assert(Op2.isImm() && "Second operand is not immediate.");
-  Encoding |= Op2.getImm() & 0xffff;
+  MCOperand Op2 = MI.getOperand(Op + 1);
+  if (Op2.isImm()) {
+    Encoding |= Op2.getImm() & 0xffff;
+    return Encoding;
+  }
+
+  // Store offsets are split around the source register.
+  assert(Op2.isExpr() && "Second operand is not immediate or expression.");
+  const MCExpr *Expr = Op2.getExpr();
+  bool IsStore = MCII.get(MI.getOpcode()).mayStore();
+  Ceespu::Fixups FixupKind =
+      IsStore ? Ceespu::fixup_ceespu_lo12 : Ceespu::fixup_ceespu_lo16;
+  if (const CeespuMCExpr *CExpr = dyn_cast<CeespuMCExpr>(Expr)) {
+    int64_t Res;
+    if (CExpr->evaluateAsConstant(Res)) return Encoding | (Res & 0xffff);
+    if (CExpr->getKind() == CeespuMCExpr::VK_Ceespu_ABS)
+      FixupKind =
+          IsStore ? Ceespu::fixup_ceespu_abs16_s : Ceespu::fixup_ceespu_abs16;
+  }
+  Fixups.push_back(
+      MCFixup::create(0, Expr, MCFixupKind(FixupKind), MI.getLoc()));
+  ++MCNumFixups;
   return Encoding;
 }
 
@@ -56,6 +56,7 @@ bool CeespuMCExpr::evaluateAsRelocatableImpl(MCValue &Res,
     case VK_Ceespu_HI:
     case VK_Ceespu_PCREL_LO:
     case VK_Ceespu_PCREL_HI:
+    case VK_Ceespu_ABS:
       return false;
     }
   }
@@ -73,6 +74,7 @@ CeespuMCExpr::VariantKind CeespuMCExpr::getVariantKindForName(StringRef name) {
       .Case("hi", VK_Ceespu_HI)
       .Case("pcrel_lo", VK_Ceespu_PCREL_LO)
       .Case("pcrel_hi", VK_Ceespu_PCREL_HI)
+      .Case("abs", VK_Ceespu_ABS)
       .Default(VK_Ceespu_Invalid);
 }
 
@@ -88,6 +90,8 @@ StringRef CeespuMCExpr::getVariantKindName(VariantKind Kind) {
     return "pcrel_lo";
   case VK_Ceespu_PCREL_HI:
     return "pcrel_hi";
+  case VK_Ceespu_ABS:
+    return "abs";
   }
 }
 
@@ -113,9 +117,11 @@ int64_t CeespuMCExpr::evaluateAsInt64(int64_t Value) const {
   default:
     llvm_unreachable("Invalid kind");
   case VK_Ceespu_LO:
-    return SignExtend64<12>(Value);
+  case VK_Ceespu_ABS:
+    return SignExtend64<16>(Value);
   case VK_Ceespu_HI:
-    // Add 1 if bit 11 is 1, to compensate for low 12 bits being negative.
-    return ((Value + 0x800) >> 12) & 0xfffff;
+    // SETI replaces the upper half of the immediate rather than adding to it,
+    // so no compensation for a negative low half is needed.
+    return (Value >> 16) & 0xffff;
   }
 }
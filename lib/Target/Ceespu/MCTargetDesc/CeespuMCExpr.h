@@ -30,6 +30,7 @@ public:
     VK_Ceespu_PCREL_LO,
     VK_Ceespu_PCREL_HI,
     VK_Ceespu_CALL,
+    VK_Ceespu_ABS,
     VK_Ceespu_Invalid
   };
 
@@ -19,6 +19,7 @@
 #include "InstPrinter/CeespuInstPrinter.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCInstrAnalysis.h"
 #include "llvm/MC/MCInstrInfo.h"
 #include "llvm/MC/MCRegisterInfo.h"
 #include "llvm/MC/MCStreamer.h"
@@ -45,7 +46,7 @@ static MCInstrInfo *createCeespuMCInstrInfo() {
 
 static MCRegisterInfo *createCeespuMCRegisterInfo(const Triple &TT) {
   MCRegisterInfo *X = new MCRegisterInfo();
-  InitCeespuMCRegisterInfo(X, Ceespu::R1);
+  InitCeespuMCRegisterInfo(X, Ceespu::LR);
   return X;
 }
 
@@ -70,6 +71,24 @@ static MCInstPrinter *createCeespuMCInstPrinter(const Triple &T,
   return new CeespuInstPrinter(MAI, MII, MRI);
 }
 
+namespace {
+class CeespuMCInstrAnalysis : public MCInstrAnalysis {
+public:
+  explicit CeespuMCInstrAnalysis(const MCInstrInfo *Info)
+      : MCInstrAnalysis(Info) {}
+
+  // A SETI prefix supplies the upper half of the immediate of the next
+  // instruction, and the core issues the pair back to back.
+  bool isPrefix(const MCInst &Inst) const override {
+    return Inst.getOpcode() == Ceespu::SETHI;
+  }
+};
+} // end anonymous namespace
+
+static MCInstrAnalysis *createCeespuMCInstrAnalysis(const MCInstrInfo *Info) {
+  return new CeespuMCInstrAnalysis(Info);
+}
+
 static MCTargetStreamer *createCeespuObjectTargetStreamer(
     MCStreamer &S, const MCSubtargetInfo &STI) {
   const Triple &TT = STI.getTargetTriple();
@@ -87,6 +106,7 @@ extern "C" void LLVMInitializeCeespuTargetMC() {
   for (Target *T : {&getTheCeespuebTarget(), &getTheCeespuTarget()}) {
     TargetRegistry::RegisterMCAsmInfo(*T, createCeespuMCAsmInfo);
     TargetRegistry::RegisterMCInstrInfo(*T, createCeespuMCInstrInfo);
+    TargetRegistry::RegisterMCInstrAnalysis(*T, createCeespuMCInstrAnalysis);
     TargetRegistry::RegisterMCRegInfo(*T, createCeespuMCRegisterInfo);
     TargetRegistry::RegisterMCAsmBackend(*T, createCeespuAsmBackend);
     TargetRegistry::RegisterMCCodeEmitter(*T, createCeespuMCCodeEmitter);
@@ -0,0 +1,69 @@
+; RUN: opt < %s -cost-model -analyze -mtriple=ceespu | FileCheck %s
+
+; There is no divider, division by a variable is a call into the runtime
+; library.
+define i32 @sdiv(i32 %a, i32 %b) {
+; CHECK-LABEL: 'sdiv'
+; CHECK: cost of 64 {{.*}} sdiv
+  %r = sdiv i32 %a, %b
+  ret i32 %r
+}
+
+define i32 @urem(i32 %a, i32 %b) {
+; CHECK-LABEL: 'urem'
+; CHECK: cost of 64 {{.*}} urem
+  %r = urem i32 %a, %b
+  ret i32 %r
+}
+
+; Division by a constant multiplies by the reciprocal.
+define i32 @udiv_const(i32 %a) {
+; CHECK-LABEL: 'udiv_const'
+; CHECK: cost of 12 {{.*}} udiv
+  %r = udiv i32 %a, 10
+  ret i32 %r
+}
+
+define i32 @udiv_pow2(i32 %a) {
+; CHECK-LABEL: 'udiv_pow2'
+; CHECK: cost of 1 {{.*}} udiv
+  %r = udiv i32 %a, 16
+  ret i32 %r
+}
+
+define i32 @sdiv_pow2(i32 %a) {
+; CHECK-LABEL: 'sdiv_pow2'
+; CHECK: cost of 4 {{.*}} sdiv
+  %r = sdiv i32 %a, 16
+  ret i32 %r
+}
+
+; When optimizing for size, division by a constant other than an unsigned
+; power of two stays a library call.
+define i32 @udiv_const_minsize(i32 %a) minsize {
+; CHECK-LABEL: 'udiv_const_minsize'
+; CHECK: cost of 64 {{.*}} udiv
+  %r = udiv i32 %a, 10
+  ret i32 %r
+}
+
+define i32 @sdiv_pow2_minsize(i32 %a) minsize {
+; CHECK-LABEL: 'sdiv_pow2_minsize'
+; CHECK: cost of 64 {{.*}} sdiv
+  %r = sdiv i32 %a, 16
+  ret i32 %r
+}
+
+define i32 @urem_pow2_minsize(i32 %a) minsize {
+; CHECK-LABEL: 'urem_pow2_minsize'
+; CHECK: cost of 1 {{.*}} urem
+  %r = urem i32 %a, 16
+  ret i32 %r
+}
+
+define i32 @mul(i32 %a, i32 %b) {
+; CHECK-LABEL: 'mul'
+; CHECK: cost of 1 {{.*}} mul
+  %r = mul i32 %a, %b
+  ret i32 %r
+}
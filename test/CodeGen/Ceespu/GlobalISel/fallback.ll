@@ -0,0 +1,41 @@
+; RUN: llc -mtriple=ceespu -global-isel -global-isel-abort=2 \
+; RUN:   -pass-remarks-missed='gisel*' -verify-machineinstrs < %s \
+; RUN:   -o /dev/null 2>&1 | FileCheck %s --check-prefix=REMARK
+; RUN: llc -mtriple=ceespu -global-isel -global-isel-abort=2 \
+; RUN:   -verify-machineinstrs < %s 2>/dev/null | FileCheck %s
+; RUN: llc -mtriple=ceespu -O0 -debug-pass=Structure < %s -o /dev/null 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=O0
+; RUN: llc -mtriple=ceespu -O2 -debug-pass=Structure < %s -o /dev/null 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=O2
+
+; GlobalISel is used by default at -O0 only.
+; O0: IRTranslator
+; O0: InstructionSelect
+; O2-NOT: IRTranslator
+
+; Functions GlobalISel can not handle are compiled with SelectionDAG.
+
+; REMARK: remark: {{.*}} unable to lower arguments{{.*}}i64_arg
+; CHECK-LABEL: i64_arg:
+; CHECK: bx clr
+define i64 @i64_arg(i64 %a) {
+  ret i64 %a
+}
+
+; REMARK: remark: {{.*}} unable to legalize instruction{{.*}}udiv
+; CHECK-LABEL: udiv:
+; CHECK: call __udivsi3
+define i32 @udiv(i32 %a, i32 %b) {
+  %r = udiv i32 %a, %b
+  ret i32 %r
+}
+
+; A compare that is not used by a branch has no instruction to select.
+; REMARK: remark: {{.*}} cannot select{{.*}}G_ICMP
+; CHECK-LABEL: setcc:
+; CHECK: bx clr
+define i32 @setcc(i32 %a, i32 %b) {
+  %c = icmp ult i32 %a, %b
+  %r = zext i1 %c to i32
+  ret i32 %r
+}
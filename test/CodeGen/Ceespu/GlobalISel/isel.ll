@@ -0,0 +1,114 @@
+; RUN: llc -mtriple=ceespu -global-isel -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s
+
+; Instructions selected by the imported patterns and by hand.
+
+define i32 @add(i32 %a, i32 %b) {
+; CHECK-LABEL: add:
+; CHECK: add c20, c20, c21
+; CHECK-NEXT: bx clr
+  %r = add i32 %a, %b
+  ret i32 %r
+}
+
+define i32 @sub_imm(i32 %a) {
+; CHECK-LABEL: sub_imm:
+; CHECK: subi c20, c20, 12
+  %r = sub i32 %a, 12
+  ret i32 %r
+}
+
+define i32 @shifts(i32 %a, i32 %b) {
+; CHECK-LABEL: shifts:
+; CHECK: shl
+; CHECK: sari {{c[0-9]+}}, {{c[0-9]+}}, 3
+  %s = shl i32 %a, %b
+  %r = ashr i32 %s, 3
+  ret i32 %r
+}
+
+define zeroext i8 @load_byte(i8* %p) {
+; CHECK-LABEL: load_byte:
+; CHECK: lbu [[R:c[0-9]+]], 0(c20)
+; CHECK: andi c20, [[R]], 255
+  %v = load i8, i8* %p
+  ret i8 %v
+}
+
+; The legalizer turns sext(trunc) into a pair of shifts, which is selected
+; as a sign extension like sext_inreg.
+define signext i16 @sext_half(i32 %a) {
+; CHECK-LABEL: sext_half:
+; CHECK: seh c20, c20
+; CHECK-NEXT: bx clr
+  %t = trunc i32 %a to i16
+  ret i16 %t
+}
+
+define i32 @sext_byte(i32 %a) {
+; CHECK-LABEL: sext_byte:
+; CHECK: seb c20, c20
+; CHECK-NEXT: bx clr
+  %t = trunc i32 %a to i8
+  %r = sext i8 %t to i32
+  ret i32 %r
+}
+
+define i32 @sext_load(i8* %p) {
+; CHECK-LABEL: sext_load:
+; CHECK: lbu [[R:c[0-9]+]], 0(c20)
+; CHECK: seb c20, [[R]]
+  %v = load i8, i8* %p
+  %r = sext i8 %v to i32
+  ret i32 %r
+}
+
+define void @store_gep(i32* %p, i32 %v) {
+; CHECK-LABEL: store_gep:
+; CHECK: sw c21, 0({{c[0-9]+}})
+  %q = getelementptr i32, i32* %p, i32 3
+  store i32 %v, i32* %q
+  ret void
+}
+
+@g = global i32 0
+
+define i32 @load_global() {
+; CHECK-LABEL: load_global:
+; CHECK: lw c20, 0({{c[0-9]+}})
+  %v = load i32, i32* @g
+  ret i32 %v
+}
+
+define i32 @stack_slot(i32 %a) {
+; CHECK-LABEL: stack_slot:
+; CHECK: sw c20, [[OFF:-?[0-9]+]](csp)
+; CHECK: lw c20, [[OFF]](csp)
+  %p = alloca i32
+  store volatile i32 %a, i32* %p
+  %v = load volatile i32, i32* %p
+  ret i32 %v
+}
+
+; A compare is folded into the branch that uses it. The branch is inverted
+; so that the true block falls through.
+define i32 @branch(i32 %a, i32 %b) {
+; CHECK-LABEL: branch:
+; CHECK: bge c20, c21, .LBB
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %t, label %f
+t:
+  ret i32 1
+f:
+  ret i32 2
+}
+
+declare i32 @callee(i32, i32)
+
+define i32 @call(i32 %a) {
+; CHECK-LABEL: call:
+; CHECK: call callee
+  %r = call i32 @callee(i32 %a, i32 %a)
+  %s = add i32 %r, 1
+  ret i32 %s
+}
@@ -0,0 +1,73 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -filetype=obj < %s \
+; RUN:   -o /dev/null 2>&1
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s --check-prefixes=CHECK,SMALL
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -code-model=medium < %s \
+; RUN:   | FileCheck %s --check-prefixes=CHECK,MEDIUM
+
+; A conditional branch out of range is inverted to branch over a jump. The
+; target of a jump is an absolute 16-bit address. The small code model links
+; all code below 64K, where a plain jump reaches everything. In the other
+; models the address of the target is unknown, so every jump takes a SETI
+; prefix.
+
+define void @relax_bcc(i1 %a) nounwind {
+; CHECK-LABEL: relax_bcc:
+; CHECK: bne {{c[0-9]+}}, c0, .LBB0_1
+; SMALL-NEXT: b .LBB0_2
+; MEDIUM-NEXT: ; %bb.
+; MEDIUM-NEXT: seti %hi(.LBB0_2)
+; MEDIUM-NEXT: b %lo(.LBB0_2)
+; CHECK: .space 40000
+; CHECK: .LBB0_2:
+; CHECK: bx clr
+  br i1 %a, label %iftrue, label %tail
+
+iftrue:
+  call void asm sideeffect ".space 40000", ""()
+  br label %tail
+
+tail:
+  ret void
+}
+
+define i32 @relax_jmp(i1 %a) nounwind {
+; CHECK-LABEL: relax_jmp:
+; SMALL-NOT: seti
+; SMALL: b .LBB1_
+; MEDIUM: seti %hi(.LBB1_
+; MEDIUM-NEXT: b %lo(.LBB1_
+; CHECK: .space 40000
+  br i1 %a, label %iftrue, label %jmp
+
+jmp:
+  call void asm sideeffect "", ""()
+  br label %tail
+
+iftrue:
+  call void asm sideeffect "", ""()
+  br label %space
+
+space:
+  call void asm sideeffect ".space 40000", ""()
+  br label %tail
+
+tail:
+  ret i32 1
+}
+
+; Nearby blocks keep the short forms.
+define void @no_relax(i1 %a) nounwind {
+; CHECK-LABEL: no_relax:
+; CHECK-NOT: seti
+; CHECK: .space 1024
+; CHECK: bx clr
+  br i1 %a, label %iftrue, label %tail
+
+iftrue:
+  call void asm sideeffect ".space 1024", ""()
+  br label %tail
+
+tail:
+  ret void
+}
@@ -0,0 +1,108 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s | FileCheck %s
+
+; Block placement lays out the likely successor as the fall through, which
+; needs the branch condition to be reversed.
+
+define void @hot_sgt(i32 %a, i32 %b, i32* %p, i32* %q) nounwind {
+; CHECK-LABEL: hot_sgt:
+; CHECK: bge c21, c20, [[COLD:.LBB[0-9]+_[0-9]+]]
+; CHECK-NEXT: ; %bb.
+; CHECK-NEXT: sw c0, 0(c22)
+; CHECK: [[COLD]]:
+; CHECK-NEXT: sw c0, 0(c23)
+  %c = icmp sgt i32 %a, %b
+  br i1 %c, label %hot, label %cold, !prof !0
+cold:
+  store volatile i32 0, i32* %q
+  ret void
+hot:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @hot_sge(i32 %a, i32 %b, i32* %p, i32* %q) nounwind {
+; CHECK-LABEL: hot_sge:
+; CHECK: bg c21, c20, [[COLD:.LBB[0-9]+_[0-9]+]]
+; CHECK-NEXT: ; %bb.
+; CHECK-NEXT: sw c0, 0(c22)
+; CHECK: [[COLD]]:
+; CHECK-NEXT: sw c0, 0(c23)
+  %c = icmp sge i32 %a, %b
+  br i1 %c, label %hot, label %cold, !prof !0
+cold:
+  store volatile i32 0, i32* %q
+  ret void
+hot:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @hot_ugt(i32 %a, i32 %b, i32* %p, i32* %q) nounwind {
+; CHECK-LABEL: hot_ugt:
+; CHECK: bgeu c21, c20, [[COLD:.LBB[0-9]+_[0-9]+]]
+; CHECK-NEXT: ; %bb.
+; CHECK-NEXT: sw c0, 0(c22)
+; CHECK: [[COLD]]:
+; CHECK-NEXT: sw c0, 0(c23)
+  %c = icmp ugt i32 %a, %b
+  br i1 %c, label %hot, label %cold, !prof !0
+cold:
+  store volatile i32 0, i32* %q
+  ret void
+hot:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @hot_uge(i32 %a, i32 %b, i32* %p, i32* %q) nounwind {
+; CHECK-LABEL: hot_uge:
+; CHECK: bgu c21, c20, [[COLD:.LBB[0-9]+_[0-9]+]]
+; CHECK-NEXT: ; %bb.
+; CHECK-NEXT: sw c0, 0(c22)
+; CHECK: [[COLD]]:
+; CHECK-NEXT: sw c0, 0(c23)
+  %c = icmp uge i32 %a, %b
+  br i1 %c, label %hot, label %cold, !prof !0
+cold:
+  store volatile i32 0, i32* %q
+  ret void
+hot:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @hot_eq(i32 %a, i32 %b, i32* %p, i32* %q) nounwind {
+; CHECK-LABEL: hot_eq:
+; CHECK: bne c20, c21, [[COLD:.LBB[0-9]+_[0-9]+]]
+; CHECK-NEXT: ; %bb.
+; CHECK-NEXT: sw c0, 0(c22)
+; CHECK: [[COLD]]:
+; CHECK-NEXT: sw c0, 0(c23)
+  %c = icmp eq i32 %a, %b
+  br i1 %c, label %hot, label %cold, !prof !0
+cold:
+  store volatile i32 0, i32* %q
+  ret void
+hot:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @hot_ne(i32 %a, i32 %b, i32* %p, i32* %q) nounwind {
+; CHECK-LABEL: hot_ne:
+; CHECK: beq c20, c21, [[COLD:.LBB[0-9]+_[0-9]+]]
+; CHECK-NEXT: ; %bb.
+; CHECK-NEXT: sw c0, 0(c22)
+; CHECK: [[COLD]]:
+; CHECK-NEXT: sw c0, 0(c23)
+  %c = icmp ne i32 %a, %b
+  br i1 %c, label %hot, label %cold, !prof !0
+cold:
+  store volatile i32 0, i32* %q
+  ret void
+hot:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+!0 = !{!"branch_weights", i32 1000, i32 1}
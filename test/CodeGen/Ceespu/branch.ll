@@ -0,0 +1,138 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s | FileCheck %s
+
+; Every integer compare is a single branch. The less than forms use the
+; greater than branches with the operands swapped. The store is laid out as
+; the fall through, so each branch tests the inverted condition.
+
+define void @br_eq(i32 %a, i32 %b, i32* %p) nounwind {
+; CHECK-LABEL: br_eq:
+; CHECK: bne c20, c21, .LBB
+  %c = icmp eq i32 %a, %b
+  br i1 %c, label %t, label %f
+f:
+  ret void
+t:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @br_ne(i32 %a, i32 %b, i32* %p) nounwind {
+; CHECK-LABEL: br_ne:
+; CHECK: beq c20, c21, .LBB
+  %c = icmp ne i32 %a, %b
+  br i1 %c, label %t, label %f
+f:
+  ret void
+t:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @br_sgt(i32 %a, i32 %b, i32* %p) nounwind {
+; CHECK-LABEL: br_sgt:
+; CHECK: bge c21, c20, .LBB
+  %c = icmp sgt i32 %a, %b
+  br i1 %c, label %t, label %f
+f:
+  ret void
+t:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @br_sge(i32 %a, i32 %b, i32* %p) nounwind {
+; CHECK-LABEL: br_sge:
+; CHECK: bg c21, c20, .LBB
+  %c = icmp sge i32 %a, %b
+  br i1 %c, label %t, label %f
+f:
+  ret void
+t:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @br_ugt(i32 %a, i32 %b, i32* %p) nounwind {
+; CHECK-LABEL: br_ugt:
+; CHECK: bgeu c21, c20, .LBB
+  %c = icmp ugt i32 %a, %b
+  br i1 %c, label %t, label %f
+f:
+  ret void
+t:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @br_uge(i32 %a, i32 %b, i32* %p) nounwind {
+; CHECK-LABEL: br_uge:
+; CHECK: bgu c21, c20, .LBB
+  %c = icmp uge i32 %a, %b
+  br i1 %c, label %t, label %f
+f:
+  ret void
+t:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @br_slt(i32 %a, i32 %b, i32* %p) nounwind {
+; CHECK-LABEL: br_slt:
+; CHECK: bge c20, c21, .LBB
+  %c = icmp slt i32 %a, %b
+  br i1 %c, label %t, label %f
+f:
+  ret void
+t:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @br_sle(i32 %a, i32 %b, i32* %p) nounwind {
+; CHECK-LABEL: br_sle:
+; CHECK: bg c20, c21, .LBB
+  %c = icmp sle i32 %a, %b
+  br i1 %c, label %t, label %f
+f:
+  ret void
+t:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @br_ult(i32 %a, i32 %b, i32* %p) nounwind {
+; CHECK-LABEL: br_ult:
+; CHECK: bgeu c20, c21, .LBB
+  %c = icmp ult i32 %a, %b
+  br i1 %c, label %t, label %f
+f:
+  ret void
+t:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+define void @br_ule(i32 %a, i32 %b, i32* %p) nounwind {
+; CHECK-LABEL: br_ule:
+; CHECK: bgu c20, c21, .LBB
+  %c = icmp ule i32 %a, %b
+  br i1 %c, label %t, label %f
+f:
+  ret void
+t:
+  store volatile i32 0, i32* %p
+  ret void
+}
+
+; A branch on a boolean compares it against zero.
+
+define void @br_bool(i1 %c, i32* %p) nounwind {
+; CHECK-LABEL: br_bool:
+; CHECK: beq {{c[0-9]+}}, c0, .LBB
+  br i1 %c, label %t, label %f
+f:
+  ret void
+t:
+  store volatile i32 0, i32* %p
+  ret void
+}
@@ -0,0 +1,62 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s | FileCheck %s
+
+; Division and remainder by a constant multiply by the reciprocal. The high
+; half of the product is built from four 16x16 partial products.
+
+define i32 @udiv10(i32 %a) nounwind {
+; CHECK-LABEL: udiv10:
+; CHECK-NOT: call
+; CHECK: mul
+; CHECK: mul
+; CHECK: mul
+; CHECK: mul
+; CHECK-NOT: call
+; CHECK: bx clr
+  %r = udiv i32 %a, 10
+  ret i32 %r
+}
+
+define i32 @urem10(i32 %a) nounwind {
+; CHECK-LABEL: urem10:
+; CHECK-NOT: call
+; CHECK: bx clr
+  %r = urem i32 %a, 10
+  ret i32 %r
+}
+
+define i32 @sdiv7(i32 %a) nounwind {
+; CHECK-LABEL: sdiv7:
+; CHECK-NOT: call
+; CHECK: sari
+; CHECK: bx clr
+  %r = sdiv i32 %a, 7
+  ret i32 %r
+}
+
+define i32 @mulhu(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: mulhu:
+; CHECK-NOT: call
+; CHECK: bx clr
+  %1 = zext i32 %a to i64
+  %2 = zext i32 %b to i64
+  %3 = mul i64 %1, %2
+  %4 = lshr i64 %3, 32
+  %5 = trunc i64 %4 to i32
+  ret i32 %5
+}
+
+; The libcall is smaller.
+define i32 @udiv10_minsize(i32 %a) nounwind minsize {
+; CHECK-LABEL: udiv10_minsize:
+; CHECK: call __udivsi3
+  %r = udiv i32 %a, 10
+  ret i32 %r
+}
+
+; Division by a variable is still a libcall.
+define i32 @udiv_var(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: udiv_var:
+; CHECK: call __udivsi3
+  %r = udiv i32 %a, %b
+  ret i32 %r
+}
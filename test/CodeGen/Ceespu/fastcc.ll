@@ -0,0 +1,82 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s | FileCheck %s
+
+; Local functions whose address is not taken use the fast convention, which
+; passes ten arguments and returns six values in registers.
+
+declare void @use(i32 (i32, i32, i32, i32, i32, i32, i32, i32)*)
+
+define internal i32 @sum8(i32 %a, i32 %b, i32 %c, i32 %d, i32 %e, i32 %f,
+                          i32 %g, i32 %h) noinline nounwind {
+; CHECK-LABEL: sum8:
+; CHECK: add c20, c20, c26
+; CHECK-NEXT: add c20, c20, c27
+; CHECK-NEXT: bx clr
+  %1 = add i32 %a, %g
+  %2 = add i32 %1, %h
+  ret i32 %2
+}
+
+define i32 @ext8(i32 %a, i32 %b, i32 %c, i32 %d, i32 %e, i32 %f,
+                 i32 %g, i32 %h) noinline nounwind {
+; CHECK-LABEL: ext8:
+; CHECK: lw {{c[0-9]+}}, 0(csp)
+; CHECK: lw {{c[0-9]+}}, 4(csp)
+  %1 = add i32 %a, %g
+  %2 = add i32 %1, %h
+  ret i32 %2
+}
+
+define internal i32 @taken8(i32 %a, i32 %b, i32 %c, i32 %d, i32 %e, i32 %f,
+                            i32 %g, i32 %h) noinline nounwind {
+; The address of taken8 escapes, so it keeps the C convention.
+; CHECK-LABEL: taken8:
+; CHECK: lw {{c[0-9]+}}, 0(csp)
+; CHECK: lw {{c[0-9]+}}, 4(csp)
+  %1 = add i32 %a, %g
+  %2 = add i32 %1, %h
+  ret i32 %2
+}
+
+define i32 @caller(i32 %x) nounwind {
+; CHECK-LABEL: caller:
+; CHECK: {{addi|or}} c27,
+; CHECK: call sum8
+; CHECK: sw {{c[0-9]+}}, 0(csp)
+; CHECK-NEXT: call ext8
+  %1 = call i32 @sum8(i32 %x, i32 1, i32 2, i32 3, i32 4, i32 5, i32 6, i32 7)
+  %2 = call i32 @ext8(i32 %x, i32 1, i32 2, i32 3, i32 4, i32 5, i32 6, i32 7)
+  %3 = add i32 %1, %2
+  call void @use(i32 (i32, i32, i32, i32, i32, i32, i32, i32)* @taken8)
+  ret i32 %3
+}
+
+define internal fastcc { i32, i32, i32, i32, i32 } @ret5(i32 %x) noinline nounwind {
+; CHECK-LABEL: ret5:
+; CHECK: or c24, c20, c0
+; CHECK-NEXT: bx clr
+  %1 = insertvalue { i32, i32, i32, i32, i32 } undef, i32 %x, 0
+  %2 = insertvalue { i32, i32, i32, i32, i32 } %1, i32 1, 1
+  %3 = insertvalue { i32, i32, i32, i32, i32 } %2, i32 2, 2
+  %4 = insertvalue { i32, i32, i32, i32, i32 } %3, i32 3, 3
+  %5 = insertvalue { i32, i32, i32, i32, i32 } %4, i32 %x, 4
+  ret { i32, i32, i32, i32, i32 } %5
+}
+
+define i32 @get5(i32 %x) nounwind {
+; CHECK-LABEL: get5:
+; CHECK: call ret5
+; CHECK: c20, c24
+  %r = call fastcc { i32, i32, i32, i32, i32 } @ret5(i32 %x)
+  %e = extractvalue { i32, i32, i32, i32, i32 } %r, 4
+  ret i32 %e
+}
+
+define { i32, i32, i32, i32, i32 } @cret5(i32 %x) nounwind {
+; The C convention returns at most four values in registers.
+; CHECK-LABEL: cret5:
+; CHECK-DAG: sw c21, 0(c20)
+; CHECK-DAG: sw c21, 16(c20)
+  %1 = insertvalue { i32, i32, i32, i32, i32 } undef, i32 %x, 0
+  %2 = insertvalue { i32, i32, i32, i32, i32 } %1, i32 %x, 4
+  ret { i32, i32, i32, i32, i32 } %2
+}
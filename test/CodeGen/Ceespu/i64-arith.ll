@@ -0,0 +1,126 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s | FileCheck %s
+
+; 64-bit arithmetic passes the carry between the halves.
+
+define i64 @add64(i64 %a, i64 %b) nounwind {
+; CHECK-LABEL: add64:
+; CHECK: add c20, c20, c22
+; CHECK-NEXT: adc
+; CHECK-NEXT: bx clr
+  %r = add i64 %a, %b
+  ret i64 %r
+}
+
+define i64 @sub64(i64 %a, i64 %b) nounwind {
+; CHECK-LABEL: sub64:
+; CHECK: sub c20, c20, c22
+; CHECK-NEXT: sbb
+; CHECK-NEXT: bx clr
+  %r = sub i64 %a, %b
+  ret i64 %r
+}
+
+; The comparison of the high halves consumes the borrow of the low halves.
+define i1 @ult64(i64 %a, i64 %b) nounwind {
+; CHECK-LABEL: ult64:
+; CHECK: sub c20, c20, c22
+; CHECK: sbb
+; CHECK: adci {{c[0-9]+}}, c0, 0
+; CHECK: bx clr
+  %r = icmp ult i64 %a, %b
+  ret i1 %r
+}
+
+; A branch on the overflow bit branches on the carry with bc. The sum is
+; needed before the branch, so a swapped copy of the add sets the carry.
+define i32 @uadd_overflow(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: uadd_overflow:
+; CHECK: add c20, [[A:c[0-9]+]], [[B:c[0-9]+]]
+; CHECK-NEXT: add {{c[0-9]+}}, [[B]], [[A]]
+; CHECK-NEXT: bc
+; CHECK-NOT: adci
+entry:
+  %t = call {i32, i1} @llvm.uadd.with.overflow.i32(i32 %a, i32 %b)
+  %o = extractvalue {i32, i1} %t, 1
+  br i1 %o, label %overflow, label %done
+overflow:
+  ret i32 -1
+done:
+  %v = extractvalue {i32, i1} %t, 0
+  ret i32 %v
+}
+
+define i32 @uadd_overflow_only(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: uadd_overflow_only:
+; CHECK: add c20, c20, c21
+; CHECK-NEXT: bc
+entry:
+  %t = call {i32, i1} @llvm.uadd.with.overflow.i32(i32 %a, i32 %b)
+  %o = extractvalue {i32, i1} %t, 1
+  br i1 %o, label %overflow, label %done
+overflow:
+  ret i32 -1
+done:
+  ret i32 0
+}
+
+; A subtraction cannot be repeated with its operands swapped, so the carry
+; is set again from the borrow that was read out of it.
+define i32 @usub_overflow_branch(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: usub_overflow_branch:
+; CHECK: sub c20, c20, c21
+; CHECK-NEXT: adci [[OV:c[0-9]+]], c0, 0
+; CHECK-NEXT: addi [[OV]], [[OV]], -1
+; CHECK-NEXT: bc
+entry:
+  %t = call {i32, i1} @llvm.usub.with.overflow.i32(i32 %a, i32 %b)
+  %o = extractvalue {i32, i1} %t, 1
+  br i1 %o, label %overflow, label %done
+overflow:
+  ret i32 -1
+done:
+  %v = extractvalue {i32, i1} %t, 0
+  ret i32 %v
+}
+
+define i1 @usub_overflow(i32 %a, i32 %b, i32* %p) nounwind {
+; CHECK-LABEL: usub_overflow:
+; CHECK: sub c21, c20, c21
+; CHECK: adci {{c[0-9]+}}, c0, 0
+  %t = call {i32, i1} @llvm.usub.with.overflow.i32(i32 %a, i32 %b)
+  %v = extractvalue {i32, i1} %t, 0
+  store i32 %v, i32* %p
+  %o = extractvalue {i32, i1} %t, 1
+  ret i1 %o
+}
+
+; Variable shifts are expanded inline.
+define i64 @shl64(i64 %a, i64 %b) nounwind {
+; CHECK-LABEL: shl64:
+; CHECK-NOT: call
+; CHECK: shl
+; CHECK: bx clr
+  %r = shl i64 %a, %b
+  ret i64 %r
+}
+
+define i64 @ashr64(i64 %a, i64 %b) nounwind {
+; CHECK-LABEL: ashr64:
+; CHECK-NOT: call
+; CHECK: sar
+; CHECK: bx clr
+  %r = ashr i64 %a, %b
+  ret i64 %r
+}
+
+define i64 @lshr64(i64 %a, i64 %b) nounwind {
+; CHECK-LABEL: lshr64:
+; CHECK-NOT: call
+; CHECK: shr
+; CHECK: bx clr
+  %r = lshr i64 %a, %b
+  ret i64 %r
+}
+
+declare {i32, i1} @llvm.uadd.with.overflow.i32(i32, i32)
+declare {i32, i1} @llvm.usub.with.overflow.i32(i32, i32)
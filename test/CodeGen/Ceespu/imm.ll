@@ -0,0 +1,77 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -ceespu-hoist-constants=false \
+; RUN:   < %s | FileCheck -check-prefix=NOHOIST %s
+
+; Materializing constants into registers.
+
+define i32 @zero() nounwind {
+; CHECK-LABEL: zero:
+; CHECK: addi c20, c0, 0
+  ret i32 0
+}
+
+define i32 @simm16() nounwind {
+; CHECK-LABEL: simm16:
+; CHECK-NOT: seti
+; CHECK: addi c20, c0, -1234
+  ret i32 -1234
+}
+
+define i32 @shifted() nounwind {
+; CHECK-LABEL: shifted:
+; CHECK-NOT: seti
+; CHECK: addi c20, c0, 9
+; CHECK-NEXT: shli c20, c20, 17
+  ret i32 1179648
+}
+
+define i32 @imm32() nounwind {
+; CHECK-LABEL: imm32:
+; CHECK: seti 4660
+; CHECK-NEXT: addi c20, c0, 22136
+  ret i32 305419896
+}
+
+define i32 @imm32_lo_signbit() nounwind {
+; CHECK-LABEL: imm32_lo_signbit:
+; CHECK: seti 4660
+; CHECK-NEXT: addi c20, c0, -32767
+  ret i32 305430529
+}
+
+define i32 @add_imm32(i32 %a) nounwind {
+; CHECK-LABEL: add_imm32:
+; CHECK: seti 4660
+; CHECK-NEXT: addi c20, c20, 22136
+  %1 = add i32 %a, 305419896
+  ret i32 %1
+}
+
+; Large loop-invariant constants are loaded once in the preheader.
+
+define void @xor_loop(i32* %p, i32 %n) nounwind {
+; CHECK-LABEL: xor_loop:
+; CHECK: seti 4660
+; CHECK-NEXT: addi [[C:c[0-9]+]], c0, 22136
+; CHECK: .LBB{{[0-9]+}}_{{[0-9]+}}:
+; CHECK-NOT: seti
+; CHECK: xor {{c[0-9]+}}, {{c[0-9]+}}, [[C]]
+; CHECK: bne
+; NOHOIST-LABEL: xor_loop:
+; NOHOIST: .LBB{{[0-9]+}}_{{[0-9]+}}:
+; NOHOIST: seti 4660
+; NOHOIST-NEXT: xori {{c[0-9]+}}, {{c[0-9]+}}, 22136
+entry:
+  br label %loop
+loop:
+  %i = phi i32 [ 0, %entry ], [ %inc, %loop ]
+  %a = getelementptr i32, i32* %p, i32 %i
+  %v = load i32, i32* %a
+  %x = xor i32 %v, 305419896
+  store i32 %x, i32* %a
+  %inc = add i32 %i, 1
+  %c = icmp ne i32 %inc, %n
+  br i1 %c, label %loop, label %exit
+exit:
+  ret void
+}
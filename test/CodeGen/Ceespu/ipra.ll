@@ -0,0 +1,81 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -enable-ipra=false < %s \
+; RUN:   | FileCheck %s --check-prefix=NOIPRA
+
+define i32 @leaf(i32 %a, i32 %b) noinline nounwind {
+  %s = add i32 %a, %b
+  ret i32 %s
+}
+
+; leaf only clobbers c20, so the values live across the calls stay in
+; caller-saved registers and nothing but clr is saved.
+define i32 @caller(i32 %x, i32 %y, i32 %z) nounwind {
+; CHECK-LABEL: caller:
+; CHECK: addi csp, csp, -4
+; CHECK-NEXT: sw clr, 0(csp)
+; CHECK-NOT: sw
+; CHECK: call leaf
+; CHECK: call leaf
+; CHECK: call leaf
+; CHECK-NOT: lw {{c[0-9]+}}
+; CHECK: bx clr
+; NOIPRA-LABEL: caller:
+; NOIPRA-DAG: sw c1,
+; NOIPRA-DAG: sw c2,
+; NOIPRA: call leaf
+; NOIPRA-DAG: lw c1,
+; NOIPRA-DAG: lw c2,
+  %1 = call i32 @leaf(i32 %x, i32 %y)
+  %2 = call i32 @leaf(i32 %1, i32 %z)
+  %3 = call i32 @leaf(i32 %2, i32 %x)
+  %4 = add i32 %3, %y
+  %5 = add i32 %4, %z
+  ret i32 %5
+}
+
+declare i32 @ext(i32, i32)
+
+define i32 @tail(i32 %a) nounwind {
+  %r = tail call i32 @ext(i32 %a, i32 %a)
+  ret i32 %r
+}
+
+; tail clobbers whatever ext clobbers, so %x has to be kept in a callee-saved
+; register.
+define i32 @caller_tail(i32 %x) nounwind {
+; CHECK-LABEL: caller_tail:
+; CHECK: or c12, c20, c0
+; CHECK-NEXT: call tail
+; CHECK-NEXT: add c20, c20, c12
+  %1 = call i32 @tail(i32 %x)
+  %2 = add i32 %1, %x
+  ret i32 %2
+}
+
+define weak i32 @hook(i32 %a) noinline nounwind {
+  ret i32 %a
+}
+
+define linkonce_odr i32 @inl(i32 %a) noinline nounwind {
+  ret i32 %a
+}
+
+; The linker may pick another definition of a weak or linkonce_odr callee,
+; so its register usage is not trusted and the values live across the calls
+; are kept in callee-saved registers.
+define i32 @user(i32 %x, i32 %y) nounwind {
+; CHECK-LABEL: user:
+; CHECK-DAG: sw c1,
+; CHECK-DAG: sw c12,
+; CHECK-DAG: or c12, c21, c0
+; CHECK-DAG: or c1, c20, c0
+; CHECK: call hook
+; CHECK-NEXT: call inl
+; CHECK-NEXT: add c20, c20, c1
+; CHECK-NEXT: add c20, c20, c12
+  %1 = call i32 @hook(i32 %x)
+  %2 = call i32 @inl(i32 %1)
+  %3 = add i32 %2, %x
+  %4 = add i32 %3, %y
+  ret i32 %4
+}
@@ -0,0 +1,177 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -filetype=obj < %s \
+; RUN:   -o /dev/null
+; RUN: llc -mtriple=ceespu -verify-machineinstrs \
+; RUN:   -ceespu-compact-jump-table-limit=0 < %s \
+; RUN:   | FileCheck %s --check-prefix=WIDE
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -align-all-blocks=15 \
+; RUN:   < %s | FileCheck %s --check-prefix=LARGE
+
+; Small functions use 16-bit entries holding the offset of the destination
+; from the start of the function.
+define void @dense(i32 %x, i32* %p) nounwind {
+; CHECK-LABEL: dense:
+; CHECK: bgu {{c[0-9]+}}, {{c[0-9]+}}, .LBB0_{{[0-9]+}}
+; CHECK: seti %hi(.LJTI0_0)
+; CHECK: lhu [[OFF:c[0-9]+]],
+; CHECK: seti %hi(dense)
+; CHECK: add [[DST:c[0-9]+]], {{.*}}[[OFF]]
+; CHECK: bx [[DST]]
+; CHECK: .section .rodata
+; CHECK-NEXT: .p2align 1
+; CHECK-NEXT: .LJTI0_0:
+; CHECK-NEXT: .hword .LBB0_2-dense
+; CHECK-NEXT: .hword .LBB0_3-dense
+
+; Padding before aligned blocks takes the function past the reach of 16-bit
+; offsets, so the entries are 32-bit offsets instead.
+; LARGE-LABEL: dense:
+; LARGE: shli [[IDX:c[0-9]+]], {{c[0-9]+}}, 2
+; LARGE: lw [[OFF:c[0-9]+]],
+; LARGE: seti %hi(dense)
+; LARGE: add [[DST:c[0-9]+]], {{.*}}[[OFF]]
+; LARGE: bx [[DST]]
+; LARGE: .section .rodata
+; LARGE-NEXT: .p2align 2
+; LARGE-NEXT: .LJTI0_0:
+; LARGE-NEXT: .word .LBB0_2-dense
+; LARGE-NEXT: .word .LBB0_3-dense
+
+; WIDE-LABEL: dense:
+; WIDE: shli [[IDX:c[0-9]+]], {{c[0-9]+}}, 2
+; WIDE: lw [[DST:c[0-9]+]],
+; WIDE: bx [[DST]]
+; WIDE: .section .rodata
+; WIDE-NEXT: .p2align 2
+; WIDE-NEXT: .LJTI0_0:
+; WIDE-NEXT: .word .LBB0_2
+; WIDE-NEXT: .word .LBB0_3
+entry:
+  switch i32 %x, label %exit [
+    i32 1, label %bb1
+    i32 2, label %bb2
+    i32 3, label %bb3
+    i32 4, label %bb4
+    i32 5, label %bb5
+    i32 6, label %bb6
+  ]
+bb1:
+  store i32 4, i32* %p
+  br label %exit
+bb2:
+  store i32 3, i32* %p
+  br label %exit
+bb3:
+  store i32 2, i32* %p
+  br label %exit
+bb4:
+  store i32 1, i32* %p
+  br label %exit
+bb5:
+  store i32 100, i32* %p
+  br label %exit
+bb6:
+  store i32 200, i32* %p
+  br label %exit
+exit:
+  ret void
+}
+
+; The assembler may still relax the conditional branches, so the choice of
+; entry width leaves room for each of them to grow by four bytes.
+; CHECK-LABEL: near_limit:
+; CHECK: .LJTI1_0:
+; CHECK-NEXT: .hword
+define void @near_limit(i32 %x, i32* %p) nounwind {
+entry:
+  switch i32 %x, label %exit [
+    i32 1, label %bb1
+    i32 2, label %bb2
+    i32 3, label %bb3
+    i32 4, label %bb4
+    i32 5, label %bb5
+    i32 6, label %bb6
+  ]
+bb1:
+  store i32 4, i32* %p
+  br label %exit
+bb2:
+  store i32 3, i32* %p
+  br label %exit
+bb3:
+  store i32 2, i32* %p
+  br label %exit
+bb4:
+  store i32 1, i32* %p
+  br label %exit
+bb5:
+  store i32 100, i32* %p
+  br label %exit
+bb6:
+  store i32 200, i32* %p
+  call void asm sideeffect ".space 65404", ""()
+  br label %exit
+exit:
+  ret void
+}
+
+; CHECK-LABEL: over_limit:
+; CHECK: .LJTI2_0:
+; CHECK-NEXT: .word
+define void @over_limit(i32 %x, i32* %p) nounwind {
+entry:
+  switch i32 %x, label %exit [
+    i32 1, label %bb1
+    i32 2, label %bb2
+    i32 3, label %bb3
+    i32 4, label %bb4
+    i32 5, label %bb5
+    i32 6, label %bb6
+  ]
+bb1:
+  store i32 4, i32* %p
+  br label %exit
+bb2:
+  store i32 3, i32* %p
+  br label %exit
+bb3:
+  store i32 2, i32* %p
+  br label %exit
+bb4:
+  store i32 1, i32* %p
+  br label %exit
+bb5:
+  store i32 100, i32* %p
+  br label %exit
+bb6:
+  store i32 200, i32* %p
+  call void asm sideeffect ".space 65408", ""()
+  br label %exit
+exit:
+  ret void
+}
+
+
+; Below the subtarget threshold the switch stays a compare and branch ladder.
+define void @sparse(i32 %x, i32* %p) nounwind {
+; CHECK-LABEL: sparse:
+; CHECK-NOT: bx c
+; CHECK: bx clr
+entry:
+  switch i32 %x, label %exit [
+    i32 1, label %bb1
+    i32 2, label %bb2
+    i32 3, label %bb3
+  ]
+bb1:
+  store i32 4, i32* %p
+  br label %exit
+bb2:
+  store i32 3, i32* %p
+  br label %exit
+bb3:
+  store i32 2, i32* %p
+  br label %exit
+exit:
+  ret void
+}
@@ -0,0 +1,96 @@
+; RUN: llc -mtriple=ceespu < %s | FileCheck %s
+; RUN: llc -mtriple=ceespu -ceespu-align-branch-targets < %s \
+; RUN:   | FileCheck %s --check-prefix=TARGETS
+; RUN: llc -mtriple=ceespu -ceespu-loop-align=0 < %s \
+; RUN:   | FileCheck %s --check-prefix=NOALIGN
+
+; Small loops have their header aligned to a fetch block.
+define i32 @sum(i32* %p, i32 %n) nounwind {
+; CHECK-LABEL: sum:
+; CHECK: .p2align 3
+; CHECK-NEXT: .LBB0_{{[0-9]+}}:
+; NOALIGN-LABEL: sum:
+; NOALIGN-NOT: .p2align
+; NOALIGN: bx clr
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  %addr = getelementptr i32, i32* %p, i32 %i
+  %v = load i32, i32* %addr
+  %acc.next = add i32 %acc, %v
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  ret i32 %r
+}
+
+; Aligning large loops does not pay off.
+define void @big(i32 %n) nounwind {
+; CHECK-LABEL: big:
+; CHECK-NOT: .p2align
+; CHECK: bx clr
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  call void asm sideeffect ".space 256", ""()
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
+
+; Nor does it when optimizing for size.
+define i32 @sum_size(i32* %p, i32 %n) nounwind optsize {
+; CHECK-LABEL: sum_size:
+; CHECK-NOT: .p2align
+; CHECK: bx clr
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  %addr = getelementptr i32, i32* %p, i32 %i
+  %v = load i32, i32* %addr
+  %acc.next = add i32 %acc, %v
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  ret i32 %r
+}
+
+; Branch targets outside loops are only aligned on request.
+define i32 @select(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: select:
+; CHECK-NOT: .p2align
+; CHECK: bx clr
+; TARGETS-LABEL: select:
+; TARGETS: .p2align 3
+; TARGETS-NEXT: .LBB3_{{[0-9]+}}:
+entry:
+  %cmp = icmp eq i32 %a, 0
+  br i1 %cmp, label %then, label %exit
+
+then:
+  call void asm sideeffect "", ""()
+  br label %exit
+
+exit:
+  %r = phi i32 [ %b, %then ], [ %a, %entry ]
+  ret i32 %r
+}
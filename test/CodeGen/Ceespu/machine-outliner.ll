@@ -0,0 +1,123 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -enable-ipra=false < %s \
+; RUN:   | FileCheck %s
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -enable-ipra=false \
+; RUN:   -enable-machine-outliner=false < %s \
+; RUN:   | FileCheck %s --check-prefix=NOOUTLINE
+; RUN: llc -mtriple=ceespu -debug-pass=Structure < %s -o /dev/null 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=PASSES
+; RUN: llc -mtriple=ceespu -enable-machine-outliner -debug-pass=Structure \
+; RUN:   < %s -o /dev/null 2>&1 | FileCheck %s --check-prefix=PASSES
+; RUN: llc -mtriple=ceespu -O0 -debug-pass=Structure < %s -o /dev/null 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=O0
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s --check-prefix=IPRA
+
+; The outliner is added once, after branch relaxation.
+; PASSES: Branch relaxation pass
+; PASSES: Machine Outliner
+; PASSES-NOT: Machine Outliner
+; O0-NOT: Machine Outliner
+
+@g = global [8 x i32] zeroinitializer
+
+declare void @callee(i32, i32, i32, i32)
+declare void @other()
+
+; The argument setup and the call are outlined together. The outlined
+; function tail calls the callee.
+define void @thunk1(i32 %x) minsize nounwind {
+; CHECK-LABEL: thunk1:
+; CHECK: call OUTLINED_FUNCTION_{{[0-9]+}}
+; CHECK-NEXT: call OUTLINED_FUNCTION_[[THUNK:[0-9]+]]
+; NOOUTLINE-LABEL: thunk1:
+; NOOUTLINE: call callee
+  call void @other()
+  call void @callee(i32 %x, i32 %x, i32 %x, i32 %x)
+  ret void
+}
+
+define void @thunk2(i32 %x) minsize nounwind {
+; CHECK-LABEL: thunk2:
+; CHECK: call other
+; CHECK-NEXT: call OUTLINED_FUNCTION_[[THUNK]]
+  call void @other()
+  call void @other()
+  call void @callee(i32 %x, i32 %x, i32 %x, i32 %x)
+  ret void
+}
+
+define void @thunk3(i32 %x) minsize nounwind {
+; CHECK-LABEL: thunk3:
+; CHECK: call other
+; CHECK-NEXT: call other
+; CHECK-NEXT: call OUTLINED_FUNCTION_[[THUNK]]
+  call void @other()
+  call void @other()
+  call void @other()
+  call void @callee(i32 %x, i32 %x, i32 %x, i32 %x)
+  ret void
+}
+
+; The link register is live after the stores, so it is kept in a free
+; caller-saved register around the call. With IPRA, callers expect save1 to
+; leave every such register alone, so nothing is outlined.
+define void @save1(i32 %x) minsize nounwind {
+; IPRA-LABEL: save1:
+; IPRA-NOT: call
+; IPRA: bx clr
+; CHECK-LABEL: save1:
+; CHECK: or [[SAVE:c[0-9]+]], clr, c0
+; CHECK-NEXT: call OUTLINED_FUNCTION_[[SAVED:[0-9]+]]
+; CHECK-NEXT: or clr, [[SAVE]], c0
+  store volatile i32 11, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 1)
+  store volatile i32 12, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 2)
+  store volatile i32 13, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 3)
+  store volatile i32 14, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 4)
+  store volatile i32 %x, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 5)
+  ret void
+}
+
+define void @save2(i32 %x) minsize nounwind {
+; CHECK-LABEL: save2:
+; CHECK: call OUTLINED_FUNCTION_[[SAVED]]
+  store volatile i32 11, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 1)
+  store volatile i32 12, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 2)
+  store volatile i32 13, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 3)
+  store volatile i32 14, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 4)
+  store volatile i32 %x, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 6)
+  ret void
+}
+
+define void @save3(i32 %x) minsize nounwind {
+; CHECK-LABEL: save3:
+; CHECK: call OUTLINED_FUNCTION_[[SAVED]]
+  store volatile i32 11, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 1)
+  store volatile i32 12, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 2)
+  store volatile i32 13, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 3)
+  store volatile i32 14, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 4)
+  store volatile i32 %x, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 7)
+  ret void
+}
+
+; Only functions built for minimum size are outlined from.
+define void @not_minsize(i32 %x) nounwind {
+; CHECK-LABEL: not_minsize:
+; CHECK-NOT: OUTLINED_FUNCTION
+; CHECK: bx clr
+  store volatile i32 11, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 1)
+  store volatile i32 12, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 2)
+  store volatile i32 13, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 3)
+  store volatile i32 14, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 4)
+  store volatile i32 %x, i32* getelementptr ([8 x i32], [8 x i32]* @g, i32 0, i32 5)
+  ret void
+}
+
+; CHECK: OUTLINED_FUNCTION_[[SAVED]]:
+; CHECK: sw {{c[0-9]+}}, %lo(g+16)(c0)
+; CHECK-NEXT: bx clr
+
+; CHECK: OUTLINED_FUNCTION_[[THUNK]]:
+; CHECK: or c23, c12, c0
+; CHECK-NEXT: b callee
+
+; NOOUTLINE-NOT: OUTLINED_FUNCTION
@@ -0,0 +1,50 @@
+; RUN: llc -mtriple=ceespu -ceespu-enable-pipeliner -verify-machineinstrs \
+; RUN:   < %s | FileCheck %s
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s --check-prefix=NOPIPE
+
+; The kernel stores the product of an earlier iteration while the load and
+; the first multiply of the next iterations are already in flight. The
+; prolog and epilog branch past the kernel for short trip counts.
+define void @scale(i32* noalias nocapture readonly %a, i32* noalias nocapture %b,
+                   i32 %k, i32 %n) {
+; CHECK-LABEL: scale:
+; CHECK: lw
+; CHECK: mul
+; CHECK: beq {{c[0-9]+}}, c0, [[EPI2:.LBB0_[0-9]+]]
+; CHECK: beq {{c[0-9]+}}, c0, [[EPI1:.LBB0_[0-9]+]]
+; CHECK: [[KERNEL:.LBB0_[0-9]+]]:
+; CHECK: sw
+; CHECK-NEXT: lw
+; CHECK: bne {{c[0-9]+}}, c0, [[KERNEL]]
+; CHECK: [[EPI1]]:
+; CHECK-NEXT: sw
+; CHECK: [[EPI2]]:
+; CHECK-NEXT: mul
+; CHECK-NEXT: sw
+; NOPIPE-LABEL: scale:
+; NOPIPE: [[LOOP:.LBB0_[0-9]+]]:
+; NOPIPE-NEXT: ; =>This Inner Loop Header
+; NOPIPE-NEXT: lw
+; NOPIPE: sw
+; NOPIPE: bne {{c[0-9]+}}, c0, [[LOOP]]
+; NOPIPE-NEXT: .LBB0_{{[0-9]+}}: ; %exit
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %loop, label %exit
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %pa = getelementptr inbounds i32, i32* %a, i32 %i
+  %pb = getelementptr inbounds i32, i32* %b, i32 %i
+  %va = load i32, i32* %pa
+  %sq = mul i32 %va, %va
+  %m = mul i32 %sq, %k
+  store i32 %m, i32* %pb
+  %i.next = add nuw nsw i32 %i, 1
+  %done = icmp eq i32 %i.next, %n
+  br i1 %done, label %exit, label %loop
+
+exit:
+  ret void
+}
@@ -0,0 +1,139 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -ceespu-save-restore=false \
+; RUN:   < %s | FileCheck %s --check-prefix=INLINE
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -ceespu-save-restore=true \
+; RUN:   < %s | FileCheck %s --check-prefix=FORCE
+
+declare i32 @f(i32)
+
+; Functions built for size hand clr to the save routine in c13, and return
+; through the restore routine.
+define i32 @three(i32 %a, i32 %b, i32 %c) nounwind optsize {
+; CHECK-LABEL: three:
+; CHECK:      addi c13, clr, 0
+; CHECK-NEXT: call __ceespu_save_5
+; CHECK-NOT:  sw
+; CHECK-NOT:  lw
+; CHECK:      b __ceespu_restore_5
+; CHECK-NEXT: .Lfunc_end0:
+
+; INLINE-LABEL: three:
+; INLINE: addi csp, csp, -24
+; INLINE: sw clr, 20(csp)
+; INLINE: lw clr, 20(csp)
+; INLINE: addi csp, csp, 24
+; INLINE-NEXT: bx clr
+  %x = call i32 @f(i32 %a)
+  %y = call i32 @f(i32 %b)
+  %z = call i32 @f(i32 %c)
+  %s1 = add i32 %x, %y
+  %s2 = add i32 %s1, %z
+  %s3 = add i32 %s2, %a
+  %s4 = add i32 %s3, %b
+  ret i32 %s4
+}
+
+; The restore routine returns to the caller, so a block that ends in a tail
+; call restores the registers from the slots the save routine used.
+define i32 @tail(i32 %a, i32 %b) nounwind optsize {
+; CHECK-LABEL: tail:
+; CHECK:      call __ceespu_save_2
+; CHECK:      lw c12, 4(csp)
+; CHECK:      lw c1, 0(csp)
+; CHECK-NEXT: lw clr, 8(csp)
+; CHECK-NEXT: addi csp, csp, 12
+; CHECK-NEXT: b f
+  %x = call i32 @f(i32 %a)
+  %y = add i32 %x, %b
+  %z = add i32 %y, %a
+  %r = tail call i32 @f(i32 %z)
+  ret i32 %r
+}
+
+; The rest of the frame is allocated after the save routine has allocated
+; the area for the registers, and released before jumping to the restore
+; routine.
+define i32 @locals(i32 %a, i32 %b) nounwind optsize {
+; CHECK-LABEL: locals:
+; CHECK:      call __ceespu_save_2
+; CHECK-NEXT: addi csp, csp, -8
+; CHECK:      addi csp, csp, 8
+; CHECK-NEXT: b __ceespu_restore_2
+  %buf = alloca [2 x i32]
+  %p = getelementptr [2 x i32], [2 x i32]* %buf, i32 0, i32 0
+  %q = getelementptr [2 x i32], [2 x i32]* %buf, i32 0, i32 1
+  store volatile i32 %a, i32* %p
+  %x = call i32 @f(i32 %b)
+  store volatile i32 %x, i32* %q
+  %y = call i32 @f(i32 %a)
+  %v = load volatile i32, i32* %p
+  %s = add i32 %y, %v
+  %t = add i32 %s, %b
+  ret i32 %t
+}
+
+; A leaf function with one register to save keeps its stores and loads.
+define i32 @leaf(i32 %a, i32 %b) nounwind optsize {
+; CHECK-LABEL: leaf:
+; CHECK-NOT: __ceespu_save
+; CHECK: sw c12, 0(csp)
+; CHECK: lw c12, 0(csp)
+; CHECK-NOT: __ceespu_restore
+; CHECK: bx clr
+  call void asm sideeffect "", "~{r12}"()
+  %y = add i32 %a, %b
+  ret i32 %y
+}
+
+; Functions that are not built for size save their registers themselves
+; unless asked otherwise.
+define i32 @speed(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: speed:
+; CHECK-NOT: __ceespu_save
+; CHECK: bx clr
+
+; FORCE-LABEL: speed:
+; FORCE: call __ceespu_save_3
+; FORCE: b __ceespu_restore_3
+  %x = call i32 @f(i32 %a)
+  %y = call i32 @f(i32 %b)
+  %s = add i32 %x, %y
+  %t = add i32 %s, %a
+  ret i32 %t
+}
+
+; Each routine that is used is emitted once, in a COMDAT group of its own.
+; CHECK:      .section .text.__ceespu_save_2,"axG",@progbits,__ceespu_save_2,comdat
+; CHECK-NEXT: .p2align 2
+; CHECK-NEXT: .globl __ceespu_save_2
+; CHECK-NEXT: .hidden __ceespu_save_2
+; CHECK-NEXT: .type __ceespu_save_2,@function
+; CHECK-NEXT: __ceespu_save_2:
+; CHECK-NEXT: addi csp, csp, -12
+; CHECK-NEXT: sw c13, 8(csp)
+; CHECK-NEXT: sw c12, 4(csp)
+; CHECK-NEXT: sw c1, 0(csp)
+; CHECK-NEXT: bx clr
+; CHECK:      .section .text.__ceespu_save_5,"axG",@progbits,__ceespu_save_5,comdat
+; CHECK:      __ceespu_save_5:
+; CHECK-NEXT: addi csp, csp, -24
+; CHECK-NEXT: sw c13, 20(csp)
+; CHECK-NEXT: sw c12, 16(csp)
+; CHECK-NEXT: sw c1, 12(csp)
+; CHECK-NEXT: sw c2, 8(csp)
+; CHECK-NEXT: sw c3, 4(csp)
+; CHECK-NEXT: sw c4, 0(csp)
+; CHECK-NEXT: bx clr
+; CHECK:      .section .text.__ceespu_restore_2,"axG",@progbits,__ceespu_restore_2,comdat
+; CHECK:      __ceespu_restore_2:
+; CHECK-NEXT: lw clr, 8(csp)
+; CHECK-NEXT: lw c12, 4(csp)
+; CHECK-NEXT: lw c1, 0(csp)
+; CHECK-NEXT: addi csp, csp, 12
+; CHECK-NEXT: bx clr
+; CHECK-NEXT: .Ltmp{{[0-9]+}}:
+; CHECK-NEXT: .size __ceespu_restore_2, .Ltmp{{[0-9]+}}-__ceespu_restore_2
+; CHECK:      .section .text.__ceespu_restore_5,"axG",@progbits,__ceespu_restore_5,comdat
+; CHECK-NOT:  __ceespu_save
+
+; INLINE-NOT: __ceespu_
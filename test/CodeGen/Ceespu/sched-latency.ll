@@ -0,0 +1,80 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -enable-misched=false \
+; RUN:   < %s | FileCheck %s
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -enable-post-misched=false \
+; RUN:   < %s | FileCheck %s
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -disable-post-ra < %s \
+; RUN:   | FileCheck %s --check-prefix=PRERA
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -disable-post-ra \
+; RUN:   -enable-misched=false < %s | FileCheck %s --check-prefix=NOSCHED
+
+; Loads and multiplies take more than a cycle, so independent instructions
+; are scheduled between them and their uses. After register allocation
+; either the post-RA machine scheduler or the list scheduler does this.
+
+define i32 @load_use(i32* %p, i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: load_use:
+; CHECK: lw [[V:c[0-9]+]], 0(c20)
+; CHECK-NEXT: xor
+; CHECK: addi {{c[0-9]+}}, [[V]], 7
+
+; NOSCHED-LABEL: load_use:
+; NOSCHED: lw [[V:c[0-9]+]], 0(c20)
+; NOSCHED-NEXT: addi {{c[0-9]+}}, [[V]], 7
+  %v = load i32, i32* %p
+  %r = add i32 %v, 7
+  %x = xor i32 %a, %b
+  %y = shl i32 %x, 3
+  %s = or i32 %r, %y
+  ret i32 %s
+}
+
+define i32 @mul_use(i32 %m, i32 %n, i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: mul_use:
+; CHECK: mul [[V:c[0-9]+]], c20, c21
+; CHECK-NEXT: xor
+; CHECK-NEXT: shli
+; CHECK-NEXT: addi {{c[0-9]+}}, [[V]], 7
+
+; NOSCHED-LABEL: mul_use:
+; NOSCHED: mul [[V:c[0-9]+]], c20, c21
+; NOSCHED-NEXT: addi {{c[0-9]+}}, [[V]], 7
+  %v = mul i32 %m, %n
+  %r = add i32 %v, 7
+  %x = xor i32 %a, %b
+  %y = shl i32 %x, 3
+  %s = or i32 %r, %y
+  ret i32 %s
+}
+
+; Before register allocation the machine scheduler starts the second load
+; early to cover the multiply.
+define i32 @two_chains(i32* %p, i32* %q) nounwind {
+; CHECK-LABEL: two_chains:
+; CHECK: lw [[A:c[0-9]+]], 0(c20)
+; CHECK-NEXT: lw [[B:c[0-9]+]], 0(c21)
+; CHECK-NEXT: addi [[A]], [[A]], 1
+; CHECK-NEXT: addi [[B]], [[B]], 2
+; CHECK-NEXT: mul [[A]], [[A]], [[A]]
+; CHECK-NEXT: mul [[B]], [[B]], [[B]]
+
+; PRERA-LABEL: two_chains:
+; PRERA: lw [[A:c[0-9]+]], 0(c20)
+; PRERA-NEXT: addi [[A]], [[A]], 1
+; PRERA-NEXT: lw [[B:c[0-9]+]], 0(c21)
+; PRERA-NEXT: mul [[A]], [[A]], [[A]]
+
+; NOSCHED-LABEL: two_chains:
+; NOSCHED: lw [[A:c[0-9]+]], 0(c20)
+; NOSCHED-NEXT: addi [[A]], [[A]], 1
+; NOSCHED-NEXT: mul [[A]], [[A]], [[A]]
+; NOSCHED-NEXT: lw
+  %a = load i32, i32* %p
+  %a1 = add i32 %a, 1
+  %a2 = mul i32 %a1, %a1
+  %b = load i32, i32* %q
+  %b1 = add i32 %b, 2
+  %b2 = mul i32 %b1, %b1
+  %s = add i32 %a2, %b2
+  ret i32 %s
+}
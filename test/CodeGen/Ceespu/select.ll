@@ -0,0 +1,53 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -ceespu-select-branch-cost=0 \
+; RUN:   < %s | FileCheck -check-prefix=BRANCH %s
+
+; Cheap selects are lowered to a compare mask instead of a branch.
+
+define i32 @umin(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: umin:
+; CHECK: sub [[M:c[0-9]+]], c20, c21
+; CHECK-NEXT: sbb [[M]], c0, c0
+; CHECK-NOT: {{bg|beq|bne}}
+; CHECK: bx clr
+; BRANCH-LABEL: umin:
+; BRANCH: bgu c21, c20, .LBB
+  %cmp = icmp ult i32 %a, %b
+  %r = select i1 %cmp, i32 %a, i32 %b
+  ret i32 %r
+}
+
+define i32 @neg_or_zero(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: neg_or_zero:
+; CHECK: sari [[M:c[0-9]+]], c20, 31
+; CHECK-NEXT: and c20, [[M]], c21
+; CHECK-NOT: {{bg|beq|bne}}
+  %cmp = icmp slt i32 %a, 0
+  %r = select i1 %cmp, i32 %b, i32 0
+  ret i32 %r
+}
+
+define i32 @setult(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: setult:
+; CHECK: sub [[M:c[0-9]+]], c20, c21
+; CHECK-NEXT: sbb [[M]], c0, c0
+; CHECK-NEXT: andi c20, [[M]], 1
+  %cmp = icmp ult i32 %a, %b
+  %r = zext i1 %cmp to i32
+  ret i32 %r
+}
+
+; A signed compare of two registers needs too many instructions, so it keeps
+; the branch. Both selects share it.
+
+define i32 @smax_pair(i32 %a, i32 %b, i32 %c, i32 %d) nounwind {
+; CHECK-LABEL: smax_pair:
+; CHECK: bg c20, c21, .LBB
+; CHECK-NOT: {{bg|beq|bne}}
+; CHECK: bx clr
+  %cmp = icmp sgt i32 %a, %b
+  %x = select i1 %cmp, i32 %c, i32 %d
+  %y = select i1 %cmp, i32 %d, i32 %c
+  %r = sub i32 %x, %y
+  ret i32 %r
+}
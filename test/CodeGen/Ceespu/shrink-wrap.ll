@@ -0,0 +1,94 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s | FileCheck %s
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -enable-shrink-wrap=false \
+; RUN:   < %s | FileCheck %s --check-prefix=NOSW
+
+declare i32 @slow_lookup(i32)
+declare i32 @use(i32*)
+
+; Only the miss path makes a call, so the frame is set up and torn down
+; there, and the hit path returns without touching the stack.
+define i32 @lookup(i32* %cache, i32 %key) nounwind {
+; CHECK-LABEL: lookup:
+; CHECK-NOT: csp
+; CHECK: bne c20, c0, [[EXIT:.LBB[0-9_]+]]
+; CHECK: addi csp, csp, -4
+; CHECK: sw clr, 0(csp)
+; CHECK: call slow_lookup
+; CHECK: lw clr, 0(csp)
+; CHECK-NEXT: addi csp, csp, 4
+; CHECK-NEXT: [[EXIT]]:
+; CHECK-NEXT: bx clr
+
+; NOSW-LABEL: lookup:
+; NOSW: addi csp, csp, -4
+; NOSW: sw clr, 0(csp)
+; NOSW: bne
+; NOSW: lw clr, 0(csp)
+; NOSW-NEXT: addi csp, csp, 4
+; NOSW-NEXT: bx clr
+entry:
+  %slot = getelementptr inbounds i32, i32* %cache, i32 %key
+  %v = load i32, i32* %slot
+  %hit = icmp ne i32 %v, 0
+  br i1 %hit, label %exit, label %miss
+
+miss:
+  %r = call i32 @slow_lookup(i32 %key)
+  %r1 = add i32 %r, 1
+  br label %exit
+
+exit:
+  %res = phi i32 [ %v, %entry ], [ %r1, %miss ]
+  ret i32 %res
+}
+
+; The frame pointer is set up after the shrink-wrapped save point too, and
+; the stack pointer is restored from it before the early return joins.
+define i32 @with_fp(i32 %n) nounwind "no-frame-pointer-elim"="true" {
+; CHECK-LABEL: with_fp:
+; CHECK-NOT: csp
+; CHECK: beq c20, c0
+; CHECK: addi csp, csp, -4
+; CHECK: addi cfp, csp, 4
+; CHECK: call use
+; CHECK: addi csp, cfp, -4
+; CHECK-NEXT: lw clr, 0(csp)
+; CHECK-NEXT: addi csp, csp, 4
+entry:
+  %c = icmp eq i32 %n, 0
+  br i1 %c, label %exit, label %work
+
+work:
+  %a = alloca [8 x i32]
+  %p = getelementptr [8 x i32], [8 x i32]* %a, i32 0, i32 0
+  %r = call i32 @use(i32* %p)
+  br label %exit
+
+exit:
+  %res = phi i32 [ 0, %entry ], [ %r, %work ]
+  ret i32 %res
+}
+
+; A frame too large for an immediate adjustment needs a scratch register, so
+; it stays in the entry and return blocks.
+define i32 @large_frame(i32 %n) nounwind {
+; CHECK-LABEL: large_frame:
+; CHECK: sub csp,
+; CHECK: beq c20, c0
+; CHECK: call use
+; CHECK: add csp,
+; CHECK-NEXT: bx clr
+entry:
+  %a = alloca [40000 x i32]
+  %c = icmp eq i32 %n, 0
+  br i1 %c, label %exit, label %work
+
+work:
+  %p = getelementptr [40000 x i32], [40000 x i32]* %a, i32 0, i32 0
+  %r = call i32 @use(i32* %p)
+  br label %exit
+
+exit:
+  %res = phi i32 [ 0, %entry ], [ %r, %work ]
+  ret i32 %res
+}
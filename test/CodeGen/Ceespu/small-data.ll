@@ -0,0 +1,74 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs -ceespu-ssection-threshold=8 \
+; RUN:   < %s | FileCheck %s
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s \
+; RUN:   | FileCheck %s --check-prefix=NOSMALL
+
+@counter = global i32 0
+@state = global [2 x i32] [i32 1, i32 2]
+@ext = external global i32
+@table = global [16 x i32] zeroinitializer
+@limit = constant i32 100
+
+; Small objects are a single access relative to c0.
+define i32 @count() nounwind {
+; CHECK-LABEL: count:
+; CHECK: lw [[R:c[0-9]+]], %abs(counter)(c0)
+; CHECK-NOT: seti
+; CHECK: sw {{c[0-9]+}}, %abs(counter)(c0)
+; NOSMALL-LABEL: count:
+; NOSMALL: seti %hi(counter)
+  %v = load i32, i32* @counter
+  %n = add i32 %v, 1
+  store i32 %n, i32* @counter
+  ret i32 %v
+}
+
+define i32 @offset() nounwind {
+; CHECK-LABEL: offset:
+; CHECK: lw {{c[0-9]+}}, %abs(state+4)(c0)
+  %p = getelementptr [2 x i32], [2 x i32]* @state, i32 0, i32 1
+  %v = load i32, i32* %p
+  ret i32 %v
+}
+
+define i32* @address() nounwind {
+; CHECK-LABEL: address:
+; CHECK: ori c20, c0, %abs(counter)
+  ret i32* @counter
+}
+
+; Declarations are assumed to follow the same threshold.
+define i32 @load_ext() nounwind {
+; CHECK-LABEL: load_ext:
+; CHECK: lw {{c[0-9]+}}, %abs(ext)(c0)
+  %v = load i32, i32* @ext
+  ret i32 %v
+}
+
+; Larger objects fold the address, and any constant offset, into a SETI
+; prefixed access.
+define i32 @load_table() nounwind {
+; CHECK-LABEL: load_table:
+; CHECK: seti %hi(table+12)
+; CHECK-NEXT: lw {{c[0-9]+}}, %lo(table+12)(c0)
+  %p = getelementptr [16 x i32], [16 x i32]* @table, i32 0, i32 3
+  %v = load i32, i32* %p
+  ret i32 %v
+}
+
+define void @store_table(i32 %x) nounwind {
+; CHECK-LABEL: store_table:
+; CHECK: seti %hi(table+8)
+; CHECK-NEXT: sw c20, %lo(table+8)(c0)
+  %p = getelementptr [16 x i32], [16 x i32]* @table, i32 0, i32 2
+  store i32 %x, i32* %p
+  ret void
+}
+
+; CHECK: .section .sbss
+; CHECK: counter:
+; CHECK: .section .sdata
+; CHECK: state:
+; CHECK: .section .srodata
+; CHECK: limit:
+; NOSMALL-NOT: .sdata
@@ -0,0 +1,88 @@
+; RUN: llc -mtriple=ceespu -verify-machineinstrs < %s | FileCheck %s
+
+declare i32 @callee(i32, i32)
+declare i32 @callee_many(i32, i32, i32, i32, i32, i32, i32)
+declare void @use(i32*)
+declare extern_weak void @weak_callee()
+
+; A direct call in tail position is a plain jump. The link register is not
+; touched, so there is nothing to save.
+define i32 @tail_direct(i32 %a, i32 %b) nounwind {
+; CHECK-LABEL: tail_direct:
+; CHECK-NOT: call
+; CHECK: b callee
+  %r = tail call i32 @callee(i32 %b, i32 %a)
+  ret i32 %r
+}
+
+; Indirect tail calls jump through a register that holds no argument and is
+; not restored by the epilogue.
+define i32 @tail_indirect(i32 (i32, i32)* %f, i32 %a) nounwind {
+; CHECK-LABEL: tail_indirect:
+; CHECK-NOT: callr
+; CHECK: bx c{{1[3-5]|2[6-9]|3[01]}}
+  %r = tail call i32 %f(i32 %a, i32 %a)
+  ret i32 %r
+}
+
+; The fast convention passes arguments in c26-c29, so the target goes in one
+; of the other registers that the epilogue leaves alone.
+define fastcc i32 @tail_indirect_fast(i32 (i32, i32, i32, i32, i32, i32, i32,
+                                           i32, i32, i32)* %f, i32 %a) nounwind {
+; CHECK-LABEL: tail_indirect_fast:
+; CHECK-NOT: callr
+; CHECK: bx c{{1[3-5]|3[01]}}
+  %r = tail call fastcc i32 %f(i32 %a, i32 %a, i32 %a, i32 %a, i32 %a, i32 %a,
+                               i32 %a, i32 %a, i32 %a, i32 %a)
+  ret i32 %r
+}
+
+; Library calls are tail called too.
+define void @tail_libcall(i8* %p, i32 %n) nounwind {
+; CHECK-LABEL: tail_libcall:
+; CHECK: b memset
+  tail call void @llvm.memset.p0i8.i32(i8* %p, i8 0, i32 %n, i1 false)
+  ret void
+}
+
+declare void @llvm.memset.p0i8.i32(i8*, i8, i32, i1)
+
+; The frame is released before the jump.
+define i32 @tail_with_frame(i32 %a) nounwind {
+; CHECK-LABEL: tail_with_frame:
+; CHECK: call use
+; CHECK: addi csp, csp, {{[0-9]+}}
+; CHECK-NEXT: b callee
+  %x = alloca i32
+  call void @use(i32* %x)
+  %r = tail call i32 @callee(i32 %a, i32 %a)
+  ret i32 %r
+}
+
+; Arguments passed on the stack would overwrite the caller's frame.
+define i32 @no_tail_stack_args(i32 %a) nounwind {
+; CHECK-LABEL: no_tail_stack_args:
+; CHECK: call callee_many
+; CHECK: bx clr
+  %r = tail call i32 @callee_many(i32 %a, i32 %a, i32 %a, i32 %a, i32 %a,
+                                  i32 %a, i32 %a)
+  ret i32 %r
+}
+
+; An extern_weak callee may resolve to null.
+define void @no_tail_weak() nounwind {
+; CHECK-LABEL: no_tail_weak:
+; CHECK: call weak_callee
+; CHECK: bx clr
+  tail call void @weak_callee()
+  ret void
+}
+
+; The attribute turns tail calls off.
+define i32 @no_tail_disabled(i32 %a) nounwind "disable-tail-calls"="true" {
+; CHECK-LABEL: no_tail_disabled:
+; CHECK: call callee
+; CHECK: bx clr
+  %r = tail call i32 @callee(i32 %a, i32 %a)
+  ret i32 %r
+}
@@ -0,0 +1,13 @@
+# RUN: llvm-mc -filetype=obj -triple=ceespu < %s \
+# RUN:     | llvm-objdump -d - | FileCheck %s
+
+# Alignment padding in code is made of nops.
+
+# CHECK: 0: {{.*}} add c1, c2, c3
+# CHECK-NEXT: 4: 00 00 21 00 add c1, c1, c0
+# CHECK-NEXT: 8: 00 00 21 00 add c1, c1, c0
+# CHECK-NEXT: c: 00 00 21 00 add c1, c1, c0
+# CHECK-NEXT: 10: {{.*}} sub c1, c2, c3
+add c1, c2, c3
+.p2align 4
+sub c1, c2, c3
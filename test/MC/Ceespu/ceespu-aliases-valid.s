@@ -0,0 +1,14 @@
+# RUN: llvm-mc %s -triple=ceespu -show-encoding | FileCheck %s
+# RUN: llvm-mc -filetype=obj -triple=ceespu < %s \
+# RUN:     | llvm-objdump -d - | FileCheck %s
+
+# CHECK: addi c1, c2, 0
+mov c1, c2
+# CHECK: add c1, c0, c1
+nop
+# CHECK: xori c3, c4, -1
+not c3, c4
+# CHECK: lw c1, 0(c2)
+lw c1, (c2)
+# CHECK: sw c1, 0(csp)
+sw c1, (csp)
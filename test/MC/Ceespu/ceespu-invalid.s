@@ -0,0 +1,29 @@
+# RUN: not llvm-mc -triple ceespu < %s 2>&1 | FileCheck %s
+
+## uimm5
+shli c1, c2, 32 ; CHECK: :[[@LINE]]:14: error: immediate must be an integer in the range [0, 31]
+sari c1, c2, -1 ; CHECK: :[[@LINE]]:14: error: immediate must be an integer in the range [0, 31]
+
+## uimm16
+seti 65536 ; CHECK: :[[@LINE]]:6: error: immediate must be an integer in the range [-32768, 65535]
+seti %lo(foo) ; CHECK: :[[@LINE]]:6: error: immediate must be an integer in the range [-32768, 65535]
+
+## Branch and jump targets
+beq c1, c2, 32768 ; CHECK: :[[@LINE]]:13: error: branch target must be a symbol or a multiple of 4 bytes in the range [-32768, 32764]
+bne c1, c2, 6 ; CHECK: :[[@LINE]]:13: error: branch target must be a symbol or a multiple of 4 bytes in the range [-32768, 32764]
+beq c1, c2, %lo(foo) ; CHECK: :[[@LINE]]:13: error: branch target must be a symbol or a multiple of 4 bytes in the range [-32768, 32764]
+b 2 ; CHECK: :[[@LINE]]:3: error: jump target must be a symbol or a word aligned address
+call %hi(foo) ; CHECK: :[[@LINE]]:6: error: jump target must be a symbol or a word aligned address
+
+## Memory operands
+lw c1, c2 ; CHECK: :[[@LINE]]:8: error: operand must be a memory operand 'offset(reg)'
+sw c1, 4 ; CHECK: :[[@LINE]]:8: error: operand must be a memory operand 'offset(reg)'
+lw c1, 4(c33) ; CHECK: :[[@LINE]]:10: error: expected register
+
+## Operand modifiers
+addi c1, c2, %pcrel_lo(foo) ; CHECK: :[[@LINE]]:15: error: unrecognized operand modifier
+
+## Invalid mnemonics and operands
+ret ; CHECK: :[[@LINE]]:1: error: unrecognized instruction mnemonic
+add c1, c2 ; CHECK: :[[@LINE]]:1: error: too few operands for instruction
+add c1, c2, 3 ; CHECK: :[[@LINE]]:13: error: invalid operand for instruction
@@ -0,0 +1,53 @@
+# RUN: llvm-mc %s -triple=ceespu -show-encoding \
+# RUN:     | FileCheck -check-prefix=CHECK-ASM %s
+# RUN: llvm-mc -filetype=obj -triple=ceespu < %s \
+# RUN:     | llvm-objdump -d - | FileCheck -check-prefix=CHECK-OBJ %s
+
+# Immediates that do not fit the instruction are split into a SETI prefix and
+# the low 16 bits. The disassembler shows the pair as a single instruction.
+
+# CHECK-ASM: seti 4660
+# CHECK-ASM: encoding: [0x34,0x12,0x00,0xa8]
+# CHECK-ASM: addi c1, c2, 22136
+# CHECK-ASM: encoding: [0x78,0x56,0x22,0x40]
+# CHECK-OBJ: addi c1, c2, 305419896
+addi c1, c2, 0x12345678
+
+# CHECK-ASM: seti 0
+# CHECK-ASM: addi c1, c2, -32768
+# CHECK-OBJ: addi c1, c2, 32768
+addi c1, c2, 32768
+
+# CHECK-ASM: seti 65535
+# CHECK-ASM: ori c1, c0, 0
+# CHECK-OBJ: ori c1, c0, -65536
+ori c1, c0, -65536
+
+# CHECK-ASM: seti 1
+# CHECK-ASM: lw c1, 4(c2)
+# CHECK-OBJ: lw c1, 65540(c2)
+lw c1, 65540(c2)
+
+# CHECK-ASM: seti 1
+# CHECK-ASM: sw c1, -32768(c2)
+# CHECK-OBJ: sw c1, 98304(c2)
+sw c1, 98304(c2)
+
+# CHECK-ASM: seti 2
+# CHECK-ASM: b 256
+# CHECK-OBJ: b 131328
+b 0x20100
+
+# CHECK-ASM: seti 2
+# CHECK-ASM: call 256
+# CHECK-OBJ: call 131328
+call 0x20100
+
+# An explicit prefix is kept as written.
+# CHECK-ASM: seti 4660
+# CHECK-ASM: encoding: [0x34,0x12,0x00,0xa8]
+# CHECK-ASM: add c1, c2, c3
+# CHECK-OBJ: seti 4660
+# CHECK-OBJ-NEXT: add c1, c2, c3
+seti 0x1234
+add c1, c2, c3
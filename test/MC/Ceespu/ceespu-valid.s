@@ -0,0 +1,138 @@
+# RUN: llvm-mc %s -triple=ceespu -show-encoding \
+# RUN:     | FileCheck -check-prefixes=CHECK,CHECK-INST %s
+# RUN: llvm-mc -filetype=obj -triple=ceespu < %s \
+# RUN:     | llvm-objdump -d - | FileCheck -check-prefix=CHECK-INST %s
+
+# CHECK-INST: add c1, c2, c3
+# CHECK: encoding: [0x00,0x18,0x22,0x00]
+add c1, c2, c3
+# CHECK-INST: adc c1, c2, c3
+# CHECK: encoding: [0x00,0x18,0x22,0x04]
+adc c1, c2, c3
+# CHECK-INST: sub c20, c21, c31
+# CHECK: encoding: [0x00,0xf8,0x95,0x0a]
+sub c20, c21, c31
+# CHECK-INST: sbb c1, c2, c3
+# CHECK: encoding: [0x00,0x18,0x22,0x0c]
+sbb c1, c2, c3
+# CHECK-INST: or c1, c2, c3
+# CHECK: encoding: [0x00,0x18,0x22,0x10]
+or c1, c2, c3
+# CHECK-INST: and c1, c2, c3
+# CHECK: encoding: [0x00,0x18,0x22,0x14]
+and c1, c2, c3
+# CHECK-INST: xor c1, c2, c3
+# CHECK: encoding: [0x00,0x18,0x22,0x18]
+xor c1, c2, c3
+# CHECK-INST: mul c1, c2, c3
+# CHECK: encoding: [0x00,0x18,0x22,0x24]
+mul c1, c2, c3
+# CHECK-INST: shl c1, c2, c3
+# CHECK: encoding: [0x00,0x18,0x22,0x20]
+shl c1, c2, c3
+# CHECK-INST: shr c1, c2, c3
+# CHECK: encoding: [0x40,0x18,0x22,0x20]
+shr c1, c2, c3
+# CHECK-INST: sar c1, c2, c3
+# CHECK: encoding: [0x80,0x18,0x22,0x20]
+sar c1, c2, c3
+# CHECK-INST: seb c1, c2
+# CHECK: encoding: [0x00,0x00,0x22,0x1c]
+seb c1, c2
+# CHECK-INST: seh c1, c2
+# CHECK: encoding: [0x01,0x00,0x22,0x1c]
+seh c1, c2
+# CHECK-INST: addi c1, c2, -1
+# CHECK: encoding: [0xff,0xff,0x22,0x40]
+addi c1, c2, -1
+# CHECK-INST: adci c1, c2, 5
+# CHECK: encoding: [0x05,0x00,0x22,0x44]
+adci c1, c2, 5
+# CHECK-INST: subi csp, csp, 16
+# CHECK: encoding: [0x10,0x00,0x52,0x4a]
+subi csp, csp, 16
+# CHECK-INST: sbbi c1, c2, -32768
+# CHECK: encoding: [0x00,0x80,0x22,0x4c]
+sbbi c1, c2, -32768
+# CHECK-INST: ori c1, c0, 32767
+# CHECK: encoding: [0xff,0x7f,0x20,0x50]
+ori c1, c0, 32767
+# CHECK-INST: andi c1, c2, 15
+# CHECK: encoding: [0x0f,0x00,0x22,0x54]
+andi c1, c2, 15
+# CHECK-INST: xori c1, c2, -1
+# CHECK: encoding: [0xff,0xff,0x22,0x58]
+xori c1, c2, -1
+# CHECK-INST: muli c1, c2, 10
+# CHECK: encoding: [0x0a,0x00,0x22,0x64]
+muli c1, c2, 10
+# CHECK-INST: shli c1, c2, 0
+# CHECK: encoding: [0x00,0x00,0x22,0x60]
+shli c1, c2, 0
+# CHECK-INST: shri c1, c2, 31
+# CHECK: encoding: [0x5f,0x00,0x22,0x60]
+shri c1, c2, 31
+# CHECK-INST: sari c1, c2, 1
+# CHECK: encoding: [0x81,0x00,0x22,0x60]
+sari c1, c2, 1
+# CHECK-INST: lw c1, 8(csp)
+# CHECK: encoding: [0x08,0x00,0x32,0x80]
+lw c1, 8(csp)
+# CHECK-INST: lh c1, -2(c2)
+# CHECK: encoding: [0xfe,0xff,0x22,0x84]
+lh c1, -2(c2)
+# CHECK-INST: lhu c1, 2(c2)
+# CHECK: encoding: [0x02,0x00,0x22,0x8c]
+lhu c1, 2(c2)
+# CHECK-INST: lb c1, -1(c2)
+# CHECK: encoding: [0xff,0xff,0x22,0x88]
+lb c1, -1(c2)
+# CHECK-INST: lbu c1, 1(c2)
+# CHECK: encoding: [0x01,0x00,0x22,0x90]
+lbu c1, 1(c2)
+# CHECK-INST: sw clr, 12(csp)
+# CHECK: encoding: [0x0c,0x98,0x12,0xd0]
+sw clr, 12(csp)
+# CHECK-INST: sh c1, -4096(c2)
+# CHECK: encoding: [0x00,0x08,0xc2,0xd7]
+sh c1, -4096(c2)
+# CHECK-INST: sb c1, 2047(cfp)
+# CHECK: encoding: [0xff,0x0f,0x10,0xd8]
+sb c1, 2047(cfp)
+# CHECK-INST: beq c1, c2, 16
+# CHECK: encoding: [0x10,0x10,0x01,0xe0]
+beq c1, c2, 16
+# CHECK-INST: bne c1, c0, -8
+# CHECK: encoding: [0xf8,0x07,0xe1,0xe7]
+bne c1, c0, -8
+# CHECK-INST: bgu c1, c2, 4096
+# CHECK: encoding: [0x00,0x10,0x41,0xe8]
+bgu c1, c2, 4096
+# CHECK-INST: bgeu c1, c2, -4096
+# CHECK: encoding: [0x00,0x10,0xc1,0xef]
+bgeu c1, c2, -4096
+# CHECK-INST: bg c1, c2, 32764
+# CHECK: encoding: [0xfc,0x17,0xe1,0xf1]
+bg c1, c2, 32764
+# CHECK-INST: bge c1, c2, -32768
+# CHECK: encoding: [0x00,0x10,0x01,0xf6]
+bge c1, c2, -32768
+# CHECK-INST: b 256
+# CHECK: encoding: [0x00,0x01,0x00,0xfc]
+b 256
+# CHECK-INST: call 256
+# CHECK: encoding: [0x01,0x01,0x00,0xfc]
+call 256
+# CHECK-INST: bx c5
+# CHECK: encoding: [0x02,0x00,0x05,0xfc]
+bx c5
+# CHECK-INST: bx clr
+# CHECK: encoding: [0x02,0x00,0x13,0xfc]
+bx clr
+# CHECK-INST: callr c5
+# CHECK: encoding: [0x03,0x00,0x05,0xfc]
+callr c5
+
+# CHECK-INST: bc 256
+# CHECK: encoding: [0x00,0x01,0x00,0xf8]
+bc 256
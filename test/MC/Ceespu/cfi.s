@@ -0,0 +1,32 @@
+# RUN: llvm-mc %s -triple=ceespu | FileCheck %s
+# RUN: llvm-mc -filetype=obj -triple=ceespu < %s \
+# RUN:     | llvm-dwarfdump -debug-frame - | FileCheck -check-prefix=DWARF %s
+# RUN: not llvm-mc -triple=ceespu -defsym=ERR=1 < %s 2>&1 \
+# RUN:     | FileCheck -check-prefix=ERR %s
+
+# Registers in CFI directives are numbered by their encoding.
+
+# DWARF: Return address column: 19
+# DWARF: DW_CFA_def_cfa_register: reg16
+# DWARF: DW_CFA_offset: reg19 -4
+# DWARF: DW_CFA_offset: reg12 -8
+
+f:
+  .cfi_startproc
+# CHECK: .cfi_def_cfa_register cfp
+  .cfi_def_cfa_register cfp
+  addi csp, csp, -8
+# CHECK: .cfi_offset clr, -4
+  .cfi_offset clr, -4
+# CHECK: .cfi_offset c12, -8
+  .cfi_offset c12, -8
+  .cfi_endproc
+
+.ifdef ERR
+  .cfi_startproc
+# ERR: :[[@LINE+1]]:15: error: invalid register name
+  .cfi_offset c32, -4
+# ERR: :[[@LINE+1]]:25: error: invalid register name
+  .cfi_def_cfa_register %c1
+  .cfi_endproc
+.endif
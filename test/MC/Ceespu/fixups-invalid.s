@@ -0,0 +1,13 @@
+# RUN: not llvm-mc -triple=ceespu -filetype=obj < %s -o /dev/null 2>&1 \
+# RUN:     | FileCheck %s
+
+# Compact jump table entries are 16-bit offsets from the start of the
+# function, which must reach every block.
+
+.Lfunc:
+.space 0x10000
+.Lfar:
+.hword .Lfar - .Lfunc
+# CHECK: :[[@LINE-1]]:{{[0-9]+}}: error: fixup value out of range
+.hword .Lfunc - .Lfar
+# CHECK: :[[@LINE-1]]:{{[0-9]+}}: error: fixup value out of range
@@ -0,0 +1,64 @@
+# RUN: llvm-mc %s -triple=ceespu -show-encoding \
+# RUN:     | FileCheck -check-prefix=CHECK-FIXUP %s
+# RUN: llvm-mc -triple=ceespu -filetype=obj < %s \
+# RUN:     | llvm-objdump -d - | FileCheck -check-prefix=CHECK-INSTR %s
+# RUN: llvm-mc -triple=ceespu -filetype=obj < %s \
+# RUN:     | llvm-objdump -r - | FileCheck -check-prefix=CHECK-REL %s
+
+# Checks that fixups that can be resolved within the same object file are
+# applied correctly, and that the rest are emitted as relocations.
+
+.LBB0:
+seti %hi(val)
+# CHECK-FIXUP: fixup A - offset: 0, value: %hi(val), kind: fixup_ceespu_hi16
+ori c1, c0, %lo(val)
+# CHECK-FIXUP: fixup A - offset: 0, value: %lo(val), kind: fixup_ceespu_lo16
+# CHECK-INSTR: ori c1, c0, 305419896
+
+lw c2, %lo(val)(c1)
+# CHECK-FIXUP: fixup A - offset: 0, value: %lo(val), kind: fixup_ceespu_lo16
+# CHECK-INSTR: lw c2, 22136(c1)
+sw c2, %lo(val)(c1)
+# CHECK-FIXUP: fixup A - offset: 0, value: %lo(val), kind: fixup_ceespu_lo12
+# CHECK-INSTR: sw c2, 22136(c1)
+
+beq c1, c2, .LBB0
+# CHECK-FIXUP: fixup A - offset: 0, value: .LBB0, kind: fixup_ceespu_cbranch
+# CHECK-INSTR: beq c1, c2, -16
+
+.set val, 0x12345678
+
+# Symbols that are not defined here need relocations.
+
+seti %hi(ext)
+# CHECK-REL: R_CEESPU_HI_16 ext
+lw c3, %lo(ext)(c3)
+# CHECK-REL: R_CEESPU_LO_16 ext
+sw c3, %lo(ext)(c3)
+# CHECK-REL: R_CEESPU_LO_12 ext
+bne c3, c0, ext
+# CHECK-REL: R_CEESPU_RJMP ext
+call func
+# CHECK-FIXUP: fixup A - offset: 0, value: func, kind: fixup_ceespu_jmp16
+# CHECK-REL: R_CEESPU_JMP_16 func
+.word ext
+# CHECK-REL: R_CEESPU_32 ext
+
+# Small data is addressed as an offset from c0.
+
+lw c4, %abs(small)(c0)
+# CHECK-FIXUP: fixup A - offset: 0, value: %abs(small), kind: fixup_ceespu_abs16
+# CHECK-INSTR: lw c4, 4660(c0)
+sw c4, %abs(small)(c0)
+# CHECK-FIXUP: fixup A - offset: 0, value: %abs(small), kind: fixup_ceespu_abs16_s
+# CHECK-INSTR: sw c4, 4660(c0)
+ori c4, c0, %abs(small)
+# CHECK-FIXUP: fixup A - offset: 0, value: %abs(small), kind: fixup_ceespu_abs16
+# CHECK-INSTR: ori c4, c0, 4660
+
+.set small, 0x1234
+
+lw c5, %abs(ext_small)(c0)
+# CHECK-REL: R_CEESPU_ABS_16 ext_small
+sw c5, %abs(ext_small)(c0)
+# CHECK-REL: R_CEESPU_ABS_16_S ext_small
@@ -0,0 +1,10 @@
+# REQUIRES: asserts
+# RUN: llvm-mc -triple=ceespu -debug-only=asm-matcher < %s -o /dev/null 2>&1 \
+# RUN:     | FileCheck %s
+
+# Parsed operands are printed with their assembly names.
+
+add c1, c2, csp
+# CHECK: operand at index 1 (<register c1>)
+# CHECK: operand at index 2 (<register c2>)
+# CHECK: operand at index 3 (<register csp>)
@@ -0,0 +1,50 @@
+# RUN: llvm-mc -filetype=obj -triple=ceespu < %s \
+# RUN:     | llvm-objdump -d - | FileCheck -check-prefix=CHECK-INSTR %s
+# RUN: llvm-mc -filetype=obj -triple=ceespu < %s \
+# RUN:     | llvm-objdump -r - | FileCheck -check-prefix=CHECK-REL %s
+
+# Instructions with a bare expression are emitted without a SETI prefix, and
+# only get one once layout shows that the value does not fit in 16 bits.
+
+# Values that turn out to be small stay a single instruction.
+# CHECK-INSTR: 0: {{.*}} addi c1, c2, 16
+addi c1, c2, small
+# CHECK-INSTR-NEXT: 4: {{.*}} lw c1, 16(c2)
+lw c1, small(c2)
+# CHECK-INSTR-NEXT: 8: {{.*}} ori c1, c0, 8
+ori c1, c0, .Lend - .Lstart
+
+# Larger values get a prefix.
+# CHECK-INSTR-NEXT: c: {{.*}} addi c1, c2, 74565
+addi c1, c2, large
+# CHECK-INSTR-NEXT: 14: {{.*}} sw c1, 74565(c2)
+sw c1, large(c2)
+
+# The address of a label is only known at link time.
+# CHECK-INSTR-NEXT: 1c: {{.*}} lw c3, 0(c0)
+# CHECK-REL: R_CEESPU_HI_16 table
+# CHECK-REL: R_CEESPU_LO_16 table
+lw c3, table(c0)
+
+# Branches in range keep their 16-bit offset.
+# CHECK-INSTR-NEXT: 24: {{.*}} beq c1, c2, 4
+beq c1, c2, .Lnear
+.Lnear:
+
+# Out of range, the condition is inverted to branch over a jump.
+# CHECK-INSTR-NEXT: 28: {{.*}} bne c1, c2, 8
+# CHECK-INSTR-NEXT: 2c: {{.*}} b 0
+# CHECK-REL: R_CEESPU_JMP_16 .Lfar
+beq c1, c2, .Lfar
+.Lstart:
+.space 8
+.Lend:
+.space 0x8000
+.Lfar:
+
+.set small, 16
+.set large, 0x12345
+
+.data
+table:
+.word 0
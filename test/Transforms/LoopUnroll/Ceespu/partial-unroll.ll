@@ -0,0 +1,53 @@
+; RUN: opt < %s -S -loop-unroll -mtriple=ceespu | FileCheck %s
+
+; Small loops are runtime unrolled to save the taken branch of every
+; iteration.
+; CHECK-LABEL: @sum
+; CHECK: load i32
+; CHECK: load i32
+; CHECK: load i32
+; CHECK: load i32
+; CHECK: for.body.epil:
+define i32 @sum(i32* %p, i32 %n) {
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %for.body, label %exit
+
+for.body:
+  %i = phi i32 [ %inc, %for.body ], [ 0, %entry ]
+  %s = phi i32 [ %add, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr inbounds i32, i32* %p, i32 %i
+  %v = load i32, i32* %arrayidx
+  %add = add i32 %v, %s
+  %inc = add nuw nsw i32 %i, 1
+  %exitcond = icmp eq i32 %inc, %n
+  br i1 %exitcond, label %exit, label %for.body
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %add, %for.body ]
+  ret i32 %r
+}
+
+; Nothing is unrolled when optimizing for size.
+; CHECK-LABEL: @sum_optsize
+; CHECK-NOT: epil
+; CHECK: ret i32
+define i32 @sum_optsize(i32* %p, i32 %n) optsize {
+entry:
+  %cmp = icmp sgt i32 %n, 0
+  br i1 %cmp, label %for.body, label %exit
+
+for.body:
+  %i = phi i32 [ %inc, %for.body ], [ 0, %entry ]
+  %s = phi i32 [ %add, %for.body ], [ 0, %entry ]
+  %arrayidx = getelementptr inbounds i32, i32* %p, i32 %i
+  %v = load i32, i32* %arrayidx
+  %add = add i32 %v, %s
+  %inc = add nuw nsw i32 %i, 1
+  %exitcond = icmp eq i32 %inc, %n
+  br i1 %exitcond, label %exit, label %for.body
+
+exit:
+  %r = phi i32 [ 0, %entry ], [ %add, %for.body ]
+  ret i32 %r
+}
@@ -0,0 +1,24 @@
+target triple = "ceespu"
+
+declare i32 @step(i32)
+
+define i32 @combine(i32 %a, i32 %b, i32 %c) optsize {
+  %x = call i32 @step(i32 %a)
+  %y = call i32 @step(i32 %b)
+  %cx = add i32 %c, %x
+  %z = call i32 @step(i32 %cx)
+  %s1 = add i32 %x, %y
+  %s2 = add i32 %s1, %z
+  %s3 = add i32 %s2, %a
+  %s4 = add i32 %s3, %b
+  ret i32 %s4
+}
+
+define i32 @refold(i32 %a, i32 %b, i32 %c) optsize {
+  %x = call i32 @combine(i32 %b, i32 %a, i32 %c)
+  %y = call i32 @combine(i32 %x, i32 %c, i32 %b)
+  %s1 = add i32 %y, %b
+  %s2 = add i32 %s1, %a
+  %s3 = add i32 %s2, %c
+  ret i32 %s3
+}
@@ -0,0 +1,64 @@
+# RUN: llvm-mc -triple=ceespu -filetype=obj %s -o %t.o
+# RUN: llvm-ceespu-sim -trace %t.o 2>&1 | FileCheck %s
+# RUN: llvm-ceespu-sim -load-use-penalty=0 -mul-penalty=0 \
+# RUN:   -taken-branch-penalty=0 %t.o 2>&1 | FileCheck %s --check-prefix=FLAT
+# RUN: llvm-ceespu-sim -load-use-penalty=3 -mul-penalty=4 \
+# RUN:   -taken-branch-penalty=5 %t.o 2>&1 | FileCheck %s --check-prefix=SLOW
+
+# The first column of the trace is the cycle the instruction issues in.
+# CHECK:      0  00000100: subi csp, csp, 4
+# CHECK-NEXT: 1  00000104: addi c1, c0, 7
+# CHECK-NEXT: 2  00000108: sw c1, 0(csp)
+# CHECK-NEXT: 3  0000010c: lw c2, 0(csp)
+# CHECK-NEXT: 5  00000110: add c3, c2, c0
+# CHECK-NEXT: 6  00000114: muli c4, c3, 3
+# CHECK-NEXT: 9  00000118: add c5, c4, c0
+# CHECK-NEXT: 10  0000011c: addi csp, csp, 4
+# A SETI prefixed pair takes two cycles.
+# CHECK-NEXT: 11  00000120: addi c1, c0, 305419896
+# CHECK-NEXT: 13  00000128: xori c1, c1, 305419896
+# CHECK-NEXT: 15  00000130: addi c6, c0, -1
+# CHECK-NEXT: 16  00000134: addi c6, c6, 1
+# CHECK-NEXT: 17  00000138: bc 8
+# CHECK-NEXT: 20  00000140: adci c7, c0, 0
+# CHECK-NEXT: 21  00000144: subi c20, c5, 20
+# CHECK-NEXT: 22  00000148: sub c20, c20, c7
+# CHECK-NEXT: 23  0000014c: or c20, c20, c1
+# CHECK-NEXT: 24  00000150: bx clr
+# CHECK-NEXT: instructions:   18
+# CHECK-NEXT: cycles:         27
+# CHECK-NEXT: stall cycles:   3
+# CHECK-NEXT: taken branches: 2
+
+# FLAT:      cycles:         20
+# FLAT-NEXT: stall cycles:   0
+
+# SLOW:      cycles:         37
+# SLOW-NEXT: stall cycles:   7
+
+	.text
+	.globl	main
+main:
+	subi	csp, csp, 4
+	addi	c1, c0, 7
+	sw	c1, 0(csp)
+	lw	c2, 0(csp)
+	add	c3, c2, c0
+	muli	c4, c3, 3
+	add	c5, c4, c0
+	addi	csp, csp, 4
+	addi	c1, c0, 305419896
+	xori	c1, c1, 305419896
+	addi	c6, c0, -1
+	addi	c6, c6, 1
+	bc	.Lcarry
+	b	.Lfail
+.Lcarry:
+	adci	c7, c0, 0
+	subi	c20, c5, 20
+	sub	c20, c20, c7
+	or	c20, c20, c1
+	bx	clr
+.Lfail:
+	addi	c20, c0, 1
+	bx	clr
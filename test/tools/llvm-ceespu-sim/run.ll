@@ -0,0 +1,128 @@
+; RUN: llc -mtriple=ceespu -filetype=obj %s -o %t.o
+; RUN: llvm-ceespu-sim %t.o > %t.out 2> %t.err
+; RUN: FileCheck %s < %t.out
+; RUN: FileCheck %s --check-prefix=STATS < %t.err
+; RUN: not llvm-ceespu-sim -trace -entry=exit_early %t.o 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=EXIT
+; RUN: not llvm-ceespu-sim -entry=spin -max-instructions=100 %t.o 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=SPIN
+; RUN: not llvm-ceespu-sim -entry=null %t.o 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=NULL
+
+; The program prints through the memory-mapped character port and exits
+; with zero when the results are right.
+; CHECK: hello
+; CHECK-NEXT: 10 fib = 55
+; STATS: instructions:
+; STATS: cycles:
+; STATS: taken branches:
+
+; A store to the exit port stops the program straight away.
+; EXIT: sw
+; EXIT-NEXT: instructions:
+; EXIT-NOT: error
+
+; SPIN: error: program did not exit within 100 instructions
+
+; NULL: error: fault at pc 0x{{[0-9a-f]+}} (null+0): load from 0x00000000
+
+@msg = private constant [7 x i8] c"hello\0A\00"
+@wide = global i64 81985529216486895
+@table = global [4 x i32] [i32 5, i32 3, i32 9, i32 1]
+
+define void @putc(i32 %c) {
+  store volatile i32 %c, i32* inttoptr (i32 -16 to i32*)
+  ret void
+}
+
+define void @puts(i8* %s) {
+entry:
+  br label %loop
+loop:
+  %p = phi i8* [ %s, %entry ], [ %next, %body ]
+  %c = load i8, i8* %p
+  %end = icmp eq i8 %c, 0
+  br i1 %end, label %done, label %body
+body:
+  %cw = zext i8 %c to i32
+  call void @putc(i32 %cw)
+  %next = getelementptr i8, i8* %p, i32 1
+  br label %loop
+done:
+  ret void
+}
+
+define void @putu(i32 %n) {
+  %lt = icmp ult i32 %n, 10
+  br i1 %lt, label %digit, label %rec
+rec:
+  %q = udiv i32 %n, 10
+  call void @putu(i32 %q)
+  br label %digit
+digit:
+  %r = urem i32 %n, 10
+  %c = add i32 %r, 48
+  call void @putc(i32 %c)
+  ret void
+}
+
+define i32 @fib(i32 %n) {
+  %small = icmp slt i32 %n, 2
+  br i1 %small, label %base, label %rec
+base:
+  ret i32 %n
+rec:
+  %n1 = sub i32 %n, 1
+  %n2 = sub i32 %n, 2
+  %f1 = call i32 @fib(i32 %n1)
+  %f2 = call i32 @fib(i32 %n2)
+  %f = add i32 %f1, %f2
+  ret i32 %f
+}
+
+define i32 @main() {
+  call void @puts(i8* getelementptr ([7 x i8], [7 x i8]* @msg, i32 0, i32 0))
+  call void @putu(i32 10)
+  call void @putc(i32 32)
+  call void @putc(i32 102)
+  call void @putc(i32 105)
+  call void @putc(i32 98)
+  call void @putc(i32 32)
+  call void @putc(i32 61)
+  call void @putc(i32 32)
+  %f = call i32 @fib(i32 10)
+  call void @putu(i32 %f)
+  call void @putc(i32 10)
+  ; 0x0123456789abcdef + 0xffffffff carries into the high word.
+  %w = load volatile i64, i64* @wide
+  %sum = add i64 %w, 4294967295
+  %hi64 = lshr i64 %sum, 32
+  %hi = trunc i64 %hi64 to i32
+  %bad.hi = xor i32 %hi, 19088744
+  ; 55 * 0x12345678 wraps around.
+  %m = mul i32 %f, 305419896
+  %bad.m = xor i32 %m, -381774904
+  %t = load volatile i32, i32* getelementptr ([4 x i32], [4 x i32]* @table, i32 0, i32 2)
+  %bad.t = xor i32 %t, 9
+  %bad.0 = or i32 %bad.hi, %bad.m
+  %bad = or i32 %bad.0, %bad.t
+  ret i32 %bad
+}
+
+define void @exit_early() {
+  store volatile i32 3, i32* inttoptr (i32 -12 to i32*)
+  store volatile i32 4, i32* inttoptr (i32 -12 to i32*)
+  ret void
+}
+
+define void @spin() {
+entry:
+  br label %loop
+loop:
+  br label %loop
+}
+
+define i32 @null() {
+  %v = load volatile i32, i32* null
+  ret i32 %v
+}
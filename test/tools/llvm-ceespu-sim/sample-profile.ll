@@ -0,0 +1,106 @@
+; RUN: llc -mtriple=ceespu -O2 -filetype=obj %s -o %t.o
+; RUN: llvm-ceespu-sim -profile-output=%t.prof %t.o 2> %t.err
+; RUN: FileCheck %s --check-prefix=BEFORE < %t.err
+; RUN: FileCheck %s --check-prefix=PROFILE < %t.prof
+; RUN: opt -sample-profile -sample-profile-file=%t.prof %s -o %t.pgo.bc
+; RUN: llc -mtriple=ceespu -O2 -filetype=obj %t.pgo.bc -o %t.pgo.o
+; RUN: llvm-ceespu-sim %t.pgo.o 2>&1 | FileCheck %s --check-prefix=AFTER
+; RUN: llvm-ceespu-sim -no-stats -profile-output=%t.bprof \
+; RUN:   -profile-format=binary %t.o
+; RUN: opt -sample-profile -sample-profile-file=%t.bprof %s -o %t.bpgo.bc
+; RUN: llc -mtriple=ceespu -O2 -filetype=obj %t.bpgo.bc -o %t.bpgo.o
+; RUN: llvm-ceespu-sim %t.bpgo.o 2>&1 | FileCheck %s --check-prefix=AFTER
+
+; Almost every element of @data is zero, which nothing in the IR says. The
+; profile of a run tells the compiler, so it lays out the zero path as the
+; fall through and most of the taken branches go away.
+
+; BEFORE: cycles:         14224
+; BEFORE: taken branches: 2522
+
+; Line offsets are relative to the first line of the function.
+; PROFILE:      bench:5102:1
+; PROFILE-NEXT:  0: 1
+; PROFILE-NEXT:  2: 20
+; PROFILE-NEXT:  3: 1240
+; PROFILE-NEXT:  4: 1280
+; PROFILE-NEXT:  5: 1280
+; PROFILE-NEXT:  6: 1240
+; PROFILE-NEXT:  8: 40
+; PROFILE-NEXT:  10: 1
+; PROFILE-NEXT: main:1:0
+; PROFILE-NEXT:  0: 1 bench:1
+
+; AFTER: cycles:         11884
+; AFTER: taken branches: 1342
+
+@data = global [64 x i32] [i32 0, i32 0, i32 0, i32 0, i32 0, i32 3, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 7, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0, i32 0], align 4
+
+define i32 @bench(i32 %n) !dbg !7 {
+entry:
+  br label %outer, !dbg !10
+
+outer:
+  %r = phi i32 [ 0, %entry ], [ %r.next, %outer.latch ], !dbg !10
+  %s.outer = phi i32 [ 0, %entry ], [ %s.next, %outer.latch ]
+  br label %inner, !dbg !11
+
+inner:
+  %i = phi i32 [ 0, %outer ], [ %i.next, %inner.latch ], !dbg !11
+  %s = phi i32 [ %s.outer, %outer ], [ %s.next, %inner.latch ]
+  %p = getelementptr [64 x i32], [64 x i32]* @data, i32 0, i32 %i, !dbg !12
+  %v = load volatile i32, i32* %p, !dbg !12
+  %z = icmp eq i32 %v, 0, !dbg !13
+  br i1 %z, label %zero, label %nonzero, !dbg !13
+
+zero:
+  %s.z = add i32 %s, 1, !dbg !14
+  br label %inner.latch, !dbg !14
+
+nonzero:
+  %s3 = mul i32 %s, 3, !dbg !15
+  %s.nz = add i32 %s3, %v, !dbg !15
+  br label %inner.latch, !dbg !15
+
+inner.latch:
+  %s.next = phi i32 [ %s.z, %zero ], [ %s.nz, %nonzero ]
+  %i.next = add i32 %i, 1, !dbg !11
+  %i.done = icmp eq i32 %i.next, 64, !dbg !11
+  br i1 %i.done, label %outer.latch, label %inner, !dbg !11
+
+outer.latch:
+  %r.next = add i32 %r, 1, !dbg !10
+  %r.done = icmp eq i32 %r.next, %n, !dbg !10
+  br i1 %r.done, label %exit, label %outer, !dbg !10
+
+exit:
+  ret i32 %s.next, !dbg !16
+}
+
+define i32 @main() !dbg !17 {
+  %s = call i32 @bench(i32 20), !dbg !18
+  %r = and i32 %s, 127, !dbg !18
+  %bad = icmp ne i32 %r, 104, !dbg !18
+  %ret = zext i1 %bad to i32, !dbg !18
+  ret i32 %ret, !dbg !18
+}
+
+!llvm.dbg.cu = !{!0}
+!llvm.module.flags = !{!3, !4}
+
+!0 = distinct !DICompileUnit(language: DW_LANG_C99, file: !1, producer: "hand written", isOptimized: true, runtimeVersion: 0, emissionKind: FullDebug)
+!1 = !DIFile(filename: "bench.c", directory: "/")
+!3 = !{i32 2, !"Dwarf Version", i32 4}
+!4 = !{i32 2, !"Debug Info Version", i32 3}
+!5 = !DISubroutineType(types: !6)
+!6 = !{}
+!7 = distinct !DISubprogram(name: "bench", scope: !1, file: !1, line: 3, type: !5, isLocal: false, isDefinition: true, scopeLine: 3, isOptimized: true, unit: !0)
+!10 = !DILocation(line: 5, column: 3, scope: !7)
+!11 = !DILocation(line: 6, column: 5, scope: !7)
+!12 = !DILocation(line: 7, column: 15, scope: !7)
+!13 = !DILocation(line: 8, column: 11, scope: !7)
+!14 = !DILocation(line: 9, column: 11, scope: !7)
+!15 = !DILocation(line: 11, column: 15, scope: !7)
+!16 = !DILocation(line: 13, column: 3, scope: !7)
+!17 = distinct !DISubprogram(name: "main", scope: !1, file: !1, line: 16, type: !5, isLocal: false, isDefinition: true, scopeLine: 16, isOptimized: true, unit: !0)
+!18 = !DILocation(line: 16, column: 14, scope: !17)
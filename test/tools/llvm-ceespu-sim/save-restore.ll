@@ -0,0 +1,58 @@
+; RUN: llc -mtriple=ceespu -filetype=obj %s -o %t.o
+; RUN: llc -mtriple=ceespu -filetype=obj %S/Inputs/save-restore-lib.ll \
+; RUN:   -o %t.lib.o
+; RUN: llvm-ceespu-sim %t.o %t.lib.o 2>&1 | FileCheck %s
+; RUN: llc -mtriple=ceespu -filetype=obj -ceespu-save-restore=false %s \
+; RUN:   -o %t.inline.o
+; RUN: llc -mtriple=ceespu -filetype=obj -ceespu-save-restore=false \
+; RUN:   %S/Inputs/save-restore-lib.ll -o %t.lib.inline.o
+; RUN: llvm-ceespu-sim %t.inline.o %t.lib.inline.o 2>&1 \
+; RUN:   | FileCheck %s --check-prefix=INLINE
+
+; Functions built for size save their callee-saved registers through shared
+; routines. Both objects define __ceespu_save_3 and __ceespu_restore_3, and
+; the copy of the second is dropped with its COMDAT group. The calls and the
+; jumps to the routines cost cycles in exchange for the bytes they save.
+; CHECK:      instructions:   23126
+; CHECK-NEXT: cycles:         36532
+; INLINE:      instructions:   20722
+; INLINE-NEXT: cycles:         30522
+
+declare i32 @combine(i32, i32, i32)
+declare i32 @refold(i32, i32, i32)
+
+define i32 @step(i32 %a) noinline optsize {
+  %x = mul i32 %a, 37
+  %y = xor i32 %x, 91
+  ret i32 %y
+}
+
+define internal i32 @fold(i32 %a, i32 %b, i32 %c) noinline optsize {
+  %x = call i32 @combine(i32 %a, i32 %b, i32 %c)
+  %y = call i32 @combine(i32 %c, i32 %x, i32 %a)
+  %s1 = add i32 %y, %b
+  %s2 = add i32 %s1, %a
+  %s3 = add i32 %s2, %c
+  ret i32 %s3
+}
+
+define i32 @main() optsize {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %acc = phi i32 [ 0, %entry ], [ %acc.next, %loop ]
+  %v = call i32 @fold(i32 %i, i32 %acc, i32 7)
+  %w = call i32 @refold(i32 %v, i32 %i, i32 %acc)
+  %acc.next = xor i32 %acc, %w
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, 100
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %low = and i32 %acc.next, 255
+  %bad = icmp ne i32 %low, 135
+  %ret = zext i1 %bad to i32
+  ret i32 %ret
+}
@@ -0,0 +1,58 @@
+; RUN: llc -mtriple=ceespu -filetype=obj %s -o %t.o
+; RUN: llvm-ceespu-sim %t.o 2>&1 | FileCheck %s
+; RUN: llc -mtriple=ceespu -filetype=obj -enable-shrink-wrap=false %s -o %t.nosw.o
+; RUN: llvm-ceespu-sim %t.nosw.o 2>&1 | FileCheck %s --check-prefix=NOSW
+
+; 960 of the 1024 lookups hit the cache. Shrink-wrapping moves the frame
+; setup and the save of clr into the miss path, so a hit does four
+; instructions less.
+; CHECK:      instructions:   12942
+; CHECK-NEXT: cycles:         23440
+; NOSW:       instructions:   16782
+; NOSW-NEXT:  cycles:         27280
+
+@cache = internal global [64 x i32] zeroinitializer
+
+define i32 @slow_lookup(i32 %key) noinline {
+  %sq = mul i32 %key, %key
+  %r = or i32 %sq, 1
+  ret i32 %r
+}
+
+; Most lookups hit the cache, and only a miss needs a frame.
+define i32 @lookup(i32 %key) noinline {
+entry:
+  %slot = getelementptr inbounds [64 x i32], [64 x i32]* @cache, i32 0, i32 %key
+  %v = load i32, i32* %slot
+  %hit = icmp ne i32 %v, 0
+  br i1 %hit, label %exit, label %miss
+
+miss:
+  %r = call i32 @slow_lookup(i32 %key)
+  store i32 %r, i32* %slot
+  br label %exit
+
+exit:
+  %res = phi i32 [ %v, %entry ], [ %r, %miss ]
+  ret i32 %res
+}
+
+define i32 @main() {
+entry:
+  br label %loop
+
+loop:
+  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]
+  %sum = phi i32 [ 0, %entry ], [ %sum.next, %loop ]
+  %key = and i32 %i, 63
+  %v = call i32 @lookup(i32 %key)
+  %sum.next = add i32 %sum, %v
+  %i.next = add i32 %i, 1
+  %done = icmp eq i32 %i.next, 1024
+  br i1 %done, label %exit, label %loop
+
+exit:
+  %ok = icmp ne i32 %sum.next, 1366016
+  %ret = zext i1 %ok to i32
+  ret i32 %ret
+}
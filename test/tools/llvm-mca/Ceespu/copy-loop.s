@@ -0,0 +1,82 @@
+# NOTE: Assertions have been autogenerated by utils/update_mca_test_checks.py
+# RUN: llvm-mca -mtriple=ceespu -mcpu=generic -iterations=100 -timeline -timeline-max-iterations=1 < %s | FileCheck %s
+
+# Scheduling the stores after the loads hides the load latency.
+
+lw    c3, 0(c1)
+lw    c4, 4(c1)
+addi  c1, c1, 8
+sw    c3, 0(c2)
+sw    c4, 4(c2)
+addi  c2, c2, 8
+bne   c1, c5, -24
+
+# CHECK:      Iterations:        100
+# CHECK-NEXT: Instructions:      700
+# CHECK-NEXT: Total Cycles:      702
+# CHECK-NEXT: Dispatch Width:    1
+# CHECK-NEXT: IPC:               1.00
+# CHECK-NEXT: Block RThroughput: 7.0
+
+# CHECK:      Instruction Info:
+# CHECK-NEXT: [1]: #uOps
+# CHECK-NEXT: [2]: Latency
+# CHECK-NEXT: [3]: RThroughput
+# CHECK-NEXT: [4]: MayLoad
+# CHECK-NEXT: [5]: MayStore
+# CHECK-NEXT: [6]: HasSideEffects
+
+# CHECK:      [1]    [2]    [3]    [4]    [5]    [6]    Instructions:
+# CHECK-NEXT:  1      2     1.00    *                   lw	c3, 0(c1)
+# CHECK-NEXT:  1      2     1.00    *                   lw	c4, 4(c1)
+# CHECK-NEXT:  1      1     1.00                        addi	c1, c1, 8
+# CHECK-NEXT:  1      1     1.00           *            sw	c3, 0(c2)
+# CHECK-NEXT:  1      1     1.00           *            sw	c4, 4(c2)
+# CHECK-NEXT:  1      1     1.00                        addi	c2, c2, 8
+# CHECK-NEXT:  1      1     1.00                        bne	c1, c5, -24
+
+# CHECK:      Resources:
+# CHECK-NEXT: [0]   - CeespuUnitALU
+# CHECK-NEXT: [1]   - CeespuUnitBranch
+# CHECK-NEXT: [2]   - CeespuUnitLSU
+# CHECK-NEXT: [3]   - CeespuUnitMul
+
+# CHECK:      Resource pressure per iteration:
+# CHECK-NEXT: [0]    [1]    [2]    [3]
+# CHECK-NEXT: 2.00   1.00   4.00    -
+
+# CHECK:      Resource pressure by instruction:
+# CHECK-NEXT: [0]    [1]    [2]    [3]    Instructions:
+# CHECK-NEXT:  -      -     1.00    -     lw	c3, 0(c1)
+# CHECK-NEXT:  -      -     1.00    -     lw	c4, 4(c1)
+# CHECK-NEXT: 1.00    -      -      -     addi	c1, c1, 8
+# CHECK-NEXT:  -      -     1.00    -     sw	c3, 0(c2)
+# CHECK-NEXT:  -      -     1.00    -     sw	c4, 4(c2)
+# CHECK-NEXT: 1.00    -      -      -     addi	c2, c2, 8
+# CHECK-NEXT:  -     1.00    -      -     bne	c1, c5, -24
+
+# CHECK:      Timeline view:
+# CHECK-NEXT: Index     012345678
+
+# CHECK:      [0,0]     DeER .  .   lw	c3, 0(c1)
+# CHECK-NEXT: [0,1]     .DeER.  .   lw	c4, 4(c1)
+# CHECK-NEXT: [0,2]     . DER.  .   addi	c1, c1, 8
+# CHECK-NEXT: [0,3]     .  DER  .   sw	c3, 0(c2)
+# CHECK-NEXT: [0,4]     .   DER .   sw	c4, 4(c2)
+# CHECK-NEXT: [0,5]     .    DER.   addi	c2, c2, 8
+# CHECK-NEXT: [0,6]     .    .DER   bne	c1, c5, -24
+
+# CHECK:      Average Wait times (based on the timeline view):
+# CHECK-NEXT: [0]: Executions
+# CHECK-NEXT: [1]: Average time spent waiting in a scheduler's queue
+# CHECK-NEXT: [2]: Average time spent waiting in a scheduler's queue while ready
+# CHECK-NEXT: [3]: Average time elapsed from WB until retire stage
+
+# CHECK:            [0]    [1]    [2]    [3]
+# CHECK-NEXT: 0.     1     0.0    0.0    0.0       lw	c3, 0(c1)
+# CHECK-NEXT: 1.     1     0.0    0.0    0.0       lw	c4, 4(c1)
+# CHECK-NEXT: 2.     1     0.0    0.0    0.0       addi	c1, c1, 8
+# CHECK-NEXT: 3.     1     0.0    0.0    0.0       sw	c3, 0(c2)
+# CHECK-NEXT: 4.     1     0.0    0.0    0.0       sw	c4, 4(c2)
+# CHECK-NEXT: 5.     1     0.0    0.0    0.0       addi	c2, c2, 8
+# CHECK-NEXT: 6.     1     0.0    0.0    0.0       bne	c1, c5, -24
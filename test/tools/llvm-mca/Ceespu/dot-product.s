@@ -0,0 +1,111 @@
+# NOTE: Assertions have been autogenerated by utils/update_mca_test_checks.py
+# RUN: llvm-mca -mtriple=ceespu -mcpu=generic -iterations=100 -timeline -timeline-max-iterations=2 -dispatch-stats < %s | FileCheck %s
+
+# The core issues in order, so the multiply waits for the second load and
+# the add waits for the multiply.
+
+lw    c3, 0(c1)
+lw    c4, 0(c2)
+mul   c5, c3, c4
+add   c6, c6, c5
+addi  c1, c1, 4
+addi  c2, c2, 4
+addi  c7, c7, -1
+bne   c7, c0, -28
+
+# CHECK:      Iterations:        100
+# CHECK-NEXT: Instructions:      800
+# CHECK-NEXT: Total Cycles:      1102
+# CHECK-NEXT: Dispatch Width:    1
+# CHECK-NEXT: IPC:               0.73
+# CHECK-NEXT: Block RThroughput: 8.0
+
+# CHECK:      Instruction Info:
+# CHECK-NEXT: [1]: #uOps
+# CHECK-NEXT: [2]: Latency
+# CHECK-NEXT: [3]: RThroughput
+# CHECK-NEXT: [4]: MayLoad
+# CHECK-NEXT: [5]: MayStore
+# CHECK-NEXT: [6]: HasSideEffects
+
+# CHECK:      [1]    [2]    [3]    [4]    [5]    [6]    Instructions:
+# CHECK-NEXT:  1      2     1.00    *                   lw	c3, 0(c1)
+# CHECK-NEXT:  1      2     1.00    *                   lw	c4, 0(c2)
+# CHECK-NEXT:  1      3     1.00                        mul	c5, c3, c4
+# CHECK-NEXT:  1      1     1.00                        add	c6, c6, c5
+# CHECK-NEXT:  1      1     1.00                        addi	c1, c1, 4
+# CHECK-NEXT:  1      1     1.00                        addi	c2, c2, 4
+# CHECK-NEXT:  1      1     1.00                        addi	c7, c7, -1
+# CHECK-NEXT:  1      1     1.00                        bne	c7, c0, -28
+
+# CHECK:      Dynamic Dispatch Stall Cycles:
+# CHECK-NEXT: RAT     - Register unavailable:                      0
+# CHECK-NEXT: RCU     - Retire tokens unavailable:                 0
+# CHECK-NEXT: SCHEDQ  - Scheduler full:                            0
+# CHECK-NEXT: LQ      - Load queue full:                           0
+# CHECK-NEXT: SQ      - Store queue full:                          0
+# CHECK-NEXT: GROUP   - Static restrictions on the dispatch group: 0
+# CHECK-NEXT: DEP     - Register operands not ready:               300
+
+# CHECK:      Dispatch Logic - number of cycles where we saw N instructions dispatched:
+# CHECK-NEXT: [# dispatched], [# cycles]
+# CHECK-NEXT:  0,              302  (27.4%)
+# CHECK-NEXT:  1,              800  (72.6%)
+
+# CHECK:      Resources:
+# CHECK-NEXT: [0]   - CeespuUnitALU
+# CHECK-NEXT: [1]   - CeespuUnitBranch
+# CHECK-NEXT: [2]   - CeespuUnitLSU
+# CHECK-NEXT: [3]   - CeespuUnitMul
+
+# CHECK:      Resource pressure per iteration:
+# CHECK-NEXT: [0]    [1]    [2]    [3]
+# CHECK-NEXT: 4.00   1.00   2.00   1.00
+
+# CHECK:      Resource pressure by instruction:
+# CHECK-NEXT: [0]    [1]    [2]    [3]    Instructions:
+# CHECK-NEXT:  -      -     1.00    -     lw	c3, 0(c1)
+# CHECK-NEXT:  -      -     1.00    -     lw	c4, 0(c2)
+# CHECK-NEXT:  -      -      -     1.00   mul	c5, c3, c4
+# CHECK-NEXT: 1.00    -      -      -     add	c6, c6, c5
+# CHECK-NEXT: 1.00    -      -      -     addi	c1, c1, 4
+# CHECK-NEXT: 1.00    -      -      -     addi	c2, c2, 4
+# CHECK-NEXT: 1.00    -      -      -     addi	c7, c7, -1
+# CHECK-NEXT:  -     1.00    -      -     bne	c7, c0, -28
+
+# CHECK:      Timeline view:
+# CHECK-NEXT:                     0123456789
+# CHECK-NEXT: Index     0123456789          0123
+
+# CHECK:      [0,0]     DeER .    .    .    .  .   lw	c3, 0(c1)
+# CHECK-NEXT: [0,1]     .DeER.    .    .    .  .   lw	c4, 0(c2)
+# CHECK-NEXT: [0,2]     .  DeeER  .    .    .  .   mul	c5, c3, c4
+# CHECK-NEXT: [0,3]     .    .DER .    .    .  .   add	c6, c6, c5
+# CHECK-NEXT: [0,4]     .    . DER.    .    .  .   addi	c1, c1, 4
+# CHECK-NEXT: [0,5]     .    .  DER    .    .  .   addi	c2, c2, 4
+# CHECK-NEXT: [0,6]     .    .   DER   .    .  .   addi	c7, c7, -1
+# CHECK-NEXT: [0,7]     .    .    DER  .    .  .   bne	c7, c0, -28
+# CHECK-NEXT: [1,0]     .    .    .DeER.    .  .   lw	c3, 0(c1)
+# CHECK-NEXT: [1,1]     .    .    . DeER    .  .   lw	c4, 0(c2)
+# CHECK-NEXT: [1,2]     .    .    .   DeeER .  .   mul	c5, c3, c4
+# CHECK-NEXT: [1,3]     .    .    .    . DER.  .   add	c6, c6, c5
+# CHECK-NEXT: [1,4]     .    .    .    .  DER  .   addi	c1, c1, 4
+# CHECK-NEXT: [1,5]     .    .    .    .   DER .   addi	c2, c2, 4
+# CHECK-NEXT: [1,6]     .    .    .    .    DER.   addi	c7, c7, -1
+# CHECK-NEXT: [1,7]     .    .    .    .    .DER   bne	c7, c0, -28
+
+# CHECK:      Average Wait times (based on the timeline view):
+# CHECK-NEXT: [0]: Executions
+# CHECK-NEXT: [1]: Average time spent waiting in a scheduler's queue
+# CHECK-NEXT: [2]: Average time spent waiting in a scheduler's queue while ready
+# CHECK-NEXT: [3]: Average time elapsed from WB until retire stage
+
+# CHECK:            [0]    [1]    [2]    [3]
+# CHECK-NEXT: 0.     2     0.0    0.0    0.0       lw	c3, 0(c1)
+# CHECK-NEXT: 1.     2     0.0    0.0    0.0       lw	c4, 0(c2)
+# CHECK-NEXT: 2.     2     0.0    0.0    0.0       mul	c5, c3, c4
+# CHECK-NEXT: 3.     2     0.0    0.0    0.0       add	c6, c6, c5
+# CHECK-NEXT: 4.     2     0.0    0.0    0.0       addi	c1, c1, 4
+# CHECK-NEXT: 5.     2     0.0    0.0    0.0       addi	c2, c2, 4
+# CHECK-NEXT: 6.     2     0.0    0.0    0.0       addi	c7, c7, -1
+# CHECK-NEXT: 7.     2     0.0    0.0    0.0       bne	c7, c0, -28
@@ -0,0 +1,84 @@
+# NOTE: Assertions have been autogenerated by utils/update_mca_test_checks.py
+# RUN: llvm-mca -mtriple=ceespu -mcpu=generic -iterations=2 -timeline < %s | FileCheck %s
+
+# Immediates that do not fit in 16 bits are split into a SETI prefix and the
+# instruction that it extends. The pair issues back to back, so the prefix
+# waits for the registers of the addi.
+
+lw    c3, 0(c1)
+addi  c4, c3, 0x12345678
+xori  c5, c4, 0x5a5a0000
+sw    c5, 0(c2)
+
+# CHECK:      Iterations:        2
+# CHECK-NEXT: Instructions:      12
+# CHECK-NEXT: Total Cycles:      16
+# CHECK-NEXT: Dispatch Width:    1
+# CHECK-NEXT: IPC:               0.75
+# CHECK-NEXT: Block RThroughput: 6.0
+
+# CHECK:      Instruction Info:
+# CHECK-NEXT: [1]: #uOps
+# CHECK-NEXT: [2]: Latency
+# CHECK-NEXT: [3]: RThroughput
+# CHECK-NEXT: [4]: MayLoad
+# CHECK-NEXT: [5]: MayStore
+# CHECK-NEXT: [6]: HasSideEffects
+
+# CHECK:      [1]    [2]    [3]    [4]    [5]    [6]    Instructions:
+# CHECK-NEXT:  1      2     1.00    *                   lw	c3, 0(c1)
+# CHECK-NEXT:  1      1     1.00                  *     seti	4660
+# CHECK-NEXT:  1      1     1.00                        addi	c4, c3, 22136
+# CHECK-NEXT:  1      1     1.00                  *     seti	23130
+# CHECK-NEXT:  1      1     1.00                        xori	c5, c4, 0
+# CHECK-NEXT:  1      1     1.00           *            sw	c5, 0(c2)
+
+# CHECK:      Resources:
+# CHECK-NEXT: [0]   - CeespuUnitALU
+# CHECK-NEXT: [1]   - CeespuUnitBranch
+# CHECK-NEXT: [2]   - CeespuUnitLSU
+# CHECK-NEXT: [3]   - CeespuUnitMul
+
+# CHECK:      Resource pressure per iteration:
+# CHECK-NEXT: [0]    [1]    [2]    [3]
+# CHECK-NEXT: 4.00    -     2.00    -
+
+# CHECK:      Resource pressure by instruction:
+# CHECK-NEXT: [0]    [1]    [2]    [3]    Instructions:
+# CHECK-NEXT:  -      -     1.00    -     lw	c3, 0(c1)
+# CHECK-NEXT: 1.00    -      -      -     seti	4660
+# CHECK-NEXT: 1.00    -      -      -     addi	c4, c3, 22136
+# CHECK-NEXT: 1.00    -      -      -     seti	23130
+# CHECK-NEXT: 1.00    -      -      -     xori	c5, c4, 0
+# CHECK-NEXT:  -      -     1.00    -     sw	c5, 0(c2)
+
+# CHECK:      Timeline view:
+# CHECK-NEXT:                     012345
+# CHECK-NEXT: Index     0123456789
+
+# CHECK:      [0,0]     DeER .    .    .   lw	c3, 0(c1)
+# CHECK-NEXT: [0,1]     . DER.    .    .   seti	4660
+# CHECK-NEXT: [0,2]     .  DER    .    .   addi	c4, c3, 22136
+# CHECK-NEXT: [0,3]     .   DER   .    .   seti	23130
+# CHECK-NEXT: [0,4]     .    DER  .    .   xori	c5, c4, 0
+# CHECK-NEXT: [0,5]     .    .DER .    .   sw	c5, 0(c2)
+# CHECK-NEXT: [1,0]     .    . DeER    .   lw	c3, 0(c1)
+# CHECK-NEXT: [1,1]     .    .   DER   .   seti	4660
+# CHECK-NEXT: [1,2]     .    .    DER  .   addi	c4, c3, 22136
+# CHECK-NEXT: [1,3]     .    .    .DER .   seti	23130
+# CHECK-NEXT: [1,4]     .    .    . DER.   xori	c5, c4, 0
+# CHECK-NEXT: [1,5]     .    .    .  DER   sw	c5, 0(c2)
+
+# CHECK:      Average Wait times (based on the timeline view):
+# CHECK-NEXT: [0]: Executions
+# CHECK-NEXT: [1]: Average time spent waiting in a scheduler's queue
+# CHECK-NEXT: [2]: Average time spent waiting in a scheduler's queue while ready
+# CHECK-NEXT: [3]: Average time elapsed from WB until retire stage
+
+# CHECK:            [0]    [1]    [2]    [3]
+# CHECK-NEXT: 0.     2     0.0    0.0    0.0       lw	c3, 0(c1)
+# CHECK-NEXT: 1.     2     0.0    0.0    0.0       seti	4660
+# CHECK-NEXT: 2.     2     0.0    0.0    0.0       addi	c4, c3, 22136
+# CHECK-NEXT: 3.     2     0.0    0.0    0.0       seti	23130
+# CHECK-NEXT: 4.     2     0.0    0.0    0.0       xori	c5, c4, 0
+# CHECK-NEXT: 5.     2     0.0    0.0    0.0       sw	c5, 0(c2)
@@ -0,0 +1,210 @@
+//===-- Profile.cpp - Sample profiles from simulation ---------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Profile.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/DebugInfo/DWARF/DWARFContext.h"
+#include "llvm/IR/DebugInfoMetadata.h"
+#include "llvm/Object/ELFObjectFile.h"
+#include "llvm/ProfileData/SampleProfWriter.h"
+#include <map>
+
+using namespace llvm;
+using namespace llvm::ceespusim;
+using namespace llvm::object;
+using namespace llvm::sampleprof;
+
+static Error makeError(const Twine &Msg) {
+  return make_error<StringError>(Msg, inconvertibleErrorCode());
+}
+
+namespace {
+/// Gives the sections of one input object the addresses they have in the
+/// image, so that its debug information is read with image addresses.
+class PlacedObjectInfo : public LoadedObjectInfoHelper<PlacedObjectInfo> {
+public:
+  DenseMap<uint64_t, uint32_t> SectionAddress;
+
+  uint64_t getSectionLoadAddress(const SectionRef &Sec) const override {
+    auto It = SectionAddress.find(Sec.getIndex());
+    if (It != SectionAddress.end())
+      return It->second;
+    // Keep the code of a discarded COMDAT group away from the image, so that
+    // its debug information does not cover code that was kept.
+    if (ELFSectionRef(Sec).getFlags() & ELF::SHF_ALLOC)
+      return 0xf0000000;
+    return 0;
+  }
+};
+
+/// Accumulates the samples of every function, inlined instances included.
+class ProfileBuilder {
+public:
+  ProfileBuilder(const Program &P) : P(P) {}
+
+  Error addObjects(ArrayRef<std::string> Files);
+  void addInstruction(uint32_t Address, uint64_t Count);
+  void addCall(uint32_t Address, uint32_t Target, uint64_t Count);
+  Error write(StringRef OutputFile, SampleProfileFormat Format);
+
+private:
+  /// Returns the samples of the function instance that Address belongs to
+  /// and sets Loc to the location of Address in it.
+  FunctionSamples *getSamples(uint32_t Address, LineLocation &Loc);
+  static uint64_t computeTotalSamples(FunctionSamples &FS);
+
+  const Program &P;
+  std::vector<OwningBinary<ObjectFile>> Objects;
+  std::vector<std::unique_ptr<DWARFContext>> Contexts;
+  StringMap<FunctionSamples> Profiles;
+  /// The largest instruction count seen for each line.
+  std::map<std::pair<FunctionSamples *, LineLocation>, uint64_t> LineCounts;
+};
+} // end anonymous namespace
+
+static LineLocation getLineLocation(const DILineInfo &Frame) {
+  // This matches FunctionSamples::getOffset.
+  return LineLocation(
+      (Frame.Line - Frame.StartLine) & 0xffff,
+      DILocation::getBaseDiscriminatorFromDiscriminator(Frame.Discriminator));
+}
+
+Error ProfileBuilder::addObjects(ArrayRef<std::string> Files) {
+  for (unsigned FileIndex = 0; FileIndex != Files.size(); ++FileIndex) {
+    auto ObjectOrErr = ObjectFile::createObjectFile(Files[FileIndex]);
+    if (!ObjectOrErr)
+      return makeError(Files[FileIndex] + ": " +
+                       toString(ObjectOrErr.takeError()));
+    PlacedObjectInfo Info;
+    for (const PlacedSection &S : P.Sections)
+      if (S.FileIndex == FileIndex)
+        Info.SectionAddress[S.SectionIndex] = S.Address;
+    Contexts.push_back(DWARFContext::create(*ObjectOrErr->getBinary(), &Info));
+    Objects.push_back(std::move(*ObjectOrErr));
+  }
+  return Error::success();
+}
+
+FunctionSamples *ProfileBuilder::getSamples(uint32_t Address,
+                                            LineLocation &Loc) {
+  auto Section = llvm::find_if(P.Sections, [&](const PlacedSection &S) {
+    return S.IsText && Address >= S.Address && Address < S.Address + S.Size;
+  });
+  if (Section == P.Sections.end())
+    return nullptr;
+
+  DILineInfoSpecifier Spec(
+      DILineInfoSpecifier::FileLineInfoKind::Default,
+      DILineInfoSpecifier::FunctionNameKind::LinkageName);
+  DIInliningInfo Frames =
+      Contexts[Section->FileIndex]->getInliningInfoForAddress(Address, Spec);
+  unsigned NumFrames = Frames.getNumberOfFrames();
+  // Instructions without a line of their own, like spills, say nothing
+  // about how often a line runs.
+  if (NumFrames == 0 || Frames.getFrame(0).Line == 0)
+    return nullptr;
+
+  // Line offsets are relative to the first line of the function, which only
+  // a subprogram DIE gives; -gline-tables-only leaves them out.
+  const DILineInfo &Outer = Frames.getFrame(NumFrames - 1);
+  if (Outer.FunctionName.empty() || Outer.FunctionName == "<invalid>")
+    return nullptr;
+
+  // Walk from the function that holds the code to the innermost function
+  // inlined into it.
+  // FunctionSamples keeps a reference to its name, so it is given the copy
+  // owned by the map it lives in.
+  auto &Entry = *Profiles.try_emplace(Outer.FunctionName).first;
+  FunctionSamples *FS = &Entry.second;
+  FS->setName(Entry.first());
+  for (unsigned I = NumFrames - 1; I != 0; --I) {
+    const DILineInfo &Callee = Frames.getFrame(I - 1);
+    FunctionSamplesMap &Callees =
+        FS->functionSamplesAt(getLineLocation(Frames.getFrame(I)));
+    auto &Inlined =
+        *Callees.insert({Callee.FunctionName, FunctionSamples()}).first;
+    FS = &Inlined.second;
+    FS->setName(Inlined.first);
+  }
+  Loc = getLineLocation(Frames.getFrame(0));
+  return FS;
+}
+
+void ProfileBuilder::addInstruction(uint32_t Address, uint64_t Count) {
+  LineLocation Loc(0, 0);
+  if (FunctionSamples *FS = getSamples(Address, Loc)) {
+    uint64_t &LineCount = LineCounts[{FS, Loc}];
+    LineCount = std::max(LineCount, Count);
+  }
+}
+
+void ProfileBuilder::addCall(uint32_t Address, uint32_t Target,
+                             uint64_t Count) {
+  const FunctionSymbol *Callee = P.findFunction(Target);
+  if (!Callee || Callee->Address != Target)
+    return;
+  LineLocation Loc(0, 0);
+  if (FunctionSamples *FS = getSamples(Address, Loc))
+    FS->addCalledTargetSamples(Loc.LineOffset, Loc.Discriminator, Callee->Name,
+                               Count);
+  auto It = Profiles.find(Callee->Name);
+  if (It != Profiles.end())
+    It->second.addHeadSamples(Count);
+}
+
+uint64_t ProfileBuilder::computeTotalSamples(FunctionSamples &FS) {
+  uint64_t Total = 0;
+  for (const auto &Body : FS.getBodySamples())
+    Total += Body.second.getSamples();
+  for (const auto &CallSite : FS.getCallsiteSamples())
+    for (auto &Callee : FS.functionSamplesAt(CallSite.first))
+      Total += computeTotalSamples(Callee.second);
+  FS.addTotalSamples(Total);
+  return Total;
+}
+
+Error ProfileBuilder::write(StringRef OutputFile, SampleProfileFormat Format) {
+  for (const auto &Entry : LineCounts)
+    Entry.first.first->addBodySamples(Entry.first.second.LineOffset,
+                                      Entry.first.second.Discriminator,
+                                      Entry.second);
+  for (auto &Entry : Profiles)
+    computeTotalSamples(Entry.second);
+
+  auto WriterOrErr = SampleProfileWriter::create(OutputFile, Format);
+  if (std::error_code EC = WriterOrErr.getError())
+    return makeError(OutputFile + ": " + EC.message());
+  if (std::error_code EC = (*WriterOrErr)->write(Profiles))
+    return makeError(OutputFile + ": " + EC.message());
+  return Error::success();
+}
+
+Error llvm::ceespusim::writeSampleProfile(const Program &P,
+                                          ArrayRef<std::string> Files,
+                                          const ExecutionProfile &EP,
+                                          StringRef OutputFile,
+                                          SampleProfileFormat Format) {
+  ProfileBuilder Builder(P);
+  if (Error E = Builder.addObjects(Files))
+    return E;
+  for (const auto &Entry : EP.Instructions)
+    Builder.addInstruction(Entry.first, Entry.second);
+  // Body samples come first, so that the head samples of a callee go to a
+  // function that has a profile.
+  for (const auto &Entry : EP.Calls)
+    Builder.addCall(Entry.first.first, Entry.first.second, Entry.second);
+  // A jump to the start of another function is a tail call.
+  for (const auto &Entry : EP.Branches) {
+    const FunctionSymbol *From = P.findFunction(Entry.first.first);
+    const FunctionSymbol *To = P.findFunction(Entry.first.second);
+    if (To && To != From && To->Address == Entry.first.second)
+      Builder.addCall(Entry.first.first, Entry.first.second, Entry.second);
+  }
+  return Builder.write(OutputFile, Format);
+}
@@ -0,0 +1,52 @@
+//===-- Profile.h - Sample profiles from simulation -------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// Records where a simulated program spends its time and turns it into a
+/// sample profile for the SampleProfile loader, the way create_llvm_prof
+/// does for hardware samples.
+///
+/// Every executed instruction is counted, so the histogram is a PC-sampling
+/// profile with a period of one instruction. The counts are mapped back to
+/// source lines through the DWARF line tables and inlining information of
+/// the input objects. A line gets the largest count of the instructions
+/// generated for it, which is how often it ran.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TOOLS_LLVM_CEESPU_SIM_PROFILE_H
+#define LLVM_TOOLS_LLVM_CEESPU_SIM_PROFILE_H
+
+#include "Program.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ProfileData/SampleProf.h"
+
+namespace llvm {
+namespace ceespusim {
+
+struct ExecutionProfile {
+  /// How many times each instruction address executed.
+  DenseMap<uint32_t, uint64_t> Instructions;
+  /// How many times each (source, target) pair of a taken branch or jump
+  /// transferred control.
+  DenseMap<std::pair<uint32_t, uint32_t>, uint64_t> Branches;
+  /// The same for calls.
+  DenseMap<std::pair<uint32_t, uint32_t>, uint64_t> Calls;
+};
+
+/// Writes the sample profile for a run of P, which was linked from Files, to
+/// OutputFile.
+Error writeSampleProfile(const Program &P, ArrayRef<std::string> Files,
+                         const ExecutionProfile &EP, StringRef OutputFile,
+                         sampleprof::SampleProfileFormat Format);
+
+} // end namespace ceespusim
+} // end namespace llvm
+
+#endif
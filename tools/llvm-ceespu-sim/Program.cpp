@@ -0,0 +1,460 @@
+//===-- Program.cpp - Ceespu program image --------------------------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Program.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/BinaryFormat/ELF.h"
+#include "llvm/Object/ELF.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <algorithm>
+
+using namespace llvm;
+using namespace llvm::ceespusim;
+using namespace llvm::object;
+
+using Elf_Shdr = ELF32LE::Shdr;
+using Elf_Sym = ELF32LE::Sym;
+using Elf_Rela = ELF32LE::Rela;
+
+/// The major opcode of SETI, OPC_SETI in CeespuInstrFormats.td. It is kept
+/// in bits 31-26 of the instruction word.
+static const uint32_t SETIOpcode = 0x2a;
+
+static Error makeError(const Twine &Msg) {
+  return make_error<StringError>(Msg, inconvertibleErrorCode());
+}
+
+static Error fileError(StringRef FileName, Error E) {
+  return makeError(FileName + ": " + toString(std::move(E)));
+}
+
+namespace {
+/// An input object and the state of linking it.
+struct InputFile {
+  std::string Name;
+  std::unique_ptr<MemoryBuffer> Buffer;
+  ELFFile<ELF32LE> File;
+  ArrayRef<Elf_Shdr> Sections;
+  ArrayRef<Elf_Sym> Symbols;
+  StringRef StringTable;
+  /// The address of each section, if it was placed.
+  std::vector<Optional<uint32_t>> SectionAddress;
+  /// Sections that belong to a COMDAT group already seen in an earlier file.
+  std::vector<bool> Discarded;
+  /// The address of each symbol, once resolved.
+  std::vector<Optional<uint32_t>> SymbolAddress;
+
+  InputFile(StringRef Name, std::unique_ptr<MemoryBuffer> Buffer,
+            ELFFile<ELF32LE> File)
+      : Name(Name), Buffer(std::move(Buffer)), File(File) {}
+
+  bool isDefinedHere(const Elf_Sym &Sym) const {
+    unsigned Index = Sym.st_shndx;
+    if (Index == ELF::SHN_UNDEF || Index == ELF::SHN_COMMON)
+      return false;
+    if (Index == ELF::SHN_ABS)
+      return true;
+    return Index < Discarded.size() && !Discarded[Index];
+  }
+};
+
+/// A global common symbol that no file defines.
+struct CommonSymbol {
+  uint64_t Size = 0;
+  uint64_t Alignment = 1;
+};
+} // end anonymous namespace
+
+static Expected<std::unique_ptr<InputFile>> readInputFile(StringRef Name) {
+  ErrorOr<std::unique_ptr<MemoryBuffer>> BufferOrErr =
+      MemoryBuffer::getFileOrSTDIN(Name);
+  if (std::error_code EC = BufferOrErr.getError())
+    return makeError(Name + ": " + EC.message());
+
+  StringRef Data = (*BufferOrErr)->getBuffer();
+  if (Data.size() < ELF::EI_NIDENT || !Data.startswith(ELF::ElfMagic) ||
+      getElfArchType(Data) !=
+          std::make_pair<uint8_t, uint8_t>(ELF::ELFCLASS32, ELF::ELFDATA2LSB))
+    return makeError(Name + ": not a 32-bit little-endian ELF file");
+
+  auto FileOrErr = ELFFile<ELF32LE>::create(Data);
+  if (!FileOrErr)
+    return fileError(Name, FileOrErr.takeError());
+  auto Input = llvm::make_unique<InputFile>(Name, std::move(*BufferOrErr),
+                                            *FileOrErr);
+  const ELFFile<ELF32LE> &File = Input->File;
+  if (File.getHeader()->e_machine != ELF::EM_CEESPU)
+    return makeError(Name + ": not a Ceespu object");
+  if (File.getHeader()->e_type != ELF::ET_REL)
+    return makeError(Name + ": not a relocatable object");
+
+  auto SectionsOrErr = File.sections();
+  if (!SectionsOrErr)
+    return fileError(Name, SectionsOrErr.takeError());
+  Input->Sections = *SectionsOrErr;
+  Input->SectionAddress.resize(Input->Sections.size());
+  Input->Discarded.resize(Input->Sections.size());
+
+  for (const Elf_Shdr &Sec : Input->Sections) {
+    if (Sec.sh_type != ELF::SHT_SYMTAB)
+      continue;
+    auto SymbolsOrErr = File.symbols(&Sec);
+    if (!SymbolsOrErr)
+      return fileError(Name, SymbolsOrErr.takeError());
+    auto StringTableOrErr = File.getStringTableForSymtab(Sec);
+    if (!StringTableOrErr)
+      return fileError(Name, StringTableOrErr.takeError());
+    Input->Symbols = *SymbolsOrErr;
+    Input->StringTable = *StringTableOrErr;
+    break;
+  }
+  Input->SymbolAddress.resize(Input->Symbols.size());
+  return std::move(Input);
+}
+
+/// Discards the members of COMDAT groups that an earlier file already
+/// provided.
+static Error discardDuplicateGroups(InputFile &Input, StringSet<> &Groups) {
+  for (const Elf_Shdr &Sec : Input.Sections) {
+    if (Sec.sh_type != ELF::SHT_GROUP)
+      continue;
+    auto MembersOrErr =
+        Input.File.getSectionContentsAsArray<support::ulittle32_t>(&Sec);
+    if (!MembersOrErr)
+      return fileError(Input.Name, MembersOrErr.takeError());
+    ArrayRef<support::ulittle32_t> Members = *MembersOrErr;
+    if (Members.empty() || !(Members[0] & ELF::GRP_COMDAT))
+      continue;
+    if (Sec.sh_info >= Input.Symbols.size())
+      return makeError(Input.Name + ": invalid COMDAT group signature");
+    auto SignatureOrErr =
+        Input.Symbols[Sec.sh_info].getName(Input.StringTable);
+    if (!SignatureOrErr)
+      return fileError(Input.Name, SignatureOrErr.takeError());
+    if (Groups.insert(*SignatureOrErr).second)
+      continue;
+    for (uint32_t Member : Members.drop_front())
+      if (Member < Input.Discarded.size())
+        Input.Discarded[Member] = true;
+  }
+  return Error::success();
+}
+
+/// Returns the order in which a section is laid out.
+static unsigned getSectionRank(StringRef Name, const Elf_Shdr &Sec) {
+  if (Name.startswith(".sdata") || Name.startswith(".sbss"))
+    return 0;
+  if (Sec.sh_flags & ELF::SHF_EXECINSTR)
+    return 1;
+  if (!(Sec.sh_flags & ELF::SHF_WRITE))
+    return 2;
+  if (Sec.sh_type != ELF::SHT_NOBITS)
+    return 3;
+  return 4;
+}
+
+static uint32_t read32(const Program &P, uint32_t Address) {
+  return support::endian::read32le(&P.Memory[Address]);
+}
+
+static void write32(Program &P, uint32_t Address, uint32_t Value) {
+  support::endian::write32le(&P.Memory[Address], Value);
+}
+
+static Error applyRelocation(Program &P, const InputFile &Input,
+                             const Elf_Rela &Rel, uint32_t Place,
+                             uint32_t SymbolValue, StringRef SymbolName) {
+  uint32_t Type = Rel.getType(false);
+  if (Type == ELF::R_CEESPU_NONE)
+    return Error::success();
+  if (uint64_t(Place) + 4 > P.Memory.size())
+    return makeError(Input.Name + ": relocation outside of the image");
+
+  uint32_t Value = SymbolValue + uint32_t(Rel.r_addend);
+  uint32_t Insn = read32(P, Place);
+  auto RangeError = [&](const Twine &What) {
+    return makeError(Input.Name + ": " + What + " for '" + SymbolName +
+                     "' at 0x" + utohexstr(Place));
+  };
+  // The split 16-bit field of stores and branches.
+  auto Split = [](uint32_t V) { return (V & 0x7ff) | ((V & 0xf800) << 10); };
+  const uint32_t SplitMask = Split(0xffff);
+
+  switch (Type) {
+  default:
+    return makeError(Input.Name + ": unsupported relocation type " +
+                     Twine(Type));
+  case ELF::R_CEESPU_32:
+    write32(P, Place, Value);
+    break;
+  case ELF::R_CEESPU_HI_16:
+    write32(P, Place, (Insn & ~0xffffU) | (Value >> 16));
+    break;
+  case ELF::R_CEESPU_LO_16:
+    write32(P, Place, (Insn & ~0xffffU) | (Value & 0xffff));
+    break;
+  case ELF::R_CEESPU_LO_12:
+    write32(P, Place, (Insn & ~SplitMask) | Split(Value));
+    break;
+  case ELF::R_CEESPU_ABS_16:
+  case ELF::R_CEESPU_ABS_16_S:
+    if (!isInt<16>(int32_t(Value)))
+      return RangeError("small data address out of range");
+    if (Type == ELF::R_CEESPU_ABS_16)
+      write32(P, Place, (Insn & ~0xffffU) | (Value & 0xffff));
+    else
+      write32(P, Place, (Insn & ~SplitMask) | Split(Value));
+    break;
+  case ELF::R_CEESPU_RJMP: {
+    int32_t Offset = int32_t(Value - Place);
+    if (!isInt<16>(Offset) || (Offset & 3))
+      return RangeError("branch target out of range");
+    write32(P, Place, (Insn & ~SplitMask) | Split(Offset));
+    break;
+  }
+  case ELF::R_CEESPU_JMP_16: {
+    // The target is only extended past 16 bits by a SETI prefix.
+    bool HasPrefix = Place >= ImageBase + 4 &&
+                     (read32(P, Place - 4) >> 26) == SETIOpcode;
+    if ((Value > 0xffff && !HasPrefix) || (Value & 3))
+      return RangeError("jump target out of range");
+    write32(P, Place, (Insn & ~0xfffcU) | (Value & 0xfffc));
+    break;
+  }
+  }
+  return Error::success();
+}
+
+const FunctionSymbol *Program::findFunction(uint32_t Address) const {
+  auto It = std::upper_bound(
+      Functions.begin(), Functions.end(), Address,
+      [](uint32_t A, const FunctionSymbol &F) { return A < F.Address; });
+  if (It == Functions.begin())
+    return nullptr;
+  --It;
+  if (Address >= It->Address + std::max<uint32_t>(It->Size, 1))
+    return nullptr;
+  return &*It;
+}
+
+Expected<Program> Program::load(ArrayRef<std::string> Files,
+                                uint32_t MemorySize) {
+  std::vector<std::unique_ptr<InputFile>> Inputs;
+  StringSet<> Groups;
+  for (const std::string &Name : Files) {
+    auto InputOrErr = readInputFile(Name);
+    if (!InputOrErr)
+      return InputOrErr.takeError();
+    Inputs.push_back(std::move(*InputOrErr));
+    if (Error E = discardDuplicateGroups(*Inputs.back(), Groups))
+      return std::move(E);
+  }
+
+  // Collect the common symbols that no file defines. They are placed with
+  // the small data so that they may be addressed either way.
+  StringSet<> Defined;
+  for (auto &Input : Inputs)
+    for (const Elf_Sym &Sym : Input->Symbols)
+      if (Sym.getBinding() != ELF::STB_LOCAL && Input->isDefinedHere(Sym))
+        if (auto NameOrErr = Sym.getName(Input->StringTable))
+          Defined.insert(*NameOrErr);
+  MapVector<StringRef, CommonSymbol> Commons;
+  for (auto &Input : Inputs)
+    for (const Elf_Sym &Sym : Input->Symbols) {
+      if (Sym.st_shndx != ELF::SHN_COMMON)
+        continue;
+      auto NameOrErr = Sym.getName(Input->StringTable);
+      if (!NameOrErr)
+        return fileError(Input->Name, NameOrErr.takeError());
+      if (Defined.count(*NameOrErr))
+        continue;
+      CommonSymbol &C = Commons[*NameOrErr];
+      C.Size = std::max<uint64_t>(C.Size, Sym.st_size);
+      C.Alignment = std::max<uint64_t>(C.Alignment, Sym.st_value);
+    }
+
+  // Place the allocated sections.
+  struct Candidate {
+    unsigned Rank;
+    unsigned FileIndex;
+    unsigned Index;
+    StringRef Name;
+  };
+  std::vector<Candidate> Candidates;
+  for (unsigned FileIndex = 0; FileIndex != Inputs.size(); ++FileIndex) {
+    InputFile *Input = Inputs[FileIndex].get();
+    for (unsigned I = 0, E = Input->Sections.size(); I != E; ++I) {
+      const Elf_Shdr &Sec = Input->Sections[I];
+      if (!(Sec.sh_flags & ELF::SHF_ALLOC) || Input->Discarded[I])
+        continue;
+      auto NameOrErr = Input->File.getSectionName(&Sec);
+      if (!NameOrErr)
+        return fileError(Input->Name, NameOrErr.takeError());
+      Candidates.push_back(
+          {getSectionRank(*NameOrErr, Sec), FileIndex, I, *NameOrErr});
+    }
+  }
+  std::stable_sort(Candidates.begin(), Candidates.end(),
+                   [](const Candidate &A, const Candidate &B) {
+                     return A.Rank < B.Rank;
+                   });
+
+  Program P;
+  uint64_t Address = ImageBase;
+  StringMap<uint32_t> CommonAddress;
+  bool PlacedCommons = false;
+  auto PlaceCommons = [&]() {
+    PlacedCommons = true;
+    for (auto &Entry : Commons) {
+      Address = alignTo(Address, std::max<uint64_t>(Entry.second.Alignment, 1));
+      CommonAddress[Entry.first] = Address;
+      Address += Entry.second.Size;
+    }
+  };
+  for (const Candidate &C : Candidates) {
+    if (C.Rank > 0 && !PlacedCommons)
+      PlaceCommons();
+    InputFile &Input = *Inputs[C.FileIndex];
+    const Elf_Shdr &Sec = Input.Sections[C.Index];
+    Address = alignTo(Address, std::max<uint64_t>(Sec.sh_addralign, 1));
+    bool IsText = Sec.sh_flags & ELF::SHF_EXECINSTR;
+    if (IsText) {
+      if (P.TextBegin == P.TextEnd)
+        P.TextBegin = Address;
+      P.TextEnd = Address + Sec.sh_size;
+    }
+    Input.SectionAddress[C.Index] = Address;
+    P.Sections.push_back({Input.Name, C.Name, C.FileIndex, C.Index,
+                          uint32_t(Address), uint32_t(Sec.sh_size), IsText});
+    Address += Sec.sh_size;
+  }
+  if (!PlacedCommons)
+    PlaceCommons();
+  if (Address > MemorySize)
+    return makeError("program needs " + Twine(Address) +
+                     " bytes of memory, but only " + Twine(MemorySize) +
+                     " are available");
+  P.Memory.assign(MemorySize, 0);
+
+  for (unsigned FileIndex = 0; FileIndex != Inputs.size(); ++FileIndex) {
+    InputFile &Input = *Inputs[FileIndex];
+    for (unsigned I = 0, E = Input.Sections.size(); I != E; ++I) {
+      const Elf_Shdr &Sec = Input.Sections[I];
+      if (!Input.SectionAddress[I] || Sec.sh_type == ELF::SHT_NOBITS)
+        continue;
+      auto ContentsOrErr = Input.File.getSectionContents(&Sec);
+      if (!ContentsOrErr)
+        return fileError(Input.Name, ContentsOrErr.takeError());
+      std::copy(ContentsOrErr->begin(), ContentsOrErr->end(),
+                P.Memory.begin() + *Input.SectionAddress[I]);
+    }
+  }
+
+  // Resolve the symbols defined in each file, then the references to other
+  // files.
+  StringSet<> Weak;
+  for (auto &Input : Inputs) {
+    for (unsigned I = 1, E = Input->Symbols.size(); I < E; ++I) {
+      const Elf_Sym &Sym = Input->Symbols[I];
+      if (!Input->isDefinedHere(Sym))
+        continue;
+      Optional<uint32_t> Value;
+      if (Sym.st_shndx == ELF::SHN_ABS)
+        Value = Sym.st_value;
+      else if (Sym.st_shndx < Input->SectionAddress.size() &&
+               Input->SectionAddress[Sym.st_shndx])
+        Value = *Input->SectionAddress[Sym.st_shndx] + Sym.st_value;
+      if (!Value)
+        continue;
+      Input->SymbolAddress[I] = Value;
+
+      auto NameOrErr = Sym.getName(Input->StringTable);
+      if (!NameOrErr)
+        return fileError(Input->Name, NameOrErr.takeError());
+      if (Sym.getType() == ELF::STT_FUNC)
+        P.Functions.push_back({*NameOrErr, *Value, uint32_t(Sym.st_size)});
+      if (Sym.getBinding() == ELF::STB_LOCAL)
+        continue;
+      bool IsWeak = Sym.getBinding() == ELF::STB_WEAK;
+      auto Inserted = P.Symbols.insert({*NameOrErr, *Value});
+      if (Inserted.second) {
+        if (IsWeak)
+          Weak.insert(*NameOrErr);
+      } else if (!Weak.count(*NameOrErr)) {
+        if (!IsWeak)
+          return makeError(Input->Name + ": duplicate symbol '" + *NameOrErr +
+                           "'");
+      } else if (!IsWeak) {
+        Inserted.first->second = *Value;
+        Weak.erase(*NameOrErr);
+      }
+    }
+  }
+  for (auto &Entry : CommonAddress)
+    P.Symbols.insert({Entry.first(), Entry.second});
+  for (auto &Input : Inputs) {
+    for (unsigned I = 1, E = Input->Symbols.size(); I < E; ++I) {
+      const Elf_Sym &Sym = Input->Symbols[I];
+      if (Input->SymbolAddress[I] || Sym.getBinding() == ELF::STB_LOCAL)
+        continue;
+      auto NameOrErr = Sym.getName(Input->StringTable);
+      if (!NameOrErr)
+        return fileError(Input->Name, NameOrErr.takeError());
+      auto It = P.Symbols.find(*NameOrErr);
+      if (It != P.Symbols.end())
+        Input->SymbolAddress[I] = It->second;
+      else if (Sym.getBinding() == ELF::STB_WEAK)
+        Input->SymbolAddress[I] = 0;
+    }
+  }
+  std::sort(P.Functions.begin(), P.Functions.end(),
+            [](const FunctionSymbol &A, const FunctionSymbol &B) {
+              return A.Address < B.Address;
+            });
+
+  // Apply the relocations of every placed section.
+  for (auto &Input : Inputs) {
+    for (const Elf_Shdr &Sec : Input->Sections) {
+      if (Sec.sh_type != ELF::SHT_RELA || Sec.sh_info >= Input->Sections.size())
+        continue;
+      Optional<uint32_t> Target = Input->SectionAddress[Sec.sh_info];
+      if (!Target)
+        continue;
+      auto RelocationsOrErr = Input->File.relas(&Sec);
+      if (!RelocationsOrErr)
+        return fileError(Input->Name, RelocationsOrErr.takeError());
+      for (const Elf_Rela &Rel : *RelocationsOrErr) {
+        uint32_t SymbolIndex = Rel.getSymbol(false);
+        StringRef SymbolName;
+        Optional<uint32_t> SymbolValue = 0;
+        if (SymbolIndex != 0) {
+          if (SymbolIndex >= Input->Symbols.size())
+            return makeError(Input->Name + ": invalid symbol index");
+          const Elf_Sym &Sym = Input->Symbols[SymbolIndex];
+          if (auto NameOrErr = Sym.getName(Input->StringTable))
+            SymbolName = *NameOrErr;
+          else
+            return fileError(Input->Name, NameOrErr.takeError());
+          SymbolValue = Input->SymbolAddress[SymbolIndex];
+          if (!SymbolValue)
+            return makeError(Input->Name + ": undefined symbol '" +
+                             SymbolName + "'");
+        }
+        if (Error E = applyRelocation(P, *Input, Rel, *Target + Rel.r_offset,
+                                      *SymbolValue, SymbolName))
+          return std::move(E);
+      }
+    }
+  }
+  return std::move(P);
+}
@@ -0,0 +1,79 @@
+//===-- Program.h - Ceespu program image ------------------------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// Links one or more Ceespu relocatable objects into a flat memory image that
+/// the simulator runs.
+///
+/// The image starts at address 0x100; the page below it is left unmapped so
+/// that null pointer accesses fault. The small data sections come first so
+/// that they can be reached with 16-bit absolute addresses, followed by text,
+/// read-only data, data and bss. The stack grows down from the top of memory.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TOOLS_LLVM_CEESPU_SIM_PROGRAM_H
+#define LLVM_TOOLS_LLVM_CEESPU_SIM_PROGRAM_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Error.h"
+#include <string>
+#include <vector>
+
+namespace llvm {
+namespace ceespusim {
+
+/// The first mapped address of the image.
+constexpr uint32_t ImageBase = 0x100;
+
+/// A section of an input object and where it was placed in the image.
+struct PlacedSection {
+  std::string FileName;
+  std::string Name;
+  unsigned FileIndex;
+  unsigned SectionIndex;
+  uint32_t Address;
+  uint32_t Size;
+  bool IsText;
+};
+
+/// A function symbol and the range of the image it covers.
+struct FunctionSymbol {
+  std::string Name;
+  uint32_t Address;
+  uint32_t Size;
+};
+
+class Program {
+public:
+  /// The memory of the simulated machine. Address 0 is the first byte.
+  std::vector<uint8_t> Memory;
+  /// The address of every global symbol that was defined.
+  StringMap<uint32_t> Symbols;
+  /// Every function symbol, local or global, sorted by address.
+  std::vector<FunctionSymbol> Functions;
+  /// Every allocated input section that was kept.
+  std::vector<PlacedSection> Sections;
+  /// The half-open range of addresses that holds code.
+  uint32_t TextBegin = 0;
+  uint32_t TextEnd = 0;
+
+  /// Returns the function that contains Address, or nullptr.
+  const FunctionSymbol *findFunction(uint32_t Address) const;
+
+  /// Links Files into an image of MemorySize bytes.
+  static Expected<Program> load(ArrayRef<std::string> Files,
+                                uint32_t MemorySize);
+};
+
+} // end namespace ceespusim
+} // end namespace llvm
+
+#endif
@@ -0,0 +1,473 @@
+//===-- Simulator.cpp - Cycle-approximate Ceespu simulator ----------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Simulator.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/MC/MCDisassembler/MCDisassembler.h"
+#include "llvm/MC/MCInstPrinter.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MathExtras.h"
+#include <algorithm>
+
+using namespace llvm;
+using namespace llvm::ceespusim;
+
+/// The return address of the entry function. Returning to it stops the
+/// program.
+static constexpr uint32_t HaltAddress = 0x80;
+
+static constexpr unsigned LinkSlot = 19;
+static constexpr unsigned StackSlot = 18;
+static constexpr unsigned ReturnSlot = 20;
+
+static Simulator::Op getOp(StringRef Name) {
+  using Op = Simulator::Op;
+  // ADE, SBB, ADEI and SBBI are the carry-setting forms that instruction
+  // selection uses; they encode as ADD, SUB, ADDI and SUBI.
+  return StringSwitch<Op>(Name)
+      .Cases("ADD", "ADE", Op::Add)
+      .Case("ADC", Op::Adc)
+      .Cases("SUB", "SBB", Op::Sub)
+      .Case("SBE", Op::Sbb)
+      .Case("AND", Op::And)
+      .Case("OR", Op::Or)
+      .Case("XOR", Op::Xor)
+      .Case("SHL", Op::Shl)
+      .Case("SHR", Op::Shr)
+      .Case("SAR", Op::Sar)
+      .Case("MUL", Op::Mul)
+      .Cases("ADDI", "ADEI", Op::AddI)
+      .Case("ADCI", Op::AdcI)
+      .Cases("SUBI", "SBBI", Op::SubI)
+      .Case("SBEI", Op::SbbI)
+      .Case("ANDI", Op::AndI)
+      .Case("ORI", Op::OrI)
+      .Case("XORI", Op::XorI)
+      .Case("SHLI", Op::ShlI)
+      .Case("SHRI", Op::ShrI)
+      .Case("SARI", Op::SarI)
+      .Case("MULI", Op::MulI)
+      .Case("SEXT8", Op::Sext8)
+      .Case("SEXT16", Op::Sext16)
+      .Case("SETHI", Op::Seti)
+      .Case("LW", Op::Lw)
+      .Case("LH", Op::Lh)
+      .Case("LHU", Op::Lhu)
+      .Case("LB", Op::Lb)
+      .Case("LBU", Op::Lbu)
+      .Case("SW", Op::Sw)
+      .Case("SH", Op::Sh)
+      .Case("SB", Op::Sb)
+      .Case("BEQ", Op::Beq)
+      .Case("BNE", Op::Bne)
+      .Case("BGT", Op::Bg)
+      .Case("BGE", Op::Bge)
+      .Case("BGU", Op::Bgu)
+      .Case("BGEU", Op::Bgeu)
+      .Case("BC", Op::Bc)
+      .Case("JMP", Op::Jmp)
+      .Case("JAL", Op::Call)
+      .Case("BX", Op::Bx)
+      .Case("JALR", Op::CallR)
+      .Default(Op::Invalid);
+}
+
+Simulator::Simulator(Program &P, const MCDisassembler &Disassembler,
+                     const MCInstrInfo &MII, const MCRegisterInfo &MRI,
+                     const MCSubtargetInfo &STI, const PipelineModel &Model)
+    : P(P), Disassembler(Disassembler), MII(MII), MRI(MRI), STI(STI),
+      Model(Model) {
+  OpcodeMap.resize(MII.getNumOpcodes());
+  for (unsigned Opc = 0, E = MII.getNumOpcodes(); Opc != E; ++Opc)
+    OpcodeMap[Opc] = getOp(MII.getName(Opc));
+  for (unsigned Reg = 1, E = MRI.getNumRegs(); Reg != E; ++Reg) {
+    StringRef Name = MRI.getName(Reg);
+    if (Name == "CARRY")
+      CarryReg = Reg;
+    else if (Name == "LR")
+      LinkReg = Reg;
+  }
+}
+
+unsigned Simulator::getSlot(unsigned Reg) const {
+  if (Reg == CarryReg)
+    return CarrySlot;
+  return MRI.getEncodingValue(Reg);
+}
+
+uint32_t Simulator::getReg(const MCInst &MI, unsigned OpIdx) const {
+  return Regs[getSlot(MI.getOperand(OpIdx).getReg())];
+}
+
+void Simulator::setReg(const MCInst &MI, unsigned OpIdx, uint32_t Value) {
+  unsigned Slot = getSlot(MI.getOperand(OpIdx).getReg());
+  if (Slot != 0)
+    Regs[Slot] = Value;
+}
+
+Error Simulator::fault(uint32_t Address, const Twine &Msg) const {
+  std::string Str;
+  raw_string_ostream OS(Str);
+  OS << "fault at pc " << format("0x%08x", PC);
+  if (const FunctionSymbol *F = P.findFunction(PC))
+    OS << " (" << F->Name << "+" << (PC - F->Address) << ")";
+  OS << ": " << Msg << format(" 0x%08x", Address);
+  return make_error<StringError>(OS.str(), inconvertibleErrorCode());
+}
+
+Expected<const Simulator::DecodedInst &> Simulator::decode(uint32_t Address) {
+  auto It = Decoded.find(Address);
+  if (It != Decoded.end())
+    return It->second;
+
+  if (Address < P.TextBegin || Address >= P.TextEnd || (Address & 3))
+    return fault(Address, "instruction fetch from");
+
+  DecodedInst D;
+  uint64_t Size;
+  ArrayRef<uint8_t> Bytes(&P.Memory[Address],
+                          std::min<uint32_t>(8, P.TextEnd - Address));
+  if (Disassembler.getInstruction(D.Inst, Size, Bytes, Address, nulls(),
+                                  nulls()) != MCDisassembler::Success)
+    return fault(Address, "invalid instruction at");
+  D.Kind = OpcodeMap[D.Inst.getOpcode()];
+  if (D.Kind == Op::Invalid)
+    return fault(Address, "unsupported instruction at");
+  D.Size = Size;
+
+  const MCInstrDesc &Desc = MII.get(D.Inst.getOpcode());
+  for (unsigned I = 0, E = D.Inst.getNumOperands(); I != E; ++I) {
+    const MCOperand &MO = D.Inst.getOperand(I);
+    if (!MO.isReg())
+      continue;
+    if (I < Desc.getNumDefs())
+      D.Writes.push_back(getSlot(MO.getReg()));
+    else
+      D.Reads.push_back(getSlot(MO.getReg()));
+  }
+  for (const MCPhysReg *R = Desc.getImplicitUses(); R && *R; ++R)
+    if (*R == CarryReg)
+      D.Reads.push_back(CarrySlot);
+  for (const MCPhysReg *R = Desc.getImplicitDefs(); R && *R; ++R)
+    if (*R == CarryReg || *R == LinkReg)
+      D.Writes.push_back(getSlot(*R));
+
+  return Decoded.insert({Address, std::move(D)}).first->second;
+}
+
+Expected<uint32_t> Simulator::load(uint32_t Address, unsigned Bytes) {
+  if (Address == CycleCountAddress && Bytes == 4)
+    return uint32_t(Stats.Cycles);
+  if (Address < ImageBase || uint64_t(Address) + Bytes > P.Memory.size())
+    return fault(Address, "load from");
+  if (Address & (Bytes - 1))
+    return fault(Address, "misaligned load from");
+  const uint8_t *Ptr = &P.Memory[Address];
+  switch (Bytes) {
+  case 1:
+    return *Ptr;
+  case 2:
+    return support::endian::read16le(Ptr);
+  default:
+    return support::endian::read32le(Ptr);
+  }
+}
+
+Error Simulator::store(uint32_t Address, unsigned Bytes, uint32_t Value) {
+  if (Address == PutCharAddress) {
+    outs() << char(Value & 0xff);
+    return Error::success();
+  }
+  if (Address == ExitAddress) {
+    ExitCode = int32_t(Value);
+    return Error::success();
+  }
+  if (Address < ImageBase || uint64_t(Address) + Bytes > P.Memory.size())
+    return fault(Address, "store to");
+  if (Address & (Bytes - 1))
+    return fault(Address, "misaligned store to");
+  uint8_t *Ptr = &P.Memory[Address];
+  switch (Bytes) {
+  case 1:
+    *Ptr = Value;
+    break;
+  case 2:
+    support::endian::write16le(Ptr, Value);
+    break;
+  default:
+    support::endian::write32le(Ptr, Value);
+    break;
+  }
+  // Forget what was decoded from code that is overwritten, including a SETI
+  // prefix that extended it.
+  if (Address < P.TextEnd && Address + Bytes > P.TextBegin) {
+    uint32_t Word = alignDown(Address, 4);
+    Decoded.erase(Word);
+    Decoded.erase(Word - 4);
+  }
+  return Error::success();
+}
+
+Expected<int> Simulator::run(uint32_t Entry, uint64_t MaxInstructions) {
+  std::fill(std::begin(Regs), std::end(Regs), 0);
+  std::fill(std::begin(ReadyAt), std::end(ReadyAt), 0);
+  Carry = false;
+  ExitCode = None;
+  Stats = SimulationStats();
+  Regs[StackSlot] = alignDown(P.Memory.size(), 8);
+  Regs[LinkSlot] = HaltAddress;
+  PC = Entry;
+
+  while (!ExitCode) {
+    if (PC == HaltAddress) {
+      ExitCode = int32_t(Regs[ReturnSlot]);
+      break;
+    }
+    if (MaxInstructions && Stats.Instructions == MaxInstructions)
+      return make_error<StringError>("program did not exit within " +
+                                         Twine(MaxInstructions) +
+                                         " instructions",
+                                     inconvertibleErrorCode());
+
+    auto DecodedOrErr = decode(PC);
+    if (!DecodedOrErr)
+      return DecodedOrErr.takeError();
+    const DecodedInst &D = *DecodedOrErr;
+    const MCInst &MI = D.Inst;
+
+    // Wait for the registers that the instruction reads.
+    uint64_t Issue = Stats.Cycles;
+    for (unsigned Slot : D.Reads)
+      Issue = std::max(Issue, ReadyAt[Slot]);
+    Stats.StallCycles += Issue - Stats.Cycles;
+    Stats.Cycles = Issue;
+    ++Stats.Instructions;
+
+    if (TraceOS) {
+      *TraceOS << format("%8" PRIu64 "  %08x:", Issue, PC);
+      if (Printer)
+        Printer->printInst(&MI, *TraceOS, "", STI);
+      *TraceOS << '\n';
+    }
+
+    uint32_t NextPC = PC + D.Size;
+    unsigned Latency = 1;
+    bool Taken = false;
+    auto Imm = [&](unsigned OpIdx) {
+      return uint32_t(MI.getOperand(OpIdx).getImm());
+    };
+    auto Branch = [&](bool Cond, uint32_t Offset) {
+      if (Cond) {
+        NextPC = PC + Offset;
+        Taken = true;
+      }
+    };
+    auto Jump = [&](uint32_t Target) {
+      NextPC = Target;
+      Taken = true;
+    };
+    auto Load = [&](unsigned Bytes, bool Signed) -> Error {
+      auto ValueOrErr = load(getReg(MI, 1) + Imm(2), Bytes);
+      if (!ValueOrErr)
+        return ValueOrErr.takeError();
+      uint32_t Value = *ValueOrErr;
+      if (Signed)
+        Value = Bytes == 1 ? SignExtend32<8>(Value) : SignExtend32<16>(Value);
+      setReg(MI, 0, Value);
+      Latency += Model.LoadUsePenalty;
+      return Error::success();
+    };
+    auto Store = [&](unsigned Bytes) {
+      return store(getReg(MI, 1) + Imm(2), Bytes, getReg(MI, 0));
+    };
+    // Register-register operations compute "ra OP rb", where ra is the
+    // second source operand.
+    uint32_t A = 0, B = 0;
+    switch (D.Kind) {
+    case Op::Add: case Op::Adc: case Op::Sub: case Op::Sbb: case Op::And:
+    case Op::Or: case Op::Xor: case Op::Mul:
+      A = getReg(MI, 2);
+      B = getReg(MI, 1);
+      break;
+    case Op::AddI: case Op::AdcI: case Op::SubI: case Op::SbbI:
+    case Op::AndI: case Op::OrI: case Op::XorI: case Op::MulI:
+      A = getReg(MI, 1);
+      B = Imm(2);
+      break;
+    default:
+      break;
+    }
+
+    switch (D.Kind) {
+    case Op::Invalid:
+      llvm_unreachable("Invalid instructions are not decoded");
+    case Op::Add:
+    case Op::AddI:
+      setReg(MI, 0, A + B);
+      Carry = A + B < A;
+      break;
+    case Op::Adc:
+    case Op::AdcI: {
+      uint64_t Sum = uint64_t(A) + B + Carry;
+      setReg(MI, 0, Sum);
+      Carry = Sum >> 32;
+      break;
+    }
+    case Op::Sub:
+    case Op::SubI:
+      setReg(MI, 0, A - B);
+      Carry = A < B;
+      break;
+    case Op::Sbb:
+    case Op::SbbI: {
+      uint64_t Subtrahend = uint64_t(B) + Carry;
+      setReg(MI, 0, A - Subtrahend);
+      Carry = A < Subtrahend;
+      break;
+    }
+    case Op::And:
+    case Op::AndI:
+      setReg(MI, 0, A & B);
+      break;
+    case Op::Or:
+    case Op::OrI:
+      setReg(MI, 0, A | B);
+      break;
+    case Op::Xor:
+    case Op::XorI:
+      setReg(MI, 0, A ^ B);
+      break;
+    case Op::Mul:
+    case Op::MulI:
+      setReg(MI, 0, A * B);
+      Latency += Model.MulPenalty;
+      break;
+    // Register shifts shift the first source operand by the second.
+    case Op::Shl:
+      setReg(MI, 0, getReg(MI, 1) << (getReg(MI, 2) & 31));
+      break;
+    case Op::Shr:
+      setReg(MI, 0, getReg(MI, 1) >> (getReg(MI, 2) & 31));
+      break;
+    case Op::Sar:
+      setReg(MI, 0, int32_t(getReg(MI, 1)) >> (getReg(MI, 2) & 31));
+      break;
+    case Op::ShlI:
+      setReg(MI, 0, getReg(MI, 1) << (Imm(2) & 31));
+      break;
+    case Op::ShrI:
+      setReg(MI, 0, getReg(MI, 1) >> (Imm(2) & 31));
+      break;
+    case Op::SarI:
+      setReg(MI, 0, int32_t(getReg(MI, 1)) >> (Imm(2) & 31));
+      break;
+    case Op::Sext8:
+      setReg(MI, 0, SignExtend32<8>(getReg(MI, 1)));
+      break;
+    case Op::Sext16:
+      setReg(MI, 0, SignExtend32<16>(getReg(MI, 1)));
+      break;
+    case Op::Seti:
+      // A prefix that extends nothing has no effect.
+      break;
+    case Op::Lw:
+      if (Error E = Load(4, false))
+        return std::move(E);
+      break;
+    case Op::Lh:
+      if (Error E = Load(2, true))
+        return std::move(E);
+      break;
+    case Op::Lhu:
+      if (Error E = Load(2, false))
+        return std::move(E);
+      break;
+    case Op::Lb:
+      if (Error E = Load(1, true))
+        return std::move(E);
+      break;
+    case Op::Lbu:
+      if (Error E = Load(1, false))
+        return std::move(E);
+      break;
+    case Op::Sw:
+      if (Error E = Store(4))
+        return std::move(E);
+      break;
+    case Op::Sh:
+      if (Error E = Store(2))
+        return std::move(E);
+      break;
+    case Op::Sb:
+      if (Error E = Store(1))
+        return std::move(E);
+      break;
+    case Op::Beq:
+      Branch(getReg(MI, 0) == getReg(MI, 1), Imm(2));
+      break;
+    case Op::Bne:
+      Branch(getReg(MI, 0) != getReg(MI, 1), Imm(2));
+      break;
+    case Op::Bg:
+      Branch(int32_t(getReg(MI, 0)) > int32_t(getReg(MI, 1)), Imm(2));
+      break;
+    case Op::Bge:
+      Branch(int32_t(getReg(MI, 0)) >= int32_t(getReg(MI, 1)), Imm(2));
+      break;
+    case Op::Bgu:
+      Branch(getReg(MI, 0) > getReg(MI, 1), Imm(2));
+      break;
+    case Op::Bgeu:
+      Branch(getReg(MI, 0) >= getReg(MI, 1), Imm(2));
+      break;
+    case Op::Bc:
+      Branch(Carry, Imm(0));
+      break;
+    case Op::Jmp:
+      Jump(Imm(0) & ~3U);
+      break;
+    case Op::Call:
+      Regs[LinkSlot] = NextPC;
+      Jump(Imm(0) & ~3U);
+      break;
+    case Op::Bx:
+      Jump(getReg(MI, 0));
+      break;
+    case Op::CallR: {
+      uint32_t Target = getReg(MI, 0);
+      Regs[LinkSlot] = NextPC;
+      Jump(Target);
+      break;
+    }
+    }
+
+    // A SETI prefixed pair takes two issue cycles.
+    unsigned IssueCycles = D.Size / 4;
+    for (unsigned Slot : D.Writes)
+      if (Slot != 0)
+        ReadyAt[Slot] = Issue + IssueCycles - 1 + Latency;
+    Stats.Cycles += IssueCycles;
+    if (Taken) {
+      Stats.Cycles += Model.TakenBranchPenalty;
+      ++Stats.TakenBranches;
+    }
+    if (Profile) {
+      ++Profile->Instructions[PC];
+      if (Taken) {
+        bool IsCall = D.Kind == Op::Call || D.Kind == Op::CallR;
+        ++(IsCall ? Profile->Calls : Profile->Branches)[{PC, NextPC}];
+      }
+    }
+    PC = NextPC;
+  }
+  return *ExitCode;
+}
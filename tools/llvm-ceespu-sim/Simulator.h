@@ -0,0 +1,152 @@
+//===-- Simulator.h - Cycle-approximate Ceespu simulator --------*- C++ -*-===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+/// \file
+///
+/// Executes a Ceespu program image one instruction at a time, decoding with
+/// the target's MC disassembler.
+///
+/// Timing follows a single-issue in-order pipeline. Every instruction issues
+/// in one cycle, or two for a SETI prefixed pair, once the registers it reads
+/// are ready. A load result is ready LoadUsePenalty cycles later than an ALU
+/// result and a multiply result MulPenalty cycles later. Every taken branch,
+/// jump, call and return costs TakenBranchPenalty extra cycles.
+///
+/// A store to 0xfffffff0 writes its low byte to stdout, and a store to
+/// 0xfffffff4 stops the program with the stored value as the exit code. A
+/// load from 0xfffffff8 returns the current cycle count. The program also
+/// stops when the entry function returns, with c20 as the exit code.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef LLVM_TOOLS_LLVM_CEESPU_SIM_SIMULATOR_H
+#define LLVM_TOOLS_LLVM_CEESPU_SIM_SIMULATOR_H
+
+#include "Profile.h"
+#include "Program.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/MC/MCInst.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace llvm {
+class MCDisassembler;
+class MCInstPrinter;
+class MCInstrInfo;
+class MCRegisterInfo;
+class MCSubtargetInfo;
+
+namespace ceespusim {
+
+/// Addresses of the memory-mapped I/O registers.
+enum : uint32_t {
+  PutCharAddress = 0xfffffff0,
+  ExitAddress = 0xfffffff4,
+  CycleCountAddress = 0xfffffff8,
+};
+
+/// The extra cycles charged by the pipeline model.
+struct PipelineModel {
+  unsigned LoadUsePenalty = 1;
+  unsigned MulPenalty = 2;
+  unsigned TakenBranchPenalty = 2;
+};
+
+struct SimulationStats {
+  uint64_t Instructions = 0;
+  uint64_t Cycles = 0;
+  /// Cycles spent waiting for a load or multiply result.
+  uint64_t StallCycles = 0;
+  uint64_t TakenBranches = 0;
+};
+
+class Simulator {
+public:
+  /// The operations that the simulator implements.
+  enum class Op {
+    Invalid,
+    Add, Adc, Sub, Sbb, And, Or, Xor, Shl, Shr, Sar, Mul,
+    AddI, AdcI, SubI, SbbI, AndI, OrI, XorI, ShlI, ShrI, SarI, MulI,
+    Sext8, Sext16, Seti,
+    Lw, Lh, Lhu, Lb, Lbu, Sw, Sh, Sb,
+    Beq, Bne, Bg, Bge, Bgu, Bgeu, Bc,
+    Jmp, Call, Bx, CallR,
+  };
+
+  Simulator(Program &P, const MCDisassembler &Disassembler,
+            const MCInstrInfo &MII, const MCRegisterInfo &MRI,
+            const MCSubtargetInfo &STI, const PipelineModel &Model);
+
+  /// Prints every executed instruction to OS, using Printer.
+  void setTrace(raw_ostream *OS, MCInstPrinter *Printer) {
+    TraceOS = OS;
+    this->Printer = Printer;
+  }
+
+  /// Records the instructions and branches executed into EP.
+  void setProfile(ExecutionProfile *EP) { Profile = EP; }
+
+  /// Runs from Entry with the stack at the top of memory until the program
+  /// exits, and returns its exit code. Fails if the program faults or does
+  /// not exit within MaxInstructions, if that is not zero.
+  Expected<int> run(uint32_t Entry, uint64_t MaxInstructions);
+
+  const SimulationStats &getStats() const { return Stats; }
+
+private:
+  struct DecodedInst {
+    MCInst Inst;
+    Op Kind;
+    unsigned Size;
+    /// Register slots read and written, including the carry.
+    SmallVector<unsigned, 3> Reads;
+    SmallVector<unsigned, 2> Writes;
+  };
+
+  /// The register file slot of the carry flag.
+  static constexpr unsigned CarrySlot = 32;
+  static constexpr unsigned NumSlots = 33;
+
+  Expected<const DecodedInst &> decode(uint32_t Address);
+  unsigned getSlot(unsigned Reg) const;
+  uint32_t getReg(const MCInst &MI, unsigned OpIdx) const;
+  void setReg(const MCInst &MI, unsigned OpIdx, uint32_t Value);
+
+  Expected<uint32_t> load(uint32_t Address, unsigned Bytes);
+  Error store(uint32_t Address, unsigned Bytes, uint32_t Value);
+  Error fault(uint32_t Address, const Twine &Msg) const;
+
+  Program &P;
+  const MCDisassembler &Disassembler;
+  const MCInstrInfo &MII;
+  const MCRegisterInfo &MRI;
+  const MCSubtargetInfo &STI;
+  PipelineModel Model;
+  raw_ostream *TraceOS = nullptr;
+  MCInstPrinter *Printer = nullptr;
+  ExecutionProfile *Profile = nullptr;
+
+  /// The operation of each target opcode.
+  std::vector<Op> OpcodeMap;
+  unsigned CarryReg = 0;
+  unsigned LinkReg = 0;
+  DenseMap<uint32_t, DecodedInst> Decoded;
+
+  uint32_t Regs[32];
+  bool Carry = false;
+  uint32_t PC = 0;
+  /// The cycle at which each register slot can be read.
+  uint64_t ReadyAt[NumSlots];
+  Optional<int> ExitCode;
+  SimulationStats Stats;
+};
+
+} // end namespace ceespusim
+} // end namespace llvm
+
+#endif
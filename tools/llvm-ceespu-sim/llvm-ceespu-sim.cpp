@@ -0,0 +1,166 @@
+//===-- llvm-ceespu-sim.cpp - Ceespu instruction set simulator ------------===//
+//
+//                     The LLVM Compiler Infrastructure
+//
+// This file is distributed under the University of Illinois Open Source
+// License. See LICENSE.TXT for details.
+//
+//===----------------------------------------------------------------------===//
+//
+// This utility links Ceespu relocatable objects into a flat image and runs
+// it on a cycle-approximate model of the core. Its exit code is the exit code
+// of the simulated program, and it reports the number of cycles taken so that
+// generated code can be compared without hardware. It can also write a
+// sample profile of the run for -fprofile-sample-use.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Profile.h"
+#include "Program.h"
+#include "Simulator.h"
+#include "llvm/MC/MCAsmInfo.h"
+#include "llvm/MC/MCContext.h"
+#include "llvm/MC/MCDisassembler/MCDisassembler.h"
+#include "llvm/MC/MCInstPrinter.h"
+#include "llvm/MC/MCInstrInfo.h"
+#include "llvm/MC/MCRegisterInfo.h"
+#include "llvm/MC/MCSubtargetInfo.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/TargetRegistry.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/WithColor.h"
+
+using namespace llvm;
+using namespace llvm::ceespusim;
+
+static cl::list<std::string> InputFilenames(cl::Positional, cl::OneOrMore,
+                                            cl::desc("<input objects>"));
+
+static cl::opt<std::string>
+    EntrySymbol("entry", cl::desc("Symbol to start execution at"),
+                cl::init("main"));
+
+static cl::opt<unsigned>
+    MemorySize("mem-size", cl::desc("Size of the simulated memory in bytes"),
+               cl::init(1 << 20));
+
+static cl::opt<unsigned> MaxInstructions(
+    "max-instructions",
+    cl::desc("Stop with an error after this many instructions (0 = no limit)"),
+    cl::init(0));
+
+static cl::opt<unsigned> LoadUsePenalty(
+    "load-use-penalty",
+    cl::desc("Extra cycles before a loaded value can be used"), cl::init(1));
+
+static cl::opt<unsigned> MulPenalty(
+    "mul-penalty",
+    cl::desc("Extra cycles before a multiply result can be used"),
+    cl::init(2));
+
+static cl::opt<unsigned> TakenBranchPenalty(
+    "taken-branch-penalty",
+    cl::desc("Extra cycles for a taken branch, jump, call or return"),
+    cl::init(2));
+
+static cl::opt<bool> Trace("trace",
+                           cl::desc("Print every instruction as it issues"),
+                           cl::init(false));
+
+static cl::opt<bool> NoStats("no-stats",
+                             cl::desc("Do not print the run statistics"),
+                             cl::init(false));
+
+static cl::opt<std::string>
+    ProfileOutput("profile-output",
+                  cl::desc("Write a sample profile of the run to this file"),
+                  cl::value_desc("filename"));
+
+static cl::opt<sampleprof::SampleProfileFormat> ProfileFormat(
+    "profile-format", cl::desc("Format of the sample profile"),
+    cl::init(sampleprof::SPF_Text),
+    cl::values(clEnumValN(sampleprof::SPF_Text, "text", "Text encoding"),
+               clEnumValN(sampleprof::SPF_Binary, "binary",
+                          "Binary encoding")));
+
+static const char *ToolName;
+
+static int error(const Twine &Msg) {
+  WithColor::error(errs(), ToolName) << Msg << '\n';
+  return 1;
+}
+
+int main(int argc, char **argv) {
+  InitLLVM X(argc, argv);
+  ToolName = argv[0];
+
+  InitializeAllTargetInfos();
+  InitializeAllTargetMCs();
+  InitializeAllDisassemblers();
+
+  cl::ParseCommandLineOptions(argc, argv, "Ceespu instruction set simulator\n");
+
+  std::string TripleName = "ceespu";
+  std::string Err;
+  const Target *TheTarget = TargetRegistry::lookupTarget(TripleName, Err);
+  if (!TheTarget)
+    return error(Err);
+
+  std::unique_ptr<MCRegisterInfo> MRI(TheTarget->createMCRegInfo(TripleName));
+  std::unique_ptr<MCAsmInfo> MAI(TheTarget->createMCAsmInfo(*MRI, TripleName));
+  std::unique_ptr<MCInstrInfo> MII(TheTarget->createMCInstrInfo());
+  std::unique_ptr<MCSubtargetInfo> STI(
+      TheTarget->createMCSubtargetInfo(TripleName, "", ""));
+  if (!MRI || !MAI || !MII || !STI)
+    return error("unable to create the Ceespu target description");
+
+  MCContext Ctx(MAI.get(), MRI.get(), nullptr);
+  std::unique_ptr<MCDisassembler> Disassembler(
+      TheTarget->createMCDisassembler(*STI, Ctx));
+  if (!Disassembler)
+    return error("no disassembler for the Ceespu target");
+
+  std::unique_ptr<MCInstPrinter> Printer;
+  if (Trace)
+    Printer.reset(TheTarget->createMCInstPrinter(
+        Triple(TripleName), MAI->getAssemblerDialect(), *MAI, *MII, *MRI));
+
+  auto ProgramOrErr = Program::load(InputFilenames, MemorySize);
+  if (!ProgramOrErr)
+    return error(toString(ProgramOrErr.takeError()));
+  Program &P = *ProgramOrErr;
+
+  auto Entry = P.Symbols.find(EntrySymbol);
+  if (Entry == P.Symbols.end())
+    return error("entry symbol '" + EntrySymbol + "' is not defined");
+
+  PipelineModel Model;
+  Model.LoadUsePenalty = LoadUsePenalty;
+  Model.MulPenalty = MulPenalty;
+  Model.TakenBranchPenalty = TakenBranchPenalty;
+
+  Simulator Sim(P, *Disassembler, *MII, *MRI, *STI, Model);
+  if (Trace)
+    Sim.setTrace(&errs(), Printer.get());
+  ExecutionProfile Profile;
+  if (!ProfileOutput.empty())
+    Sim.setProfile(&Profile);
+  Expected<int> ExitCode = Sim.run(Entry->second, MaxInstructions);
+  outs().flush();
+
+  const SimulationStats &Stats = Sim.getStats();
+  if (!NoStats) {
+    errs() << "instructions:   " << Stats.Instructions << '\n'
+           << "cycles:         " << Stats.Cycles << '\n'
+           << "stall cycles:   " << Stats.StallCycles << '\n'
+           << "taken branches: " << Stats.TakenBranches << '\n';
+  }
+  if (!ExitCode)
+    return error(toString(ExitCode.takeError()));
+  if (!ProfileOutput.empty())
+    if (Error E = writeSampleProfile(P, InputFilenames, Profile, ProfileOutput,
+                                     ProfileFormat))
+      return error(toString(std::move(E)));
+  return *ExitCode;
+}
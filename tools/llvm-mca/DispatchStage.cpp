@@ -63,6 +63,38 @@ bool DispatchStage::checkScheduler(const InstRef &IR) {
   return SC->canBeDispatched(IR);
 }
 
+static int getReadAdvance(const ReadState &RS, const WriteState &WS,
+                          const MCSubtargetInfo &STI) {
+  const ReadDescriptor &RD = RS.getDescriptor();
+  if (!RD.HasReadAdvanceEntries)
+    return 0;
+  const MCSchedClassDesc *SC =
+      STI.getSchedModel().getSchedClassDesc(RD.SchedClassID);
+  return STI.getReadAdvanceCycles(SC, RD.UseIndex, WS.getWriteResourceID());
+}
+
+bool DispatchStage::checkOperands(const InstRef &IR) {
+  // An out-of-order processor waits for the operands in the schedulers.
+  if (STI.getSchedModel().isOutOfOrder())
+    return true;
+
+  SmallVector<WriteState *, 4> DependentWrites;
+  for (const std::unique_ptr<ReadState> &RS : IR.getInstruction()->getUses()) {
+    collectWrites(DependentWrites, RS->getRegisterID());
+    for (const WriteState *WS : DependentWrites) {
+      int CyclesLeft = WS->getCyclesLeft();
+      if (CyclesLeft == UNKNOWN_CYCLES ||
+          CyclesLeft > getReadAdvance(*RS, *WS, STI)) {
+        Owner->notifyStallEvent(
+            HWStallEvent(HWStallEvent::RegisterDependencyStall, IR));
+        return false;
+      }
+    }
+    DependentWrites.clear();
+  }
+  return true;
+}
+
 void DispatchStage::updateRAWDependencies(ReadState &RS,
                                           const MCSubtargetInfo &STI) {
   SmallVector<WriteState *, 4> DependentWrites;
@@ -42,6 +42,9 @@ class Backend;
 //     RetireControlUnit) to accommodate all opcodes.
 //  2) There are enough temporaries to rename output register operands.
 //  3) There are enough entries available in the used buffered resource(s).
+//  4) On an in-order processor, the registers that it reads are available.
+//     Such a processor issues an instruction in the cycle that it is
+//     dispatched.
 //
 // The number of micro opcodes that can be dispatched in one cycle is limited by
 // the value of field 'DispatchWidth'. A "dynamic dispatch stall" occurs when
@@ -68,6 +71,7 @@ class DispatchStage : public Stage {
   bool checkRCU(const InstRef &IR);
   bool checkPRF(const InstRef &IR);
   bool checkScheduler(const InstRef &IR);
+  bool checkOperands(const InstRef &IR);
   void dispatch(InstRef IR);
   bool isRCUEmpty() const { return RCU.isEmpty(); }
   void updateRAWDependencies(ReadState &RS, const llvm::MCSubtargetInfo &STI);
@@ -81,7 +85,8 @@ class DispatchStage : public Stage {
 
   bool canDispatch(const InstRef &IR) {
     assert(isAvailable(IR.getInstruction()->getDesc().NumMicroOps));
-    return checkRCU(IR) && checkPRF(IR) && checkScheduler(IR);
+    return checkRCU(IR) && checkPRF(IR) && checkScheduler(IR) &&
+           checkOperands(IR);
   }
 
   void collectWrites(llvm::SmallVectorImpl<WriteState *> &Vec,
@@ -63,6 +63,10 @@ void DispatchStatistics::printDispatchStalls(raw_ostream &OS) const {
              << HWStalls[HWStallEvent::StoreQueueFull];
   TempStream << "\nGROUP   - Static restrictions on the dispatch group: "
              << HWStalls[HWStallEvent::DispatchGroupStall];
+  // Only an in-order processor waits for operands at dispatch.
+  if (HWStalls[HWStallEvent::RegisterDependencyStall])
+    TempStream << "\nDEP     - Register operands not ready:               "
+               << HWStalls[HWStallEvent::RegisterDependencyStall];
   TempStream << '\n';
   TempStream.flush();
   OS << Buffer;
@@ -23,7 +23,8 @@ bool FetchStage::execute(InstRef &IR) {
   if (!SM.hasNext())
     return false;
   const SourceRef SR = SM.peekNext();
-  std::unique_ptr<Instruction> I = IB.createInstruction(*SR.second);
+  const llvm::MCInst &Next = SM.getMCInstFromIndex(SR.first + 1);
+  std::unique_ptr<Instruction> I = IB.createInstruction(*SR.second, &Next);
   IR = InstRef(SR.first, I.get());
   Instructions[IR.getSourceIndex()] = std::move(I);
   return true;
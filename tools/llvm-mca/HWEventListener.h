@@ -97,6 +97,7 @@ public:
     // Generic stall events generated by the DispatchStage.
     RegisterFileStall,
     RetireControlUnitStall,
+    RegisterDependencyStall,
     // Generic stall events generated by the Scheduler.
     DispatchGroupStall,
     SchedulerQueueFull,
@@ -385,7 +385,41 @@ static void populateReads(InstrDesc &ID, const MCInst &MCI,
   }
 }
 
-const InstrDesc &InstrBuilder::createInstrDescImpl(const MCInst &MCI) {
+// A prefix issues together with the instruction that it extends, so it has to
+// wait for the registers that the extended instruction reads.
+static void populatePrefixReads(InstrDesc &ID, const MCInst &Extended,
+                                const MCInstrDesc &ExtendedDesc,
+                                unsigned SchedClassID) {
+  auto AddRead = [&](unsigned RegID) {
+    ReadDescriptor Read;
+    Read.OpIndex = -1;
+    Read.UseIndex = ID.Reads.size();
+    Read.RegisterID = RegID;
+    Read.SchedClassID = SchedClassID;
+    Read.HasReadAdvanceEntries = false;
+    ID.Reads.push_back(Read);
+    LLVM_DEBUG(dbgs() << "\t\tPrefix read of RegisterID=" << RegID << '\n');
+  };
+
+  unsigned NumExplicitDefs = ExtendedDesc.getNumDefs();
+  for (unsigned I = 0, E = Extended.getNumOperands(); I < E; ++I) {
+    const MCOperand &Op = Extended.getOperand(I);
+    if (!Op.isReg())
+      continue;
+    if (NumExplicitDefs) {
+      --NumExplicitDefs;
+      continue;
+    }
+    if (Op.getReg())
+      AddRead(Op.getReg());
+  }
+
+  for (unsigned I = 0, E = ExtendedDesc.getNumImplicitUses(); I < E; ++I)
+    AddRead(ExtendedDesc.getImplicitUses()[I]);
+}
+
+const InstrDesc &InstrBuilder::createInstrDescImpl(const MCInst &MCI,
+                                                   const MCInst *Extended) {
   assert(STI.getSchedModel().hasInstrSchedModel() &&
          "Itineraries are not yet supported!");
 
@@ -434,13 +468,17 @@ const InstrDesc &InstrBuilder::createInstrDescImpl(const MCInst &MCI) {
   computeMaxLatency(*ID, MCDesc, SCDesc, STI);
   populateWrites(*ID, MCI, MCDesc, SCDesc, STI);
   populateReads(*ID, MCI, MCDesc, SCDesc, STI);
+  if (Extended)
+    populatePrefixReads(*ID, *Extended, MCII.get(Extended->getOpcode()),
+                        SchedClassID);
 
   LLVM_DEBUG(dbgs() << "\t\tMaxLatency=" << ID->MaxLatency << '\n');
   LLVM_DEBUG(dbgs() << "\t\tNumMicroOps=" << ID->NumMicroOps << '\n');
 
-  // Now add the new descriptor.
+  // Now add the new descriptor. The descriptor of a prefix depends on the
+  // instruction that it extends, so it is specific to MCI.
   SchedClassID = MCDesc.getSchedClass();
-  if (!SM.getSchedClassDesc(SchedClassID)->isVariant()) {
+  if (!Extended && !SM.getSchedClassDesc(SchedClassID)->isVariant()) {
     Descriptors[MCI.getOpcode()] = std::move(ID);
     return *Descriptors[MCI.getOpcode()];
   }
@@ -449,19 +487,21 @@ const InstrDesc &InstrBuilder::createInstrDescImpl(const MCInst &MCI) {
   return *VariantDescriptors[&MCI];
 }
 
-const InstrDesc &InstrBuilder::getOrCreateInstrDesc(const MCInst &MCI) {
-  if (Descriptors.find_as(MCI.getOpcode()) != Descriptors.end())
+const InstrDesc &InstrBuilder::getOrCreateInstrDesc(const MCInst &MCI,
+                                                    const MCInst *Next) {
+  const MCInst *Extended = Next && MCIA && MCIA->isPrefix(MCI) ? Next : nullptr;
+  if (!Extended && Descriptors.find_as(MCI.getOpcode()) != Descriptors.end())
     return *Descriptors[MCI.getOpcode()];
 
   if (VariantDescriptors.find(&MCI) != VariantDescriptors.end())
     return *VariantDescriptors[&MCI];
 
-  return createInstrDescImpl(MCI);
+  return createInstrDescImpl(MCI, Extended);
 }
 
 std::unique_ptr<Instruction>
-InstrBuilder::createInstruction(const MCInst &MCI) {
-  const InstrDesc &D = getOrCreateInstrDesc(MCI);
+InstrBuilder::createInstruction(const MCInst &MCI, const MCInst *Next) {
+  const InstrDesc &D = getOrCreateInstrDesc(MCI, Next);
   std::unique_ptr<Instruction> NewIS = llvm::make_unique<Instruction>(D);
 
   // Initialize Reads first.
@@ -17,6 +17,7 @@
 
 #include "Instruction.h"
 #include "Support.h"
+#include "llvm/MC/MCInstrAnalysis.h"
 #include "llvm/MC/MCInstrInfo.h"
 #include "llvm/MC/MCSubtargetInfo.h"
 
@@ -34,27 +35,36 @@ class DispatchUnit;
 /// descriptors (i.e. InstrDesc objects).
 /// Information from the machine scheduling model is used to identify processor
 /// resources that are consumed by an instruction.
+///
+/// A prefix (see MCInstrAnalysis::isPrefix) issues together with the
+/// instruction that it extends. Given that instruction, the builder makes the
+/// prefix also wait for the registers that it reads.
 class InstrBuilder {
   const llvm::MCSubtargetInfo &STI;
   const llvm::MCInstrInfo &MCII;
+  const llvm::MCInstrAnalysis *MCIA;
   llvm::SmallVector<uint64_t, 8> ProcResourceMasks;
 
   llvm::DenseMap<unsigned short, std::unique_ptr<const InstrDesc>> Descriptors;
   llvm::DenseMap<const llvm::MCInst *, std::unique_ptr<const InstrDesc>>
       VariantDescriptors;
 
-  const InstrDesc &createInstrDescImpl(const llvm::MCInst &MCI);
+  const InstrDesc &createInstrDescImpl(const llvm::MCInst &MCI,
+                                       const llvm::MCInst *Extended);
   InstrBuilder(const InstrBuilder &) = delete;
   InstrBuilder &operator=(const InstrBuilder &) = delete;
 
 public:
-  InstrBuilder(const llvm::MCSubtargetInfo &sti, const llvm::MCInstrInfo &mcii)
-      : STI(sti), MCII(mcii),
+  InstrBuilder(const llvm::MCSubtargetInfo &sti, const llvm::MCInstrInfo &mcii,
+               const llvm::MCInstrAnalysis *mcia = nullptr)
+      : STI(sti), MCII(mcii), MCIA(mcia),
         ProcResourceMasks(STI.getSchedModel().getNumProcResourceKinds()) {
     computeProcResourceMasks(STI.getSchedModel(), ProcResourceMasks);
   }
 
-  const InstrDesc &getOrCreateInstrDesc(const llvm::MCInst &MCI);
+  // Next is the instruction that follows MCI in the sequence, if known.
+  const InstrDesc &getOrCreateInstrDesc(const llvm::MCInst &MCI,
+                                        const llvm::MCInst *Next = nullptr);
   // Returns an array of processor resource masks.
   // Masks are computed by function mca::computeProcResourceMasks. see
   // Support.h for a description of how masks are computed and how masks can be
@@ -63,7 +73,8 @@ public:
     return ProcResourceMasks;
   }
 
-  std::unique_ptr<Instruction> createInstruction(const llvm::MCInst &MCI);
+  std::unique_ptr<Instruction>
+  createInstruction(const llvm::MCInst &MCI, const llvm::MCInst *Next = nullptr);
 };
 } // namespace mca
 
@@ -35,6 +35,11 @@ RetireControlUnit::RetireControlUnit(const llvm::MCSchedModel &SM)
     MaxRetirePerCycle = EPI.MaxRetirePerCycle;
   }
 
+  // An in-order processor has no reorder buffer. Its instructions still
+  // complete out of order, so they are queued to retire in program order.
+  if (!AvailableSlots)
+    AvailableSlots = InOrderQueueSize;
+
   assert(AvailableSlots && "Invalid reorder buffer size!");
   Queue.resize(AvailableSlots);
 }
@@ -63,6 +63,9 @@ private:
   unsigned MaxRetirePerCycle; // 0 means no limit.
   std::vector<RUToken> Queue;
 
+  // The number of tokens available on a processor without a reorder buffer.
+  static const unsigned InOrderQueueSize = 256;
+
 public:
   RetireControlUnit(const llvm::MCSchedModel &SM);
 
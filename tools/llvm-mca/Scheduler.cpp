@@ -240,9 +240,12 @@ void Scheduler::scheduleInstruction(InstRef &IR) {
   reserveBuffers(Desc.Buffers);
   notifyReservedBuffers(Desc.Buffers);
 
-  // If necessary, reserve queue entries in the load-store unit (LSU).
+  // If necessary, reserve queue entries in the load-store unit (LSU). An
+  // in-order processor issues memory operations in program order, so they
+  // never wait for each other there.
   bool Reserved = LSU->reserve(IR);
-  if (!IR.getInstruction()->isReady() || (Reserved && !LSU->isReady(IR))) {
+  bool WaitsForLSU = Reserved && SM.isOutOfOrder() && !LSU->isReady(IR);
+  if (!IR.getInstruction()->isReady() || WaitsForLSU) {
     LLVM_DEBUG(dbgs() << "[SCHEDULER] Adding " << Idx
                       << " to the Wait Queue\n");
     WaitQueue[Idx] = IR.getInstruction();